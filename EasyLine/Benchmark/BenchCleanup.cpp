@@ -0,0 +1,83 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "LineCleanup.h"
+#include "LineDocument.h"
+#include "UndoHistory.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 5'000'000;
+
+// An import-like drawing: a grid of walls and diagonal hatching, tile by
+// tile, where about one line in six is a copy of an earlier one (half of
+// them reversed) and one in six a collinear piece overlapping one
+void BuildScene(LineDocument& document)
+{
+    std::mt19937 rng(47);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const Color color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    const int tilesPerRow = (int)std::ceil(std::sqrt((float)kLineCount / LineChunk::kCapacity));
+    const float tileSize = 256.0f;
+    std::vector<glm::vec2> recent;
+    for (int i = 0; i < kLineCount; i++) {
+        const int tile = i / (int)LineChunk::kCapacity;
+        const glm::vec2 base = glm::vec2(tile % tilesPerRow, tile / tilesPerRow) * tileSize;
+        const float roll = unit(rng);
+        if (recent.size() >= 64 && roll < 1.0f / 3.0f) {
+            const size_t line = (size_t)(unit(rng) * (recent.size() / 2 - 1)) * 2;
+            const glm::vec2 a = recent[line], b = recent[line + 1];
+            if (roll < 1.0f / 6.0f) {
+                if (i % 2) document.AddLine(a, b, 0.01f, color);
+                else document.AddLine(b, a, 0.01f, color);
+            } else {
+                // a piece from inside the line to beyond its end, on the same grid line
+                document.AddLine(a + (b - a) * 0.5f, b + (b - a) * 0.5f, 0.01f, color);
+            }
+            continue;
+        }
+        const glm::vec2 p = base + glm::floor(glm::vec2(unit(rng), unit(rng)) * (tileSize - 8.0f) * 8.0f) / 8.0f;
+        const float length = std::floor(unit(rng) * 6.0f) + 2.0f;
+        const int kind = (int)(unit(rng) * 3.0f);
+        const glm::vec2 q = p + (kind == 0 ? glm::vec2(length, 0.0f) : kind == 1 ? glm::vec2(0.0f, length) : glm::vec2(length, length * 0.5f));
+        document.AddLine(p, q, 0.01f, color);
+        if (recent.size() >= 4096) recent.erase(recent.begin(), recent.begin() + 2048);
+        recent.push_back(p);
+        recent.push_back(q);
+    }
+}
+
+} // namespace
+
+EL_BENCHMARK(Cleanup_Overkill)
+{
+    JobSystem::Init();
+    LineDocument document;
+    BuildScene(document);
+    UndoHistory history;
+    document.SetHistory(&history);
+    std::printf("  %d lines on %u workers\n", kLineCount, JobSystem::GetWorkerCount());
+
+    Timer timer;
+    const CleanupResult result = RemoveOverkill(document, 1e-3f);
+    const double cleanupMs = timer.ElapsedMs();
+    std::printf("  %-12s %8.1f ms, removed %zu lines (%.1f%%): %zu duplicates, %zu overlapping, %zu extended\n", "overkill", cleanupMs,
+        result.GetRemovedCount(), 100.0 * result.GetRemovedCount() / kLineCount, result.Duplicates, result.Overlaps, result.Extended);
+
+    timer.Reset();
+    history.Undo(document);
+    std::printf("  %-12s %8.1f ms\n", "undo", timer.ElapsedMs());
+
+    // a drawing with nothing to clean pays only the search
+    const CleanupResult again = RemoveOverkill(document, 1e-3f);
+    timer.Reset();
+    const CleanupResult clean = RemoveOverkill(document, 1e-3f);
+    std::printf("  %-12s %8.1f ms on the cleaned drawing, removed %zu\n", "search only", timer.ElapsedMs(), clean.GetRemovedCount());
+    DoNotOptimize(again.GetRemovedCount());
+    JobSystem::Shutdown();
+}
@@ -0,0 +1,87 @@
+#include "Benchmark.h"
+#include "Dimension.h"
+#include "GlyphAtlas.h"
+#include "JobSystem.h"
+#include <cstdio>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kDimensionCount = 20'000;
+
+void BuildDimensions(DimensionSet& dimensions)
+{
+    std::mt19937 rng(49);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < kDimensionCount; i++) {
+        Dimension dimension;
+        dimension.Kind = (DimensionKind)(i % 3);
+        dimension.P0 = glm::vec2(unit(rng), unit(rng)) * 1000.0f;
+        dimension.P1 = dimension.P0 + (glm::vec2(unit(rng), unit(rng)) - 0.5f) * 40.0f;
+        dimension.Location = (dimension.P0 + dimension.P1) * 0.5f + glm::vec2(unit(rng), unit(rng)) * 5.0f;
+        dimension.Angle = i % 2 ? 1.5707963f : 0.0f;
+        dimensions.Add(dimension);
+    }
+}
+
+} // namespace
+
+EL_BENCHMARK(Dimensions_Layout)
+{
+    GlyphAtlas atlas;
+    if (!atlas.Build("Resource/Font/Roboto-Medium.ttf", 48)) {
+        std::printf("  skipped: no font next to the benchmark\n");
+        return;
+    }
+    JobSystem::Init();
+    DimensionSet dimensions;
+    BuildDimensions(dimensions);
+    DimensionLayout layout;
+    std::printf("  %d dimensions on %u workers\n", kDimensionCount, JobSystem::GetWorkerCount());
+
+    Timer timer;
+    layout.Update(dimensions, atlas, 0.01f);
+    std::printf("  %-14s %8.2f ms, %zu strings, %zu quads (%.1f MB)\n", "first layout", timer.ElapsedMs(), layout.GetLaidOutCount(),
+        layout.GetQuads().size(), layout.GetQuads().size() * sizeof(GlyphQuad) / 1e6);
+
+    // a frame where nothing changed, and one that zooms within the same step
+    const int frames = 10000;
+    timer.Reset();
+    for (int i = 0; i < frames; i++) DoNotOptimize(layout.Update(dimensions, atlas, i % 2 ? 0.01f : 0.0101f));
+    std::printf("  %-14s %8.3f us per frame\n", "unchanged", timer.ElapsedMs() * 1000.0 / frames);
+
+    // zooming to the next step places every dimension again from cached strings
+    timer.Reset();
+    layout.Update(dimensions, atlas, 0.02f);
+    std::printf("  %-14s %8.2f ms, %zu strings\n", "zoom step", timer.ElapsedMs(), layout.GetLaidOutCount());
+
+    // moving one dimension formats only its string
+    Dimension moved = dimensions.Get(0);
+    moved.P1 += glm::vec2(1.0f, 0.0f);
+    dimensions.Set(0, moved);
+    timer.Reset();
+    layout.Update(dimensions, atlas, 0.02f);
+    std::printf("  %-14s %8.2f ms, %zu strings\n", "one edited", timer.ElapsedMs(), layout.GetLaidOutCount());
+    JobSystem::Shutdown();
+}
+
+EL_BENCHMARK(Dimensions_GlyphAtlas)
+{
+    // computing the distance fields against loading them from the cache
+    const char* cachePath = "bench_glyphs.sdf";
+    std::remove(cachePath);
+    GlyphAtlas atlas;
+    Timer timer;
+    if (!atlas.Build("Resource/Font/Roboto-Medium.ttf", 48, cachePath)) {
+        std::printf("  skipped: no font next to the benchmark\n");
+        return;
+    }
+    std::printf("  %-14s %8.1f ms, %d x %d\n", "generate", timer.ElapsedMs(), atlas.GetWidth(), atlas.GetHeight());
+    timer.Reset();
+    atlas.Build("Resource/Font/Roboto-Medium.ttf", 48, cachePath);
+    std::printf("  %-14s %8.1f ms\n", "from cache", timer.ElapsedMs());
+    std::remove(cachePath);
+}
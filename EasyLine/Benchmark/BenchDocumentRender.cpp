@@ -0,0 +1,78 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "LineTessellator.h"
+#include <algorithm>
+#include <random>
+#include <thread>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 2'000'000;
+constexpr int kFrames = 10;
+
+void BuildScene(LineDocument& document)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < kLineCount; i++) {
+        float cx = (float)(i / (int)LineChunk::kCapacity);
+        glm::vec2 p0 = { cx + unit(rng), unit(rng) * 100.0f };
+        glm::vec2 p1 = p0 + glm::vec2(unit(rng), unit(rng)) * 0.1f;
+        document.AddLine(p0, p1, 0.01f, { 1.0f, 1.0f, 1.0f, 1.0f });
+    }
+}
+
+// One frame of Renderer::DrawDocument's CPU side
+double CullAndTessellate(const LineDocument& document, const AABB& view, std::vector<std::vector<LineVertex>>& staging)
+{
+    Timer timer;
+    JobSystem::ParallelFor(document.GetChunkCount(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            staging[i].clear();
+            CullAndTessellateChunk(document.GetChunk(i), view, staging[i]);
+        }
+    });
+    return timer.ElapsedMs();
+}
+
+} // namespace
+
+EL_BENCHMARK(JobSystem_CullAndTessellate)
+{
+    LineDocument document;
+    BuildScene(document);
+    std::vector<std::vector<LineVertex>> staging(document.GetChunkCount());
+
+    const AABB full = document.GetBounds();
+    const AABB half = { full.Min, { full.GetCenter().x, full.Max.y } };
+
+    std::vector<uint32_t> workerCounts = { 0 };
+    const uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t n = 1; n < hw; n *= 2) workerCounts.push_back(n);
+    if (hw > 1 && workerCounts.back() != hw - 1) workerCounts.push_back(hw - 1);
+
+    std::printf("  %d lines in %zu chunks, %u hardware threads\n", kLineCount, document.GetChunkCount(), hw);
+    double baseline = 0.0;
+    for (uint32_t workers : workerCounts) {
+        if (workers > 0) JobSystem::Init(workers);
+
+        CullAndTessellate(document, full, staging);  // warm staging capacity
+        double fullMs = 0.0, halfMs = 0.0;
+        for (int f = 0; f < kFrames; f++) {
+            fullMs += CullAndTessellate(document, full, staging);
+            halfMs += CullAndTessellate(document, half, staging);
+        }
+        fullMs /= kFrames;
+        halfMs /= kFrames;
+        if (workers == 0) baseline = fullMs;
+
+        std::printf("  %2u workers + caller: all visible %8.2f ms (x%.2f)   half visible %8.2f ms\n",
+            workers, fullMs, baseline / fullMs, halfMs);
+
+        JobSystem::Shutdown();
+    }
+}
@@ -0,0 +1,82 @@
+#include "Benchmark.h"
+#include "DxfWriter.h"
+#include "FileWriter.h"
+#include "LineDocument.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 2'000'000;
+
+void BuildScene(LineDocument& document)
+{
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < kLineCount; i++) {
+        glm::vec2 p0 = { unit(rng) * 1000.0f, unit(rng) * 1000.0f };
+        glm::vec2 p1 = p0 + glm::vec2(unit(rng), unit(rng));
+        Color color = (i % 4 == 0) ? Color{ 1.0f, 0.0f, 0.0f, 1.0f } : Color{ 1.0f, 1.0f, 1.0f, 1.0f };
+        document.AddLine(p0, p1, 0.01f, color);
+    }
+}
+
+// What the exporter replaced: iostream formatting, same content
+void WriteWithStream(const LineDocument& document, const std::string& path)
+{
+    std::ofstream out(path);
+    out.precision(9);
+    out << "  0\nSECTION\n  2\nENTITIES\n";
+    for (size_t c = 0; c < document.GetChunkCount(); c++) {
+        const LineChunk& chunk = document.GetChunk(c);
+        for (uint32_t i = 0; i < chunk.Count; i++) {
+            out << "  0\nLINE\n  8\n0\n 10\n" << chunk.X0[i] << "\n 20\n" << chunk.Y0[i]
+                << "\n 11\n" << chunk.X1[i] << "\n 21\n" << chunk.Y1[i] << "\n";
+        }
+    }
+    out << "  0\nENDSEC\n  0\nEOF\n";
+}
+
+} // namespace
+
+EL_BENCHMARK(Dxf_ExportThroughput)
+{
+    LineDocument document;
+    BuildScene(document);
+    const std::string path = (std::filesystem::temp_directory_path() / "EasyLineBenchmark.dxf").string();
+
+    // to_chars + FileWriter
+    Timer timer;
+    HeapStats heap = GetHeapStats();
+    FileWriter out;
+    out.Open(path);
+    WriteDxf(document, out);
+    const uint64_t bytes = out.GetBytesWritten();
+    out.Close();
+    const double writerMs = timer.ElapsedMs();
+    const HeapStats writerHeap = GetHeapStats() - heap;
+
+    // the same bytes again as one raw write: the disk-bound floor
+    std::vector<char> raw(bytes, 'x');
+    timer.Reset();
+    out.Open(path);
+    out.Write(raw.data(), raw.size());
+    out.Close();
+    const double rawMs = timer.ElapsedMs();
+
+    timer.Reset();
+    WriteWithStream(document, path);
+    const double streamMs = timer.ElapsedMs();
+    std::remove(path.c_str());
+
+    std::printf("  %d lines, %.1f MB\n", kLineCount, bytes / 1e6);
+    std::printf("  FileWriter + to_chars: %8.2f ms  %7.1f MB/s  %zu heap allocations\n", writerMs, bytes / 1e3 / writerMs,
+        (size_t)writerHeap.Allocations);
+    std::printf("  raw write floor:       %8.2f ms  %7.1f MB/s\n", rawMs, bytes / 1e3 / rawMs);
+    std::printf("  ofstream <<:           %8.2f ms  %7.1f MB/s\n", streamMs, bytes / 1e3 / streamMs);
+}
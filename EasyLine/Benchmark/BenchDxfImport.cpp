@@ -0,0 +1,157 @@
+#include "Benchmark.h"
+#include "DocumentLoader.h"
+#include "DxfReader.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "Log.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <thread>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kEntityCount = 1'000'000;
+constexpr int kRuns = 3;
+
+// Writes the same drawing as ASCII or binary DXF: mostly LINEs, plus polylines,
+// circles and inserts of a small block, roughly like a floor plan export
+class DxfWriter {
+public:
+    explicit DxfWriter(bool binary) : m_Binary(binary) {
+        if (m_Binary) m_Data.append("AutoCAD Binary DXF\r\n\x1a", 22);
+    }
+
+    void String(int code, std::string_view value) {
+        if (m_Binary) {
+            Code(code);
+            m_Data.append(value);
+            m_Data.push_back('\0');
+        } else {
+            fmt::format_to(std::back_inserter(m_Data), "{:>3}\n{}\n", code, value);
+        }
+    }
+
+    void Double(int code, double value) {
+        if (m_Binary) {
+            Code(code);
+            m_Data.append((const char*)&value, sizeof(value));
+        } else {
+            fmt::format_to(std::back_inserter(m_Data), "{:>3}\n{}\n", code, value);
+        }
+    }
+
+    void Int(int code, int value) {
+        if (m_Binary && code >= 90 && code <= 99) {
+            int32_t v = value;
+            Code(code);
+            m_Data.append((const char*)&v, sizeof(v));
+        } else if (m_Binary) {
+            int16_t v = (int16_t)value;
+            Code(code);
+            m_Data.append((const char*)&v, sizeof(v));
+        } else {
+            fmt::format_to(std::back_inserter(m_Data), "{:>3}\n{:>6}\n", code, value);
+        }
+    }
+
+    const std::string& GetData() const { return m_Data; }
+
+private:
+    void Code(int code) {
+        uint16_t c = (uint16_t)code;
+        m_Data.append((const char*)&c, sizeof(c));
+    }
+
+    bool m_Binary;
+    std::string m_Data;
+};
+
+std::string BuildDxf(bool binary) {
+    DxfWriter w(binary);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    w.String(0, "SECTION"); w.String(2, "TABLES");
+    w.String(0, "TABLE"); w.String(2, "LAYER");
+    w.String(0, "LAYER"); w.String(2, "WALLS"); w.Int(62, 3);
+    w.String(0, "ENDTAB");
+    w.String(0, "ENDSEC");
+
+    w.String(0, "SECTION"); w.String(2, "BLOCKS");
+    w.String(0, "BLOCK"); w.String(8, "0"); w.String(2, "DOOR"); w.Double(10, 0.0); w.Double(20, 0.0);
+    w.String(0, "LINE"); w.String(8, "0"); w.Double(10, 0.0); w.Double(20, 0.0); w.Double(11, 0.9); w.Double(21, 0.0);
+    w.String(0, "ARC"); w.String(8, "0"); w.Double(10, 0.0); w.Double(20, 0.0); w.Double(40, 0.9); w.Double(50, 0.0); w.Double(51, 90.0);
+    w.String(0, "ENDBLK");
+    w.String(0, "ENDSEC");
+
+    w.String(0, "SECTION"); w.String(2, "ENTITIES");
+    for (int i = 0; i < kEntityCount; i++) {
+        double x = (double)(i % 1000) + unit(rng), y = (double)(i / 1000) + unit(rng);
+        switch (i % 20) {
+        case 0:
+            w.String(0, "LWPOLYLINE"); w.String(8, "WALLS"); w.Int(90, 4); w.Int(70, 1);
+            w.Double(10, x); w.Double(20, y); w.Double(10, x + 0.5); w.Double(20, y);
+            w.Double(10, x + 0.5); w.Double(20, y + 0.5); w.Double(10, x); w.Double(20, y + 0.5);
+            break;
+        case 1:
+            w.String(0, "CIRCLE"); w.String(8, "0"); w.Double(10, x); w.Double(20, y); w.Double(40, 0.2);
+            break;
+        case 2:
+            w.String(0, "INSERT"); w.String(8, "0"); w.String(2, "DOOR"); w.Double(10, x); w.Double(20, y); w.Double(50, 90.0);
+            break;
+        default:
+            w.String(0, "LINE"); w.String(8, "WALLS"); w.Int(62, 1 + i % 255);
+            w.Double(10, x); w.Double(20, y); w.Double(11, x + unit(rng) * 0.2); w.Double(21, y + unit(rng) * 0.2);
+            break;
+        }
+    }
+    w.String(0, "ENDSEC");
+    w.String(0, "EOF");
+    return w.GetData();
+}
+
+// Parse the whole buffer and move the chunks into a document, like a LoadAsync + Poll loop
+double Import(const std::string& data, size_t& lines) {
+    Timer timer;
+    LoadTask task("bench.dxf");
+    task.SetTotalBytes(data.size());
+    std::string error;
+    if (!ReadDxf((const uint8_t*)data.data(), data.size(), task, error))
+        std::printf("  import failed: %s\n", error.c_str());
+    LineDocument document;
+    task.Poll(document);
+    lines = document.GetLineCount();
+    return timer.ElapsedMs();
+}
+
+} // namespace
+
+EL_BENCHMARK(Dxf_ImportThroughput)
+{
+    const std::string ascii = BuildDxf(false);
+    const std::string binary = BuildDxf(true);
+
+    std::vector<uint32_t> workerCounts = { 0 };
+    const uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
+    if (hw > 1) workerCounts.push_back(hw - 1);
+
+    std::printf("  %d entities: ASCII %.1f MB, binary %.1f MB\n", kEntityCount, ascii.size() / 1e6, binary.size() / 1e6);
+    for (uint32_t workers : workerCounts) {
+        if (workers > 0) JobSystem::Init(workers);
+
+        for (const std::string* data : { &ascii, &binary }) {
+            size_t lines = 0;
+            double best = 1e30;
+            for (int r = 0; r < kRuns; r++) best = std::min(best, Import(*data, lines));
+            std::printf("  %2u workers + caller, %-6s: %8.2f ms  %8.1f MB/s  %zu lines\n", workers,
+                data == &ascii ? "ASCII" : "binary", best, data->size() / 1e6 / (best / 1000.0), lines);
+        }
+
+        JobSystem::Shutdown();
+    }
+}
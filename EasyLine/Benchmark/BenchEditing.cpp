@@ -0,0 +1,134 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "LineEditing.h"
+#include "Predicates.h"
+#include "UndoHistory.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 2'000'000;
+constexpr int kEdits = 1000;
+
+// Short lines at about one per unit square, each crossing one or two others,
+// added tile by tile so that each chunk covers one area as in a loaded
+// drawing, and long horizontal and vertical lines across it all at the end
+// like a grid layer
+void BuildScene(LineDocument& document)
+{
+    std::mt19937 rng(45);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const Color color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    const int longLines = kLineCount / 1000;
+    const int tiles = (kLineCount - longLines + (int)LineChunk::kCapacity - 1) / (int)LineChunk::kCapacity;
+    const int tilesPerRow = (int)std::ceil(std::sqrt((float)tiles));
+    const float tileSize = std::sqrt((float)LineChunk::kCapacity);
+    for (int i = 0; i < kLineCount - longLines; i++) {
+        const int tile = i / (int)LineChunk::kCapacity;
+        const glm::vec2 base = glm::vec2(tile % tilesPerRow, tile / tilesPerRow) * tileSize;
+        const glm::vec2 p0 = base + glm::vec2(unit(rng), unit(rng)) * tileSize;
+        const float angle = unit(rng) * 6.2831853f, length = unit(rng) * 2.0f;
+        document.AddLine(p0, p0 + length * glm::vec2(std::cos(angle), std::sin(angle)), 0.01f, color);
+    }
+    const float size = tilesPerRow * tileSize;
+    for (int i = 0; i < longLines; i++) {
+        const float at = unit(rng) * size;
+        if (i % 2 == 0) document.AddLine({ 0.0f, at }, { size, at }, 0.01f, color);
+        else document.AddLine({ at, 0.0f }, { at, size }, 0.01f, color);
+    }
+}
+
+glm::vec2 Midpoint(const LineDocument& document, LineHandle handle)
+{
+    const LineChunk& chunk = document.GetChunk(GetHandleChunk(handle));
+    const uint32_t slot = GetHandleSlot(handle);
+    return { (chunk.X0[slot] + chunk.X1[slot]) * 0.5f, (chunk.Y0[slot] + chunk.Y1[slot]) * 0.5f };
+}
+
+// What finding the boundaries costs without the index: every line tested against the one trimmed
+double ScanForBoundaries(const LineDocument& document, LineHandle handle, size_t& crossings)
+{
+    const LineChunk& line = document.GetChunk(GetHandleChunk(handle));
+    const uint32_t s = GetHandleSlot(handle);
+    const glm::dvec2 a = { line.X0[s], line.Y0[s] }, b = { line.X1[s], line.Y1[s] };
+    Timer timer;
+    for (size_t c = 0; c < document.GetChunkCount(); c++) {
+        const LineChunk& chunk = document.GetChunk(c);
+        for (uint32_t slot = 0; slot < chunk.Count; slot++) {
+            if (std::max(chunk.X0[slot], chunk.X1[slot]) < std::min(a.x, b.x) || std::min(chunk.X0[slot], chunk.X1[slot]) > std::max(a.x, b.x) ||
+                std::max(chunk.Y0[slot], chunk.Y1[slot]) < std::min(a.y, b.y) || std::min(chunk.Y0[slot], chunk.Y1[slot]) > std::max(a.y, b.y))
+                continue;
+            const glm::dvec2 c0 = { chunk.X0[slot], chunk.Y0[slot] }, c1 = { chunk.X1[slot], chunk.Y1[slot] };
+            const double o0 = Orient2D(c0, c1, a), o1 = Orient2D(c0, c1, b);
+            crossings += (o0 > 0.0) != (o1 > 0.0);
+        }
+    }
+    return timer.ElapsedMs();
+}
+
+template<typename Edit>
+void Measure(const char* name, LineDocument& document, UndoHistory& history, Edit&& edit)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> pick(0, kLineCount - 1);
+    double totalMs = 0.0, worstMs = 0.0, indexMs = 0.0;
+    int applied = 0;
+    for (int i = 0; i < kEdits; i++) {
+        const LineHandle handle = MakeLineHandle(pick(rng) / LineChunk::kCapacity, pick(rng) % LineChunk::kCapacity);
+        if (!document.IsLineValid(handle)) continue;
+        Timer timer;
+        applied += edit(handle, Midpoint(document, handle));
+        const double editMs = timer.ElapsedMs();
+        // what the next frame pays: the trees of the edited chunks
+        timer.Reset();
+        document.UpdateSpatialIndex();
+        const double updateMs = timer.ElapsedMs();
+        totalMs += editMs + updateMs;
+        indexMs += updateMs;
+        worstMs = std::max(worstMs, editMs + updateMs);
+        history.Undo(document);
+        document.UpdateSpatialIndex();
+    }
+    std::printf("  %-20s %7.4f ms average (%.4f ms index update), %7.4f ms worst, %d of %d applied\n", name, totalMs / kEdits,
+        indexMs / kEdits, worstMs, applied, kEdits);
+}
+
+} // namespace
+
+EL_BENCHMARK(Editing_TrimExtendFillet)
+{
+    JobSystem::Init();
+    LineDocument document;
+    BuildScene(document);
+    document.UpdateSpatialIndex();
+    UndoHistory history;
+    document.SetHistory(&history);
+    std::printf("  %d lines, each edit applied, indexed and undone\n", kLineCount);
+
+    Measure("trim at midpoint", document, history,
+        [&](LineHandle handle, const glm::vec2& point) { return TrimLine(document, handle, point); });
+    Measure("extend nearer end", document, history,
+        [&](LineHandle handle, const glm::vec2& point) { return ExtendLine(document, handle, point + 0.001f); });
+    // a fence a few units long through the line, as dragged across a detail
+    Measure("fence trim", document, history, [&](LineHandle handle, const glm::vec2& point) {
+        return TrimFence(document, point - glm::vec2(2.0f, 1.0f), point + glm::vec2(2.0f, 1.0f)) > 0;
+    });
+    Measure("fillet r=0.1", document, history, [&](LineHandle handle, const glm::vec2& point) {
+        // with the next line in the chunk, wherever it is
+        const LineHandle other = handle ^ 1;
+        return FilletLines(document, handle, point, other, Midpoint(document, other), 0.1f);
+    });
+
+    size_t crossings = 0;
+    double scanMs = 0.0;
+    for (int i = 0; i < 20; i++) scanMs += ScanForBoundaries(document, MakeLineHandle(i * 7, i), crossings);
+    DoNotOptimize(crossings);
+    std::printf("  %-20s %7.4f ms per line, to find the boundaries by testing every line\n", "without the index", scanMs / 20);
+    JobSystem::Shutdown();
+}
@@ -0,0 +1,140 @@
+#include "Benchmark.h"
+#include "DocumentLoader.h"
+#include "ElbFormat.h"
+#include "FileWriter.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 4'000'000;
+
+// Something like a building plan in meters, drawn to the millimeter: closed
+// rooms as polylines, door swings as flattened arcs, a handful of colors
+void BuildPlan(LineDocument& document)
+{
+    std::mt19937 rng(21);
+    std::uniform_int_distribution<int> mm(500, 6000);
+    const Color colors[] = { { 1.0f, 1.0f, 1.0f, 1.0f }, { 1.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 1.0f, 1.0f } };
+    int room = 0;
+    while ((int)document.GetLineCount() < kLineCount) {
+        const glm::vec2 origin = { (float)(room % 500) * 8.0f, (float)(room / 500) * 8.0f };
+        const glm::vec2 size = { mm(rng) / 1000.0f, mm(rng) / 1000.0f };
+        const Color& color = colors[room % 3];
+        const glm::vec2 corners[] = { origin, origin + glm::vec2(size.x, 0.0f), origin + size, origin + glm::vec2(0.0f, size.y) };
+        for (int i = 0; i < 4; i++) document.AddLine(corners[i], corners[(i + 1) % 4], 0.01f, color);
+
+        const glm::vec2 hinge = origin + glm::vec2(0.1f, 0.0f);
+        for (int s = 0; s < 16; s++) {
+            const float a0 = s * 1.5707963f / 16.0f, a1 = (s + 1) * 1.5707963f / 16.0f;
+            document.AddLine(hinge + 0.9f * glm::vec2(std::cos(a0), std::sin(a0)), hinge + 0.9f * glm::vec2(std::cos(a1), std::sin(a1)), 0.005f, color);
+        }
+        room++;
+    }
+    document.UpdateSpatialIndex();
+}
+
+// Unconnected random segments with random colors: close to the worst case
+void BuildNoise(LineDocument& document)
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < kLineCount; i++) {
+        float cx = (float)(i / (int)LineChunk::kCapacity);
+        glm::vec2 p0 = { cx + unit(rng), unit(rng) * 100.0f };
+        glm::vec2 p1 = p0 + glm::vec2(unit(rng), unit(rng)) * 0.1f;
+        document.AddLine(p0, p1, 0.01f, { unit(rng), unit(rng), unit(rng), 1.0f });
+    }
+    document.UpdateSpatialIndex();
+}
+
+uint64_t Save(const LineDocument& document, const std::string& path, bool compressed, double& ms)
+{
+    Timer timer;
+    FileWriter out;
+    out.Open(path);
+    compressed ? WriteElbCompressed(document, out) : WriteElb(document, out);
+    const uint64_t bytes = out.GetBytesWritten();
+    out.Close();
+    ms = timer.ElapsedMs();
+    return bytes;
+}
+
+// Open and read every line once, as the first full redraw would
+double Open(const std::string& path, LineDocument& document)
+{
+    Timer timer;
+    auto file = std::make_shared<MappedFile>();
+    file->Open(path);
+    LoadTask task(path);
+    std::string error;
+    if (!ReadElb(*file, task, error)) std::printf("  open failed: %s\n", error.c_str());
+    task.Poll(document);
+    float sum = 0.0f;
+    for (size_t c = 0; c < document.GetChunkCount(); c++) {
+        const LineChunk& chunk = document.GetChunk(c);
+        for (uint32_t i = 0; i < chunk.Count; i++) sum += chunk.X0[i] + chunk.Y1[i];
+    }
+    DoNotOptimize(sum);
+    return timer.ElapsedMs();
+}
+
+float GetMaxError(const LineDocument& a, const LineDocument& b)
+{
+    float error = 0.0f;
+    for (size_t c = 0; c < a.GetChunkCount(); c++) {
+        const LineChunk& x = a.GetChunk(c);
+        const LineChunk& y = b.GetChunk(c);
+        for (uint32_t i = 0; i < x.Count; i++) {
+            error = std::max({ error, std::abs(x.X0[i] - y.X0[i]), std::abs(x.Y0[i] - y.Y0[i]),
+                std::abs(x.X1[i] - y.X1[i]), std::abs(x.Y1[i] - y.Y1[i]) });
+        }
+    }
+    return error;
+}
+
+} // namespace
+
+EL_BENCHMARK(Elb_Compress)
+{
+    JobSystem::Init();
+    const std::string plainPath = (std::filesystem::temp_directory_path() / "EasyLineBenchmark.elb").string();
+    const std::string packedPath = (std::filesystem::temp_directory_path() / "EasyLineBenchmark.elbz").string();
+
+    for (bool plan : { true, false }) {
+        LineDocument source;
+        plan ? BuildPlan(source) : BuildNoise(source);
+
+        double plainSaveMs = 0.0, packedSaveMs = 0.0;
+        const uint64_t plainBytes = Save(source, plainPath, false, plainSaveMs);
+        const uint64_t packedBytes = Save(source, packedPath, true, packedSaveMs);
+
+        double plainOpenMs = 1e30, packedOpenMs = 1e30;
+        float error = 0.0f;
+        for (int r = 0; r < 3; r++) {
+            LineDocument plain, packed;
+            plainOpenMs = std::min(plainOpenMs, Open(plainPath, plain));
+            packedOpenMs = std::min(packedOpenMs, Open(packedPath, packed));
+            error = GetMaxError(source, packed);
+        }
+
+        std::printf("  %s, %zu lines:\n", plan ? "plan" : "noise", source.GetLineCount());
+        std::printf("    .elb  %8.1f MB  save %7.1f ms  open + read %7.1f ms\n", plainBytes / 1e6, plainSaveMs, plainOpenMs);
+        std::printf("    .elbz %8.1f MB  save %7.1f ms  open + read %7.1f ms  (%.1fx smaller, %.1f bytes/line, max error %g)\n",
+            packedBytes / 1e6, packedSaveMs, packedOpenMs, (double)plainBytes / packedBytes,
+            (double)packedBytes / source.GetLineCount(), error);
+    }
+
+    std::remove(plainPath.c_str());
+    std::remove(packedPath.c_str());
+    JobSystem::Shutdown();
+}
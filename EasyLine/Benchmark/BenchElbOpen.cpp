@@ -0,0 +1,75 @@
+#include "Benchmark.h"
+#include "DocumentLoader.h"
+#include "ElbFormat.h"
+#include "FileWriter.h"
+#include "LineDocument.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+void BuildScene(LineDocument& document, int lineCount)
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < lineCount; i++) {
+        float cx = (float)(i / (int)LineChunk::kCapacity);
+        glm::vec2 p0 = { cx + unit(rng), unit(rng) * 100.0f };
+        glm::vec2 p1 = p0 + glm::vec2(unit(rng), unit(rng)) * 0.1f;
+        document.AddLine(p0, p1, 0.01f, { 1.0f, 1.0f, 1.0f, 1.0f });
+    }
+    document.UpdateSpatialIndex();
+}
+
+// Map, validate and hand every chunk to a document, like LoadAsync + Poll
+double Open(const std::string& path, LineDocument& document)
+{
+    Timer timer;
+    auto file = std::make_shared<MappedFile>();
+    file->Open(path);
+    LoadTask task(path);
+    std::string error;
+    if (!ReadElb(*file, task, error)) std::printf("  open failed: %s\n", error.c_str());
+    task.Poll(document);
+    return timer.ElapsedMs();
+}
+
+} // namespace
+
+EL_BENCHMARK(Elb_Open)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "EasyLineBenchmark.elb").string();
+
+    // below and above kElbVerifyLimit: the first pays for reading every page once
+    for (int lineCount : { 4'000'000, 16'000'000 }) {
+        double saveMs = 0.0;
+        uint64_t bytes = 0;
+        {
+            LineDocument source;
+            BuildScene(source, lineCount);
+            Timer timer;
+            FileWriter out;
+            out.Open(path);
+            WriteElb(source, out);
+            bytes = out.GetBytesWritten();
+            out.Close();
+            saveMs = timer.ElapsedMs();
+        }
+
+        LineDocument document;
+        const double openMs = Open(path, document);
+        size_t visible = 0;
+        Timer query;
+        document.QueryLines({ { 10.0f, 10.0f }, { 12.0f, 12.0f } }, [&](LineHandle) { visible++; });
+        const double queryMs = query.ElapsedMs();
+
+        std::printf("  %9d lines, %7.1f MB: save %8.2f ms, open %7.2f ms%s, first query %.2f ms (%zu lines)\n", lineCount,
+            bytes / 1e6, saveMs, openMs, bytes <= kElbVerifyLimit ? " (verified)" : "", queryMs, visible);
+    }
+    std::remove(path.c_str());
+}
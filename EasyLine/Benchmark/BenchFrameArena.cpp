@@ -0,0 +1,90 @@
+#include "Benchmark.h"
+#include "FrameArena.h"
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr size_t kLineCount = 1'000'000;
+constexpr size_t kDimensionCount = 1000;
+constexpr int kFrames = 20;
+
+struct Vertex { float x, y, r, g, b, a; };
+
+// The per-frame work the editor does on a big scene: expand every line into
+// two triangles, collect the visible and selected lines, format dimension labels.
+template<typename VertexVector, typename IndexVector, typename MakeLabel>
+size_t SimulateFrame(VertexVector& vertices, IndexVector& visible, IndexVector& selected, MakeLabel&& makeLabel)
+{
+    for (uint32_t i = 0; i < kLineCount; i++) {
+        float x = (float)(i % 1000), y = (float)(i / 1000);
+        Vertex v = { x, y, 1.0f, 0.0f, 0.0f, 1.0f };
+        for (int k = 0; k < 6; k++) vertices.push_back(v);
+        if ((i & 3) != 0) visible.push_back(i);
+        if ((i & 63) == 0) selected.push_back(i);
+    }
+    size_t labelBytes = 0;
+    for (size_t i = 0; i < kDimensionCount; i++)
+        labelBytes += makeLabel((double)i * 0.125);
+    return vertices.size() + visible.size() + selected.size() + labelBytes;
+}
+
+void Report(const char* name, const HeapStats& heap, double ms)
+{
+    std::printf("  %-14s %10.1f allocs/frame %10.2f MB/frame %8.2f ms/frame\n", name,
+        (double)heap.Allocations / kFrames, (double)heap.Bytes / kFrames / (1024.0 * 1024.0), ms / kFrames);
+}
+
+} // namespace
+
+EL_BENCHMARK(FrameArena_TransientContainers)
+{
+    std::printf("  %zu lines, %zu dimension labels, %d frames\n", kLineCount, kDimensionCount, kFrames);
+
+    // Before: transient std:: containers on the general heap
+    {
+        HeapStats before = GetHeapStats();
+        Timer timer;
+        for (int frame = 0; frame < kFrames; frame++) {
+            std::vector<Vertex> vertices;
+            std::vector<uint32_t> visible, selected;
+            size_t n = SimulateFrame(vertices, visible, selected, [](double value) {
+                std::string label = fmt::format("{:.3f} mm", value);
+                DoNotOptimize(label);
+                return label.size();
+            });
+            DoNotOptimize(n);
+        }
+        double ms = timer.ElapsedMs();
+        Report("heap", GetHeapStats() - before, ms);
+    }
+
+    // After: the same containers on a FrameArena, reset at the end of every frame
+    {
+        FrameArena arena;
+        HeapStats before = GetHeapStats();
+        Timer timer;
+        for (int frame = 0; frame < kFrames; frame++) {
+            {
+                FrameVector<Vertex> vertices(&arena);
+                FrameVector<uint32_t> visible(&arena), selected(&arena);
+                size_t n = SimulateFrame(vertices, visible, selected, [&arena](double value) {
+                    std::string_view label = arena.Format("{:.3f} mm", value);
+                    DoNotOptimize(label);
+                    return label.size();
+                });
+                DoNotOptimize(n);
+            }
+            arena.Reset();
+        }
+        double ms = timer.ElapsedMs();
+        Report("frame arena", GetHeapStats() - before, ms);
+        std::printf("  arena capacity %.1f MB, high water %.1f MB, %zu upstream block allocations total\n",
+            arena.GetCapacity() / (1024.0 * 1024.0), arena.GetHighWaterMark() / (1024.0 * 1024.0),
+            arena.GetUpstreamAllocationCount());
+    }
+}
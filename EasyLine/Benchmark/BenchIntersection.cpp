@@ -0,0 +1,98 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "SegmentIntersection.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+// Naive runs are quadratic; larger sets are timed on a subset of this size and scaled
+constexpr size_t kNaiveLimit = 100'000;
+
+// Short segments at about one per unit square, so each crosses one or two
+// others, plus a few long horizontal and vertical lines across the drawing
+// like grid or border lines that cross thousands
+std::vector<LineSegment> BuildScene(size_t count)
+{
+    std::mt19937 rng((uint32_t)count);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float size = std::sqrt((float)count);
+    std::vector<LineSegment> segments;
+    segments.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (i % 1000 == 0) {
+            const float at = unit(rng) * size;
+            segments.push_back(i % 2000 == 0 ? LineSegment{ { 0.0f, at }, { size, at } } : LineSegment{ { at, 0.0f }, { at, size } });
+            continue;
+        }
+        const glm::vec2 p0 = glm::vec2(unit(rng), unit(rng)) * size;
+        const float angle = unit(rng) * 6.2831853f, length = unit(rng) * 2.0f;
+        segments.push_back({ p0, p0 + length * glm::vec2(std::cos(angle), std::sin(angle)) });
+    }
+    return segments;
+}
+
+void Sort(std::vector<SegmentIntersection>& intersections)
+{
+    std::sort(intersections.begin(), intersections.end(), [](const SegmentIntersection& a, const SegmentIntersection& b) {
+        return a.A != b.A ? a.A < b.A : a.B < b.B;
+    });
+}
+
+bool IsSame(const std::vector<SegmentIntersection>& a, const std::vector<SegmentIntersection>& b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (a[i].A != b[i].A || a[i].B != b[i].B || a[i].Point != b[i].Point || a[i].Overlap != b[i].Overlap) return false;
+    return true;
+}
+
+void Run(size_t count)
+{
+    const std::vector<LineSegment> segments = BuildScene(count);
+    std::vector<SegmentIntersection> sweep, parallel;
+
+    Timer timer;
+    FindIntersections(segments, sweep);
+    const double sweepMs = timer.ElapsedMs();
+    timer.Reset();
+    FindIntersectionsParallel(segments, parallel);
+    const double parallelMs = timer.ElapsedMs();
+    Sort(sweep);
+    Sort(parallel);
+    std::printf("  %7zu segments: %8zu intersections\n", count, sweep.size());
+    std::printf("    sweep                %9.1f ms\n", sweepMs);
+    std::printf("    sweep, x-slabs       %9.1f ms%s\n", parallelMs, IsSame(sweep, parallel) ? "" : " (results differ)");
+
+    if (count <= kNaiveLimit) {
+        std::vector<SegmentIntersection> naive;
+        timer.Reset();
+        FindIntersectionsNaive(segments, naive);
+        const double naiveMs = timer.ElapsedMs();
+        Sort(naive);
+        std::printf("    naive O(n^2)         %9.1f ms%s\n", naiveMs, IsSame(sweep, naive) ? "" : " (results differ)");
+    } else {
+        // the first kNaiveLimit segments are a uniform sample of the scene
+        const std::vector<LineSegment> subset(segments.begin(), segments.begin() + kNaiveLimit);
+        std::vector<SegmentIntersection> naive;
+        timer.Reset();
+        FindIntersectionsNaive(subset, naive);
+        const double scale = (double)count / kNaiveLimit;
+        std::printf("    naive O(n^2)         %9.0f ms (estimated from %zu segments)\n", timer.ElapsedMs() * scale * scale, kNaiveLimit);
+    }
+}
+
+} // namespace
+
+EL_BENCHMARK(Intersection_SweepVsNaive)
+{
+    JobSystem::Init();
+    std::printf("  %u workers\n", JobSystem::GetWorkerCount());
+    Run(100'000);
+    Run(1'000'000);
+    JobSystem::Shutdown();
+}
@@ -0,0 +1,79 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "LineTopology.h"
+#include "LoopOperations.h"
+#include "UndoHistory.h"
+#include <cmath>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kOutlineCount = 10'000;
+
+// A part outline: a wobbly disc of 24 to 96 vertices with notches cut in,
+// so offsets have both corners that open and ones that close
+Ring MakeOutline(std::mt19937& rng, const glm::dvec2& center)
+{
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const int vertices = 24 + (int)(unit(rng) * 72.0);
+    Ring ring;
+    for (int i = 0; i < vertices; i++) {
+        const double angle = 6.283185307179586 * i / vertices;
+        const double radius = (i % 6 == 3 ? 0.55 : 1.0) * (3.0 + unit(rng));
+        ring.push_back(center + radius * glm::dvec2(std::cos(angle), std::sin(angle)));
+    }
+    return ring;
+}
+
+} // namespace
+
+EL_BENCHMARK(Loops_OffsetBoolean)
+{
+    JobSystem::Init();
+    std::mt19937 rng(48);
+    LineDocument document;
+    const Color color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    const int perRow = (int)std::ceil(std::sqrt((double)kOutlineCount));
+    std::vector<Ring> outlines;
+    for (int i = 0; i < kOutlineCount; i++) {
+        outlines.push_back(MakeOutline(rng, glm::dvec2(i % perRow, i / perRow) * 12.0));
+        const Ring& ring = outlines.back();
+        for (size_t k = 0; k < ring.size(); k++) document.AddLine(glm::vec2(ring[k]), glm::vec2(ring[(k + 1) % ring.size()]), 0.01f, color);
+    }
+    UndoHistory history;
+    document.SetHistory(&history);
+    LineTopology topology;
+    topology.Build(document, 0.0f);
+    std::vector<LineTopology::Polyline> loops;
+    topology.GetClosedLoops(loops);
+    std::printf("  %zu outlines, %zu lines, on %u workers\n", loops.size(), document.GetLineCount(), JobSystem::GetWorkerCount());
+
+    for (double distance : { 0.5, -0.5, 2.0 }) {
+        const size_t lines = document.GetLineCount();
+        Timer timer;
+        const size_t rings = OffsetLoops(document, topology, loops, distance);
+        const double ms = timer.ElapsedMs();
+        std::printf("  offset %+4.1f   %8.1f ms, %7.0f loops/s, %zu rings of %zu lines added\n", distance, ms, loops.size() / ms * 1000.0, rings,
+            document.GetLineCount() - lines);
+        history.Undo(document);
+        topology.Build(document, 0.0f);
+    }
+
+    // one operand against another: each outline with a copy of itself moved by a third of its size
+    std::vector<Ring> moved = outlines;
+    for (Ring& ring : moved)
+        for (glm::dvec2& p : ring) p += glm::dvec2(1.3, 0.9);
+    static constexpr const char* kNames[] = { "union", "intersection", "difference" };
+    for (int operation = 0; operation < 3; operation++) {
+        std::vector<Ring> result;
+        Timer timer;
+        CombineRings(outlines, moved, (LoopOperation)operation, result);
+        const double ms = timer.ElapsedMs();
+        std::printf("  %-12s %8.1f ms, %7.0f loop pairs/s, %zu rings\n", kNames[operation], ms, outlines.size() / ms * 1000.0, result.size());
+    }
+    JobSystem::Shutdown();
+}
@@ -0,0 +1,145 @@
+#include "Benchmark.h"
+#include "Camera.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "LinePicker.h"
+#include <algorithm>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 10'000'000;
+constexpr int kPicks = 2000;
+constexpr float kPixelTolerance = 5.0f;
+
+// Dense drawing: every chunk fills a 0.5 x 0.5 tile, so a few pixels of
+// tolerance still cover hundreds of lines when the whole drawing is in view
+void BuildScene(LineDocument& document)
+{
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const int tiles = (kLineCount + (int)LineChunk::kCapacity - 1) / (int)LineChunk::kCapacity;
+    const int tilesPerRow = (int)std::ceil(std::sqrt((float)tiles));
+    for (int i = 0; i < kLineCount; i++) {
+        const int tile = i / (int)LineChunk::kCapacity;
+        const glm::vec2 base = { (tile % tilesPerRow) * 0.5f, (tile / tilesPerRow) * 0.5f };
+        const glm::vec2 p0 = base + glm::vec2(unit(rng), unit(rng)) * 0.5f;
+        document.AddLine(p0, p0 + (glm::vec2(unit(rng), unit(rng)) - 0.5f) * 0.1f, 0.002f, { 1.0f, 1.0f, 1.0f, 1.0f });
+    }
+}
+
+using KernelFn = uint32_t (*)(const SegmentBatch&, const glm::vec2&, float&);
+
+// Run a kernel over every line of the document, as picking does without an index
+void MeasureKernel(const char* name, KernelFn kernel, const LineDocument& document, const glm::vec2& point, uint64_t& check)
+{
+    Timer timer;
+    uint64_t sum = 0;
+    for (size_t c = 0; c < document.GetChunkCount(); c++) {
+        const LineChunk& chunk = document.GetChunk(c);
+        float distance;
+        sum += kernel({ chunk.X0, chunk.Y0, chunk.X1, chunk.Y1, chunk.Thickness, chunk.Count }, point, distance);
+    }
+    const double ms = timer.ElapsedMs();
+    std::printf("  kernel %-7s %8.2f ms, %7.0f M lines/s%s\n", name, ms, kLineCount / ms / 1e3,
+        check == 0 || sum == check ? "" : " (results differ from scalar)");
+    if (check == 0) check = sum;
+}
+
+} // namespace
+
+EL_BENCHMARK(Picking_Nearest)
+{
+    JobSystem::Init();
+    LineDocument document;
+    BuildScene(document);
+    document.UpdateSpatialIndex();
+    const AABB bounds = document.GetBounds();
+    std::printf("  %d lines in %zu chunks, %.1f x %.1f\n", kLineCount, document.GetChunkCount(), bounds.GetSize().x, bounds.GetSize().y);
+
+    const glm::vec2 center = bounds.GetCenter();
+    uint64_t check = 0;
+    MeasureKernel("scalar", &FindNearestSegmentScalar, document, center, check);
+#ifdef EL_PICK_X86
+    MeasureKernel("SSE2", &FindNearestSegmentSSE2, document, center, check);
+    if (IsAVX2Supported()) MeasureKernel("AVX2", &FindNearestSegmentAVX2, document, center, check);
+#endif
+
+    // random clicks over a 1920 x 1080 view, from the whole drawing down to a close-up
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<float> px(0.0f, 1920.0f), py(0.0f, 1080.0f);
+    Camera camera(1920.0f, 1080.0f);
+    for (float magnification : { 1.0f, 10.0f, 100.0f }) {
+        camera.FitBounds(bounds);
+        camera.SetZoom(camera.GetZoom() / magnification);
+        int hits = 0;
+        double worstMs = 0.0;
+        Timer total;
+        for (int i = 0; i < kPicks; i++) {
+            Timer timer;
+            PickResult result;
+            hits += PickLine(document, camera, { px(rng), py(rng) }, kPixelTolerance, result);
+            worstMs = std::max(worstMs, timer.ElapsedMs());
+        }
+        std::printf("  pick at %3.0fx zoom: %7.3f ms average, %7.3f ms worst, %d of %d hit\n", magnification,
+            total.ElapsedMs() / kPicks, worstMs, hits, kPicks);
+    }
+    JobSystem::Shutdown();
+}
+
+// Hover picking through the ID buffer against the CPU picker. The GPU pass
+// needs a GL context, so the readback is reproduced here: every pixel of the
+// region holds the line the CPU picker finds within half a pixel of its
+// center. Only resolving the readback is what a hover costs the CPU.
+EL_BENCHMARK(Picking_HoverIdBuffer)
+{
+    constexpr int kHovers = 100;
+    constexpr int kRadius = (int)kPixelTolerance;
+    constexpr int kSide = 2 * kRadius + 1;
+    JobSystem::Init();
+    LineDocument document;
+    BuildScene(document);
+    document.UpdateSpatialIndex();
+    const AABB bounds = document.GetBounds();
+
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> px((float)kRadius, 1920.0f - kRadius), py((float)kRadius, 1080.0f - kRadius);
+    Camera camera(1920.0f, 1080.0f);
+    for (float magnification : { 1.0f, 100.0f }) {
+        camera.FitBounds(bounds);
+        camera.SetZoom(camera.GetZoom() / magnification);
+        double cpuMs = 0.0, idMs = 0.0;
+        int cpuHits = 0, idHits = 0, agree = 0;
+        std::vector<uint32_t> ids(kSide * kSide);
+        for (int i = 0; i < kHovers; i++) {
+            const glm::vec2 pixel = { std::floor(px(rng)), std::floor(py(rng)) };
+            for (int y = 0; y < kSide; y++) {
+                for (int x = 0; x < kSide; x++) {
+                    PickResult covered;
+                    const glm::vec2 center = pixel + glm::vec2((float)(x - kRadius), (float)(y - kRadius)) + 0.5f;
+                    ids[y * kSide + x] = PickLine(document, camera, center, 0.5f, covered) ? covered.Handle + 1 : 0;
+                }
+            }
+
+            Timer cpuTimer;
+            PickResult result;
+            const bool cpuHit = PickLine(document, camera, pixel + 0.5f, kPixelTolerance, result);
+            cpuMs += cpuTimer.ElapsedMs();
+
+            Timer idTimer;
+            LineHandle handle = 0;
+            const bool idHit = PickIdRegion(ids.data(), kSide, kSide, { kRadius, kRadius }, handle);
+            idMs += idTimer.ElapsedMs();
+
+            cpuHits += cpuHit;
+            idHits += idHit;
+            agree += cpuHit == idHit && (!cpuHit || handle == result.Handle);
+        }
+        std::printf("  hover at %3.0fx zoom: CPU %7.4f ms, ID buffer readback %7.4f ms; hits %d / %d, same line %d of %d\n",
+            magnification, cpuMs / kHovers, idMs / kHovers, cpuHits, idHits, agree, kHovers);
+    }
+    JobSystem::Shutdown();
+}
@@ -0,0 +1,72 @@
+#include "Benchmark.h"
+#include "FileWriter.h"
+#include "JobSystem.h"
+#include "PngWriter.h"
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr uint32_t kWidth = 16384;
+constexpr uint32_t kHeight = 8192;
+constexpr uint32_t kStripRows = 256;
+
+// What a tile strip of a plan looks like once rendered: canvas color, a grid
+// of one-pixel walls, some diagonals and a few solid patches of color
+void FillStrip(uint8_t* strip, uint32_t y0, uint32_t rows)
+{
+    for (uint32_t r = 0; r < rows; r++) {
+        const uint32_t y = y0 + r;
+        uint8_t* p = strip + (size_t)r * kWidth * 3;
+        for (uint32_t x = 0; x < kWidth; x++, p += 3) {
+            const bool wall = x % 173 == 0 || y % 131 == 0 || (x + y) % 997 == 0;
+            const bool patch = (x / 512 + y / 512) % 7 == 0 && (x % 512) < 40;
+            p[0] = wall ? 255 : patch ? 200 : 115;
+            p[1] = wall ? 255 : patch ? 40 : 140;
+            p[2] = wall ? 255 : patch ? 40 : 153;
+        }
+    }
+}
+
+} // namespace
+
+EL_BENCHMARK(Png_StreamEncode)
+{
+    JobSystem::Init();
+    const std::string path = (std::filesystem::temp_directory_path() / "EasyLineBenchmark.png").string();
+    std::vector<uint8_t> strips[2];
+    for (auto& strip : strips) strip.resize((size_t)kWidth * kStripRows * 3);
+
+    // strips are filled here while the previous one encodes, as the GPU tiles would be
+    double fillMs = 0.0;
+    Timer timer;
+    HeapStats heap = GetHeapStats();
+    FileWriter out;
+    out.Open(path);
+    PngWriter png;
+    png.Begin(out, kWidth, kHeight);
+    for (uint32_t y = 0, s = 0; y < kHeight; y += kStripRows, s ^= 1) {
+        Timer fill;
+        FillStrip(strips[s].data(), y, kStripRows);
+        fillMs += fill.ElapsedMs();
+        png.Submit(strips[s].data(), kStripRows);
+    }
+    png.End();
+    const uint64_t bytes = out.GetBytesWritten();
+    out.Close();
+    const double ms = timer.ElapsedMs();
+    const HeapStats used = GetHeapStats() - heap;
+
+    const double raw = (double)kWidth * kHeight * 3;
+    std::printf("  %u x %u RGB (%.0f MB raw) -> %.1f MB PNG (%.0fx) in %.0f ms, %.0f ms of it producing strips\n",
+        kWidth, kHeight, raw / 1e6, bytes / 1e6, raw / bytes, ms, fillMs);
+    std::printf("  encode %.0f MB/s raw; memory: two strips %.0f MB + %.0f MB encoder and file buffers allocated (whole image %.0f MB)\n",
+        raw / 1e6 / ((ms - fillMs) / 1000.0), 2.0 * kWidth * kStripRows * 3 / 1e6, used.Bytes / 1e6, raw / 1e6);
+
+    std::remove(path.c_str());
+    JobSystem::Shutdown();
+}
@@ -0,0 +1,131 @@
+#include "Benchmark.h"
+#include "Predicates.h"
+#include <cmath>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr size_t kPointCount = 1 << 20;
+constexpr int kRounds = 16;
+
+double NaiveOrient(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c)
+{
+    return (a.x - c.x) * (b.y - c.y) - (a.y - c.y) * (b.x - c.x);
+}
+
+double NaiveInCircle(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c, const glm::dvec2& d)
+{
+    const glm::dvec2 ad = a - d, bd = b - d, cd = c - d;
+    return glm::dot(ad, ad) * (bd.x * cd.y - cd.x * bd.y) + glm::dot(bd, bd) * (cd.x * ad.y - ad.x * cd.y)
+        + glm::dot(cd, cd) * (ad.x * bd.y - bd.x * ad.y);
+}
+
+int Sign(double value)
+{
+    return (value > 0.0) - (value < 0.0);
+}
+
+// Each three consecutive points of Triangles are tested for orientation, each
+// four of Circles for in-circle
+struct Scene {
+    const char* Name;
+    std::vector<glm::dvec2> Triangles, Circles;
+};
+
+// Float document coordinates in a 1000 unit drawing: nearly always decided by the filter
+Scene RandomPoints()
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> coordinate(0.0f, 1000.0f);
+    Scene scene{ "random", {}, {} };
+    for (size_t i = 0; i < kPointCount; i++) {
+        scene.Triangles.push_back({ coordinate(rng), coordinate(rng) });
+        scene.Circles.push_back({ coordinate(rng), coordinate(rng) });
+    }
+    return scene;
+}
+
+// Points computed in double, as transformed or intersected points are: third
+// points on the line through the first two and fourth points on the circle
+// through the first three, all off by rounding only
+Scene DegeneratePoints()
+{
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    Scene scene{ "near-degenerate", {}, {} };
+    for (size_t i = 0; i < kPointCount / 3; i++) {
+        const glm::dvec2 a = glm::dvec2(unit(rng), unit(rng)) * 1000.0, b = a + glm::dvec2(unit(rng), unit(rng)) * 100.0;
+        scene.Triangles.push_back(a);
+        scene.Triangles.push_back(b);
+        scene.Triangles.push_back(glm::mix(a, b, unit(rng) * 3.0 - 1.0));
+    }
+    for (size_t i = 0; i < kPointCount / 4; i++) {
+        const glm::dvec2 center = glm::dvec2(unit(rng), unit(rng)) * 1000.0;
+        const double radius = 1.0 + unit(rng) * 100.0;
+        for (int j = 0; j < 4; j++) {
+            const double angle = (j + unit(rng) * 0.5) * 1.5707963267948966;
+            scene.Circles.push_back(center + radius * glm::dvec2(std::cos(angle), std::sin(angle)));
+        }
+    }
+    return scene;
+}
+
+template<typename Predicate>
+double TimeOrient(const std::vector<glm::dvec2>& points, Predicate predicate, int& signs)
+{
+    Timer timer;
+    for (int round = 0; round < kRounds; round++)
+        for (size_t i = 0; i + 2 < points.size(); i += 3) signs += Sign(predicate(points[i], points[i + 1], points[i + 2]));
+    return timer.ElapsedMs() * 1.0e6 / (kRounds * (points.size() / 3));
+}
+
+template<typename Predicate>
+double TimeInCircle(const std::vector<glm::dvec2>& points, Predicate predicate, int& signs)
+{
+    Timer timer;
+    for (int round = 0; round < kRounds; round++)
+        for (size_t i = 0; i + 3 < points.size(); i += 4)
+            signs += Sign(predicate(points[i], points[i + 1], points[i + 2], points[i + 3]));
+    return timer.ElapsedMs() * 1.0e6 / (kRounds * (points.size() / 4));
+}
+
+// How often the plain evaluation disagrees with the exact sign
+size_t CountWrongOrient(const std::vector<glm::dvec2>& points)
+{
+    size_t wrong = 0;
+    for (size_t i = 0; i + 2 < points.size(); i += 3)
+        wrong += Sign(NaiveOrient(points[i], points[i + 1], points[i + 2])) != Sign(Orient2D(points[i], points[i + 1], points[i + 2]));
+    return wrong;
+}
+
+size_t CountWrongInCircle(const std::vector<glm::dvec2>& points)
+{
+    size_t wrong = 0;
+    for (size_t i = 0; i + 3 < points.size(); i += 4) {
+        const glm::dvec2 &a = points[i], &b = points[i + 1], &c = points[i + 2], &d = points[i + 3];
+        wrong += Sign(NaiveInCircle(a, b, c, d)) != Sign(InCircle(a, b, c, d));
+    }
+    return wrong;
+}
+
+} // namespace
+
+EL_BENCHMARK(Predicates_FilterCost)
+{
+    for (const Scene& scene : { RandomPoints(), DegeneratePoints() }) {
+        int signs = 0;
+        const double naiveOrient = TimeOrient(scene.Triangles, NaiveOrient, signs);
+        const double orient = TimeOrient(scene.Triangles, Orient2D, signs);
+        const double naiveInCircle = TimeInCircle(scene.Circles, NaiveInCircle, signs);
+        const double inCircle = TimeInCircle(scene.Circles, InCircle, signs);
+        DoNotOptimize(signs);
+        std::printf("  %s points\n", scene.Name);
+        std::printf("    naive cross      %6.2f ns    Orient2D %7.2f ns  (%+.2f ns), naive sign wrong %zu of %zu\n", naiveOrient,
+            orient, orient - naiveOrient, CountWrongOrient(scene.Triangles), scene.Triangles.size() / 3);
+        std::printf("    naive in-circle  %6.2f ns    InCircle %7.2f ns  (%+.2f ns), naive sign wrong %zu of %zu\n", naiveInCircle,
+            inCircle, inCircle - naiveInCircle, CountWrongInCircle(scene.Circles), scene.Circles.size() / 4);
+    }
+}
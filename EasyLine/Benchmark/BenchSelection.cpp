@@ -0,0 +1,82 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "LineSelection.h"
+#include "SelectionSet.h"
+#include <cmath>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 5'000'000;
+constexpr int kRepeats = 20;
+constexpr int kLassoPoints = 256;
+
+// Tiles of 0.5 x 0.5 per chunk, like the editor's demo drawing
+void BuildScene(LineDocument& document)
+{
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const int tiles = (kLineCount + (int)LineChunk::kCapacity - 1) / (int)LineChunk::kCapacity;
+    const int tilesPerRow = (int)std::ceil(std::sqrt((float)tiles));
+    for (int i = 0; i < kLineCount; i++) {
+        const int tile = i / (int)LineChunk::kCapacity;
+        const glm::vec2 base = { (tile % tilesPerRow) * 0.5f, (tile / tilesPerRow) * 0.5f };
+        const glm::vec2 p0 = base + glm::vec2(unit(rng), unit(rng)) * 0.5f;
+        document.AddLine(p0, p0 + (glm::vec2(unit(rng), unit(rng)) - 0.5f) * 0.1f, 0.002f, { 1.0f, 1.0f, 1.0f, 1.0f });
+    }
+}
+
+template<typename Fn>
+void Measure(const char* name, const SelectionSet& selection, Fn&& select)
+{
+    double best = 1e30, total = 0.0;
+    for (int i = 0; i < kRepeats; i++) {
+        Timer timer;
+        select();
+        const double ms = timer.ElapsedMs();
+        best = std::min(best, ms);
+        total += ms;
+    }
+    std::printf("  %-34s %8.3f ms average, %8.3f ms best, %8zu selected\n", name, total / kRepeats, best, selection.GetCount());
+}
+
+} // namespace
+
+EL_BENCHMARK(Selection_BoxAndLasso)
+{
+    JobSystem::Init();
+    LineDocument document;
+    BuildScene(document);
+    const AABB bounds = document.GetBounds();
+    const glm::vec2 center = bounds.GetCenter(), size = bounds.GetSize();
+    std::printf("  %d lines in %zu chunks, %u workers\n", kLineCount, document.GetChunkCount(), JobSystem::GetWorkerCount());
+
+    SelectionSet selection;
+    const AABB all = bounds.Inflated(1.0f);
+    // a box whose edges cut through chunks, so every chunk along them is tested line by line
+    const AABB half = { bounds.Min + size * 0.13f, center + size * 0.11f };
+    const AABB small = { center - 0.7f, center + 0.7f };
+    Measure("window, whole drawing", selection, [&] { SelectInRect(document, all, SelectionMode::Window, selection); });
+    Measure("window, a third of the drawing", selection, [&] { SelectInRect(document, half, SelectionMode::Window, selection); });
+    Measure("crossing, a third of the drawing", selection, [&] { SelectInRect(document, half, SelectionMode::Crossing, selection); });
+    Measure("crossing, 1.4 x 1.4 box", selection, [&] { SelectInRect(document, small, SelectionMode::Crossing, selection); });
+
+    // a wobbly circle over most of the drawing
+    std::vector<glm::vec2> lasso;
+    for (int i = 0; i < kLassoPoints; i++) {
+        const float angle = 6.2831853f * i / kLassoPoints;
+        const float radius = 0.4f * std::min(size.x, size.y) * (1.0f + 0.05f * std::sin(angle * 9.0f));
+        lasso.push_back(center + radius * glm::vec2(std::cos(angle), std::sin(angle)));
+    }
+    Measure("lasso window, no index", selection, [&] { SelectInPolygon(document, lasso, SelectionMode::Window, selection); });
+    // chunks on the outline are narrowed down by their trees once the index is built
+    document.UpdateSpatialIndex();
+    Measure("lasso window, 256 points", selection, [&] { SelectInPolygon(document, lasso, SelectionMode::Window, selection); });
+    Measure("lasso crossing, 256 points", selection, [&] { SelectInPolygon(document, lasso, SelectionMode::Crossing, selection); });
+    std::printf("  selection set: %.2f MB\n", selection.GetChunkCount() * SelectionSet::kWordsPerChunk * 8 / 1e6);
+    JobSystem::Shutdown();
+}
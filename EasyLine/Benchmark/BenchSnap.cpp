@@ -0,0 +1,82 @@
+#include "Benchmark.h"
+#include "Camera.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "SnapEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 10'000'000;
+constexpr int kMoves = 20000;
+constexpr float kPixelRadius = 10.0f;
+
+// Same dense tiles as the picking benchmark
+void BuildScene(LineDocument& document)
+{
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const int tiles = (kLineCount + (int)LineChunk::kCapacity - 1) / (int)LineChunk::kCapacity;
+    const int tilesPerRow = (int)std::ceil(std::sqrt((float)tiles));
+    for (int i = 0; i < kLineCount; i++) {
+        const int tile = i / (int)LineChunk::kCapacity;
+        const glm::vec2 base = { (tile % tilesPerRow) * 0.5f, (tile / tilesPerRow) * 0.5f };
+        const glm::vec2 p0 = base + glm::vec2(unit(rng), unit(rng)) * 0.5f;
+        document.AddLine(p0, p0 + (glm::vec2(unit(rng), unit(rng)) - 0.5f) * 0.1f, 0.002f, { 1.0f, 1.0f, 1.0f, 1.0f });
+    }
+}
+
+// A mouse wandering over the view a pixel or two per move, as mouse-move events arrive
+void Measure(const char* name, const LineDocument& document, const Camera& camera, bool cached)
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+    SnapEngine engine;
+    glm::vec2 pixel = { 960.0f, 540.0f };
+    int snaps = 0;
+    size_t candidates = 0;
+    double worstMs = 0.0;
+    Timer total;
+    for (int i = 0; i < kMoves; i++) {
+        pixel = glm::clamp(pixel + glm::vec2(step(rng), step(rng)), glm::vec2(0.0f), glm::vec2(1919.0f, 1079.0f));
+        if (!cached) engine.Invalidate();
+        Timer timer;
+        SnapResult result;
+        snaps += engine.Snap(document, camera, pixel, kPixelRadius, result);
+        worstMs = std::max(worstMs, timer.ElapsedMs());
+        candidates += engine.GetCandidateCount();
+    }
+    const double ms = total.ElapsedMs();
+    std::printf("  %-28s %7.4f ms average, %7.4f ms worst, %5.1f%% snapped, %5.1f%% refills, %6.0f lines cached\n", name,
+        ms / kMoves, worstMs, 100.0 * snaps / kMoves, 100.0 * engine.GetRefillCount() / kMoves, (double)candidates / kMoves);
+}
+
+} // namespace
+
+EL_BENCHMARK(Snap_MouseMove)
+{
+    JobSystem::Init();
+    LineDocument document;
+    BuildScene(document);
+    document.UpdateSpatialIndex();
+    const AABB bounds = document.GetBounds();
+    std::printf("  %d lines in %zu chunks, %.0f px snap radius\n", kLineCount, document.GetChunkCount(), kPixelRadius);
+
+    // from the whole drawing, where the radius covers hundreds of lines, down to a close-up
+    Camera camera(1920.0f, 1080.0f);
+    for (float magnification : { 1.0f, 10.0f, 100.0f }) {
+        camera.FitBounds(bounds);
+        camera.SetZoom(camera.GetZoom() / magnification);
+        char name[64];
+        std::snprintf(name, sizeof(name), "%gx, cached cells", magnification);
+        Measure(name, document, camera, true);
+        std::snprintf(name, sizeof(name), "%gx, query every move", magnification);
+        Measure(name, document, camera, false);
+    }
+    JobSystem::Shutdown();
+}
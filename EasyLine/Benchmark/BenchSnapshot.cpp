@@ -0,0 +1,125 @@
+#include "Benchmark.h"
+#include "ElbFormat.h"
+#include "FileWriter.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 10'000'000;
+constexpr int kSnapshots = 1000;
+constexpr int kEditsPerFrame = 200;
+constexpr double kFrameMs = 1000.0 / 60.0;
+
+void BuildScene(LineDocument& document)
+{
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < kLineCount; i++) {
+        float cx = (float)(i / (int)LineChunk::kCapacity);
+        glm::vec2 p0 = { cx + unit(rng), unit(rng) * 100.0f };
+        glm::vec2 p1 = p0 + glm::vec2(unit(rng), unit(rng)) * 0.1f;
+        document.AddLine(p0, p1, 0.01f, { 1.0f, 1.0f, 1.0f, 1.0f });
+    }
+    document.UpdateSpatialIndex();
+}
+
+// Bytes the live document holds on its own, i.e. chunks and trees it no longer shares with the snapshot
+size_t GetUnsharedBytes(const LineDocument& document, const LineDocument& snapshot)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < document.GetChunkCount(); i++) {
+        if (i >= snapshot.GetChunkCount() || &document.GetChunk(i) != &snapshot.GetChunk(i)) bytes += sizeof(LineChunk);
+        const ChunkTree* tree = document.GetSpatialIndex().GetTree(i);
+        if (tree && tree != snapshot.GetSpatialIndex().GetTree(i)) bytes += sizeof(ChunkTree);
+    }
+    return bytes;
+}
+
+} // namespace
+
+EL_BENCHMARK(Snapshot_Autosave)
+{
+    JobSystem::Init();
+    const std::string path = (std::filesystem::temp_directory_path() / "EasyLineBenchmark.autosave.elb").string();
+
+    LineDocument document;
+    BuildScene(document);
+    const size_t documentBytes = document.GetChunkCount() * (sizeof(LineChunk) + sizeof(ChunkTree));
+    std::printf("  %d lines in %zu chunks, %.1f MB\n", kLineCount, document.GetChunkCount(), documentBytes / 1e6);
+
+    // what a snapshot would cost if it copied the data
+    {
+        Timer timer;
+        std::vector<LineChunk> copy(document.GetChunkCount());
+        for (size_t i = 0; i < copy.size(); i++) copy[i] = document.GetChunk(i);
+        DoNotOptimize(copy.data());
+        std::printf("  deep copy:        %10.3f ms, %8.1f MB extra\n", timer.ElapsedMs(), copy.size() * sizeof(LineChunk) / 1e6);
+    }
+
+    {
+        Timer timer;
+        for (int i = 0; i < kSnapshots; i++) DoNotOptimize(document.CreateSnapshot());
+        std::printf("  snapshot:         %10.3f us\n", timer.ElapsedMs() * 1000.0 / kSnapshots);
+    }
+
+    // Save a snapshot on a worker while the main thread keeps editing, like
+    // autosave during a session: each frame moves lines in one area (chunk)
+    // of the drawing at 60 frames per second, and every chunk edited is copied once
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<uint32_t> pickChunk(0, kLineCount / LineChunk::kCapacity - 1);
+    std::uniform_int_distribution<uint32_t> pickSlot(0, LineChunk::kCapacity - 1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    uint32_t area = 0;
+    auto edit = [&] {
+        const LineHandle handle = MakeLineHandle(area, pickSlot(rng));
+        const glm::vec2 p0 = { document.GetChunk(GetHandleChunk(handle)).X0[GetHandleSlot(handle)], unit(rng) * 100.0f };
+        document.MoveLine(handle, p0, p0 + glm::vec2(0.05f));
+    };
+
+    Timer saveTimer;
+    std::shared_ptr<const LineDocument> snapshot = document.CreateSnapshot();
+    Timer firstEdit;
+    edit();
+    const double firstEditMs = firstEdit.ElapsedMs();
+
+    JobCounter counter;
+    bool saved = false;
+    JobSystem::Run([&] {
+        FileWriter out;
+        saved = out.Open(path) && WriteElb(*snapshot, out) && out.Close();
+    }, &counter);
+
+    int frames = 0;
+    double worstFrameMs = 0.0;
+    size_t peakBytes = 0;
+    while (!counter.IsDone()) {
+        Timer frame;
+        area = pickChunk(rng);
+        for (int i = 0; i < kEditsPerFrame; i++) edit();
+        document.UpdateSpatialIndex();
+        const double frameMs = frame.ElapsedMs();
+        worstFrameMs = std::max(worstFrameMs, frameMs);
+        peakBytes = std::max(peakBytes, GetUnsharedBytes(document, *snapshot));
+        frames++;
+        if (frameMs < kFrameMs) std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(kFrameMs - frameMs));
+    }
+    const double saveMs = saveTimer.ElapsedMs();
+    snapshot.reset();
+
+    std::printf("  first edit after: %10.3f ms (copies the chunk list and one chunk)\n", firstEditMs);
+    std::printf("  background save:  %10.1f ms%s, %d frames of %d edits meanwhile, worst frame %.2f ms\n", saveMs,
+        saved ? "" : " (failed)", frames, kEditsPerFrame, worstFrameMs);
+    std::printf("  peak extra memory %10.1f MB (%.1f%% of the document)\n", peakBytes / 1e6, 100.0 * peakBytes / documentBytes);
+
+    std::remove(path.c_str());
+    JobSystem::Shutdown();
+}
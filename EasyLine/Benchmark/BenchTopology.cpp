@@ -0,0 +1,92 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "LineTopology.h"
+#include "SelectionSet.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 5'000'000;
+// Endpoints are drawn off their vertex by up to this, as in a drawing exported without snapping
+constexpr float kJitter = 1e-4f;
+
+// Closed rectangles and open runs of connected lines, tile by tile, with
+// the shared corners jittered so only a welding tolerance joins them
+void BuildScene(LineDocument& document)
+{
+    std::mt19937 rng(46);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> jitter(-kJitter, kJitter);
+    const Color color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    auto jittered = [&](const glm::vec2& p) { return p + glm::vec2(jitter(rng), jitter(rng)); };
+    const int tilesPerRow = (int)std::ceil(std::sqrt((float)kLineCount / LineChunk::kCapacity));
+    const float tileSize = 64.0f;
+    int lines = 0;
+    for (int tile = 0; lines < kLineCount; tile++) {
+        const glm::vec2 base = glm::vec2(tile % tilesPerRow, tile / tilesPerRow) * tileSize;
+        for (int i = 0; i < (int)LineChunk::kCapacity && lines < kLineCount;) {
+            const glm::vec2 start = base + glm::vec2(unit(rng), unit(rng)) * (tileSize - 4.0f);
+            if (i % 3 == 0) {
+                const glm::vec2 size = glm::vec2(unit(rng), unit(rng)) * 3.0f + 0.1f;
+                const glm::vec2 corners[4] = { start, start + glm::vec2(size.x, 0.0f), start + size, start + glm::vec2(0.0f, size.y) };
+                for (int k = 0; k < 4; k++) document.AddLine(jittered(corners[k]), jittered(corners[(k + 1) % 4]), 0.01f, color);
+                i += 4;
+                lines += 4;
+                continue;
+            }
+            glm::vec2 p = start;
+            for (int k = 0; k < 8; k++) {
+                const float angle = unit(rng) * 6.2831853f;
+                const glm::vec2 q = p + 0.4f * glm::vec2(std::cos(angle), std::sin(angle));
+                document.AddLine(jittered(p), jittered(q), 0.01f, color);
+                p = q;
+            }
+            i += 8;
+            lines += 8;
+        }
+    }
+}
+
+void Measure(const char* name, const LineDocument& document, float tolerance)
+{
+    LineTopology topology;
+    double bestMs = 1e30;
+    for (int run = 0; run < 3; run++) {
+        Timer timer;
+        topology.Build(document, tolerance);
+        bestMs = std::min(bestMs, timer.ElapsedMs());
+    }
+    std::printf("  %-16s %8.1f ms build, %zu vertices, %zu components\n", name, bestMs, topology.GetVertexCount(), topology.GetComponentCount());
+
+    Timer timer;
+    std::vector<LineTopology::Polyline> polylines;
+    topology.GetPolylines(polylines);
+    const double polylineMs = timer.ElapsedMs();
+    const size_t closed = std::count_if(polylines.begin(), polylines.end(), [](const LineTopology::Polyline& polyline) { return polyline.Closed; });
+    std::printf("  %-16s %8.1f ms to merge into %zu polylines, %zu closed\n", "", polylineMs, polylines.size(), closed);
+
+    SelectionSet selection;
+    timer.Reset();
+    for (int i = 0; i < 1000; i++) topology.SelectChain(MakeLineHandle(i, (i * 8) % 4000), selection);
+    std::printf("  %-16s %8.4f ms per chain select\n", "", timer.ElapsedMs() / 1000);
+    DoNotOptimize(selection.GetCount());
+}
+
+} // namespace
+
+EL_BENCHMARK(Topology_Build)
+{
+    JobSystem::Init();
+    LineDocument document;
+    BuildScene(document);
+    std::printf("  %d lines on %u workers, best of 3 builds\n", kLineCount, JobSystem::GetWorkerCount());
+    Measure("exact", document, 0.0f);
+    Measure("tolerance 1e-3", document, 1e-3f);
+    JobSystem::Shutdown();
+}
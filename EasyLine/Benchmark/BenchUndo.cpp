@@ -0,0 +1,84 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "UndoHistory.h"
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 2'000'000;
+constexpr int kDragFrames = 600;
+constexpr int kDragLines = 100;
+
+void BuildScene(LineDocument& document)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < kLineCount; i++) {
+        float cx = (float)(i / (int)LineChunk::kCapacity);
+        glm::vec2 p0 = { cx + unit(rng), unit(rng) * 100.0f };
+        document.AddLine(p0, p0 + glm::vec2(unit(rng), unit(rng)) * 0.1f, 0.01f, { 1.0f, 1.0f, 1.0f, 1.0f });
+    }
+}
+
+} // namespace
+
+EL_BENCHMARK(Undo_BulkDelete)
+{
+    JobSystem::Init();
+    LineDocument document;
+    BuildScene(document);
+    UndoHistory history;
+    document.SetHistory(&history);
+
+    // delete most of the drawing in one step: every line but a few scattered ones
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> keep(0, 63);
+    Timer timer;
+    history.BeginCommand("Delete");
+    size_t removed = 0;
+    for (size_t c = 0; c < document.GetChunkCount(); c++) {
+        for (uint32_t slot = 0; slot < document.GetChunk(c).Count; slot++) {
+            if (keep(rng) == 0) continue;
+            document.RemoveLine(MakeLineHandle((uint32_t)c, slot));
+            removed++;
+        }
+    }
+    history.EndCommand();
+    std::printf("  delete %zu of %d lines: %8.1f ms, history %.2f MB (%.2f bytes per line)\n", removed, kLineCount,
+        timer.ElapsedMs(), history.GetMemoryUsage() / 1e6, (double)history.GetMemoryUsage() / removed);
+
+    timer.Reset();
+    history.Undo(document);
+    std::printf("  undo:  %8.1f ms, %zu lines\n", timer.ElapsedMs(), document.GetLineCount());
+    timer.Reset();
+    history.Redo(document);
+    std::printf("  redo:  %8.1f ms, %zu lines\n", timer.ElapsedMs(), document.GetLineCount());
+    history.Undo(document);
+    history.Clear();
+
+    // a drag: every frame moves the same lines a little and continues the same step
+    std::uniform_int_distribution<uint32_t> pickLine(0, LineChunk::kCapacity - 1);
+    std::vector<LineHandle> dragged;
+    for (int i = 0; i < kDragLines; i++) dragged.push_back(MakeLineHandle(7, pickLine(rng)));
+    timer.Reset();
+    for (int frame = 0; frame < kDragFrames; frame++) {
+        history.BeginCommand("Move", 1);
+        for (LineHandle handle : dragged) {
+            if (!document.IsLineValid(handle)) continue;
+            const LineChunk& chunk = document.GetChunk(GetHandleChunk(handle));
+            const uint32_t slot = GetHandleSlot(handle);
+            const glm::vec2 step = { 0.001f, 0.0f };
+            document.MoveLine(handle, glm::vec2(chunk.X0[slot], chunk.Y0[slot]) + step, glm::vec2(chunk.X1[slot], chunk.Y1[slot]) + step);
+        }
+        history.EndCommand();
+    }
+    std::printf("  drag of %d lines over %d frames: %.3f ms per frame, %zu step, history %.1f KB\n", kDragLines, kDragFrames,
+        timer.ElapsedMs() / kDragFrames, history.GetCommandCount(), history.GetMemoryUsage() / 1e3);
+
+    document.SetHistory(nullptr);
+    JobSystem::Shutdown();
+}
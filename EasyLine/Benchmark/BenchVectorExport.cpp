@@ -0,0 +1,130 @@
+#include "Benchmark.h"
+#include "FileWriter.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "PathTracer.h"
+#include "PdfWriter.h"
+#include "SvgWriter.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+using namespace EasyLine;
+using namespace EasyLine::Bench;
+
+namespace {
+
+constexpr int kLineCount = 1'000'000;
+
+// Plan-like drawing: rooms drawn as closed outlines split into wall pieces,
+// flattened door swings, in three colors
+void BuildPlan(LineDocument& document)
+{
+    std::mt19937 rng(8);
+    std::uniform_int_distribution<int> mm(500, 6000);
+    const Color colors[] = { { 1.0f, 1.0f, 1.0f, 1.0f }, { 1.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 1.0f, 1.0f } };
+    int room = 0;
+    while ((int)document.GetLineCount() < kLineCount) {
+        const glm::vec2 origin = { (float)(room % 300) * 8.0f, (float)(room / 300) * 8.0f };
+        const glm::vec2 size = { mm(rng) / 1000.0f, mm(rng) / 1000.0f };
+        const Color& color = colors[room % 3];
+        const glm::vec2 corners[] = { origin, origin + glm::vec2(size.x, 0.0f), origin + size, origin + glm::vec2(0.0f, size.y), origin };
+        for (int i = 0; i < 4; i++) {
+            // each wall in four collinear pieces, as drawings exploded from polylines often are
+            for (int k = 0; k < 4; k++)
+                document.AddLine(corners[i] + (corners[i + 1] - corners[i]) * (k / 4.0f), corners[i] + (corners[i + 1] - corners[i]) * ((k + 1) / 4.0f), 0.01f, color);
+        }
+        const glm::vec2 hinge = origin + glm::vec2(0.1f, 0.0f);
+        for (int s = 0; s < 16; s++) {
+            const float a0 = s * 1.5707963f / 16.0f, a1 = (s + 1) * 1.5707963f / 16.0f;
+            document.AddLine(hinge + 0.9f * glm::vec2(std::cos(a0), std::sin(a0)), hinge + 0.9f * glm::vec2(std::cos(a1), std::sin(a1)), 0.005f, color);
+        }
+        room++;
+    }
+    document.UpdateSpatialIndex();
+}
+
+// The straightforward export: one <line> element per document line
+uint64_t WriteSvgLines(const LineDocument& document, const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return 0;
+    const AABB bounds = GetExportBounds(document);
+    std::fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"%g %g %g %g\">\n<g transform=\"scale(1 -1)\">\n",
+        bounds.Min.x, -bounds.Max.y, bounds.GetSize().x, bounds.GetSize().y);
+    for (size_t c = 0; c < document.GetChunkCount(); c++) {
+        const LineChunk& chunk = document.GetChunk(c);
+        for (uint32_t i = 0; i < chunk.Count; i++) {
+            const uint32_t color = chunk.Color[i];
+            std::fprintf(file, "<line x1=\"%g\" y1=\"%g\" x2=\"%g\" y2=\"%g\" stroke=\"#%02x%02x%02x\" stroke-width=\"%g\"/>\n",
+                chunk.X0[i], chunk.Y0[i], chunk.X1[i], chunk.Y1[i], color & 0xff, (color >> 8) & 0xff, (color >> 16) & 0xff, chunk.Thickness[i]);
+        }
+    }
+    std::fprintf(file, "</g>\n</svg>\n");
+    const uint64_t bytes = (uint64_t)std::ftell(file);
+    std::fclose(file);
+    return bytes;
+}
+
+template<typename Fn>
+uint64_t Export(const std::string& path, double& ms, Fn&& write)
+{
+    Timer timer;
+    FileWriter out;
+    out.Open(path);
+    write(out);
+    const uint64_t bytes = out.GetBytesWritten();
+    out.Close();
+    ms = timer.ElapsedMs();
+    return bytes;
+}
+
+size_t CountPaths(const LineDocument& document, size_t& points)
+{
+    PathTracer tracer;
+    ChunkPaths paths;
+    size_t count = 0;
+    points = 0;
+    for (size_t c = 0; c < document.GetChunkCount(); c++) {
+        tracer.Trace(document.GetChunk(c), document.GetSpatialIndex().GetTree(c), nullptr, paths);
+        count += paths.Paths.size();
+        points += paths.Points.size();
+    }
+    return count;
+}
+
+} // namespace
+
+EL_BENCHMARK(Vector_Export)
+{
+    JobSystem::Init();
+    LineDocument document;
+    BuildPlan(document);
+    const std::string path = (std::filesystem::temp_directory_path() / "EasyLineBenchmark").string();
+
+    Timer timer;
+    const uint64_t lineBytes = WriteSvgLines(document, path + ".lines.svg");
+    const double lineMs = timer.ElapsedMs();
+
+    double svgMs = 0.0, pdfMs = 0.0, viewMs = 0.0;
+    const uint64_t svgBytes = Export(path + ".svg", svgMs, [&](FileWriter& out) { WriteSvg(document, out); });
+    const uint64_t pdfBytes = Export(path + ".pdf", pdfMs, [&](FileWriter& out) { WritePdf(document, out); });
+    // a zoomed-in view: a tenth of the drawing each way
+    const AABB bounds = document.GetBounds();
+    const AABB view = { bounds.GetCenter() - bounds.GetSize() * 0.05f, bounds.GetCenter() + bounds.GetSize() * 0.05f };
+    const uint64_t viewBytes = Export(path + ".view.svg", viewMs, [&](FileWriter& out) { WriteSvg(document, view, out); });
+
+    size_t points = 0;
+    const size_t paths = CountPaths(document, points);
+
+    std::printf("  %zu lines -> %zu polylines, %zu points (%.1f lines per polyline)\n",
+        document.GetLineCount(), paths, points, (double)document.GetLineCount() / paths);
+    std::printf("  <line> per line (fprintf): %8.1f MB  %7.1f ms\n", lineBytes / 1e6, lineMs);
+    std::printf("  SVG, merged paths:         %8.1f MB  %7.1f ms  (%.1fx smaller)\n", svgBytes / 1e6, svgMs, (double)lineBytes / svgBytes);
+    std::printf("  PDF, merged paths:         %8.1f MB  %7.1f ms\n", pdfBytes / 1e6, pdfMs);
+    std::printf("  SVG of a 1%% view:          %8.1f MB  %7.1f ms\n", viewBytes / 1e6, viewMs);
+
+    for (const char* suffix : { ".lines.svg", ".svg", ".pdf", ".view.svg" }) std::remove((path + suffix).c_str());
+    JobSystem::Shutdown();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace EasyLine::Bench {
+
+struct BenchmarkCase {
+    const char* Name;
+    void (*Run)();
+};
+
+std::vector<BenchmarkCase>& GetRegistry();
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) { GetRegistry().push_back({ name, run }); }
+};
+
+// Process-wide heap traffic, counted by the operator new/delete overrides in main.cpp
+struct HeapStats {
+    size_t Allocations = 0;
+    size_t Bytes = 0;
+};
+
+HeapStats GetHeapStats();
+
+inline HeapStats operator-(const HeapStats& a, const HeapStats& b) {
+    return { a.Allocations - b.Allocations, a.Bytes - b.Bytes };
+}
+
+class Timer {
+public:
+    Timer() { Reset(); }
+    void Reset() { m_Start = std::chrono::steady_clock::now(); }
+    double ElapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+// Keep the optimizer from discarding a computed value
+template<typename T>
+inline void DoNotOptimize(const T& value) {
+#ifdef _MSC_VER
+    const volatile void* sink = &value;
+    (void)sink;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+} // namespace EasyLine::Bench
+
+// Defines and registers a benchmark function: EL_BENCHMARK(FrameArena_Vertices) { ... }
+#define EL_BENCHMARK(name) \
+    static void Benchmark_##name(); \
+    static ::EasyLine::Bench::Registrar s_Registrar_##name(#name, &Benchmark_##name); \
+    static void Benchmark_##name()
@@ -0,0 +1,88 @@
+// EasyLine benchmark runner: runs every registered benchmark, or only those
+// whose name contains one of the command line arguments.
+#include "Benchmark.h"
+#include "Log.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+static std::atomic<size_t> s_allocations{0};
+static std::atomic<size_t> s_allocatedBytes{0};
+
+static void* CountedAlloc(size_t size, size_t alignment) {
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    void* p = nullptr;
+#ifdef _WIN32
+    p = _aligned_malloc(size, alignment);
+#else
+    if (posix_memalign(&p, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) != 0)
+        p = nullptr;
+#endif
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+static void CountedFree(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+void* operator new(size_t size) { return CountedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size) { return CountedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t al) { return CountedAlloc(size, (size_t)al); }
+void* operator new[](size_t size, std::align_val_t al) { return CountedAlloc(size, (size_t)al); }
+void operator delete(void* p) noexcept { CountedFree(p); }
+void operator delete[](void* p) noexcept { CountedFree(p); }
+void operator delete(void* p, size_t) noexcept { CountedFree(p); }
+void operator delete[](void* p, size_t) noexcept { CountedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { CountedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { CountedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { CountedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { CountedFree(p); }
+
+namespace EasyLine::Bench {
+
+std::vector<BenchmarkCase>& GetRegistry() {
+    static std::vector<BenchmarkCase> s_registry;
+    return s_registry;
+}
+
+HeapStats GetHeapStats() {
+    return { s_allocations.load(std::memory_order_relaxed), s_allocatedBytes.load(std::memory_order_relaxed) };
+}
+
+} // namespace EasyLine::Bench
+
+int main(int argc, char** argv)
+{
+    using namespace EasyLine::Bench;
+
+    EasyLine::Log::Init();
+
+    int ran = 0;
+    for (const BenchmarkCase& bench : GetRegistry()) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; i++)
+            selected = std::strstr(bench.Name, argv[i]) != nullptr;
+        if (!selected) continue;
+
+        std::printf("== %s\n", bench.Name);
+        bench.Run();
+        std::printf("\n");
+        ran++;
+    }
+
+    if (ran == 0) {
+        std::printf("No benchmark matched. Available:\n");
+        for (const BenchmarkCase& bench : GetRegistry())
+            std::printf("  %s\n", bench.Name);
+        return 1;
+    }
+    return 0;
+}
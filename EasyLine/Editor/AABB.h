@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include "glm/glm.hpp"
+
+namespace EasyLine {
+
+// Axis-aligned bounding box in world coordinates. A default constructed box is
+// empty (Min > Max) so it can be grown with Expand().
+struct AABB
+{
+	glm::vec2 Min = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+	glm::vec2 Max = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+	AABB() = default;
+	AABB(const glm::vec2& min, const glm::vec2& max) : Min(min), Max(max) {}
+
+	bool IsEmpty() const { return Min.x > Max.x || Min.y > Max.y; }
+
+	void Expand(const glm::vec2& p) { Min = glm::min(Min, p); Max = glm::max(Max, p); }
+	void Expand(const AABB& other) { Min = glm::min(Min, other.Min); Max = glm::max(Max, other.Max); }
+
+	AABB Inflated(float amount) const { return { Min - amount, Max + amount }; }
+
+	bool Contains(const glm::vec2& p) const { return p.x >= Min.x && p.x <= Max.x && p.y >= Min.y && p.y <= Max.y; }
+	bool Contains(const AABB& other) const { return other.Min.x >= Min.x && other.Max.x <= Max.x && other.Min.y >= Min.y && other.Max.y <= Max.y; }
+	bool Intersects(const AABB& other) const { return Min.x <= other.Max.x && Max.x >= other.Min.x && Min.y <= other.Max.y && Max.y >= other.Min.y; }
+
+	// True if segment ab has a point in the box (closed). The side tests run
+	// in double, where they are exact for float input of similar magnitude.
+	bool IntersectsSegment(const glm::vec2& a, const glm::vec2& b) const
+	{
+		if (std::max(a.x, b.x) < Min.x || std::min(a.x, b.x) > Max.x || std::max(a.y, b.y) < Min.y || std::min(a.y, b.y) > Max.y)
+			return false;
+		// within the box of the segment, it misses only if all corners are strictly on one side of it
+		const double dx = (double)b.x - a.x, dy = (double)b.y - a.y;
+		int positive = 0, negative = 0;
+		for (int corner = 0; corner < 4; corner++)
+		{
+			const double x = (corner & 1) ? Max.x : Min.x, y = (corner & 2) ? Max.y : Min.y;
+			const double side = dx * (y - a.y) - dy * (x - a.x);
+			positive += side > 0.0;
+			negative += side < 0.0;
+		}
+		return positive < 4 && negative < 4;
+	}
+
+	glm::vec2 GetCenter() const { return (Min + Max) * 0.5f; }
+	glm::vec2 GetSize() const { return Max - Min; }
+};
+
+}
@@ -18,6 +18,37 @@ void Camera::OnResize(float width, float height)
 	RecalculateViewMatrix();
 }
 
+AABB Camera::GetViewBounds() const
+{
+	glm::vec2 halfExtent = { m_AspectRatio * m_Zoom, m_Zoom };
+	return { m_Position - halfExtent, m_Position + halfExtent };
+}
+
+glm::vec2 Camera::ScreenToWorld(const glm::vec2& pixel) const
+{
+	AABB view = GetViewBounds();
+	glm::vec2 size = view.GetSize();
+	return { view.Min.x + pixel.x / m_Width * size.x, view.Max.y - pixel.y / m_Height * size.y };
+}
+
+glm::vec2 Camera::WorldToScreen(const glm::vec2& position) const
+{
+	AABB view = GetViewBounds();
+	glm::vec2 size = view.GetSize();
+	return { (position.x - view.Min.x) / size.x * m_Width, (view.Max.y - position.y) / size.y * m_Height };
+}
+
+void Camera::FitBounds(const AABB& bounds)
+{
+	if (bounds.IsEmpty())
+		return;
+
+	glm::vec2 halfSize = bounds.GetSize() * 0.5f * 1.05f;
+	m_Position = bounds.GetCenter();
+	m_Zoom = std::max({ halfSize.y, halfSize.x / m_AspectRatio, 1e-6f });
+	RecalculateViewMatrix();
+}
+
 void Camera::RecalculateViewMatrix()
 {
 	m_ProjectionMatrix = glm::ortho(-m_AspectRatio * m_Zoom, m_AspectRatio * m_Zoom, -m_Zoom, m_Zoom, -1.0f, 1.0f);
@@ -2,6 +2,7 @@
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
+#include "AABB.h"
 
 namespace EasyLine {
 
@@ -20,6 +21,18 @@ public:
 	void SetZoom(float zoom) { m_Zoom = zoom; RecalculateViewMatrix(); }
 	float GetZoom() const { return m_Zoom; }
 
+	// World-space rectangle currently covered by the viewport
+	AABB GetViewBounds() const;
+	// Center on bounds and zoom so all of it is visible, with a small margin
+	void FitBounds(const AABB& bounds);
+
+	// World position of a framebuffer pixel (origin top left, y down)
+	glm::vec2 ScreenToWorld(const glm::vec2& pixel) const;
+	// Framebuffer pixel of a world position, the inverse of ScreenToWorld
+	glm::vec2 WorldToScreen(const glm::vec2& position) const;
+	// World-space size of one pixel
+	float GetPixelSize() const { return 2.0f * m_Zoom / m_Height; }
+
 private:
 	void RecalculateViewMatrix();
 
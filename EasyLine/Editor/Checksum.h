@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace EasyLine {
+
+// Fletcher-64 over 32-bit words: cheap enough to run over every byte of a
+// multi-GB file at memory speed, and catches torn writes and bit rot. Not a
+// cryptographic hash. Data may be fed in pieces; only the last may have a
+// size that is not a multiple of 4.
+class Checksum {
+public:
+    void Update(const void* data, size_t size) {
+        const uint8_t* p = (const uint8_t*)data;
+        size_t words = size / 4;
+        while (words > 0) {
+            // both sums stay below 2^64 for this many words before reducing
+            const size_t block = words < 16384 ? words : 16384;
+            for (size_t i = 0; i < block; i++, p += 4) {
+                uint32_t word;
+                std::memcpy(&word, p, 4);
+                m_A += word;
+                m_B += m_A;
+            }
+            m_A %= kModulus;
+            m_B %= kModulus;
+            words -= block;
+        }
+        if (size % 4) {
+            uint32_t word = 0;
+            std::memcpy(&word, p, size % 4);
+            m_A = (m_A + word) % kModulus;
+            m_B = (m_B + m_A) % kModulus;
+        }
+    }
+
+    uint64_t Get() const { return (m_B << 32) | m_A; }
+
+    static uint64_t Compute(const void* data, size_t size) {
+        Checksum checksum;
+        checksum.Update(data, size);
+        return checksum.Get();
+    }
+
+private:
+    static constexpr uint64_t kModulus = 0xffffffffull;
+    uint64_t m_A = 0;
+    uint64_t m_B = 0;
+};
+
+} // namespace EasyLine
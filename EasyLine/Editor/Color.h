@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace EasyLine {
+
+struct Color { float r,g,b,a; };
+
+// RGBA8 packing used for stored line colors (R in the low byte)
+inline uint32_t PackColor(const Color& c) {
+    auto channel = [](float v) { return (uint32_t)(v <= 0.0f ? 0.0f : v >= 1.0f ? 255.0f : v * 255.0f + 0.5f); };
+    return channel(c.r) | (channel(c.g) << 8) | (channel(c.b) << 16) | (channel(c.a) << 24);
+}
+
+inline Color UnpackColor(uint32_t c) {
+    const float k = 1.0f / 255.0f;
+    return { (c & 0xff) * k, ((c >> 8) & 0xff) * k, ((c >> 16) & 0xff) * k, (c >> 24) * k };
+}
+
+} // namespace EasyLine
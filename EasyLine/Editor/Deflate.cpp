@@ -0,0 +1,205 @@
+#include "Deflate.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace EasyLine {
+
+static constexpr size_t kMinMatch = 3;
+static constexpr size_t kMaxMatch = 258;
+static constexpr size_t kWindowSize = 32768;
+static constexpr uint32_t kHashBits = 14;
+
+namespace {
+
+struct Code {
+    uint32_t Bits;      // already bit-reversed, extra bits included
+    uint32_t Length;
+};
+
+// The fixed Huffman codes of RFC 1951 3.2.6 with the length and distance
+// symbols (and their extra bits) resolved per value
+struct FixedCodes {
+    Code Literal[257];
+    Code Length[kMaxMatch + 1];
+    Code Distance[kWindowSize + 1];
+
+    FixedCodes() {
+        for (uint32_t symbol = 0; symbol < 288; symbol++) {
+            Code code = symbol < 144 ? Code{ 0x30 + symbol, 8 } : symbol < 256 ? Code{ 0x190 + symbol - 144, 9 }
+                : symbol < 280 ? Code{ symbol - 256, 7 } : Code{ 0xc0 + symbol - 280, 8 };
+            code.Bits = Reverse(code.Bits, code.Length);
+            if (symbol <= 256) Literal[symbol] = code;
+            if (symbol >= 257 && symbol <= 285) {
+                const uint32_t index = symbol - 257;
+                for (uint32_t extra = 0; extra < (1u << kLengthExtra[index]); extra++) {
+                    const uint32_t length = kLengthBase[index] + extra;
+                    // 258 has a symbol of its own, 284 + 31 would collide with it
+                    if (length > kMaxMatch || (length == kMaxMatch && symbol != 285)) break;
+                    Length[length] = { code.Bits | extra << code.Length, code.Length + kLengthExtra[index] };
+                }
+            }
+        }
+        for (uint32_t symbol = 0; symbol < 30; symbol++) {
+            const uint32_t bits = Reverse(symbol, 5);
+            for (uint32_t extra = 0; extra < (1u << kDistanceExtra[symbol]); extra++)
+                Distance[kDistanceBase[symbol] + extra] = { bits | extra << 5, 5u + kDistanceExtra[symbol] };
+        }
+    }
+
+    static uint32_t Reverse(uint32_t bits, uint32_t length) {
+        uint32_t reversed = 0;
+        for (uint32_t i = 0; i < length; i++) reversed |= ((bits >> i) & 1u) << (length - 1 - i);
+        return reversed;
+    }
+
+    static constexpr uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static constexpr uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static constexpr uint16_t kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static constexpr uint8_t kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+};
+
+const FixedCodes& GetFixedCodes() {
+    static const FixedCodes codes;
+    return codes;
+}
+
+// Deflate packs bits starting at the least significant bit of each byte
+struct BitWriter {
+    uint8_t* Out;
+    uint64_t Bits = 0;
+    uint32_t Count = 0;
+
+    void Put(const Code& code) { Put(code.Bits, code.Length); }
+    void Put(uint32_t bits, uint32_t length) {
+        Bits |= (uint64_t)bits << Count;
+        Count += length;
+        if (Count >= 32) {
+            for (int i = 0; i < 4; i++) *Out++ = (uint8_t)(Bits >> (8 * i));
+            Bits >>= 32;
+            Count -= 32;
+        }
+    }
+    void Align() {
+        for (; Count > 0; Count = Count > 8 ? Count - 8 : 0) {
+            *Out++ = (uint8_t)Bits;
+            Bits >>= 8;
+        }
+        Bits = 0;
+    }
+};
+
+uint32_t Load32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t Hash3(const uint8_t* p) {
+    return ((Load32(p) & 0xffffffu) * 2654435761u) >> (32 - kHashBits);
+}
+
+size_t MatchLength(const uint8_t* a, const uint8_t* b, size_t limit) {
+    size_t length = kMinMatch;
+    if constexpr (std::endian::native == std::endian::little) {
+        for (; length + 8 <= limit; length += 8) {
+            uint64_t x, y;
+            std::memcpy(&x, a + length, 8);
+            std::memcpy(&y, b + length, 8);
+            if (x != y) return length + std::countr_zero(x ^ y) / 8;
+        }
+    }
+    while (length < limit && a[length] == b[length]) length++;
+    return length;
+}
+
+} // namespace
+
+size_t DeflateCompress(const uint8_t* src, size_t size, uint8_t* dst) {
+    const FixedCodes& codes = GetFixedCodes();
+    BitWriter out{ dst };
+    out.Put(2, 3);  // not final, fixed codes
+
+    size_t i = 0;
+    if (size >= 4) {
+        uint32_t table[1u << kHashBits] = {};   // position + 1, 0 = empty
+        while (i + 4 <= size) {
+            const uint32_t h = Hash3(src + i);
+            const size_t ref = table[h];
+            table[h] = (uint32_t)(i + 1);
+            if (ref == 0 || i - (ref - 1) > kWindowSize || (Load32(src + ref - 1) & 0xffffffu) != (Load32(src + i) & 0xffffffu)) {
+                out.Put(codes.Literal[src[i++]]);
+                continue;
+            }
+            const size_t length = MatchLength(src + ref - 1, src + i, std::min(kMaxMatch, size - i));
+            out.Put(codes.Length[length]);
+            out.Put(codes.Distance[i - (ref - 1)]);
+            i += length;
+        }
+    }
+    for (; i < size; i++) out.Put(codes.Literal[src[i]]);
+    out.Put(codes.Literal[256]);
+
+    // sync flush: empty stored block, which also byte-aligns the output
+    out.Put(0, 3);
+    out.Align();
+    uint8_t* p = out.Out;
+    *p++ = 0x00;
+    *p++ = 0x00;
+    *p++ = 0xff;
+    *p++ = 0xff;
+    return (size_t)(p - dst);
+}
+
+static constexpr uint32_t kAdlerBase = 65521;
+
+uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size) {
+    uint32_t a = adler & 0xffff, b = adler >> 16;
+    while (size > 0) {
+        // largest run whose sums cannot overflow 32 bits before reducing
+        const size_t run = std::min<size_t>(size, 5552);
+        for (size_t i = 0; i < run; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= kAdlerBase;
+        b %= kAdlerBase;
+        data += run;
+        size -= run;
+    }
+    return a | b << 16;
+}
+
+uint32_t Adler32Combine(uint32_t first, uint32_t second, uint64_t secondSize) {
+    const uint32_t remainder = (uint32_t)(secondSize % kAdlerBase);
+    uint32_t a = first & 0xffff;
+    uint32_t b = (uint32_t)(((uint64_t)remainder * a) % kAdlerBase);
+    a += (second & 0xffff) + kAdlerBase - 1;
+    b += (first >> 16) + (second >> 16) + kAdlerBase - remainder;
+    if (a >= kAdlerBase) a -= kAdlerBase;
+    if (a >= kAdlerBase) a -= kAdlerBase;
+    if (b >= 2 * kAdlerBase) b -= 2 * kAdlerBase;
+    if (b >= kAdlerBase) b -= kAdlerBase;
+    return a | b << 16;
+}
+
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    static const auto table = [] {
+        struct Table { uint32_t Entries[256]; } t;
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            t.Entries[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) crc = table.Entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+} // namespace EasyLine
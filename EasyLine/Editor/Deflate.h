@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace EasyLine {
+
+// Raw deflate (RFC 1951) encoder for streams that are compressed in pieces
+// on several threads. Each piece becomes one block with the fixed Huffman
+// codes, followed by a sync flush (an empty stored block) that byte-aligns
+// it, and matches never reach back into an earlier piece, so compressed
+// pieces simply concatenate. kDeflateFinalBlock closes the stream.
+//
+// Matching is greedy through a hash table of 3-byte sequences. The fixed
+// codes cost little on the data this is meant for (filtered image rows,
+// mostly runs), and need no statistics pass.
+
+// Upper bound of DeflateCompress output for size input bytes (literals take up to 9 bits)
+constexpr size_t DeflateBound(size_t size) { return size + size / 8 + 16; }
+
+// Compress size bytes of src into dst, which must hold DeflateBound(size). Returns the compressed size.
+size_t DeflateCompress(const uint8_t* src, size_t size, uint8_t* dst);
+
+// Last block of a stream: final, fixed codes, nothing but the end-of-block code
+constexpr uint8_t kDeflateFinalBlock[2] = { 0x03, 0x00 };
+
+// zlib checksum; start with adler = 1
+uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size);
+// Checksum of the concatenation of two pieces, from the checksums of each
+uint32_t Adler32Combine(uint32_t first, uint32_t second, uint64_t secondSize);
+// CRC-32 as used by PNG and zip; start with crc = 0
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size);
+
+} // namespace EasyLine
@@ -0,0 +1,209 @@
+#include "Dimension.h"
+#include "GlyphAtlas.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+namespace EasyLine {
+
+namespace {
+
+constexpr size_t kGrain = 256;
+constexpr int kDecimals = 2;
+// Sizes in pixels of the layout's scale
+constexpr float kStrokeWidth = 1.0f;
+constexpr float kArrowLength = 10.0f;
+constexpr float kArrowHalfWidth = 3.0f;
+constexpr float kExtensionGap = 3.0f;       // between the measured point and its extension line
+constexpr float kExtensionBeyond = 4.0f;    // extension line past the dimension line
+constexpr float kTextGap = 3.0f;
+
+size_t GetStrokeCount(DimensionKind kind) {
+    // two extension lines, the dimension line and two arrows; a leader and an arrow
+    return kind == DimensionKind::Radial ? 3 : 7;
+}
+
+glm::vec2 Perpendicular(const glm::vec2& v) {
+    return { -v.y, v.x };
+}
+
+glm::vec2 NormalizeOr(const glm::vec2& v, const glm::vec2& fallback) {
+    const float length = glm::length(v);
+    return length > 0.0f ? v / length : fallback;
+}
+
+// Text along d reads left to right, or bottom to top when d is vertical
+glm::vec2 GetReadable(const glm::vec2& d) {
+    return d.x < -1e-6f || (std::abs(d.x) <= 1e-6f && d.y < 0.0f) ? -d : d;
+}
+
+void AddStroke(GlyphQuad*& out, const glm::vec2& a, const glm::vec2& b, float width, const glm::vec2& solidUv) {
+    const glm::vec2 normal = Perpendicular(NormalizeOr(b - a, { 1.0f, 0.0f }));
+    *out++ = { a - normal * (width * 0.5f), b - a, normal * width, solidUv, solidUv };
+}
+
+// An open arrowhead at tip, pointing along direction
+void AddArrow(GlyphQuad*& out, const glm::vec2& tip, const glm::vec2& direction, float scale, const glm::vec2& solidUv) {
+    const glm::vec2 back = tip - direction * (kArrowLength * scale);
+    const glm::vec2 side = Perpendicular(direction) * (kArrowHalfWidth * scale);
+    AddStroke(out, tip, back + side, kStrokeWidth * scale, solidUv);
+    AddStroke(out, tip, back - side, kStrokeWidth * scale, solidUv);
+}
+
+// The text's glyphs with the middle of its baseline at center, running along
+// direction, height world units tall
+void PlaceText(GlyphQuad*& out, const std::vector<GlyphQuad>& glyphs, const glm::vec2& center, const glm::vec2& direction, float height) {
+    const glm::vec2 right = direction * height, up = Perpendicular(direction) * height;
+    for (const GlyphQuad& glyph : glyphs)
+        *out++ = { center + right * glyph.Position.x + up * glyph.Position.y, right * glyph.Right.x, up * glyph.Up.y, glyph.UvMin, glyph.UvMax };
+}
+
+void BuildQuads(const Dimension& dimension, const std::vector<GlyphQuad>& glyphs, float textWidth, float scale, const glm::vec2& solidUv,
+    GlyphQuad* out) {
+    const float height = DimensionLayout::kTextHeight * scale;
+    const float width = textWidth * height;
+    const float stroke = kStrokeWidth * scale;
+
+    if (dimension.Kind == DimensionKind::Radial) {
+        // leader from the circle out to Location, the text past its end
+        const glm::vec2 away = NormalizeOr(dimension.Location - dimension.P1, NormalizeOr(dimension.P1 - dimension.P0, { 1.0f, 0.0f }));
+        AddStroke(out, dimension.P1, dimension.Location, stroke, solidUv);
+        AddArrow(out, dimension.P1, -away, scale, solidUv);
+        const glm::vec2 direction = GetReadable(away);
+        const glm::vec2 center = dimension.Location + away * (width * 0.5f + kTextGap * scale) - Perpendicular(direction) * (height * 0.35f);
+        PlaceText(out, glyphs, center, direction, height);
+        return;
+    }
+
+    // The dimension line runs through Location along the measured direction,
+    // between the feet of the measured points
+    const glm::vec2 d = dimension.Kind == DimensionKind::Linear ? glm::vec2(std::cos(dimension.Angle), std::sin(dimension.Angle))
+        : NormalizeOr(dimension.P1 - dimension.P0, { 1.0f, 0.0f });
+    const glm::vec2& location = dimension.Location;
+    const glm::vec2 e0 = location + d * glm::dot(dimension.P0 - location, d);
+    const glm::vec2 e1 = location + d * glm::dot(dimension.P1 - location, d);
+    for (int end = 0; end < 2; end++) {
+        const glm::vec2& p = end ? dimension.P1 : dimension.P0;
+        const glm::vec2& e = end ? e1 : e0;
+        const glm::vec2 u = NormalizeOr(e - p, Perpendicular(d));
+        AddStroke(out, p + u * (kExtensionGap * scale), e + u * (kExtensionBeyond * scale), stroke, solidUv);
+    }
+
+    // The text goes over the middle of the line, or past its end when it
+    // does not fit between the arrows
+    const float length = glm::length(e1 - e0);
+    const glm::vec2 along = NormalizeOr(e1 - e0, d);
+    const glm::vec2 direction = GetReadable(d);
+    glm::vec2 lineFrom = e0, lineTo = e1, center = (e0 + e1) * 0.5f;
+    if (width + 2.0f * (kArrowLength + kTextGap) * scale > length) {
+        const bool forward = glm::dot(along, direction) >= 0.0f;
+        const glm::vec2& end = forward ? e1 : e0;
+        center = end + direction * ((kArrowLength + kTextGap) * scale + width * 0.5f);
+        (forward ? lineTo : lineFrom) = center + direction * (width * 0.5f);
+    }
+    AddStroke(out, lineFrom, lineTo, stroke, solidUv);
+    AddArrow(out, e0, -along, scale, solidUv);
+    AddArrow(out, e1, along, scale, solidUv);
+    PlaceText(out, glyphs, center + Perpendicular(direction) * (kTextGap * scale), direction, height);
+}
+
+} // namespace
+
+float GetDimensionValue(const Dimension& dimension) {
+    const glm::vec2 delta = dimension.P1 - dimension.P0;
+    if (dimension.Kind == DimensionKind::Linear)
+        return std::abs(glm::dot(delta, glm::vec2(std::cos(dimension.Angle), std::sin(dimension.Angle))));
+    return glm::length(delta);
+}
+
+size_t DimensionSet::Add(const Dimension& dimension) {
+    m_Dimensions.push_back(dimension);
+    m_Revision++;
+    return m_Dimensions.size() - 1;
+}
+
+void DimensionSet::Set(size_t index, const Dimension& dimension) {
+    m_Dimensions[index] = dimension;
+    m_Revision++;
+}
+
+void DimensionSet::Clear() {
+    m_Dimensions.clear();
+    m_Revision++;
+}
+
+bool DimensionLayout::Update(const DimensionSet& dimensions, const GlyphAtlas& atlas, float pixelSize) {
+    const int bucket = (int)std::floor(std::log2(std::max(pixelSize, 1e-30f)) * kBucketsPerOctave + 0.5f);
+    const float scale = m_TextHeight > 0.0f ? m_TextHeight / kTextHeight : std::exp2((float)bucket / kBucketsPerOctave);
+    m_LaidOutCount = 0;
+    if (m_Dimensions == &dimensions && m_Revision == dimensions.GetRevision() && m_Atlas == &atlas && m_Scale == scale) return false;
+    // strings laid out with another atlas have its metrics
+    if (m_Atlas != &atlas) m_Texts.clear();
+    m_Dimensions = &dimensions;
+    m_Revision = dimensions.GetRevision();
+    m_Atlas = &atlas;
+    m_Scale = scale;
+
+    // Lay out the strings whose value changed, and count every dimension's quads
+    const size_t count = dimensions.GetCount();
+    m_Texts.resize(count);
+    m_FirstQuads.assign(count + 1, 0);
+    std::atomic<size_t> laidOut{0};
+    JobSystem::ParallelFor(count, kGrain, [&](size_t begin, size_t end) {
+        size_t strings = 0;
+        for (size_t i = begin; i < end; i++) {
+            const Dimension& dimension = dimensions.Get(i);
+            const float value = GetDimensionValue(dimension);
+            const bool radial = dimension.Kind == DimensionKind::Radial;
+            Text& text = m_Texts[i];
+            if (!text.Valid || text.Value != value || text.Radial != radial) {
+                char buffer[64];
+                const int length = std::min(std::snprintf(buffer, sizeof(buffer), radial ? "R%.*f" : "%.*f", kDecimals, value), (int)sizeof(buffer) - 1);
+                text.Glyphs.clear();
+                float pen = 0.0f;
+                for (int c = 0; c < length; c++) {
+                    const GlyphMetrics* glyph = atlas.GetGlyph((unsigned char)buffer[c]);
+                    if (!glyph) continue;
+                    if (glyph->Max.x > glyph->Min.x)
+                        text.Glyphs.push_back({ { pen + glyph->Min.x, glyph->Min.y }, { glyph->Max.x - glyph->Min.x, 0.0f },
+                            { 0.0f, glyph->Max.y - glyph->Min.y }, glyph->UvMin, glyph->UvMax });
+                    pen += glyph->Advance;
+                }
+                for (GlyphQuad& glyph : text.Glyphs) glyph.Position.x -= pen * 0.5f;
+                text.Width = pen;
+                text.Value = value;
+                text.Radial = radial;
+                text.Valid = true;
+                strings++;
+            }
+            m_FirstQuads[i + 1] = GetStrokeCount(dimension.Kind) + text.Glyphs.size();
+        }
+        laidOut.fetch_add(strings, std::memory_order_relaxed);
+    });
+    std::partial_sum(m_FirstQuads.begin(), m_FirstQuads.end(), m_FirstQuads.begin());
+
+    // Then place them all at this scale
+    m_Quads.resize(m_FirstQuads[count]);
+    JobSystem::ParallelFor(count, kGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            BuildQuads(dimensions.Get(i), m_Texts[i].Glyphs, m_Texts[i].Width, scale, atlas.GetSolidUv(), m_Quads.data() + m_FirstQuads[i]);
+    });
+    m_LaidOutCount = laidOut.load();
+    m_Version++;
+    return true;
+}
+
+void DimensionLayout::Clear() {
+    m_Texts.clear();
+    m_FirstQuads.clear();
+    m_Quads.clear();
+    m_Dimensions = nullptr;
+    m_Atlas = nullptr;
+    m_Scale = 0.0f;
+    m_Version++;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace EasyLine {
+
+class GlyphAtlas;
+
+enum class DimensionKind : uint8_t {
+    Linear,     // distance along a fixed direction, horizontal or vertical as drafted
+    Aligned,    // distance between the points, dimension line parallel to them
+    Radial,     // radius of a circle, from its center to a point on it
+};
+
+// A dimension as CAD stores one: the points measured and where it is drawn
+struct Dimension {
+    DimensionKind Kind = DimensionKind::Aligned;
+    glm::vec2 P0 = { 0.0f, 0.0f };        // measured points; the center and a point on the circle for radial
+    glm::vec2 P1 = { 0.0f, 0.0f };
+    glm::vec2 Location = { 0.0f, 0.0f };  // a point on the dimension line; the end of the leader for radial
+    float Angle = 0.0f;                   // linear only: direction measured, radians from the x axis
+};
+
+// The distance the dimension shows
+float GetDimensionValue(const Dimension& dimension);
+
+// The view's dimensions. They annotate the drawing but are not part of the
+// document: they are neither saved nor undone with it.
+class DimensionSet {
+public:
+    size_t Add(const Dimension& dimension);
+    void Set(size_t index, const Dimension& dimension);
+    void Clear();
+
+    size_t GetCount() const { return m_Dimensions.size(); }
+    const Dimension& Get(size_t index) const { return m_Dimensions[index]; }
+    // Changes on every edit
+    uint64_t GetRevision() const { return m_Revision; }
+
+private:
+    std::vector<Dimension> m_Dimensions;
+    uint64_t m_Revision = 0;
+};
+
+// One quad of dimension geometry, a glyph or a stroke, drawn as an instance:
+// corner (s, t) lies at Position + s * Right + t * Up and samples the atlas
+// at mix(UvMin, UvMax, (s, t))
+struct GlyphQuad {
+    glm::vec2 Position;
+    glm::vec2 Right;
+    glm::vec2 Up;
+    glm::vec2 UvMin;
+    glm::vec2 UvMax;
+};
+
+// Dimension lines, arrows and text of a DimensionSet as quads for one
+// instanced draw.
+//
+// Text and arrows keep about the same size on screen, so their size in the
+// drawing depends on the zoom. It is rounded to kBucketsPerOctave steps per
+// doubling of the zoom, and the quads are rebuilt only when the step or the
+// set changes: between those, a frame does no work at all. With a text
+// height set in drawing units they scale with the drawing instead, and the
+// zoom never rebuilds them. Each dimension's string is formatted and laid
+// out once per value and kept, so a rebuild only places the cached glyphs.
+// Both run in parallel on the job system.
+class DimensionLayout {
+public:
+    static constexpr float kTextHeight = 14.0f;     // pixels, before rounding to the zoom step
+    static constexpr int kBucketsPerOctave = 4;
+
+    // Bring the quads up to date for a view where a pixel is pixelSize
+    // world units. Returns true if they changed.
+    bool Update(const DimensionSet& dimensions, const GlyphAtlas& atlas, float pixelSize);
+    void Clear();
+
+    // Text height in drawing units, or 0 to keep the text kTextHeight pixels
+    // tall on screen
+    void SetTextHeight(float height) { m_TextHeight = height; }
+    float GetTextHeight() const { return m_TextHeight; }
+
+    const std::vector<GlyphQuad>& GetQuads() const { return m_Quads; }
+    // Changes whenever the quads do
+    uint64_t GetVersion() const { return m_Version; }
+    // Strings formatted and laid out by the last Update()
+    size_t GetLaidOutCount() const { return m_LaidOutCount; }
+
+private:
+    // A dimension's string at unit text height, centered on the origin of its baseline
+    struct Text {
+        std::vector<GlyphQuad> Glyphs;
+        float Value = 0.0f;
+        float Width = 0.0f;
+        bool Radial = false;
+        bool Valid = false;
+    };
+
+    std::vector<Text> m_Texts;
+    std::vector<size_t> m_FirstQuads;
+    std::vector<GlyphQuad> m_Quads;
+    const DimensionSet* m_Dimensions = nullptr;
+    const GlyphAtlas* m_Atlas = nullptr;
+    uint64_t m_Revision = 0;
+    float m_TextHeight = 0.0f;
+    float m_Scale = 0.0f;   // drawing units per pixel of kTextHeight the quads were built at
+    uint64_t m_Version = 0;
+    size_t m_LaidOutCount = 0;
+};
+
+} // namespace EasyLine
@@ -0,0 +1,93 @@
+#include "DocumentAutosave.h"
+#include "ElbFormat.h"
+#include "FileWriter.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "Log.h"
+#include <atomic>
+#include <cstdio>
+
+namespace EasyLine {
+
+struct DocumentAutosave::Save {
+    std::shared_ptr<const LineDocument> Snapshot;
+    uint64_t Revision = 0;
+    std::chrono::steady_clock::time_point Start;
+    JobCounter Counter;
+    std::atomic<bool> Succeeded{false};
+};
+
+DocumentAutosave::DocumentAutosave() = default;
+
+DocumentAutosave::~DocumentAutosave() {
+    Stop();
+}
+
+void DocumentAutosave::Start(const LineDocument& document, const std::string& path, std::chrono::milliseconds interval) {
+    Stop();
+    m_Document = &document;
+    m_Path = path;
+    m_Interval = interval;
+    m_SavedRevision = document.GetRevision();
+    m_LastSave = std::chrono::steady_clock::now();
+}
+
+void DocumentAutosave::Stop(bool removeFile) {
+    if (!IsActive()) return;
+    if (m_Save) {
+        JobSystem::Wait(m_Save->Counter);
+        FinishSave();
+    }
+    if (removeFile) std::remove(m_Path.c_str());
+    m_Document = nullptr;
+}
+
+void DocumentAutosave::Update() {
+    if (!IsActive()) return;
+    if (m_Save) {
+        if (!m_Save->Counter.IsDone()) return;
+        FinishSave();
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - m_LastSave < m_Interval || m_Document->GetRevision() == m_SavedRevision) return;
+
+    auto save = std::make_unique<Save>();
+    save->Snapshot = m_Document->CreateSnapshot();
+    save->Revision = m_Document->GetRevision();
+    save->Start = now;
+
+    // The snapshot is only released on this thread, in FinishSave, so the
+    // document never sees a chunk as unshared while the worker reads it
+    Save* job = save.get();
+    JobSystem::Run([job, path = m_Path] {
+        FileWriter out;
+        if (!out.Open(path)) return;
+        if (!WriteElb(*job->Snapshot, out)) {
+            out.Discard();
+            return;
+        }
+        job->Succeeded = out.Close();
+    }, &job->Counter);
+    m_Save = std::move(save);
+}
+
+void DocumentAutosave::MarkSaved() {
+    if (IsActive()) m_SavedRevision = m_Document->GetRevision();
+}
+
+void DocumentAutosave::FinishSave() {
+    std::unique_ptr<Save> save = std::move(m_Save);
+    m_LastSave = std::chrono::steady_clock::now();
+    if (!save->Succeeded) {
+        // try again after the next interval
+        EL_CORE_ERROR("Autosave to {} failed", m_Path);
+        return;
+    }
+    // a later explicit save may already have covered more
+    if (save->Revision > m_SavedRevision) m_SavedRevision = save->Revision;
+    m_LastSaveMs = std::chrono::duration<double, std::milli>(m_LastSave - save->Start).count();
+    EL_CORE_INFO("Autosaved {} lines to {} in {:.0f} ms", save->Snapshot->GetLineCount(), m_Path, m_LastSaveMs);
+}
+
+} // namespace EasyLine
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace EasyLine {
+
+class LineDocument;
+
+// Periodic background save of a document into a recovery file.
+//
+// Every interval, if the document changed, a snapshot is taken (O(1), see
+// LineDocument::CreateSnapshot) and written as .elb on a worker thread, so
+// the editing thread never waits for the disk however large the drawing is.
+// Each save replaces the previous recovery file only once it is complete.
+class DocumentAutosave {
+public:
+    static constexpr std::chrono::milliseconds kDefaultInterval{60000};
+
+    DocumentAutosave();
+    ~DocumentAutosave();
+
+    DocumentAutosave(const DocumentAutosave&) = delete;
+    DocumentAutosave& operator=(const DocumentAutosave&) = delete;
+
+    // Save document (not owned) to path whenever it has changed for interval.
+    // The document as it is now counts as saved.
+    void Start(const LineDocument& document, const std::string& path, std::chrono::milliseconds interval = kDefaultInterval);
+    // Wait for a save in progress and stop. removeFile deletes the recovery file.
+    void Stop(bool removeFile = false);
+    bool IsActive() const { return m_Document != nullptr; }
+    const std::string& GetPath() const { return m_Path; }
+
+    // Call once per frame on the thread that edits the document
+    void Update();
+    // The document was saved elsewhere at its current revision; nothing to recover
+    void MarkSaved();
+
+    bool IsSaving() const { return m_Save != nullptr; }
+    // Wall time of the last completed save, from snapshot to rename
+    double GetLastSaveMs() const { return m_LastSaveMs; }
+
+private:
+    struct Save;
+
+    void FinishSave();
+
+    const LineDocument* m_Document = nullptr;
+    std::string m_Path;
+    std::chrono::milliseconds m_Interval = kDefaultInterval;
+    uint64_t m_SavedRevision = 0;
+    std::chrono::steady_clock::time_point m_LastSave;
+    double m_LastSaveMs = 0.0;
+    std::unique_ptr<Save> m_Save;
+};
+
+} // namespace EasyLine
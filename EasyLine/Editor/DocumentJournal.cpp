@@ -0,0 +1,286 @@
+#include "DocumentJournal.h"
+#include "Checksum.h"
+#include "ElbFormat.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "Log.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+namespace EasyLine {
+
+struct JournalHeader {
+    static constexpr uint32_t kMagic = 0x314a4c45;     // "ELJ1"
+    static constexpr uint32_t kVersion = 1;
+
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t JournalId;         // ElbHeader::JournalId of the base
+    uint64_t HeaderChecksum;    // of the fields above
+};
+
+struct JournalBatchHeader {
+    static constexpr uint32_t kMagic = 0x48435442;     // "BTCH"
+
+    uint32_t Magic;
+    uint32_t RecordCount;
+    uint64_t Sequence;          // 1, 2, 3... per journal
+    uint64_t Checksum;          // of the fields above and the records
+};
+
+struct DocumentJournal::Compaction {
+    std::shared_ptr<const LineDocument> Snapshot;
+    uint64_t Sequence = 0;      // last batch contained in the snapshot
+    uint64_t JournalSize = 0;   // journal bytes at snapshot time; batches after this are kept
+    JobCounter Counter;
+    std::atomic<bool> Succeeded{false};
+};
+
+static uint64_t ComputeBatchChecksum(const JournalBatchHeader& batch, const void* records) {
+    Checksum checksum;
+    checksum.Update(&batch, offsetof(JournalBatchHeader, Checksum));
+    checksum.Update(records, batch.RecordCount * sizeof(JournalRecord));
+    return checksum.Get();
+}
+
+// Returns false if the records do not fit the document, i.e. the journal belongs to another base
+static bool ApplyRecords(LineDocument& document, const uint8_t* data, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        JournalRecord r;
+        std::memcpy(&r, data + i * sizeof(JournalRecord), sizeof(r));
+        switch (r.Op) {
+        case JournalRecord::Add:
+            if (document.AddLine({ r.X0, r.Y0 }, { r.X1, r.Y1 }, r.Thickness, UnpackColor(r.Color)) != r.Handle) return false;
+            break;
+        case JournalRecord::Move:
+            if (!document.IsLineValid(r.Handle)) return false;
+            document.MoveLine(r.Handle, { r.X0, r.Y0 }, { r.X1, r.Y1 });
+            break;
+        case JournalRecord::Remove:
+            if (!document.IsLineValid(r.Handle)) return false;
+            document.RemoveLine(r.Handle);
+            break;
+        case JournalRecord::Restore:
+            if (document.IsLineValid(r.Handle)) return false;
+            document.RestoreLine(r.Handle);
+            if (!document.IsLineValid(r.Handle)) return false;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+DocumentJournal::DocumentJournal() = default;
+
+DocumentJournal::~DocumentJournal() {
+    Detach();
+}
+
+bool DocumentJournal::Attach(LineDocument& document, const std::string& basePath) {
+    Detach();
+
+    ElbHeader base;
+    {
+        MappedFile file;
+        if (!file.Open(basePath)) return false;
+        std::string error;
+        if (!ReadElbHeader(file.GetData(), file.GetSize(), base, error)) {
+            EL_CORE_ERROR("{}: {}", basePath, error);
+            return false;
+        }
+    }
+    m_BasePath = basePath;
+    m_Path = basePath + ".journal";
+    m_Id = base.JournalId;
+    m_Sequence = base.JournalSequence;
+    m_CompactSize = kCompactSize;
+    document.SetJournal(nullptr);
+
+    // Replay the batches the base does not contain yet. Stop at the first
+    // torn, corrupt or out-of-order batch: everything after it is lost anyway.
+    std::vector<uint8_t> live;
+    bool clean = false, mismatch = false;
+    size_t replayed = 0;
+    std::error_code ec;
+    if (std::filesystem::exists(m_Path, ec)) {
+        MappedFile journal;
+        JournalHeader header = {};
+        bool valid = journal.Open(m_Path) && journal.GetSize() >= sizeof(header);
+        if (valid) {
+            std::memcpy(&header, journal.GetData(), sizeof(header));
+            valid = header.Magic == JournalHeader::kMagic && header.Version == JournalHeader::kVersion &&
+                header.HeaderChecksum == Checksum::Compute(&header, offsetof(JournalHeader, HeaderChecksum)) &&
+                header.JournalId == m_Id;
+        }
+
+        if (valid) {
+            const uint8_t* data = journal.GetData();
+            const size_t size = journal.GetSize();
+            size_t offset = sizeof(JournalHeader), liveBegin = offset;
+            while (size - offset >= sizeof(JournalBatchHeader)) {
+                JournalBatchHeader batch;
+                std::memcpy(&batch, data + offset, sizeof(batch));
+                const uint8_t* records = data + offset + sizeof(batch);
+                const uint64_t bytes = (uint64_t)batch.RecordCount * sizeof(JournalRecord);
+                if (batch.Magic != JournalBatchHeader::kMagic || bytes > size - offset - sizeof(batch) ||
+                    batch.Checksum != ComputeBatchChecksum(batch, records))
+                    break;
+
+                if (batch.Sequence <= m_Sequence) {
+                    // already folded into the base by a compaction that was cut short
+                    offset += sizeof(batch) + bytes;
+                    liveBegin = offset;
+                    continue;
+                }
+                if (batch.Sequence != m_Sequence + 1) break;
+                if (!ApplyRecords(document, records, batch.RecordCount)) {
+                    mismatch = true;
+                    break;
+                }
+                m_Sequence = batch.Sequence;
+                replayed += batch.RecordCount;
+                offset += sizeof(batch) + bytes;
+            }
+            if (mismatch) {
+                // not the document this journal was written for; leave both files alone
+                EL_CORE_ERROR("{}: edits do not match the document, journal not attached", m_Path);
+                return false;
+            }
+            clean = liveBegin == sizeof(JournalHeader) && offset == size;
+            live.assign(data + liveBegin, data + offset);
+            if (offset != size) EL_CORE_WARN("{}: dropped {} bytes of incomplete edits", m_Path, size - offset);
+        }
+    }
+
+    if (!clean && !Rewrite(live.data(), live.size())) return false;
+    if (!m_File.OpenAppend(m_Path)) return false;
+    m_Size = sizeof(JournalHeader) + live.size();
+
+    m_Document = &document;
+    document.SetJournal(this);
+    m_LastCommit = std::chrono::steady_clock::now();
+    if (replayed > 0) EL_CORE_INFO("{}: replayed {} edits", m_Path, replayed);
+    return true;
+}
+
+void DocumentJournal::Detach() {
+    if (!IsAttached()) return;
+    if (m_Compaction) {
+        JobSystem::Wait(m_Compaction->Counter);
+        FinishCompaction();
+    }
+    Commit();
+    m_File.Close();
+    m_Document->SetJournal(nullptr);
+    m_Document = nullptr;
+    m_Pending.clear();
+}
+
+void DocumentJournal::RecordAdd(LineHandle handle, const LineChunk& chunk, uint32_t slot) {
+    m_Pending.push_back({ JournalRecord::Add, handle, chunk.X0[slot], chunk.Y0[slot], chunk.X1[slot], chunk.Y1[slot],
+        chunk.Thickness[slot], chunk.Color[slot] });
+}
+
+void DocumentJournal::RecordMove(LineHandle handle, const glm::vec2& p0, const glm::vec2& p1) {
+    m_Pending.push_back({ JournalRecord::Move, handle, p0.x, p0.y, p1.x, p1.y, 0.0f, 0 });
+}
+
+void DocumentJournal::RecordRemove(LineHandle handle) {
+    m_Pending.push_back({ JournalRecord::Remove, handle, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0 });
+}
+
+void DocumentJournal::RecordRestore(LineHandle handle) {
+    m_Pending.push_back({ JournalRecord::Restore, handle, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0 });
+}
+
+bool DocumentJournal::Commit() {
+    if (!IsAttached()) return false;
+    m_LastCommit = std::chrono::steady_clock::now();
+    if (m_Pending.empty()) return true;
+
+    JournalBatchHeader batch = { JournalBatchHeader::kMagic, (uint32_t)m_Pending.size(), m_Sequence + 1, 0 };
+    batch.Checksum = ComputeBatchChecksum(batch, m_Pending.data());
+    m_File.Write(&batch, sizeof(batch));
+    m_File.Write(m_Pending.data(), m_Pending.size() * sizeof(JournalRecord));
+    if (!m_File.Sync()) {
+        // edits stay pending; a full save is still possible
+        EL_CORE_ERROR("Failed to commit {} edits to {}", m_Pending.size(), m_Path);
+        return false;
+    }
+
+    m_Sequence = batch.Sequence;
+    m_Size += sizeof(batch) + m_Pending.size() * sizeof(JournalRecord);
+    m_Pending.clear();
+    return true;
+}
+
+void DocumentJournal::Update() {
+    if (!IsAttached()) return;
+    if (m_Compaction && m_Compaction->Counter.IsDone()) FinishCompaction();
+    if (!m_Pending.empty() && std::chrono::steady_clock::now() - m_LastCommit >= kCommitInterval) Commit();
+    if (!m_Compaction && m_Size > m_CompactSize) StartCompaction();
+}
+
+bool DocumentJournal::Rewrite(const uint8_t* batches, size_t size) {
+    JournalHeader header = { JournalHeader::kMagic, JournalHeader::kVersion, m_Id, 0 };
+    header.HeaderChecksum = Checksum::Compute(&header, offsetof(JournalHeader, HeaderChecksum));
+
+    FileWriter out;
+    if (!out.Open(m_Path)) return false;
+    out.Write(&header, sizeof(header));
+    out.Write(batches, size);
+    return out.Close();
+}
+
+void DocumentJournal::StartCompaction() {
+    if (!Commit()) return;
+
+    auto compaction = std::make_unique<Compaction>();
+    compaction->Snapshot = m_Document->CreateSnapshot();
+    compaction->Sequence = m_Sequence;
+    compaction->JournalSize = m_Size;
+    EL_CORE_INFO("Compacting {} ({} MB of edits)", m_Path, m_Size >> 20);
+
+    // The snapshot is only released on this thread, in FinishCompaction, so
+    // the document never sees a chunk as unshared while the worker reads it
+    Compaction* job = compaction.get();
+    JobSystem::Run([job, path = m_BasePath, id = m_Id] {
+        FileWriter out;
+        job->Succeeded = out.Open(path) && WriteElb(*job->Snapshot, out, id, job->Sequence) && out.Close();
+    }, &job->Counter);
+    m_Compaction = std::move(compaction);
+}
+
+void DocumentJournal::FinishCompaction() {
+    std::unique_ptr<Compaction> compaction = std::move(m_Compaction);
+    if (!compaction->Succeeded) {
+        EL_CORE_ERROR("Compacting {} failed", m_BasePath);
+        m_CompactSize = m_Size * 2;
+        return;
+    }
+
+    // the new base holds everything up to the snapshot; keep the batches committed since
+    m_File.Close();
+    std::vector<uint8_t> tail;
+    {
+        MappedFile journal;
+        if (journal.Open(m_Path) && journal.GetSize() > compaction->JournalSize)
+            tail.assign(journal.GetData() + compaction->JournalSize, journal.GetData() + journal.GetSize());
+    }
+    if (Rewrite(tail.data(), tail.size())) {
+        m_Size = sizeof(JournalHeader) + tail.size();
+        m_CompactSize = kCompactSize;
+    } else {
+        // still consistent: replay skips the batches the base already has
+        m_CompactSize = m_Size * 2;
+    }
+    if (!m_File.OpenAppend(m_Path))
+        EL_CORE_ERROR("Cannot reopen {}, edits are no longer saved", m_Path);
+}
+
+} // namespace EasyLine
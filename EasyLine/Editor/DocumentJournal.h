@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "FileWriter.h"
+#include "LineChunk.h"
+
+namespace EasyLine {
+
+class LineDocument;
+
+// One edit. Fixed size, so batches are written and replayed as plain arrays.
+struct JournalRecord {
+    enum Type : uint32_t { Add = 1, Move = 2, Remove = 3, Restore = 4 };
+
+    uint32_t Op;
+    LineHandle Handle;
+    float X0, Y0, X1, Y1;
+    float Thickness;    // Add only
+    uint32_t Color;     // Add only
+};
+
+// Append-only log of edits kept next to an .elb base file (<base>.journal),
+// so saving costs O(edits) instead of rewriting the whole drawing.
+//
+// The document reports every edit here; Commit() appends the queued ones as
+// a single checksummed batch and fsyncs. A crash loses at most the batch
+// being written, and a torn batch is simply dropped on replay. Once the
+// journal outgrows kCompactSize, a snapshot of the document is written as
+// the new base on a worker thread and the journal is cut down to the batches
+// made after the snapshot. The base header names its journal and the last
+// batch it already contains, so every crash point leaves a consistent pair.
+class DocumentJournal {
+public:
+    static constexpr uint64_t kCompactSize = 64ull << 20;
+    static constexpr std::chrono::milliseconds kCommitInterval{1000};
+
+    DocumentJournal();
+    ~DocumentJournal();
+
+    DocumentJournal(const DocumentJournal&) = delete;
+    DocumentJournal& operator=(const DocumentJournal&) = delete;
+
+    // Apply the journal of basePath to document (just loaded from basePath),
+    // then record its further edits. Starts a new journal if there is none
+    // for this base. Returns false (and logs) on I/O errors.
+    bool Attach(LineDocument& document, const std::string& basePath);
+    // Commit what is pending, finish a running compaction and stop recording
+    void Detach();
+    bool IsAttached() const { return m_Document != nullptr; }
+    const std::string& GetBasePath() const { return m_BasePath; }
+
+    void RecordAdd(LineHandle handle, const LineChunk& chunk, uint32_t slot);
+    void RecordMove(LineHandle handle, const glm::vec2& p0, const glm::vec2& p1);
+    void RecordRemove(LineHandle handle);
+    void RecordRestore(LineHandle handle);
+
+    // Write the pending edits as one batch and wait until it is on disk
+    bool Commit();
+    // Call once per frame: commits every kCommitInterval and runs compaction
+    void Update();
+
+    size_t GetPendingCount() const { return m_Pending.size(); }
+    uint64_t GetSize() const { return m_Size; }
+    uint64_t GetSequence() const { return m_Sequence; }
+    bool IsCompacting() const { return m_Compaction != nullptr; }
+
+private:
+    struct Compaction;
+
+    // Replace the journal file with a header followed by the given batches
+    bool Rewrite(const uint8_t* batches, size_t size);
+    void StartCompaction();
+    void FinishCompaction();
+
+    LineDocument* m_Document = nullptr;
+    std::string m_BasePath;
+    std::string m_Path;
+    FileWriter m_File;
+    uint64_t m_Id = 0;
+    uint64_t m_Sequence = 0;    // last committed batch
+    uint64_t m_Size = 0;        // bytes on disk
+    uint64_t m_CompactSize = kCompactSize;
+    std::vector<JournalRecord> m_Pending;
+    std::chrono::steady_clock::time_point m_LastCommit;
+    std::unique_ptr<Compaction> m_Compaction;
+};
+
+} // namespace EasyLine
@@ -0,0 +1,233 @@
+#include "DocumentLoader.h"
+#include "DxfReader.h"
+#include "ElbFormat.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+namespace EasyLine {
+
+float LoadTask::GetProgress() const {
+    uint64_t total = m_TotalBytes.load(std::memory_order_relaxed);
+    if (total == 0) return IsFinished() ? 1.0f : 0.0f;
+    return std::min(1.0f, (float)((double)m_ParsedBytes.load(std::memory_order_relaxed) / (double)total));
+}
+
+std::string LoadTask::GetError() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Error;
+}
+
+size_t LoadTask::Poll(LineDocument& document) {
+    std::vector<ReadyChunk> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ready.swap(m_Ready);
+    }
+    if (IsCancelRequested()) return 0;
+
+    size_t lines = 0;
+    for (ReadyChunk& r : ready) {
+        lines += r.Chunk->Count - r.Chunk->DeletedCount;
+        document.AppendChunk(std::move(r.Chunk), std::move(r.Tree));
+    }
+    return lines;
+}
+
+void LoadTask::Publish(std::shared_ptr<LineChunk> chunk, std::shared_ptr<ChunkTree> tree) {
+    if (!chunk || chunk->Count == 0 || IsCancelRequested()) return;
+
+    // the index tree is built here on the worker, so the main thread only links it in
+    if (!tree) {
+        tree = std::make_shared<ChunkTree>();
+        SpatialIndex::BuildTree(*chunk, *tree);
+    }
+    m_LineCount.fetch_add(chunk->Count - chunk->DeletedCount, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Ready.push_back({ std::move(chunk), std::move(tree) });
+}
+
+void LoadTask::Finish(LoadState state, const std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Error = error;
+    }
+    m_State.store(state, std::memory_order_release);
+}
+
+void ChunkBuilder::AddLine(const glm::vec2& p0, const glm::vec2& p1, float thickness, uint32_t color) {
+    if (!m_Chunk) m_Chunk = std::make_unique<LineChunk>();
+
+    LineChunk& chunk = *m_Chunk;
+    const uint32_t slot = chunk.Count++;
+    chunk.X0[slot] = p0.x;
+    chunk.Y0[slot] = p0.y;
+    chunk.X1[slot] = p1.x;
+    chunk.Y1[slot] = p1.y;
+    chunk.Thickness[slot] = thickness;
+    chunk.Color[slot] = color;
+    chunk.Bounds.Expand(p0);
+    chunk.Bounds.Expand(p1);
+    chunk.MaxThickness = std::max(chunk.MaxThickness, thickness);
+
+    if (chunk.IsFull()) Flush();
+}
+
+void ChunkBuilder::Flush() {
+    if (!m_Chunk) return;
+    m_Chunk->Version++;
+    m_Task.Publish(std::move(m_Chunk));
+}
+
+// ---------------------------------------------------------------------------
+// Line list text format (.txt): one line per row,
+//     x0 y0 x1 y1 [thickness [RRGGBBAA]]
+// separated by spaces, tabs or commas. Rows starting with '#' are comments.
+// Rows are independent, so the file is cut into slices parsed in parallel.
+
+static constexpr size_t kSliceSize = 1 << 20;
+static const uint32_t kDefaultColor = PackColor({ 1.0f, 1.0f, 1.0f, 1.0f });
+
+static bool IsSeparator(char c) { return c == ' ' || c == '\t' || c == ',' || c == '\r'; }
+
+static const char* SkipSeparators(const char* p, const char* end) {
+    while (p < end && IsSeparator(*p)) p++;
+    return p;
+}
+
+// Returns false if the row is malformed
+static bool ParseRow(const char* p, const char* end, ChunkBuilder& builder) {
+    float v[5] = { 0.0f, 0.0f, 0.0f, 0.0f, kDefaultLineThickness };
+    int count = 0;
+    for (; count < 5; count++) {
+        p = SkipSeparators(p, end);
+        if (p == end || *p == '#') break;
+        auto [next, ec] = std::from_chars(p, end, v[count]);
+        if (ec != std::errc()) break;
+        p = next;
+    }
+    if (count < 4) return false;
+
+    uint32_t color = kDefaultColor;
+    p = SkipSeparators(p, end);
+    if (p < end && *p == '#') p++;
+    if (p < end) {
+        uint32_t rgba = 0;
+        auto [next, ec] = std::from_chars(p, end, rgba, 16);
+        if (ec != std::errc() || next - p != 8) return false;
+        // RRGGBBAA in the file, R in the low byte in memory
+        color = ((rgba >> 24) & 0xff) | ((rgba >> 8) & 0xff00) | ((rgba << 8) & 0xff0000) | (rgba << 24);
+    }
+
+    builder.AddLine({ v[0], v[1] }, { v[2], v[3] }, v[4], color);
+    return true;
+}
+
+static bool ReadLineList(const MappedFile& file, LoadTask& task, std::string& error) {
+    const char* data = (const char*)file.GetData();
+    const size_t size = file.GetSize();
+
+    std::vector<std::pair<size_t, size_t>> slices;
+    for (size_t begin = 0; begin < size;) {
+        size_t end = std::min(size, begin + kSliceSize);
+        while (end < size && data[end - 1] != '\n') end++;
+        slices.push_back({ begin, end });
+        begin = end;
+    }
+
+    std::atomic<uint64_t> malformed{0};
+    JobSystem::ParallelFor(slices.size(), 1, [&](size_t first, size_t last) {
+        for (size_t s = first; s < last && !task.IsCancelRequested(); s++) {
+            ChunkBuilder builder(task);
+            const char* p = data + slices[s].first;
+            const char* end = data + slices[s].second;
+            while (p < end) {
+                const char* eol = std::find(p, end, '\n');
+                const char* row = SkipSeparators(p, eol);
+                if (row < eol && *row != '#' && !ParseRow(row, eol, builder))
+                    malformed.fetch_add(1, std::memory_order_relaxed);
+                p = eol < end ? eol + 1 : end;
+            }
+            builder.Flush();
+            task.AddProgress(slices[s].second - slices[s].first);
+        }
+    });
+
+    if (malformed.load() > 0)
+        EL_CORE_WARN("{}: skipped {} malformed rows", file.GetPath(), malformed.load());
+    if (malformed.load() > 0 && task.GetLineCount() == 0) {
+        error = "No valid rows (expected: x0 y0 x1 y1 [thickness [RRGGBBAA]])";
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+
+struct ReaderEntry {
+    const char* Extension;
+    DocumentReaderFn Read;
+};
+
+static const ReaderEntry s_Readers[] = {
+    { ".txt", ReadLineList },
+    { ".dxf", ReadDxf },
+    { ".elb", ReadElb },
+    { ".elbz", ReadElb },
+};
+
+static DocumentReaderFn FindReader(const std::string& path) {
+    std::string lower = path;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    for (const ReaderEntry& entry : s_Readers) {
+        size_t n = std::char_traits<char>::length(entry.Extension);
+        if (lower.size() >= n && lower.compare(lower.size() - n, n, entry.Extension) == 0)
+            return entry.Read;
+    }
+    return nullptr;
+}
+
+bool DocumentLoader::IsSupported(const std::string& path) {
+    return FindReader(path) != nullptr;
+}
+
+std::shared_ptr<LoadTask> DocumentLoader::LoadAsync(const std::string& path) {
+    auto task = std::make_shared<LoadTask>(path);
+
+    DocumentReaderFn reader = FindReader(path);
+    if (!reader) {
+        EL_CORE_ERROR("No reader for file: {}", path);
+        task->Finish(LoadState::Failed, "Unsupported file type");
+        return task;
+    }
+
+    EL_CORE_INFO("Loading {}", path);
+    JobSystem::Run([task, reader] {
+        auto file = std::make_shared<MappedFile>();
+        if (!file->Open(task->GetPath())) {
+            task->Finish(LoadState::Failed, "Cannot open file");
+            return;
+        }
+        task->SetTotalBytes(file->GetSize());
+
+        std::string error;
+        bool ok = reader(*file, *task, error);
+        if (task->IsCancelRequested()) {
+            EL_CORE_INFO("Loading {} cancelled", task->GetPath());
+            task->Finish(LoadState::Cancelled);
+        } else if (!ok) {
+            EL_CORE_ERROR("Loading {} failed: {}", task->GetPath(), error);
+            task->Finish(LoadState::Failed, error);
+        } else {
+            EL_CORE_INFO("Loaded {} ({} lines)", task->GetPath(), task->GetLineCount());
+            task->Finish(LoadState::Completed);
+        }
+    });
+    return task;
+}
+
+} // namespace EasyLine
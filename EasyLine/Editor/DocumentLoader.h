@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "LineDocument.h"
+
+namespace EasyLine {
+
+class MappedFile;
+
+// Line width given to imported lines that do not carry one
+constexpr float kDefaultLineThickness = 0.01f;
+
+enum class LoadState { Loading, Completed, Cancelled, Failed };
+
+// Shared state of one background load. Readers parse the file on worker
+// threads and publish finished chunks, with their index trees already built;
+// the main thread moves them into the document with Poll() every frame, so the
+// drawing fills in while the user keeps panning around.
+class LoadTask {
+public:
+    explicit LoadTask(std::string path) : m_Path(std::move(path)) {}
+
+    const std::string& GetPath() const { return m_Path; }
+    LoadState GetState() const { return m_State.load(std::memory_order_acquire); }
+    bool IsFinished() const { return GetState() != LoadState::Loading; }
+    // Fraction of the file parsed so far, 0..1
+    float GetProgress() const;
+    uint64_t GetLineCount() const { return m_LineCount.load(std::memory_order_relaxed); }
+    std::string GetError() const;
+
+    // Stop as soon as possible. Chunks not yet handed to the document are dropped.
+    void Cancel() { m_CancelRequested.store(true, std::memory_order_release); }
+    bool IsCancelRequested() const { return m_CancelRequested.load(std::memory_order_acquire); }
+
+    // Main thread: append the chunks finished since the last call. Returns the number of lines added.
+    size_t Poll(LineDocument& document);
+
+    // Reader side, called from worker threads
+    void SetTotalBytes(uint64_t bytes) { m_TotalBytes.store(bytes, std::memory_order_relaxed); }
+    void AddProgress(uint64_t bytes) { m_ParsedBytes.fetch_add(bytes, std::memory_order_relaxed); }
+    // Hand a finished chunk to the document; its index tree is built here unless one is given
+    void Publish(std::shared_ptr<LineChunk> chunk, std::shared_ptr<ChunkTree> tree = nullptr);
+    void Finish(LoadState state, const std::string& error = {});
+
+private:
+    struct ReadyChunk {
+        std::shared_ptr<LineChunk> Chunk;
+        std::shared_ptr<ChunkTree> Tree;
+    };
+
+    std::string m_Path;
+    std::atomic<LoadState> m_State{LoadState::Loading};
+    std::atomic<bool> m_CancelRequested{false};
+    std::atomic<uint64_t> m_TotalBytes{0};
+    std::atomic<uint64_t> m_ParsedBytes{0};
+    std::atomic<uint64_t> m_LineCount{0};
+
+    mutable std::mutex m_Mutex;     // guards m_Ready and m_Error
+    std::vector<ReadyChunk> m_Ready;
+    std::string m_Error;
+};
+
+// Packs lines coming out of a reader into chunks and publishes each full one.
+// One builder per thread; whatever is left is published by Flush() or the destructor.
+class ChunkBuilder {
+public:
+    explicit ChunkBuilder(LoadTask& task) : m_Task(task) {}
+    ~ChunkBuilder() { Flush(); }
+
+    void AddLine(const glm::vec2& p0, const glm::vec2& p1, float thickness, uint32_t color);
+    void Flush();
+
+private:
+    LoadTask& m_Task;
+    std::unique_ptr<LineChunk> m_Chunk;
+};
+
+// Parses the whole mapped file into task. Returns false and sets error on malformed input.
+using DocumentReaderFn = bool (*)(const MappedFile& file, LoadTask& task, std::string& error);
+
+class DocumentLoader {
+public:
+    // Start loading path on the job system; the reader is picked by file extension.
+    static std::shared_ptr<LoadTask> LoadAsync(const std::string& path);
+    static bool IsSupported(const std::string& path);
+};
+
+} // namespace EasyLine
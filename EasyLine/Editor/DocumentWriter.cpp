@@ -0,0 +1,85 @@
+#include "DocumentWriter.h"
+#include "DxfWriter.h"
+#include "ElbFormat.h"
+#include "FileWriter.h"
+#include "LineDocument.h"
+#include "Log.h"
+#include "PdfWriter.h"
+#include "SvgWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+
+namespace EasyLine {
+
+struct WriterEntry {
+    const char* Extension;
+    DocumentWriterFn Write;
+    DocumentRegionWriterFn WriteRegion;
+};
+
+static const WriterEntry s_Writers[] = {
+    { ".dxf", WriteDxf, nullptr },
+    { ".elb", WriteElb, nullptr },
+    { ".elbz", WriteElbCompressed, nullptr },
+    { ".svg", WriteSvg, WriteSvg },
+    { ".pdf", WritePdf, WritePdf },
+};
+
+static const WriterEntry* FindWriter(const std::string& path) {
+    std::string lower = path;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    for (const WriterEntry& entry : s_Writers) {
+        size_t n = std::char_traits<char>::length(entry.Extension);
+        if (lower.size() >= n && lower.compare(lower.size() - n, n, entry.Extension) == 0)
+            return &entry;
+    }
+    return nullptr;
+}
+
+bool DocumentWriter::IsSupported(const std::string& path) {
+    return FindWriter(path) != nullptr;
+}
+
+bool DocumentWriter::SupportsRegion(const std::string& path) {
+    const WriterEntry* entry = FindWriter(path);
+    return entry && entry->WriteRegion;
+}
+
+template<typename Fn>
+static bool SaveWith(const LineDocument& document, const std::string& path, Fn&& write) {
+    auto start = std::chrono::steady_clock::now();
+    FileWriter out;
+    if (!out.Open(path)) return false;
+    if (!write(out)) {
+        out.Discard();
+        EL_CORE_ERROR("Saving {} failed", path);
+        return false;
+    }
+    const uint64_t bytes = out.GetBytesWritten();
+    if (!out.Close()) return false;
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EL_CORE_INFO("Saved {} ({} lines, {:.1f} MB in {:.0f} ms)", path, document.GetLineCount(), bytes / 1e6, ms);
+    return true;
+}
+
+bool DocumentWriter::Save(const LineDocument& document, const std::string& path) {
+    const WriterEntry* entry = FindWriter(path);
+    if (!entry) {
+        EL_CORE_ERROR("No writer for file: {}", path);
+        return false;
+    }
+    return SaveWith(document, path, [&](FileWriter& out) { return entry->Write(document, out); });
+}
+
+bool DocumentWriter::Save(const LineDocument& document, const std::string& path, const AABB& region) {
+    const WriterEntry* entry = FindWriter(path);
+    if (!entry || !entry->WriteRegion) {
+        EL_CORE_ERROR("No region writer for file: {}", path);
+        return false;
+    }
+    return SaveWith(document, path, [&](FileWriter& out) { return entry->WriteRegion(document, region, out); });
+}
+
+} // namespace EasyLine
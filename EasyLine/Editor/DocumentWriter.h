@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+namespace EasyLine {
+
+class FileWriter;
+class LineDocument;
+struct AABB;
+
+// Formats the whole document into out. Returns false if writing failed.
+using DocumentWriterFn = bool (*)(const LineDocument& document, FileWriter& out);
+// Formats the lines overlapping region (vector exports of the view)
+using DocumentRegionWriterFn = bool (*)(const LineDocument& document, const AABB& region, FileWriter& out);
+
+class DocumentWriter {
+public:
+    // Save the document to path; the format is picked by file extension.
+    // The previous file is only replaced once the new one is completely written.
+    static bool Save(const LineDocument& document, const std::string& path);
+    // Save only the part of the document inside region, for formats that support it
+    static bool Save(const LineDocument& document, const std::string& path, const AABB& region);
+    static bool IsSupported(const std::string& path);
+    static bool SupportsRegion(const std::string& path);
+};
+
+} // namespace EasyLine
@@ -0,0 +1,849 @@
+#include "DxfReader.h"
+#include "DocumentLoader.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace EasyLine {
+
+namespace {
+
+constexpr size_t kSliceSize = 8 << 20;
+constexpr size_t kProgressStep = 1 << 20;
+constexpr int kArcSegmentsPerTurn = 64;
+constexpr int kMaxBlockDepth = 16;
+constexpr double kPi = 3.14159265358979323846;
+constexpr char kBinarySentinel[] = "AutoCAD Binary DXF\r\n\x1a";  // followed by a NUL byte
+constexpr size_t kBinarySentinelSize = sizeof(kBinarySentinel);  // includes that NUL
+
+const uint32_t kWhite = PackColor({ 1.0f, 1.0f, 1.0f, 1.0f });
+
+std::string_view Trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\r')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+} // namespace
+
+// AutoCAD Color Index: 1-9 fixed, 10-249 a 24-hue HSV wheel (5 values x full/half
+// saturation), 250-255 grays
+uint32_t GetAciColor(int index) {
+    static const uint8_t kBasic[10][3] = {
+        { 0, 0, 0 }, { 255, 0, 0 }, { 255, 255, 0 }, { 0, 255, 0 }, { 0, 255, 255 },
+        { 0, 0, 255 }, { 255, 0, 255 }, { 255, 255, 255 }, { 128, 128, 128 }, { 192, 192, 192 },
+    };
+    static const uint8_t kGrays[6] = { 51, 91, 132, 173, 214, 255 };
+    static const float kValues[5] = { 255.0f, 204.0f, 153.0f, 127.0f, 76.0f };
+
+    uint8_t rgb[3];
+    if (index <= 0 || index > 255) {
+        return kWhite;
+    } else if (index < 10) {
+        std::memcpy(rgb, kBasic[index], 3);
+    } else if (index >= 250) {
+        rgb[0] = rgb[1] = rgb[2] = kGrays[index - 250];
+    } else {
+        const int k = (index - 10) % 10;
+        const float hue = (float)((index - 10) / 10) * 15.0f;
+        const float v = kValues[k / 2];
+        const float c = v * ((k & 1) ? 0.5f : 1.0f);
+        const float x = c * (1.0f - std::fabs(std::fmod(hue / 60.0f, 2.0f) - 1.0f));
+        const float m = v - c;
+        float r = 0, g = 0, b = 0;
+        switch ((int)(hue / 60.0f)) {
+        case 0: r = c; g = x; break;
+        case 1: r = x; g = c; break;
+        case 2: g = c; b = x; break;
+        case 3: g = x; b = c; break;
+        case 4: r = x; b = c; break;
+        default: r = c; b = x; break;
+        }
+        rgb[0] = (uint8_t)(r + m);
+        rgb[1] = (uint8_t)(g + m);
+        rgb[2] = (uint8_t)(b + m);
+    }
+    return rgb[0] | (rgb[1] << 8) | (rgb[2] << 16) | 0xff000000u;
+}
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Tokenizer
+
+struct DxfToken {
+    int Code = -1;
+    std::string_view Text;  // ASCII: the value line; binary: string and byte-chunk values
+    double Number = 0.0;    // binary: numeric values
+    bool Binary = false;
+
+    std::string_view AsString() const { return Trim(Text); }
+
+    double AsDouble() const {
+        if (Binary) return Number;
+        std::string_view s = Trim(Text);
+        if (!s.empty() && s.front() == '+') s.remove_prefix(1);
+        double value = 0.0;
+        std::from_chars(s.data(), s.data() + s.size(), value);
+        return value;
+    }
+
+    int64_t AsInt() const {
+        if (Binary) return (int64_t)Number;
+        std::string_view s = Trim(Text);
+        if (!s.empty() && s.front() == '+') s.remove_prefix(1);
+        int64_t value = 0;
+        std::from_chars(s.data(), s.data() + s.size(), value);
+        return value;
+    }
+};
+
+enum class BinaryKind { String, Double, Int16, Int32, Int64, Bool, Bytes };
+
+// Value encoding of a group code in binary DXF
+BinaryKind GetBinaryKind(int code) {
+    if (code >= 10 && code <= 59) return BinaryKind::Double;
+    if (code >= 60 && code <= 79) return BinaryKind::Int16;
+    if (code >= 90 && code <= 99) return BinaryKind::Int32;
+    if (code >= 110 && code <= 149) return BinaryKind::Double;
+    if (code >= 160 && code <= 169) return BinaryKind::Int64;
+    if (code >= 170 && code <= 179) return BinaryKind::Int16;
+    if (code >= 210 && code <= 239) return BinaryKind::Double;
+    if (code >= 270 && code <= 289) return BinaryKind::Int16;
+    if (code >= 290 && code <= 299) return BinaryKind::Bool;
+    if (code >= 310 && code <= 319) return BinaryKind::Bytes;
+    if (code >= 370 && code <= 389) return BinaryKind::Int16;
+    if (code >= 400 && code <= 409) return BinaryKind::Int16;
+    if (code >= 420 && code <= 429) return BinaryKind::Int32;
+    if (code >= 440 && code <= 459) return BinaryKind::Int32;
+    if (code >= 460 && code <= 469) return BinaryKind::Double;
+    if (code == 1004) return BinaryKind::Bytes;
+    if (code >= 1010 && code <= 1059) return BinaryKind::Double;
+    if (code >= 1060 && code <= 1070) return BinaryKind::Int16;
+    if (code == 1071) return BinaryKind::Int32;
+    return BinaryKind::String;
+}
+
+template<typename T>
+T ReadLittleEndian(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+class DxfTokenizer {
+public:
+    DxfTokenizer(const char* begin, const char* end, bool binary)
+        : m_Pos(begin), m_End(end), m_Binary(binary) {}
+
+    bool Next(DxfToken& token) { return m_Binary ? NextBinary(token) : NextAscii(token); }
+
+    const char* GetPosition() const { return m_Pos; }
+    bool HasError() const { return m_Error; }
+
+private:
+    const char* ReadLine(std::string_view& line) {
+        const char* eol = (const char*)std::memchr(m_Pos, '\n', (size_t)(m_End - m_Pos));
+        const char* lineEnd = eol ? eol : m_End;
+        line = std::string_view(m_Pos, (size_t)(lineEnd - m_Pos));
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        return eol ? eol + 1 : m_End;
+    }
+
+    bool NextAscii(DxfToken& token) {
+        std::string_view codeLine;
+        do {
+            if (m_Pos >= m_End) return false;
+            m_Pos = ReadLine(codeLine);
+            codeLine = Trim(codeLine);
+        } while (codeLine.empty());
+
+        int code = 0;
+        auto [ptr, ec] = std::from_chars(codeLine.data(), codeLine.data() + codeLine.size(), code);
+        if (ec != std::errc() || ptr != codeLine.data() + codeLine.size()) {
+            m_Error = true;
+            return false;
+        }
+
+        token.Code = code;
+        token.Binary = false;
+        token.Text = {};
+        if (m_Pos < m_End) m_Pos = ReadLine(token.Text);
+        return true;
+    }
+
+    bool NextBinary(DxfToken& token) {
+        if (m_End - m_Pos < 2) return false;
+        token.Code = ReadLittleEndian<uint16_t>(m_Pos);
+        token.Binary = true;
+        token.Text = {};
+        token.Number = 0.0;
+        m_Pos += 2;
+
+        size_t size = 0;
+        switch (GetBinaryKind(token.Code)) {
+        case BinaryKind::String: {
+            const char* nul = (const char*)std::memchr(m_Pos, 0, (size_t)(m_End - m_Pos));
+            if (!nul) { m_Error = true; return false; }
+            token.Text = std::string_view(m_Pos, (size_t)(nul - m_Pos));
+            m_Pos = nul + 1;
+            return true;
+        }
+        case BinaryKind::Bytes:
+            if (m_Pos >= m_End) { m_Error = true; return false; }
+            size = (uint8_t)*m_Pos++;
+            if ((size_t)(m_End - m_Pos) < size) { m_Error = true; return false; }
+            token.Text = std::string_view(m_Pos, size);
+            m_Pos += size;
+            return true;
+        case BinaryKind::Double: size = 8; break;
+        case BinaryKind::Int64: size = 8; break;
+        case BinaryKind::Int32: size = 4; break;
+        case BinaryKind::Int16: size = 2; break;
+        case BinaryKind::Bool: size = 1; break;
+        }
+        if ((size_t)(m_End - m_Pos) < size) { m_Error = true; return false; }
+
+        switch (GetBinaryKind(token.Code)) {
+        case BinaryKind::Double: token.Number = ReadLittleEndian<double>(m_Pos); break;
+        case BinaryKind::Int64: token.Number = (double)ReadLittleEndian<int64_t>(m_Pos); break;
+        case BinaryKind::Int32: token.Number = ReadLittleEndian<int32_t>(m_Pos); break;
+        case BinaryKind::Int16: token.Number = ReadLittleEndian<int16_t>(m_Pos); break;
+        default: token.Number = (uint8_t)*m_Pos; break;
+        }
+        m_Pos += size;
+        return true;
+    }
+
+    const char* m_Pos;
+    const char* m_End;
+    bool m_Binary;
+    bool m_Error = false;
+};
+
+// ---------------------------------------------------------------------------
+// Blocks and geometry targets
+
+struct Affine {
+    double M00 = 1.0, M01 = 0.0, M10 = 0.0, M11 = 1.0, Tx = 0.0, Ty = 0.0;
+
+    glm::dvec2 Apply(double x, double y) const { return { M00 * x + M01 * y + Tx, M10 * x + M11 * y + Ty }; }
+
+    // this after other
+    Affine operator*(const Affine& o) const {
+        return { M00 * o.M00 + M01 * o.M10, M00 * o.M01 + M01 * o.M11,
+                 M10 * o.M00 + M11 * o.M10, M10 * o.M01 + M11 * o.M11,
+                 M00 * o.Tx + M01 * o.Ty + Tx, M10 * o.Tx + M11 * o.Ty + Ty };
+    }
+
+    static Affine Translate(double x, double y) { return { 1.0, 0.0, 0.0, 1.0, x, y }; }
+    static Affine Scale(double sx, double sy) { return { sx, 0.0, 0.0, sy, 0.0, 0.0 }; }
+    static Affine Rotate(double radians) {
+        double c = std::cos(radians), s = std::sin(radians);
+        return { c, -s, s, c, 0.0, 0.0 };
+    }
+};
+
+struct InsertRef {
+    std::string_view Block;
+    double X = 0.0, Y = 0.0;
+    double ScaleX = 1.0, ScaleY = 1.0;
+    double Rotation = 0.0;      // degrees
+    int Columns = 1, Rows = 1;
+    double ColumnSpacing = 0.0, RowSpacing = 0.0;
+    bool Mirrored = false;      // extrusion (0,0,-1): OCS x axis points along -X
+    uint32_t Color = 0;
+    bool ByBlock = false;
+};
+
+struct BlockSegment {
+    double X0, Y0, X1, Y1;
+    uint32_t Color;
+    bool ByBlock;
+};
+
+struct DxfBlock {
+    double BaseX = 0.0, BaseY = 0.0;
+    std::vector<BlockSegment> Segments;
+    std::vector<InsertRef> Inserts;
+};
+
+// Layer colors and block definitions, read before ENTITIES and shared
+// read-only by the entity slices. Keys point into the mapped file.
+struct DxfTables {
+    std::unordered_map<std::string_view, uint32_t> LayerColors;
+    std::unordered_map<std::string_view, DxfBlock> Blocks;
+};
+
+class DxfTarget {
+public:
+    virtual ~DxfTarget() = default;
+    virtual void Segment(double x0, double y0, double x1, double y1, uint32_t color, bool byBlock) = 0;
+    virtual void Insert(const InsertRef& insert) = 0;
+};
+
+class BlockTarget : public DxfTarget {
+public:
+    void SetBlock(DxfBlock* block) { m_Block = block; }
+
+    void Segment(double x0, double y0, double x1, double y1, uint32_t color, bool byBlock) override {
+        m_Block->Segments.push_back({ x0, y0, x1, y1, color, byBlock });
+    }
+    void Insert(const InsertRef& insert) override { m_Block->Inserts.push_back(insert); }
+
+private:
+    DxfBlock* m_Block = nullptr;
+};
+
+// Model space: lines go straight into the chunk builder, inserts are expanded
+class DocumentTarget : public DxfTarget {
+public:
+    DocumentTarget(const DxfTables& tables, ChunkBuilder& builder) : m_Tables(tables), m_Builder(builder) {}
+
+    void Segment(double x0, double y0, double x1, double y1, uint32_t color, bool byBlock) override {
+        m_Builder.AddLine({ (float)x0, (float)y0 }, { (float)x1, (float)y1 }, kDefaultLineThickness, byBlock ? kWhite : color);
+    }
+
+    void Insert(const InsertRef& insert) override { Expand(insert, Affine(), kWhite, 0); }
+
+private:
+    void Expand(const InsertRef& insert, const Affine& parent, uint32_t inheritedColor, int depth) {
+        if (depth > kMaxBlockDepth) return;
+        auto it = m_Tables.Blocks.find(insert.Block);
+        if (it == m_Tables.Blocks.end()) return;
+        const DxfBlock& block = it->second;
+
+        const uint32_t color = insert.ByBlock ? inheritedColor : insert.Color;
+        const double angle = insert.Rotation * kPi / 180.0;
+        const Affine rotation = Affine::Rotate(angle);
+        const Affine local = rotation * Affine::Scale(insert.ScaleX, insert.ScaleY) * Affine::Translate(-block.BaseX, -block.BaseY);
+        const Affine mirror = insert.Mirrored ? Affine::Scale(-1.0, 1.0) : Affine();
+
+        for (int row = 0; row < std::max(1, insert.Rows); row++) {
+            for (int col = 0; col < std::max(1, insert.Columns); col++) {
+                glm::dvec2 offset = rotation.Apply(col * insert.ColumnSpacing, row * insert.RowSpacing);
+                const Affine t = parent * mirror * Affine::Translate(insert.X + offset.x, insert.Y + offset.y) * local;
+
+                for (const BlockSegment& s : block.Segments) {
+                    glm::dvec2 p0 = t.Apply(s.X0, s.Y0), p1 = t.Apply(s.X1, s.Y1);
+                    m_Builder.AddLine({ (float)p0.x, (float)p0.y }, { (float)p1.x, (float)p1.y }, kDefaultLineThickness,
+                        s.ByBlock ? color : s.Color);
+                }
+                for (const InsertRef& child : block.Inserts)
+                    Expand(child, t, color, depth + 1);
+            }
+        }
+    }
+
+    const DxfTables& m_Tables;
+    ChunkBuilder& m_Builder;
+};
+
+// ---------------------------------------------------------------------------
+// Entities
+
+enum class EntityKind { None, Line, LwPolyline, Polyline, Vertex, SeqEnd, Arc, Circle, Insert, Dimension, Other };
+
+EntityKind GetEntityKind(std::string_view name) {
+    if (name == "LINE") return EntityKind::Line;
+    if (name == "LWPOLYLINE") return EntityKind::LwPolyline;
+    if (name == "POLYLINE") return EntityKind::Polyline;
+    if (name == "VERTEX") return EntityKind::Vertex;
+    if (name == "SEQEND") return EntityKind::SeqEnd;
+    if (name == "ARC") return EntityKind::Arc;
+    if (name == "CIRCLE") return EntityKind::Circle;
+    if (name == "INSERT") return EntityKind::Insert;
+    if (name == "DIMENSION") return EntityKind::Dimension;
+    return EntityKind::Other;
+}
+
+struct PolyVertex {
+    double X, Y, Bulge;
+};
+
+// Collects the group codes of one entity at a time and flattens it into the
+// target when the next group code 0 arrives.
+class EntityParser {
+public:
+    explicit EntityParser(const DxfTables& tables) : m_Tables(tables) {}
+
+    void SetTarget(DxfTarget* target) { m_Target = target; }
+
+    void Feed(const DxfToken& token) {
+        if (token.Code == 0) {
+            End();
+            Begin(GetEntityKind(token.AsString()));
+            return;
+        }
+        if (m_Kind == EntityKind::None || m_Kind == EntityKind::Other) return;
+
+        switch (token.Code) {
+        case 2: m_Block = token.AsString(); break;
+        case 8: m_Layer = token.AsString(); break;
+        case 10:
+            if (m_Kind == EntityKind::LwPolyline) m_Vertices.push_back({ token.AsDouble(), 0.0, 0.0 });
+            else m_X[0] = token.AsDouble();
+            break;
+        case 20:
+            if (m_Kind == EntityKind::LwPolyline) { if (!m_Vertices.empty()) m_Vertices.back().Y = token.AsDouble(); }
+            else m_Y[0] = token.AsDouble();
+            break;
+        case 11: m_X[1] = token.AsDouble(); break;
+        case 21: m_Y[1] = token.AsDouble(); break;
+        case 40: m_Radius = token.AsDouble(); break;
+        case 41: m_ScaleX = token.AsDouble(); break;
+        case 42:
+            if (m_Kind == EntityKind::LwPolyline) { if (!m_Vertices.empty()) m_Vertices.back().Bulge = token.AsDouble(); }
+            else if (m_Kind == EntityKind::Vertex) m_Bulge = token.AsDouble();
+            else m_ScaleY = token.AsDouble();
+            break;
+        case 44: m_ColumnSpacing = token.AsDouble(); break;
+        case 45: m_RowSpacing = token.AsDouble(); break;
+        case 50: m_Angle0 = token.AsDouble(); break;
+        case 51: m_Angle1 = token.AsDouble(); break;
+        case 62: m_ColorIndex = (int)token.AsInt(); break;
+        case 70: m_Flags = (int)token.AsInt(); break;
+        case 71: m_Rows = (int)token.AsInt(); break;
+        case 230: m_ExtrusionZ = token.AsDouble(); break;
+        case 420: m_TrueColor = token.AsInt(); break;
+        default: break;
+        }
+    }
+
+    // End the pending entity (and an unterminated POLYLINE)
+    void Finish() {
+        End();
+        m_Kind = EntityKind::None;
+        if (m_InPolyline) EndPolyline();
+    }
+
+private:
+    void Begin(EntityKind kind) {
+        if (m_InPolyline && kind != EntityKind::Vertex && kind != EntityKind::SeqEnd)
+            EndPolyline();
+
+        m_Kind = kind;
+        m_Layer = {};
+        m_Block = {};
+        m_X[0] = m_Y[0] = m_X[1] = m_Y[1] = 0.0;
+        m_Radius = m_Angle0 = m_Angle1 = m_Bulge = 0.0;
+        m_ScaleX = m_ScaleY = 1.0;
+        m_ColumnSpacing = m_RowSpacing = 0.0;
+        m_ExtrusionZ = 1.0;
+        m_Flags = 0;
+        m_Rows = 1;
+        m_ColorIndex = 256;
+        m_TrueColor = -1;
+        m_Vertices.clear();
+    }
+
+    void End() {
+        if (!m_Target) return;
+        bool byBlock = false;
+
+        switch (m_Kind) {
+        case EntityKind::Line: {
+            uint32_t color = ResolveColor(byBlock);
+            m_Target->Segment(m_X[0], m_Y[0], m_X[1], m_Y[1], color, byBlock);
+            break;
+        }
+        case EntityKind::Arc:
+        case EntityKind::Circle: {
+            uint32_t color = ResolveColor(byBlock);
+            double start = m_Kind == EntityKind::Circle ? 0.0 : m_Angle0 * kPi / 180.0;
+            double sweep = 2.0 * kPi;
+            if (m_Kind == EntityKind::Arc) {
+                double end = m_Angle1 * kPi / 180.0;
+                sweep = std::fmod(end - start, 2.0 * kPi);
+                if (sweep <= 0.0) sweep += 2.0 * kPi;
+            }
+            EmitArc(m_X[0], m_Y[0], m_Radius, start, sweep, m_ExtrusionZ < 0.0, color, byBlock);
+            break;
+        }
+        case EntityKind::LwPolyline: {
+            uint32_t color = ResolveColor(byBlock);
+            EmitPolyline(m_Vertices, (m_Flags & 1) != 0, m_ExtrusionZ < 0.0, color, byBlock);
+            break;
+        }
+        case EntityKind::Polyline:
+            // geometry follows as VERTEX entities; polygon/polyface meshes are skipped
+            m_InPolyline = true;
+            m_PolylineSkip = (m_Flags & (16 | 64)) != 0;
+            m_PolylineClosed = (m_Flags & 1) != 0;
+            m_PolylineMirrored = m_ExtrusionZ < 0.0;
+            m_PolylineColor = ResolveColor(m_PolylineByBlock);
+            m_PolylineVertices.clear();
+            break;
+        case EntityKind::Vertex:
+            if (m_InPolyline && !m_PolylineSkip)
+                m_PolylineVertices.push_back({ m_X[0], m_Y[0], m_Bulge });
+            break;
+        case EntityKind::SeqEnd:
+            if (m_InPolyline) EndPolyline();
+            break;
+        case EntityKind::Insert: {
+            InsertRef insert;
+            insert.Block = m_Block;
+            insert.X = m_X[0];
+            insert.Y = m_Y[0];
+            insert.ScaleX = m_ScaleX;
+            insert.ScaleY = m_ScaleY;
+            insert.Rotation = m_Angle0;
+            insert.Columns = std::max(1, m_Flags);  // group 70 is the column count on INSERT
+            insert.Rows = std::max(1, m_Rows);
+            insert.ColumnSpacing = m_ColumnSpacing;
+            insert.RowSpacing = m_RowSpacing;
+            insert.Mirrored = m_ExtrusionZ < 0.0;
+            insert.Color = ResolveColor(insert.ByBlock);
+            m_Target->Insert(insert);
+            break;
+        }
+        case EntityKind::Dimension: {
+            // the dimension's lines, arrows and text live in an anonymous block in world coordinates
+            InsertRef insert;
+            insert.Block = m_Block;
+            insert.Color = ResolveColor(insert.ByBlock);
+            if (!insert.Block.empty()) m_Target->Insert(insert);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    void EndPolyline() {
+        if (!m_PolylineSkip && m_Target)
+            EmitPolyline(m_PolylineVertices, m_PolylineClosed, m_PolylineMirrored, m_PolylineColor, m_PolylineByBlock);
+        m_InPolyline = false;
+        m_PolylineVertices.clear();
+    }
+
+    uint32_t ResolveColor(bool& byBlock) const {
+        byBlock = false;
+        if (m_TrueColor >= 0) {
+            uint32_t rgb = (uint32_t)m_TrueColor;
+            return ((rgb >> 16) & 0xff) | (rgb & 0xff00) | ((rgb & 0xff) << 16) | 0xff000000u;
+        }
+        if (m_ColorIndex == 0) {
+            byBlock = true;
+            return kWhite;
+        }
+        if (m_ColorIndex == 256) {
+            auto it = m_Tables.LayerColors.find(m_Layer);
+            return it != m_Tables.LayerColors.end() ? it->second : kWhite;
+        }
+        return GetAciColor(std::abs(m_ColorIndex));
+    }
+
+    void Emit(double x0, double y0, double x1, double y1, bool mirrored, uint32_t color, bool byBlock) {
+        if (mirrored) { x0 = -x0; x1 = -x1; }
+        m_Target->Segment(x0, y0, x1, y1, color, byBlock);
+    }
+
+    void EmitArc(double cx, double cy, double radius, double start, double sweep, bool mirrored, uint32_t color, bool byBlock) {
+        const int segments = std::max(1, (int)std::ceil(std::fabs(sweep) / (2.0 * kPi) * kArcSegmentsPerTurn));
+        double px = cx + radius * std::cos(start), py = cy + radius * std::sin(start);
+        for (int i = 1; i <= segments; i++) {
+            double a = start + sweep * (double)i / segments;
+            double x = cx + radius * std::cos(a), y = cy + radius * std::sin(a);
+            Emit(px, py, x, y, mirrored, color, byBlock);
+            px = x;
+            py = y;
+        }
+    }
+
+    // Straight segment, or an arc when bulge (tan of a quarter of the sweep) is non-zero
+    void EmitBulge(const PolyVertex& a, const PolyVertex& b, bool mirrored, uint32_t color, bool byBlock) {
+        const double dx = b.X - a.X, dy = b.Y - a.Y;
+        const double chord = std::sqrt(dx * dx + dy * dy);
+        if (a.Bulge == 0.0 || chord == 0.0) {
+            Emit(a.X, a.Y, b.X, b.Y, mirrored, color, byBlock);
+            return;
+        }
+        const double sweep = 4.0 * std::atan(a.Bulge);
+        const double h = 0.5 * chord / std::tan(0.5 * sweep);   // signed distance from chord midpoint to center
+        const double cx = 0.5 * (a.X + b.X) - dy / chord * h;
+        const double cy = 0.5 * (a.Y + b.Y) + dx / chord * h;
+        const double radius = std::sqrt((a.X - cx) * (a.X - cx) + (a.Y - cy) * (a.Y - cy));
+        EmitArc(cx, cy, radius, std::atan2(a.Y - cy, a.X - cx), sweep, mirrored, color, byBlock);
+    }
+
+    void EmitPolyline(const std::vector<PolyVertex>& vertices, bool closed, bool mirrored, uint32_t color, bool byBlock) {
+        const size_t n = vertices.size();
+        if (n < 2) return;
+        for (size_t i = 0; i + 1 < n; i++)
+            EmitBulge(vertices[i], vertices[i + 1], mirrored, color, byBlock);
+        if (closed)
+            EmitBulge(vertices[n - 1], vertices[0], mirrored, color, byBlock);
+    }
+
+    const DxfTables& m_Tables;
+    DxfTarget* m_Target = nullptr;
+
+    EntityKind m_Kind = EntityKind::None;
+    std::string_view m_Layer, m_Block;
+    double m_X[2] = {}, m_Y[2] = {};
+    double m_Radius = 0.0, m_Angle0 = 0.0, m_Angle1 = 0.0, m_Bulge = 0.0;
+    double m_ScaleX = 1.0, m_ScaleY = 1.0;
+    double m_ColumnSpacing = 0.0, m_RowSpacing = 0.0;
+    double m_ExtrusionZ = 1.0;
+    int m_Flags = 0, m_Rows = 1;
+    int m_ColorIndex = 256;
+    int64_t m_TrueColor = -1;
+    std::vector<PolyVertex> m_Vertices;     // LWPOLYLINE, capacity reused across entities
+
+    bool m_InPolyline = false;              // POLYLINE seen, collecting VERTEX until SEQEND
+    bool m_PolylineSkip = false;
+    bool m_PolylineClosed = false;
+    bool m_PolylineMirrored = false;
+    bool m_PolylineByBlock = false;
+    uint32_t m_PolylineColor = 0;
+    std::vector<PolyVertex> m_PolylineVertices;
+};
+
+// ---------------------------------------------------------------------------
+// ASCII entity slicing
+
+bool IsCodeZero(std::string_view line) { return Trim(line) == "0"; }
+
+// Start of the line after p (or end)
+const char* NextLineStart(const char* p, const char* end) {
+    const char* eol = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+    return eol ? eol + 1 : end;
+}
+
+std::string_view LineAt(const char* p, const char* end) {
+    const char* eol = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+    return std::string_view(p, (size_t)((eol ? eol : end) - p));
+}
+
+// A "0" line followed by a line starting with a letter is always a group code
+// 0 and its entity name: a value line is always followed by a numeric code
+// line. Cuts never separate a POLYLINE or INSERT from its VERTEX/ATTRIB/SEQEND.
+const char* FindEntityStart(const char* p, const char* end) {
+    while (p < end) {
+        const char* next = NextLineStart(p, end);
+        if (next < end && IsCodeZero(LineAt(p, end))) {
+            std::string_view name = Trim(LineAt(next, end));
+            if (!name.empty() && ((name[0] >= 'A' && name[0] <= 'Z') || (name[0] >= 'a' && name[0] <= 'z')) &&
+                name != "VERTEX" && name != "SEQEND" && name != "ATTRIB")
+                return p;
+        }
+        p = next;
+    }
+    return end;
+}
+
+// The "0 / ENDSEC" pair closing the section that starts at begin
+const char* FindSectionEnd(const char* begin, const char* end) {
+    std::string_view text(begin, (size_t)(end - begin));
+    for (size_t pos = text.find("ENDSEC"); pos != std::string_view::npos; pos = text.find("ENDSEC", pos + 6)) {
+        const char* line = begin + pos;
+        if (line > begin && line[-1] != '\n') continue;
+        if (Trim(LineAt(line, end)) != "ENDSEC") continue;
+        // previous line must be the group code 0
+        const char* prevEnd = line - 1;
+        const char* prev = prevEnd;
+        while (prev > begin && prev[-1] != '\n') prev--;
+        if (IsCodeZero(std::string_view(prev, (size_t)(prevEnd - prev)))) return prev;
+    }
+    return end;
+}
+
+// ---------------------------------------------------------------------------
+// Driver
+
+enum class Section { None, Header, Tables, Blocks, Entities, Other };
+
+class DxfParser {
+public:
+    DxfParser(const char* begin, const char* end, bool binary, LoadTask& task)
+        : m_Begin(begin), m_End(end), m_Binary(binary), m_Task(task) {}
+
+    bool Parse(std::string& error) {
+        DxfTokenizer tokenizer(m_Begin + (m_Binary ? kBinarySentinelSize : 0), m_End, m_Binary);
+        ChunkBuilder builder(m_Task);
+        DocumentTarget documentTarget(m_Tables, builder);
+        BlockTarget blockTarget;
+        EntityParser entities(m_Tables);
+
+        Section section = Section::None;
+        bool expectSectionName = false;
+        bool inBlockHeader = false;
+        DxfBlock blockHeader;
+        std::string_view blockName;
+        bool inLayer = false;
+        std::string_view layerName;
+        int layerColor = 7;
+        const char* reported = m_Begin;
+
+        DxfToken token;
+        while (tokenizer.Next(token)) {
+            if (tokenizer.GetPosition() - reported >= (ptrdiff_t)kProgressStep) {
+                if (m_Task.IsCancelRequested()) return true;
+                m_Task.AddProgress((uint64_t)(tokenizer.GetPosition() - reported));
+                reported = tokenizer.GetPosition();
+            }
+
+            if (expectSectionName) {
+                expectSectionName = false;
+                std::string_view name = token.AsString();
+                section = name == "HEADER" ? Section::Header : name == "TABLES" ? Section::Tables :
+                          name == "BLOCKS" ? Section::Blocks : name == "ENTITIES" ? Section::Entities : Section::Other;
+                if (section == Section::Entities) {
+                    if (!m_Binary) {
+                        // hand the ASCII entity stream to the parallel slicer
+                        m_Task.AddProgress((uint64_t)(tokenizer.GetPosition() - reported));
+                        return ParseEntitySlices(tokenizer.GetPosition(), error);
+                    }
+                    entities.SetTarget(&documentTarget);
+                }
+                continue;
+            }
+
+            if (token.Code == 0) {
+                std::string_view name = token.AsString();
+                if (inLayer) {
+                    m_Tables.LayerColors[layerName] = GetAciColor(std::abs(layerColor));
+                    inLayer = false;
+                }
+                if (name == "SECTION") {
+                    expectSectionName = true;
+                    continue;
+                }
+                if (name == "ENDSEC" || name == "EOF") {
+                    entities.Finish();
+                    entities.SetTarget(nullptr);
+                    section = Section::None;
+                    if (name == "EOF") break;
+                    continue;
+                }
+            }
+
+            switch (section) {
+            case Section::Tables:
+                if (token.Code == 0) {
+                    inLayer = token.AsString() == "LAYER";
+                    layerName = {};
+                    layerColor = 7;
+                } else if (inLayer && token.Code == 2) {
+                    layerName = token.AsString();
+                } else if (inLayer && token.Code == 62) {
+                    layerColor = (int)token.AsInt();
+                }
+                break;
+
+            case Section::Blocks:
+                if (token.Code == 0 && inBlockHeader) {
+                    // header done: the block's entities follow
+                    inBlockHeader = false;
+                    DxfBlock& block = m_Tables.Blocks[blockName];
+                    block.BaseX = blockHeader.BaseX;
+                    block.BaseY = blockHeader.BaseY;
+                    blockTarget.SetBlock(&block);
+                    entities.SetTarget(&blockTarget);
+                }
+                if (token.Code == 0 && token.AsString() == "BLOCK") {
+                    entities.Finish();
+                    entities.SetTarget(nullptr);
+                    inBlockHeader = true;
+                    blockName = {};
+                    blockHeader = DxfBlock();
+                } else if (token.Code == 0 && token.AsString() == "ENDBLK") {
+                    entities.Finish();
+                    entities.SetTarget(nullptr);
+                } else if (inBlockHeader) {
+                    if (token.Code == 2) blockName = token.AsString();
+                    else if (token.Code == 10) blockHeader.BaseX = token.AsDouble();
+                    else if (token.Code == 20) blockHeader.BaseY = token.AsDouble();
+                } else {
+                    entities.Feed(token);
+                }
+                break;
+
+            case Section::Entities:
+                entities.Feed(token);
+                break;
+
+            default:
+                break;
+            }
+        }
+        entities.Finish();
+        builder.Flush();
+        m_Task.AddProgress((uint64_t)(m_End - reported));
+
+        if (tokenizer.HasError()) {
+            error = fmt::format("Malformed DXF near byte {}", tokenizer.GetPosition() - m_Begin);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool ParseEntitySlices(const char* begin, std::string& error) {
+        const char* end = FindSectionEnd(begin, m_End);
+
+        std::vector<const char*> cuts = { begin };
+        while (cuts.back() < end) {
+            const char* next = (size_t)(end - cuts.back()) > kSliceSize ? FindEntityStart(cuts.back() + kSliceSize, end) : end;
+            cuts.push_back(next);
+        }
+
+        std::atomic<bool> failed{false};
+        JobSystem::ParallelFor(cuts.size() - 1, 1, [&](size_t first, size_t last) {
+            for (size_t s = first; s < last && !m_Task.IsCancelRequested(); s++) {
+                DxfTokenizer tokenizer(cuts[s], cuts[s + 1], false);
+                ChunkBuilder builder(m_Task);
+                DocumentTarget target(m_Tables, builder);
+                EntityParser entities(m_Tables);
+                entities.SetTarget(&target);
+
+                DxfToken token;
+                while (tokenizer.Next(token))
+                    entities.Feed(token);
+                entities.Finish();
+                builder.Flush();
+                if (tokenizer.HasError()) failed = true;
+                m_Task.AddProgress((uint64_t)(cuts[s + 1] - cuts[s]));
+            }
+        });
+        // the rest of the file (OBJECTS etc.) carries no geometry
+        m_Task.AddProgress((uint64_t)(m_End - end));
+
+        if (failed.load()) {
+            error = "Malformed group code in ENTITIES section";
+            return false;
+        }
+        return true;
+    }
+
+    const char* m_Begin;
+    const char* m_End;
+    bool m_Binary;
+    LoadTask& m_Task;
+    DxfTables m_Tables;
+};
+
+} // namespace
+
+bool ReadDxf(const uint8_t* data, size_t size, LoadTask& task, std::string& error) {
+    const char* begin = (const char*)data;
+    const bool binary = size >= kBinarySentinelSize && std::memcmp(begin, kBinarySentinel, kBinarySentinelSize) == 0;
+    DxfParser parser(begin, begin + size, binary, task);
+    return parser.Parse(error);
+}
+
+bool ReadDxf(const MappedFile& file, LoadTask& task, std::string& error) {
+    return ReadDxf(file.GetData(), file.GetSize(), task, error);
+}
+
+} // namespace EasyLine
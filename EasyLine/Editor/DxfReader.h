@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace EasyLine {
+
+class LoadTask;
+class MappedFile;
+
+// DXF import, ASCII and binary (R13+ two-byte group codes).
+//
+// Reads LINE, LWPOLYLINE, POLYLINE, ARC, CIRCLE, INSERT and DIMENSION entities
+// (the latter through its anonymous geometry block). Arcs, circles and bulged
+// polyline segments are flattened into lines; block references are expanded
+// with their transform, including nested blocks and MINSERT arrays. Colors
+// follow ACI / true color with BYLAYER and BYBLOCK resolved.
+//
+// The tokenizer works in place on the mapped file: values are string_views
+// into the mapping and numbers are parsed with std::from_chars, so there is no
+// per-token allocation. The ASCII ENTITIES section is cut at entity
+// boundaries and parsed in parallel on the job system.
+bool ReadDxf(const MappedFile& file, LoadTask& task, std::string& error);
+bool ReadDxf(const uint8_t* data, size_t size, LoadTask& task, std::string& error);
+
+// RGBA of an AutoCAD Color Index (1-255), packed like LineChunk::Color
+uint32_t GetAciColor(int index);
+
+} // namespace EasyLine
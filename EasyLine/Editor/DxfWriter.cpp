@@ -0,0 +1,137 @@
+#include "DxfWriter.h"
+#include "DxfReader.h"
+#include "FileWriter.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace EasyLine {
+
+namespace {
+
+const uint32_t kWhite = PackColor({ 1.0f, 1.0f, 1.0f, 1.0f });
+
+// Nearest ACI entry by RGB distance. Drawings use few colors, so the last
+// lookup is cached and the palette scan rarely runs.
+class AciMatcher {
+public:
+    AciMatcher() {
+        for (int i = 1; i < 256; i++) m_Palette[i] = GetAciColor(i);
+    }
+
+    int Find(uint32_t color) {
+        color |= 0xff000000u;
+        if (color == m_LastColor) return m_LastIndex;
+
+        int best = 7, bestDistance = INT32_MAX;
+        for (int i = 1; i < 256; i++) {
+            int dr = (int)(color & 0xff) - (int)(m_Palette[i] & 0xff);
+            int dg = (int)((color >> 8) & 0xff) - (int)((m_Palette[i] >> 8) & 0xff);
+            int db = (int)((color >> 16) & 0xff) - (int)((m_Palette[i] >> 16) & 0xff);
+            int distance = dr * dr + dg * dg + db * db;
+            if (distance < bestDistance) {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+        m_LastColor = color;
+        m_LastIndex = best;
+        return best;
+    }
+
+private:
+    uint32_t m_Palette[256] = {};
+    uint32_t m_LastColor = 0xffffffffu;
+    int m_LastIndex = 7;
+};
+
+// Upper bound of one LINE record: the fixed text, four floats and the color groups
+constexpr size_t kMaxRecordSize = 160;
+// Chunks formatted per batch and worker before the batch is written out in order
+constexpr size_t kChunksPerWorker = 2;
+
+char* Append(char* p, std::string_view text) {
+    std::memcpy(p, text.data(), text.size());
+    return p + text.size();
+}
+
+char* AppendFloat(char* p, float value) { return std::to_chars(p, p + 32, value).ptr; }
+char* AppendInt(char* p, int64_t value) { return std::to_chars(p, p + 24, value).ptr; }
+
+size_t FormatChunk(const LineChunk& chunk, AciMatcher& aci, char* begin) {
+    char* p = begin;
+    const bool anyDeleted = chunk.DeletedCount > 0;
+    for (uint32_t i = 0; i < chunk.Count; i++) {
+        if (anyDeleted && chunk.IsDeleted(i)) continue;
+        p = Append(p, "  0\nLINE\n  8\n0\n");
+        const uint32_t color = chunk.Color[i] | 0xff000000u;
+        if (color != kWhite) {
+            p = Append(p, " 62\n");
+            p = AppendInt(p, aci.Find(color));
+            p = Append(p, "\n420\n");
+            p = AppendInt(p, (int64_t)(((color & 0xff) << 16) | (color & 0xff00) | ((color >> 16) & 0xff)));
+            *p++ = '\n';
+        }
+        p = Append(p, " 10\n");
+        p = AppendFloat(p, chunk.X0[i]);
+        p = Append(p, "\n 20\n");
+        p = AppendFloat(p, chunk.Y0[i]);
+        p = Append(p, "\n 11\n");
+        p = AppendFloat(p, chunk.X1[i]);
+        p = Append(p, "\n 21\n");
+        p = AppendFloat(p, chunk.Y1[i]);
+        *p++ = '\n';
+    }
+    return (size_t)(p - begin);
+}
+
+void WriteHeaderPoint(FileWriter& out, const char* name, const glm::vec2& p) {
+    out.Write("  9\n");
+    out.Write(name);
+    out.Write("\n 10\n");
+    out.WriteFloat(p.x);
+    out.Write("\n 20\n");
+    out.WriteFloat(p.y);
+    out.Put('\n');
+}
+
+} // namespace
+
+bool WriteDxf(const LineDocument& document, FileWriter& out) {
+    const AABB bounds = document.GetBounds().IsEmpty() ? AABB{ { 0.0f, 0.0f }, { 0.0f, 0.0f } } : document.GetBounds();
+
+    out.Write("  0\nSECTION\n  2\nHEADER\n  9\n$ACADVER\n  1\nAC1009\n");
+    WriteHeaderPoint(out, "$EXTMIN", bounds.Min);
+    WriteHeaderPoint(out, "$EXTMAX", bounds.Max);
+    out.Write("  0\nENDSEC\n  0\nSECTION\n  2\nENTITIES\n");
+
+    // Chunks are formatted in parallel into per-slot buffers, then written in
+    // document order, so the output is identical whatever the worker count
+    const size_t batchSize = (JobSystem::GetWorkerCount() + 1) * kChunksPerWorker;
+    std::vector<std::unique_ptr<char[]>> buffers(std::min(batchSize, document.GetChunkCount()));
+    std::vector<size_t> sizes(buffers.size());
+    for (auto& buffer : buffers) buffer = std::make_unique<char[]>(LineChunk::kCapacity * kMaxRecordSize);
+
+    size_t first = 0;
+    const std::function<void(size_t, size_t)> format = [&](size_t begin, size_t end) {
+        AciMatcher aci;
+        for (size_t i = begin; i < end; i++)
+            sizes[i] = FormatChunk(document.GetChunk(first + i), aci, buffers[i].get());
+    };
+    for (; first < document.GetChunkCount() && !out.HasError(); first += buffers.size()) {
+        const size_t count = std::min(buffers.size(), document.GetChunkCount() - first);
+        JobSystem::ParallelFor(count, 1, format);
+        for (size_t i = 0; i < count; i++)
+            out.Write(buffers[i].get(), sizes[i]);
+    }
+
+    out.Write("  0\nENDSEC\n  0\nEOF\n");
+    return !out.HasError();
+}
+
+} // namespace EasyLine
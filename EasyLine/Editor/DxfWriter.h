@@ -0,0 +1,14 @@
+#pragma once
+
+namespace EasyLine {
+
+class FileWriter;
+class LineDocument;
+
+// DXF export as plain ASCII (R12 layout: HEADER extents + ENTITIES), one LINE
+// per document line on layer 0. Colors are written as the nearest ACI index
+// for older readers plus the exact true color (group 420); white lines are
+// left BYLAYER. Line thickness has no DXF equivalent in R12 and is dropped.
+bool WriteDxf(const LineDocument& document, FileWriter& out);
+
+} // namespace EasyLine
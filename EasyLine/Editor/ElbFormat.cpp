@@ -0,0 +1,544 @@
+#include "ElbFormat.h"
+#include "Checksum.h"
+#include "DocumentLoader.h"
+#include "FileWriter.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "Log.h"
+#include "LzCodec.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace EasyLine {
+
+static constexpr uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// A record is one chunk followed by its tree, padded to whole pages, so the
+// lines and the index of a region are paged in together
+static constexpr uint64_t kTreeOffsetInRecord = AlignUp(sizeof(LineChunk), 64);
+static constexpr uint64_t kRecordSize = AlignUp(kTreeOffsetInRecord + sizeof(ChunkTree), kElbPageSize);
+
+static const char s_Zeros[kElbPageSize] = {};
+
+struct ChunkRecord {
+    LineChunk Chunk;
+    ChunkTree Tree;
+};
+
+// Copy of chunk and tree with unused slots and padding zeroed; the tree is
+// rebuilt if the index has none for the chunk's current version
+static void FillRecord(const LineDocument& document, size_t index, ChunkRecord& record) {
+    const LineChunk& chunk = document.GetChunk(index);
+    LineChunk& c = record.Chunk;
+    std::memset((void*)&c, 0, sizeof(c));
+    c.Count = chunk.Count;
+    c.DeletedCount = chunk.DeletedCount;
+    c.Version = chunk.Version;
+    c.Bounds = chunk.Bounds;
+    c.MaxThickness = chunk.MaxThickness;
+    std::memcpy(c.X0, chunk.X0, chunk.Count * sizeof(float));
+    std::memcpy(c.Y0, chunk.Y0, chunk.Count * sizeof(float));
+    std::memcpy(c.X1, chunk.X1, chunk.Count * sizeof(float));
+    std::memcpy(c.Y1, chunk.Y1, chunk.Count * sizeof(float));
+    std::memcpy(c.Thickness, chunk.Thickness, chunk.Count * sizeof(float));
+    std::memcpy(c.Color, chunk.Color, chunk.Count * sizeof(uint32_t));
+    std::memcpy(c.Deleted, chunk.Deleted, sizeof(c.Deleted));
+
+    ChunkTree& t = record.Tree;
+    std::memset((void*)&t, 0, sizeof(t));
+    const ChunkTree* tree = document.GetSpatialIndex().GetTree(index);
+    if (!tree || tree->ChunkVersion != chunk.Version) {
+        SpatialIndex::BuildTree(c, t);
+        // BuildTree leaves the unused tail alone, which is still zero
+        return;
+    }
+    t.ChunkVersion = tree->ChunkVersion;
+    t.LineCount = tree->LineCount;
+    t.LeafCount = tree->LeafCount;
+    t.NodeCount = tree->NodeCount;
+    std::memcpy(t.Order, tree->Order, tree->LineCount * sizeof(uint16_t));
+    std::memcpy(t.Nodes, tree->Nodes, tree->NodeCount * sizeof(ChunkTree::Node));
+}
+
+// ---------------------------------------------------------------------------
+// Packed chunks of compressed files
+
+struct PackedChunkHeader {
+    uint32_t Count;
+    uint32_t DeletedCount;
+    uint32_t Version;
+    float MaxThickness;
+    AABB Bounds;            // Bounds.Min is the origin of the quantized coordinates
+    uint32_t StreamSize;    // varint streams, before LZ
+    uint32_t LzSize;        // size of the LZ block that follows; 0 if the streams follow as is
+};
+
+// six streams of at most one 10-byte varint per line, plus the deleted bits
+static constexpr size_t kMaxStreamSize = 6 * 10 * LineChunk::kCapacity + sizeof(LineChunk::Deleted);
+static constexpr size_t kMaxPackedSize = sizeof(PackedChunkHeader) + LzCompressBound(kMaxStreamSize);
+
+static uint64_t ZigZag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static int64_t UnZigZag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+static uint8_t* PutVarint(uint8_t* p, uint64_t v) {
+    for (; v >= 0x80; v >>= 7) *p++ = (uint8_t)v | 0x80;
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static bool GetVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    if (p < end && *p < 0x80) {
+        v = *p++;
+        return true;
+    }
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint32_t FloatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float BitsToFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static int64_t Quantize(float value, double origin, double precision) {
+    const double q = ((double)value - origin) / precision;
+    // a non-finite coordinate cannot be kept; the clamp keeps the conversion defined
+    return std::isfinite(q) ? std::llround(std::clamp(q, -0x1p52, 0x1p52)) : 0;
+}
+
+// Float spacing at the drawing's largest coordinate: a finer quantum would not keep anything more
+static double GetFloatResolution(const LineDocument& document) {
+    float extent = 0.0f;
+    for (size_t i = 0; i < document.GetChunkCount(); i++) {
+        const AABB& bounds = document.GetChunk(i).Bounds;
+        for (float v : { bounds.Min.x, bounds.Min.y, bounds.Max.x, bounds.Max.y })
+            if (std::isfinite(v)) extent = std::max(extent, std::abs(v));
+    }
+    return (double)std::nextafter(extent, INFINITY) - (double)extent;
+}
+
+// Encode one axis of the endpoints: starts against the previous line's end,
+// ends against their start. Connected polylines give zero deltas.
+static uint8_t* PutAxis(uint8_t* p, const float* a0, const float* a1, uint32_t count, double origin, double precision) {
+    int64_t prev = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const int64_t start = Quantize(a0[i], origin, precision);
+        p = PutVarint(p, ZigZag(start - prev));
+        prev = Quantize(a1[i], origin, precision);
+    }
+    for (uint32_t i = 0; i < count; i++)
+        p = PutVarint(p, ZigZag(Quantize(a1[i], origin, precision) - Quantize(a0[i], origin, precision)));
+    return p;
+}
+
+static bool GetAxis(const uint8_t*& p, const uint8_t* end, float* a0, float* a1, uint32_t count, double origin, double precision) {
+    // the end deltas follow the start deltas, so the starts are read first
+    int64_t starts[LineChunk::kCapacity];
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t v;
+        if (!GetVarint(p, end, v)) return false;
+        starts[i] = UnZigZag(v);
+    }
+    uint64_t prev = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t v;
+        if (!GetVarint(p, end, v)) return false;
+        // unsigned, so corrupt deltas wrap instead of overflowing
+        const uint64_t start = prev + (uint64_t)starts[i];
+        prev = start + (uint64_t)UnZigZag(v);
+        a0[i] = (float)(origin + (double)(int64_t)start * precision);
+        a1[i] = (float)(origin + (double)(int64_t)prev * precision);
+    }
+    return true;
+}
+
+// Packs chunk into out (kMaxPackedSize bytes) using streams (kMaxStreamSize) as scratch. Returns the packed size.
+static size_t PackChunk(const LineChunk& chunk, double precision, uint8_t* streams, uint8_t* out) {
+    const uint32_t count = chunk.Count;
+    uint8_t* p = streams;
+    p = PutAxis(p, chunk.X0, chunk.X1, count, chunk.Bounds.Min.x, precision);
+    p = PutAxis(p, chunk.Y0, chunk.Y1, count, chunk.Bounds.Min.y, precision);
+    // thickness and color rarely change from one line to the next
+    uint32_t prevThickness = 0, prevColor = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        p = PutVarint(p, FloatBits(chunk.Thickness[i]) ^ prevThickness);
+        prevThickness = FloatBits(chunk.Thickness[i]);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        p = PutVarint(p, chunk.Color[i] ^ prevColor);
+        prevColor = chunk.Color[i];
+    }
+    if (chunk.DeletedCount > 0) {
+        const size_t bytes = (count + 31) / 32 * sizeof(uint32_t);
+        std::memcpy(p, chunk.Deleted, bytes);
+        p += bytes;
+    }
+
+    PackedChunkHeader header = {};
+    header.Count = count;
+    header.DeletedCount = chunk.DeletedCount;
+    header.Version = chunk.Version;
+    header.MaxThickness = chunk.MaxThickness;
+    header.Bounds = chunk.Bounds;
+    header.StreamSize = (uint32_t)(p - streams);
+
+    uint8_t* payload = out + sizeof(header);
+    size_t payloadSize = LzCompress(streams, header.StreamSize, payload);
+    if (payloadSize < header.StreamSize) {
+        header.LzSize = (uint32_t)payloadSize;
+    } else {
+        payloadSize = header.StreamSize;
+        std::memcpy(payload, streams, payloadSize);
+    }
+    std::memcpy(out, &header, sizeof(header));
+    return sizeof(header) + payloadSize;
+}
+
+// Decodes a packed block into chunk using streams (kMaxStreamSize) as scratch. False if it is malformed.
+static bool UnpackChunk(const uint8_t* data, size_t size, double precision, uint8_t* streams, LineChunk& chunk) {
+    PackedChunkHeader header;
+    if (size < sizeof(header)) return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.Count > LineChunk::kCapacity || header.DeletedCount > header.Count || header.StreamSize > kMaxStreamSize)
+        return false;
+
+    const uint8_t* payload = data + sizeof(header);
+    const size_t payloadSize = size - sizeof(header);
+    const uint8_t* p = payload;
+    if (header.LzSize != 0) {
+        if (payloadSize != header.LzSize || !LzDecompress(payload, payloadSize, streams, header.StreamSize)) return false;
+        p = streams;
+    } else if (payloadSize != header.StreamSize) {
+        return false;
+    }
+    const uint8_t* end = p + header.StreamSize;
+
+    const uint32_t count = header.Count;
+    chunk.Count = count;
+    chunk.DeletedCount = header.DeletedCount;
+    chunk.Version = header.Version;
+    chunk.MaxThickness = header.MaxThickness;
+    if (!GetAxis(p, end, chunk.X0, chunk.X1, count, header.Bounds.Min.x, precision) ||
+        !GetAxis(p, end, chunk.Y0, chunk.Y1, count, header.Bounds.Min.y, precision))
+        return false;
+
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t v;
+        if (!GetVarint(p, end, v)) return false;
+        bits ^= (uint32_t)v;
+        chunk.Thickness[i] = BitsToFloat(bits);
+    }
+    bits = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t v;
+        if (!GetVarint(p, end, v)) return false;
+        bits ^= (uint32_t)v;
+        chunk.Color[i] = bits;
+    }
+    std::memset(chunk.Deleted, 0, sizeof(chunk.Deleted));
+    if (header.DeletedCount > 0) {
+        const size_t bytes = (count + 31) / 32 * sizeof(uint32_t);
+        if ((size_t)(end - p) < bytes) return false;
+        std::memcpy(chunk.Deleted, p, bytes);
+        p += bytes;
+    }
+    if (p != end) return false;
+
+    // rounding may move an endpoint by up to half the quantum
+    chunk.Bounds = header.Bounds;
+    for (uint32_t i = 0; i < count; i++) {
+        chunk.Bounds.Expand(glm::vec2(chunk.X0[i], chunk.Y0[i]));
+        chunk.Bounds.Expand(glm::vec2(chunk.X1[i], chunk.Y1[i]));
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+
+static uint64_t MakeJournalId() {
+    std::random_device random;
+    return ((uint64_t)random() << 32) | random();
+}
+
+// Header, padding and chunk table; the records follow right after
+static void WriteHeaderAndTable(const LineDocument& document, FileWriter& out, const std::vector<ElbChunkEntry>& table,
+    uint64_t journalId, uint64_t journalSequence, uint32_t flags, double precision) {
+    const uint64_t tableOffset = kElbPageSize;
+
+    ElbHeader header = {};
+    header.Magic = ElbHeader::kMagic;
+    header.Version = ElbHeader::kVersion;
+    header.ChunkSize = sizeof(LineChunk);
+    header.TreeSize = sizeof(ChunkTree);
+    header.ChunkCount = table.size();
+    header.LineCount = document.GetLineCount();
+    header.Bounds = document.GetBounds();
+    header.TableOffset = tableOffset;
+    header.TableChecksum = Checksum::Compute(table.data(), table.size() * sizeof(ElbChunkEntry));
+    header.JournalId = journalId;
+    header.JournalSequence = journalSequence;
+    header.Flags = flags;
+    header.Precision = precision;
+    header.HeaderChecksum = Checksum::Compute(&header, offsetof(ElbHeader, HeaderChecksum));
+
+    out.Write(&header, sizeof(header));
+    out.Write(s_Zeros, tableOffset - sizeof(header));
+    out.Write(table.data(), table.size() * sizeof(ElbChunkEntry));
+}
+
+bool WriteElb(const LineDocument& document, FileWriter& out) {
+    return WriteElb(document, out, MakeJournalId(), 0);
+}
+
+bool WriteElb(const LineDocument& document, FileWriter& out, uint64_t journalId, uint64_t journalSequence) {
+    const size_t chunkCount = document.GetChunkCount();
+    const uint64_t tableOffset = kElbPageSize;
+    const uint64_t firstRecord = AlignUp(tableOffset + chunkCount * sizeof(ElbChunkEntry), kElbPageSize);
+
+    // checksums first, since the table precedes the records
+    std::vector<ElbChunkEntry> table(chunkCount);
+    JobSystem::ParallelFor(chunkCount, 4, [&](size_t begin, size_t end) {
+        auto record = std::make_unique<ChunkRecord>();
+        for (size_t i = begin; i < end; i++) {
+            FillRecord(document, i, *record);
+            table[i].ChunkOffset = firstRecord + i * kRecordSize;
+            table[i].TreeOffset = table[i].ChunkOffset + kTreeOffsetInRecord;
+            table[i].ChunkChecksum = Checksum::Compute(&record->Chunk, sizeof(LineChunk));
+            table[i].TreeChecksum = Checksum::Compute(&record->Tree, sizeof(ChunkTree));
+            table[i].PackedSize = 0;
+        }
+    });
+
+    WriteHeaderAndTable(document, out, table, journalId, journalSequence, 0, 0.0);
+    out.Write(s_Zeros, firstRecord - tableOffset - table.size() * sizeof(ElbChunkEntry));
+
+    auto record = std::make_unique<ChunkRecord>();
+    for (size_t i = 0; i < chunkCount && !out.HasError(); i++) {
+        FillRecord(document, i, *record);
+        out.Write(&record->Chunk, sizeof(LineChunk));
+        out.Write(s_Zeros, kTreeOffsetInRecord - sizeof(LineChunk));
+        out.Write(&record->Tree, sizeof(ChunkTree));
+        out.Write(s_Zeros, kRecordSize - kTreeOffsetInRecord - sizeof(ChunkTree));
+    }
+    return !out.HasError();
+}
+
+bool WriteElbCompressed(const LineDocument& document, FileWriter& out) {
+    return WriteElbCompressed(document, out, 0.0);
+}
+
+bool WriteElbCompressed(const LineDocument& document, FileWriter& out, double precision) {
+    precision = std::max(precision, GetFloatResolution(document));
+    const size_t chunkCount = document.GetChunkCount();
+
+    // Packed blocks are small, so all of them are kept until the table,
+    // which precedes them, is complete
+    std::vector<std::vector<uint8_t>> blocks(chunkCount);
+    JobSystem::ParallelFor(chunkCount, 4, [&](size_t begin, size_t end) {
+        auto streams = std::make_unique<uint8_t[]>(kMaxStreamSize);
+        auto packed = std::make_unique<uint8_t[]>(kMaxPackedSize);
+        for (size_t i = begin; i < end; i++) {
+            const size_t size = PackChunk(document.GetChunk(i), precision, streams.get(), packed.get());
+            blocks[i].assign(packed.get(), packed.get() + size);
+        }
+    });
+
+    std::vector<ElbChunkEntry> table(chunkCount);
+    uint64_t offset = kElbPageSize + chunkCount * sizeof(ElbChunkEntry);
+    for (size_t i = 0; i < chunkCount; i++) {
+        table[i] = { offset, 0, Checksum::Compute(blocks[i].data(), blocks[i].size()), 0, blocks[i].size() };
+        offset += blocks[i].size();
+    }
+
+    WriteHeaderAndTable(document, out, table, MakeJournalId(), 0, ElbHeader::Compressed, precision);
+    for (size_t i = 0; i < chunkCount && !out.HasError(); i++)
+        out.Write(blocks[i].data(), blocks[i].size());
+    return !out.HasError();
+}
+
+static bool IsInside(uint64_t offset, uint64_t size, uint64_t alignment, uint64_t fileSize) {
+    return offset % alignment == 0 && offset <= fileSize && size <= fileSize - offset;
+}
+
+bool ReadElbHeader(const uint8_t* data, size_t size, ElbHeader& header, std::string& error) {
+    if (size < sizeof(header)) {
+        error = "File too small";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.Magic != ElbHeader::kMagic) {
+        error = "Not an EasyLine document";
+        return false;
+    }
+    if (header.HeaderChecksum != Checksum::Compute(&header, offsetof(ElbHeader, HeaderChecksum))) {
+        error = "Header checksum mismatch";
+        return false;
+    }
+    if (header.Version != ElbHeader::kVersion) {
+        error = fmt::format("Unsupported format version {}", header.Version);
+        return false;
+    }
+    if (header.ChunkSize != sizeof(LineChunk) || header.TreeSize != sizeof(ChunkTree)) {
+        error = "Written with a different chunk layout";
+        return false;
+    }
+    if ((header.Flags & ElbHeader::Compressed) && !(header.Precision > 0.0 && std::isfinite(header.Precision))) {
+        error = "Invalid coordinate precision";
+        return false;
+    }
+    if (header.ChunkCount > size / sizeof(ElbChunkEntry) ||
+        !IsInside(header.TableOffset, header.ChunkCount * sizeof(ElbChunkEntry), alignof(ElbChunkEntry), size)) {
+        error = "Chunk table out of range";
+        return false;
+    }
+    return true;
+}
+
+// Compressed files: chunks are checked, decoded and indexed in parallel a
+// batch at a time, and each batch is published in file order, so handles
+// match the document that was written
+static bool ReadPackedChunks(const uint8_t* data, uint64_t size, const ElbHeader& header, const ElbChunkEntry* table,
+    LoadTask& task, std::string& error) {
+    constexpr size_t kBatchSize = 256;
+
+    const size_t chunkCount = (size_t)header.ChunkCount;
+    for (size_t i = 0; i < chunkCount; i++) {
+        if (table[i].PackedSize > kMaxPackedSize || !IsInside(table[i].ChunkOffset, table[i].PackedSize, 1, size)) {
+            error = fmt::format("Chunk {} out of range", i);
+            return false;
+        }
+    }
+
+    uint64_t published = 0;
+    std::vector<std::shared_ptr<LineChunk>> chunks(kBatchSize);
+    std::vector<std::shared_ptr<ChunkTree>> trees(kBatchSize);
+    for (size_t first = 0; first < chunkCount && !task.IsCancelRequested(); first += kBatchSize) {
+        const size_t count = std::min(kBatchSize, chunkCount - first);
+        std::atomic<size_t> corrupt{SIZE_MAX};
+        JobSystem::ParallelFor(count, 4, [&](size_t begin, size_t end) {
+            auto streams = std::make_unique<uint8_t[]>(kMaxStreamSize);
+            for (size_t k = begin; k < end; k++) {
+                const ElbChunkEntry& entry = table[first + k];
+                const uint8_t* block = data + entry.ChunkOffset;
+                // every slot in use is written by UnpackChunk
+                auto chunk = std::make_shared_for_overwrite<LineChunk>();
+                if (Checksum::Compute(block, entry.PackedSize) != entry.ChunkChecksum ||
+                    !UnpackChunk(block, entry.PackedSize, header.Precision, streams.get(), *chunk)) {
+                    corrupt = first + k;
+                    continue;
+                }
+                auto tree = std::make_shared_for_overwrite<ChunkTree>();
+                SpatialIndex::BuildTree(*chunk, *tree);
+                chunks[k] = std::move(chunk);
+                trees[k] = std::move(tree);
+            }
+        });
+        if (corrupt.load() != SIZE_MAX) {
+            error = fmt::format("Chunk {} is corrupt", corrupt.load());
+            return false;
+        }
+
+        uint64_t bytes = 0;
+        for (size_t k = 0; k < count; k++) {
+            bytes += table[first + k].PackedSize;
+            task.Publish(std::move(chunks[k]), std::move(trees[k]));
+        }
+        task.AddProgress(bytes);
+        published += bytes;
+    }
+    task.AddProgress(size - published);
+    return true;
+}
+
+bool ReadElb(const MappedFile& file, LoadTask& task, std::string& error) {
+    // chunks point straight into the mapping, which they keep alive
+    std::shared_ptr<const MappedFile> owner = file.weak_from_this().lock();
+    if (!owner) {
+        error = "Mapping is not shared";
+        return false;
+    }
+
+    const uint8_t* data = file.GetData();
+    const uint64_t size = file.GetSize();
+    ElbHeader header;
+    if (!ReadElbHeader(data, size, header, error)) return false;
+
+    const ElbChunkEntry* table = (const ElbChunkEntry*)(data + header.TableOffset);
+    if (header.TableChecksum != Checksum::Compute(table, header.ChunkCount * sizeof(ElbChunkEntry))) {
+        error = "Chunk table checksum mismatch";
+        return false;
+    }
+    if (header.Flags & ElbHeader::Compressed) return ReadPackedChunks(data, size, header, table, task, error);
+
+    const size_t chunkCount = (size_t)header.ChunkCount;
+    for (size_t i = 0; i < chunkCount; i++) {
+        if (!IsInside(table[i].ChunkOffset, sizeof(LineChunk), alignof(LineChunk), size) ||
+            !IsInside(table[i].TreeOffset, sizeof(ChunkTree), alignof(ChunkTree), size)) {
+            error = fmt::format("Chunk {} out of range", i);
+            return false;
+        }
+    }
+
+    if (size <= kElbVerifyLimit) {
+        std::atomic<size_t> corrupt{SIZE_MAX};
+        JobSystem::ParallelFor(chunkCount, 4, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end && !task.IsCancelRequested(); i++) {
+                if (Checksum::Compute(data + table[i].ChunkOffset, sizeof(LineChunk)) != table[i].ChunkChecksum ||
+                    Checksum::Compute(data + table[i].TreeOffset, sizeof(ChunkTree)) != table[i].TreeChecksum)
+                    corrupt = i;
+            }
+        });
+        if (corrupt.load() != SIZE_MAX) {
+            error = fmt::format("Checksum mismatch in chunk {}", corrupt.load());
+            return false;
+        }
+    } else {
+        EL_CORE_INFO("{}: {} MB, record checksums not verified", file.GetPath(), size >> 20);
+    }
+
+    // No copy: the chunks alias the read-only mapping. Being mapped, they are
+    // copied by the document before any edit.
+    for (size_t i = 0; i < chunkCount && !task.IsCancelRequested(); i++) {
+        auto chunk = MakeMappedPtr<LineChunk>(owner, data + table[i].ChunkOffset);
+        auto tree = MakeMappedPtr<ChunkTree>(owner, data + table[i].TreeOffset);
+        if (chunk->Count > LineChunk::kCapacity || chunk->DeletedCount > chunk->Count) {
+            error = fmt::format("Chunk {} is corrupt", i);
+            return false;
+        }
+        // Queries trust the tree's indices, and checksums are skipped for
+        // large files, so a tree that could lead them astray is rebuilt
+        if (!SpatialIndex::IsTreeValid(*chunk, *tree)) {
+            EL_CORE_WARN("{}: index of chunk {} is corrupt, rebuilding it", file.GetPath(), i);
+            auto rebuilt = std::make_shared<ChunkTree>();
+            SpatialIndex::BuildTree(*chunk, *rebuilt);
+            tree = std::move(rebuilt);
+        }
+        task.Publish(std::move(chunk), std::move(tree));
+    }
+    task.AddProgress(size);
+    return true;
+}
+
+} // namespace EasyLine
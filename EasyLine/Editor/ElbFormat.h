@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "AABB.h"
+
+namespace EasyLine {
+
+class FileWriter;
+class LineDocument;
+class LoadTask;
+class MappedFile;
+
+// Native EasyLine document (.elb): the in-memory chunk and index structures
+// written out byte for byte, so opening a file is a mapping plus offset
+// lookups with no parsing. The OS pages chunks in as the camera reaches them.
+//
+//   ElbHeader           page 0
+//   ElbChunkEntry[]     chunk table, from page 1
+//   chunk records       page aligned: LineChunk, then its ChunkTree
+//
+// LineChunk and ChunkTree hold no pointers; their sizes are recorded in the
+// header and files from a build with a different layout are rejected.
+// Unused slots are written as zeros so the output is deterministic.
+// Checksums cover the header, the table and each record.
+//
+// Compressed files (.elbz, ElbHeader::Compressed) trade the mapping for size,
+// for archives and network shares. Each chunk is stored as one packed block
+// instead of a record: coordinates quantized to the drawing's precision and
+// delta coded (a line's start against the previous line's end, its end
+// against its start), every field as varints, then LZ compressed (LzCodec).
+// Index trees are not stored; chunks are decoded and indexed in parallel on
+// open.
+//
+// Edits made after the file was written live in a journal next to it (see
+// DocumentJournal); the header names the journal and the last batch of it
+// already folded into this file.
+struct ElbHeader {
+    static constexpr uint32_t kMagic = 0x31424c45;     // "ELB1"
+    static constexpr uint32_t kVersion = 3;
+
+    enum Flag : uint32_t { Compressed = 1 };
+
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t ChunkSize;         // sizeof(LineChunk)
+    uint32_t TreeSize;          // sizeof(ChunkTree)
+    uint64_t ChunkCount;
+    uint64_t LineCount;
+    AABB Bounds;
+    uint64_t TableOffset;
+    uint64_t TableChecksum;
+    uint64_t JournalId;         // random, shared with the journal that belongs to this file
+    uint64_t JournalSequence;   // journal batches up to this one are already contained
+    uint32_t Flags;
+    uint32_t Reserved;
+    double Precision;           // compressed: coordinate quantum, 0 otherwise
+    uint64_t HeaderChecksum;    // of all fields above
+};
+
+// Compressed files: ChunkOffset and ChunkChecksum are those of the packed
+// block, PackedSize its length; the tree fields are zero
+struct ElbChunkEntry {
+    uint64_t ChunkOffset;
+    uint64_t TreeOffset;
+    uint64_t ChunkChecksum;
+    uint64_t TreeChecksum;
+    uint64_t PackedSize;
+};
+
+constexpr uint64_t kElbPageSize = 4096;
+// Record checksums are verified on open up to this file size; bigger files
+// would have to be read in full, which is exactly what the format avoids
+constexpr uint64_t kElbVerifyLimit = 256ull << 20;
+
+bool ReadElb(const MappedFile& file, LoadTask& task, std::string& error);
+// Validate and copy out the header of an .elb file
+bool ReadElbHeader(const uint8_t* data, size_t size, ElbHeader& header, std::string& error);
+
+// Write a standalone file, with a fresh journal id
+bool WriteElb(const LineDocument& document, FileWriter& out);
+// Write a compacted base for the given journal, containing its batches up to journalSequence
+bool WriteElb(const LineDocument& document, FileWriter& out, uint64_t journalId, uint64_t journalSequence);
+
+// Write a compressed file. Coordinates are kept to within precision, which
+// is raised to at least the float resolution at the drawing's largest
+// coordinate; that resolution is used when precision is 0.
+bool WriteElbCompressed(const LineDocument& document, FileWriter& out, double precision);
+bool WriteElbCompressed(const LineDocument& document, FileWriter& out);
+
+} // namespace EasyLine
@@ -0,0 +1,174 @@
+#include "FileWriter.h"
+#include "Log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace EasyLine {
+
+FileWriter::~FileWriter() {
+    Discard();
+}
+
+bool FileWriter::Open(const std::string& path) {
+    Discard();
+    m_Path = path;
+    m_TempPath = path + ".tmp";
+    m_Used = 0;
+    m_Flushed = 0;
+    m_Error = false;
+    m_Append = false;
+
+#ifdef _WIN32
+    m_File = _open(m_TempPath.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY | _O_SEQUENTIAL, _S_IREAD | _S_IWRITE);
+#else
+    m_File = ::open(m_TempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+    if (m_File < 0) {
+        EL_CORE_ERROR("Failed to create file: {}", m_TempPath);
+        return false;
+    }
+    if (!m_Buffer) m_Buffer = std::make_unique<char[]>(kBufferSize);
+    return true;
+}
+
+bool FileWriter::OpenAppend(const std::string& path) {
+    Discard();
+    m_Path = path;
+    m_TempPath.clear();
+    m_Used = 0;
+    m_Flushed = 0;
+    m_Error = false;
+    m_Append = true;
+
+#ifdef _WIN32
+    m_File = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    m_File = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+    if (m_File < 0) {
+        EL_CORE_ERROR("Failed to open file for appending: {}", path);
+        return false;
+    }
+    if (!m_Buffer) m_Buffer = std::make_unique<char[]>(kBufferSize);
+    return true;
+}
+
+bool FileWriter::Sync() {
+    if (!IsOpen()) return false;
+    Flush();
+#ifdef _WIN32
+    if (_commit(m_File) != 0) m_Error = true;
+#else
+    if (fsync(m_File) != 0) m_Error = true;
+#endif
+    return !m_Error;
+}
+
+bool FileWriter::Close() {
+    if (!IsOpen()) return false;
+    Flush();
+
+    if (m_Append) {
+#ifdef _WIN32
+        bool ok = _close(m_File) == 0 && !m_Error;
+#else
+        bool ok = ::close(m_File) == 0 && !m_Error;
+#endif
+        m_File = -1;
+        if (!ok) EL_CORE_ERROR("Failed to write file: {}", m_Path);
+        return ok;
+    }
+
+    // on disk before the rename, so a crash leaves the old file or the new one
+    Sync();
+#ifdef _WIN32
+    bool ok = _close(m_File) == 0 && !m_Error;
+    m_File = -1;
+    ok = ok && MoveFileExA(m_TempPath.c_str(), m_Path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    bool ok = ::close(m_File) == 0 && !m_Error;
+    m_File = -1;
+    ok = ok && std::rename(m_TempPath.c_str(), m_Path.c_str()) == 0;
+#endif
+    if (!ok) {
+        EL_CORE_ERROR("Failed to write file: {}", m_Path);
+        std::remove(m_TempPath.c_str());
+    }
+    return ok;
+}
+
+void FileWriter::Discard() {
+    if (!IsOpen()) return;
+#ifdef _WIN32
+    _close(m_File);
+#else
+    ::close(m_File);
+#endif
+    m_File = -1;
+    if (!m_Append) std::remove(m_TempPath.c_str());
+}
+
+void FileWriter::Write(const void* data, size_t size) {
+    if (m_Used + size <= kBufferSize) {
+        std::memcpy(m_Buffer.get() + m_Used, data, size);
+        m_Used += size;
+        return;
+    }
+    // large blocks skip the buffer
+    Flush();
+    if (size >= kBufferSize / 2) {
+        WriteToFile(data, size);
+        m_Flushed += size;
+    } else {
+        std::memcpy(m_Buffer.get(), data, size);
+        m_Used = size;
+    }
+}
+
+void FileWriter::Flush() {
+    if (m_Used == 0) return;
+    WriteToFile(m_Buffer.get(), m_Used);
+    m_Flushed += m_Used;
+    m_Used = 0;
+}
+
+void FileWriter::WriteToFile(const void* data, size_t size) {
+    if (m_Error || m_File < 0) return;
+    const char* p = (const char*)data;
+    while (size > 0) {
+        const size_t block = std::min<size_t>(size, 1u << 30);
+#ifdef _WIN32
+        const long long written = _write(m_File, p, (unsigned int)block);
+#else
+        const ssize_t written = ::write(m_File, p, block);
+#endif
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) {
+            EL_CORE_ERROR("Write failed: {}", m_Append ? m_Path : m_TempPath);
+            m_Error = true;
+            return;
+        }
+        p += written;
+        size -= (size_t)written;
+    }
+}
+
+} // namespace EasyLine
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace EasyLine {
+
+// Buffered, allocation-free file output for the exporters. Everything goes
+// into one large buffer that is handed to the OS with a single write call
+// whenever it fills up; numbers are formatted in place with std::to_chars.
+//
+// The data is written next to the target and renamed over it by Close(), so
+// a failed or abandoned save never leaves a truncated file behind. Files
+// opened with OpenAppend() are written in place instead (journals).
+class FileWriter {
+public:
+    static constexpr size_t kBufferSize = 4 << 20;
+
+    FileWriter() = default;
+    ~FileWriter();
+
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    // Returns false (and logs) if the file cannot be created
+    bool Open(const std::string& path);
+    // Append to path directly, creating it if needed
+    bool OpenAppend(const std::string& path);
+    // Flush and move the file into place. Returns false if anything failed to write.
+    bool Close();
+    // Drop the partially written file (appended data stays)
+    void Discard();
+    // Flush and wait until the data is on disk. Returns false if anything failed to write.
+    bool Sync();
+
+    bool IsOpen() const { return m_File >= 0; }
+    bool HasError() const { return m_Error; }
+    uint64_t GetBytesWritten() const { return m_Flushed + m_Used; }
+    const std::string& GetPath() const { return m_Path; }
+
+    void Write(const void* data, size_t size);
+    void Write(std::string_view text) { Write(text.data(), text.size()); }
+
+    void Put(char c) {
+        if (m_Used == kBufferSize) Flush();
+        m_Buffer[m_Used++] = c;
+    }
+
+    // Shortest representation that reads back to the same value
+    void WriteFloat(float value) { Advance(std::to_chars(Reserve(32), m_Buffer.get() + m_Used + 32, value).ptr); }
+    void WriteDouble(double value) { Advance(std::to_chars(Reserve(32), m_Buffer.get() + m_Used + 32, value).ptr); }
+    void WriteInt(int64_t value) { Advance(std::to_chars(Reserve(24), m_Buffer.get() + m_Used + 24, value).ptr); }
+    void WriteFixed(double value, int precision) {
+        Advance(std::to_chars(Reserve(64), m_Buffer.get() + m_Used + 64, value, std::chars_format::fixed, precision).ptr);
+    }
+
+    // Room for size bytes at the write position; commit them with Advance()
+    char* Reserve(size_t size) {
+        if (m_Used + size > kBufferSize) Flush();
+        return m_Buffer.get() + m_Used;
+    }
+    void Advance(char* end) { m_Used = (size_t)(end - m_Buffer.get()); }
+
+private:
+    void Flush();
+    void WriteToFile(const void* data, size_t size);
+
+    std::unique_ptr<char[]> m_Buffer;
+    size_t m_Used = 0;
+    uint64_t m_Flushed = 0;
+    bool m_Error = false;
+    std::string m_Path;
+    std::string m_TempPath;
+    int m_File = -1;
+    bool m_Append = false;
+};
+
+} // namespace EasyLine
@@ -0,0 +1,63 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace EasyLine {
+
+static constexpr size_t kBlockAlignment = 64;
+
+FrameArena::FrameArena(size_t initialCapacity) {
+    NewBlock(initialCapacity);
+}
+
+FrameArena::~FrameArena() {
+    FreeBlocks();
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+    uintptr_t p = ((uintptr_t)m_Ptr + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+    if (p + size > (uintptr_t)m_End) {
+        NewBlock(std::max(size + alignment, m_Capacity));
+        p = ((uintptr_t)m_Ptr + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+    }
+    m_Ptr = (std::byte*)(p + size);
+    m_HighWater = std::max(m_HighWater, GetUsedBytes());
+    return (void*)p;
+}
+
+void FrameArena::Reset() {
+    if (m_Blocks.size() > 1) {
+        // The last frame did not fit: replace the chain with one block that would have held it.
+        size_t size = m_Capacity;
+        FreeBlocks();
+        NewBlock(size);
+    }
+    m_Ptr = m_Begin;
+    m_UsedBefore = 0;
+}
+
+void FrameArena::NewBlock(size_t minSize) {
+    if (!m_Blocks.empty())
+        m_UsedBefore += (size_t)(m_Ptr - m_Begin);
+
+    size_t size = (std::max<size_t>(minSize, 4096) + kBlockAlignment - 1) & ~(kBlockAlignment - 1);
+    std::byte* data = (std::byte*)::operator new(size, std::align_val_t(kBlockAlignment));
+    m_Blocks.push_back({ data, size });
+    m_UpstreamAllocations++;
+    m_Capacity += size;
+
+    m_Begin = m_Ptr = data;
+    m_End = data + size;
+}
+
+void FrameArena::FreeBlocks() {
+    for (const Block& block : m_Blocks)
+        ::operator delete(block.Data, std::align_val_t(kBlockAlignment));
+    m_Blocks.clear();
+    m_Begin = m_Ptr = m_End = nullptr;
+    m_UsedBefore = 0;
+    m_Capacity = 0;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <spdlog/fmt/fmt.h>
+
+namespace EasyLine {
+
+// Linear bump allocator for data that only lives until the end of the frame.
+//
+// Allocating is a pointer bump, deallocating is a no-op, and everything is
+// released at once by Reset() (Renderer::EndFrame). If a frame overflows the
+// current block, more blocks are chained; the next Reset() folds them into a
+// single block big enough for the whole frame, so steady-state frames do not
+// touch the heap at all.
+//
+// FrameArena is a std::pmr::memory_resource, so any pmr container can be
+// pointed at it (see FrameVector / FrameString below). Not thread-safe.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t initialCapacity = 1 << 20);
+    ~FrameArena() override;
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template<typename T>
+    T* AllocateArray(size_t count) { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+    // Format into arena memory; the view stays valid until the next Reset().
+    template<typename... Args>
+    std::string_view Format(fmt::format_string<Args...> format, Args&&... args)
+    {
+        // short labels are formatted on the stack, then copied in once
+        fmt::basic_memory_buffer<char, 256> text;
+        fmt::vformat_to(std::back_inserter(text), format, fmt::make_format_args(args...));
+        char* buffer = AllocateArray<char>(text.size() + 1);
+        std::copy(text.begin(), text.end(), buffer);
+        buffer[text.size()] = '\0';
+        return { buffer, text.size() };
+    }
+
+    // Rewind to empty. All pointers handed out since the last Reset() become invalid.
+    void Reset();
+
+    size_t GetUsedBytes() const { return m_UsedBefore + (size_t)(m_Ptr - m_Begin); }
+    size_t GetCapacity() const { return m_Capacity; }
+    size_t GetHighWaterMark() const { return m_HighWater; }
+    // Number of times the arena itself went to the heap (block allocations).
+    size_t GetUpstreamAllocationCount() const { return m_UpstreamAllocations; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override { return Allocate(bytes, alignment); }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct Block { std::byte* Data; size_t Size; };
+
+    void NewBlock(size_t minSize);
+    void FreeBlocks();
+
+    std::vector<Block> m_Blocks;
+    std::byte* m_Begin = nullptr;   // current block
+    std::byte* m_Ptr = nullptr;
+    std::byte* m_End = nullptr;
+    size_t m_UsedBefore = 0;        // bytes used in blocks before the current one
+    size_t m_Capacity = 0;
+    size_t m_HighWater = 0;
+    size_t m_UpstreamAllocations = 0;
+};
+
+// Containers for the frame path. Construct them with the arena, e.g.
+// FrameVector<uint32_t> visible(&Renderer::GetFrameArena());
+template<typename T>
+using FrameVector = std::pmr::vector<T>;
+using FrameString = std::pmr::string;
+
+} // namespace EasyLine
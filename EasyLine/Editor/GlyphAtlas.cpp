@@ -0,0 +1,208 @@
+#include "GlyphAtlas.h"
+#include "Checksum.h"
+#include "FileWriter.h"
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// ImGui ships stb_truetype but compiles it static into its own translation
+// unit, so we take our own private copy of the implementation
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imgui/imstb_truetype.h"
+
+namespace EasyLine {
+
+namespace {
+
+constexpr int kAtlasWidth = 512;
+constexpr int kPadding = 2;     // blank texels around every glyph
+constexpr int kSolidSize = 4;   // side of the block that is inside everywhere
+constexpr uint8_t kOnEdge = 128;
+
+// Cache file: the header, then the glyph metrics and the pixels
+constexpr char kCacheMagic[4] = { 'E', 'L', 'G', 'A' };
+constexpr uint32_t kCacheVersion = 1;
+
+struct CacheHeader {
+    char Magic[4];
+    uint32_t Version;
+    uint32_t PixelHeight;
+    uint32_t Spread;
+    uint32_t GlyphCount;
+    uint32_t MetricsSize;   // sizeof(GlyphMetrics) of the build that wrote it
+    uint64_t FontChecksum;
+    int32_t Width, Height;
+    float SolidUv[2];
+    uint64_t DataChecksum;  // of the metrics and pixels
+};
+
+struct GlyphBitmap {
+    unsigned char* Pixels = nullptr;
+    int Width = 0, Height = 0, OffsetX = 0, OffsetY = 0;
+    int X = 0, Y = 0;   // place in the atlas
+};
+
+bool ReadBytes(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in) return false;
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+} // namespace
+
+bool GlyphAtlas::Build(const std::string& fontPath, int pixelHeight, const std::string& cachePath) {
+    Clear();
+    std::vector<unsigned char> font;
+    if (!ReadBytes(fontPath, font)) {
+        EL_CORE_ERROR("Failed to open font: {}", fontPath);
+        return false;
+    }
+    Checksum checksum;
+    checksum.Update(font.data(), font.size());
+    if (!cachePath.empty() && LoadCache(cachePath, checksum.Get(), pixelHeight)) return true;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!Generate(font, pixelHeight)) {
+        EL_CORE_ERROR("Not a TrueType font: {}", fontPath);
+        return false;
+    }
+    EL_CORE_INFO("Glyph atlas of {} at {} px: {} x {} in {:.0f} ms", fontPath, pixelHeight, m_Width, m_Height,
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    if (!cachePath.empty()) WriteCache(cachePath, checksum.Get(), pixelHeight);
+    return true;
+}
+
+bool GlyphAtlas::Generate(const std::vector<unsigned char>& data, int pixelHeight) {
+    stbtt_fontinfo font;
+    const int offset = data.empty() ? -1 : stbtt_GetFontOffsetForIndex(data.data(), 0);
+    if (offset < 0 || !stbtt_InitFont(&font, data.data(), offset)) return false;
+    const float scale = stbtt_ScaleForPixelHeight(&font, (float)pixelHeight);
+
+    // Distance fields of every glyph, kSpread pixels past its outline, then
+    // packed on shelves after the solid block
+    const uint32_t glyphCount = kLastCodepoint - kFirstCodepoint + 1;
+    std::vector<GlyphBitmap> bitmaps(glyphCount);
+    for (uint32_t i = 0; i < glyphCount; i++) {
+        GlyphBitmap& bitmap = bitmaps[i];
+        bitmap.Pixels = stbtt_GetCodepointSDF(&font, scale, (int)(kFirstCodepoint + i), kSpread, kOnEdge, (float)kOnEdge / kSpread,
+            &bitmap.Width, &bitmap.Height, &bitmap.OffsetX, &bitmap.OffsetY);
+    }
+    int x = kPadding + kSolidSize + kPadding, y = kPadding, shelfHeight = kSolidSize;
+    for (GlyphBitmap& bitmap : bitmaps) {
+        if (!bitmap.Pixels) continue;
+        if (x + bitmap.Width + kPadding > kAtlasWidth) {
+            x = kPadding;
+            y += shelfHeight + kPadding;
+            shelfHeight = 0;
+        }
+        bitmap.X = x;
+        bitmap.Y = y;
+        x += bitmap.Width + kPadding;
+        shelfHeight = std::max(shelfHeight, bitmap.Height);
+    }
+    m_Width = kAtlasWidth;
+    m_Height = y + shelfHeight + kPadding;
+    m_Pixels.assign((size_t)m_Width * m_Height, 0);
+    for (int row = 0; row < kSolidSize; row++)
+        std::fill_n(m_Pixels.begin() + (size_t)(kPadding + row) * m_Width + kPadding, kSolidSize, (uint8_t)255);
+    m_SolidUv = glm::vec2(kPadding + kSolidSize * 0.5f) / glm::vec2((float)m_Width, (float)m_Height);
+
+    const glm::vec2 texel = 1.0f / glm::vec2((float)m_Width, (float)m_Height);
+    const float unit = 1.0f / pixelHeight;
+    m_Glyphs.resize(glyphCount);
+    for (uint32_t i = 0; i < glyphCount; i++) {
+        GlyphBitmap& bitmap = bitmaps[i];
+        GlyphMetrics& glyph = m_Glyphs[i];
+        int advance = 0, bearing = 0;
+        stbtt_GetCodepointHMetrics(&font, (int)(kFirstCodepoint + i), &advance, &bearing);
+        glyph.Advance = advance * scale * unit;
+        if (!bitmap.Pixels) continue;
+        for (int row = 0; row < bitmap.Height; row++)
+            std::copy_n(bitmap.Pixels + row * bitmap.Width, bitmap.Width, m_Pixels.begin() + (size_t)(bitmap.Y + row) * m_Width + bitmap.X);
+        stbtt_FreeSDF(bitmap.Pixels, nullptr);
+        // bitmap rows run down from OffsetY above the baseline; the quad
+        // takes in the spread around the outline
+        glyph.Min = glm::vec2((float)bitmap.OffsetX, (float)-(bitmap.OffsetY + bitmap.Height)) * unit;
+        glyph.Max = glm::vec2((float)(bitmap.OffsetX + bitmap.Width), (float)-bitmap.OffsetY) * unit;
+        glyph.UvMin = glm::vec2((float)bitmap.X, (float)(bitmap.Y + bitmap.Height)) * texel;
+        glyph.UvMax = glm::vec2((float)(bitmap.X + bitmap.Width), (float)bitmap.Y) * texel;
+    }
+    return true;
+}
+
+bool GlyphAtlas::LoadCache(const std::string& path, uint64_t fontChecksum, int pixelHeight) {
+    std::vector<unsigned char> bytes;
+    if (!ReadBytes(path, bytes)) return false;
+    CacheHeader header;
+    if (bytes.size() < sizeof(header)) return false;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    const uint32_t glyphCount = kLastCodepoint - kFirstCodepoint + 1;
+    if (std::memcmp(header.Magic, kCacheMagic, 4) != 0 || header.Version != kCacheVersion || header.PixelHeight != (uint32_t)pixelHeight ||
+        header.Spread != (uint32_t)kSpread || header.GlyphCount != glyphCount || header.MetricsSize != sizeof(GlyphMetrics) ||
+        header.FontChecksum != fontChecksum || header.Width <= 0 || header.Height <= 0) {
+        EL_CORE_INFO("Glyph atlas cache {} is for another font or size, rebuilding it", path);
+        return false;
+    }
+    const size_t metricsSize = glyphCount * sizeof(GlyphMetrics);
+    const size_t pixelCount = (size_t)header.Width * header.Height;
+    Checksum checksum;
+    if (bytes.size() == sizeof(header) + metricsSize + pixelCount) checksum.Update(bytes.data() + sizeof(header), metricsSize + pixelCount);
+    if (bytes.size() != sizeof(header) + metricsSize + pixelCount || checksum.Get() != header.DataChecksum) {
+        EL_CORE_WARN("Glyph atlas cache {} is damaged, rebuilding it", path);
+        return false;
+    }
+    m_Glyphs.resize(glyphCount);
+    std::memcpy(m_Glyphs.data(), bytes.data() + sizeof(header), metricsSize);
+    m_Pixels.assign(bytes.begin() + sizeof(header) + metricsSize, bytes.end());
+    m_Width = header.Width;
+    m_Height = header.Height;
+    m_SolidUv = { header.SolidUv[0], header.SolidUv[1] };
+    return true;
+}
+
+void GlyphAtlas::WriteCache(const std::string& path, uint64_t fontChecksum, int pixelHeight) const {
+    CacheHeader header = {};
+    std::memcpy(header.Magic, kCacheMagic, 4);
+    header.Version = kCacheVersion;
+    header.PixelHeight = (uint32_t)pixelHeight;
+    header.Spread = (uint32_t)kSpread;
+    header.GlyphCount = (uint32_t)m_Glyphs.size();
+    header.MetricsSize = sizeof(GlyphMetrics);
+    header.FontChecksum = fontChecksum;
+    header.Width = m_Width;
+    header.Height = m_Height;
+    header.SolidUv[0] = m_SolidUv.x;
+    header.SolidUv[1] = m_SolidUv.y;
+    // the checksum runs over the metrics and pixels as one stream, as LoadCache reads them
+    std::vector<unsigned char> data(m_Glyphs.size() * sizeof(GlyphMetrics) + m_Pixels.size());
+    std::memcpy(data.data(), m_Glyphs.data(), m_Glyphs.size() * sizeof(GlyphMetrics));
+    std::memcpy(data.data() + m_Glyphs.size() * sizeof(GlyphMetrics), m_Pixels.data(), m_Pixels.size());
+    Checksum checksum;
+    checksum.Update(data.data(), data.size());
+    header.DataChecksum = checksum.Get();
+
+    // a failed write only costs computing the atlas again next time
+    FileWriter out;
+    if (!out.Open(path)) return;
+    out.Write(&header, sizeof(header));
+    out.Write(data.data(), data.size());
+    if (!out.Close()) EL_CORE_WARN("Failed to write the glyph atlas cache {}", path);
+}
+
+void GlyphAtlas::Clear() {
+    m_Glyphs.clear();
+    m_Pixels.clear();
+    m_Width = m_Height = 0;
+}
+
+const GlyphMetrics* GlyphAtlas::GetGlyph(uint32_t codepoint) const {
+    if (codepoint < kFirstCodepoint || codepoint - kFirstCodepoint >= m_Glyphs.size()) return nullptr;
+    return &m_Glyphs[codepoint - kFirstCodepoint];
+}
+
+} // namespace EasyLine
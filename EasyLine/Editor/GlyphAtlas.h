@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace EasyLine {
+
+// Where a glyph's quad goes and what it samples. Positions are in units of
+// the font's pixel height, from the pen position on the baseline, y up;
+// UvMin is the quad's bottom left corner in the atlas, UvMax its top right.
+struct GlyphMetrics {
+    glm::vec2 Min = { 0.0f, 0.0f };
+    glm::vec2 Max = { 0.0f, 0.0f };
+    glm::vec2 UvMin = { 0.0f, 0.0f };
+    glm::vec2 UvMax = { 0.0f, 0.0f };
+    float Advance = 0.0f;
+};
+
+// Printable ASCII of a TrueType font as signed distance fields in one
+// single-channel texture. A texel holds the distance to the nearest outline,
+// 0.5 on the outline itself and growing inwards, over kSpread pixels of the
+// rasterized size either side. Sampled with linear filtering and cut at 0.5,
+// that gives sharp edges at any magnification from one atlas, where a
+// coverage bitmap would blur; the shader antialiases over one screen pixel.
+//
+// Glyphs are packed on shelves with a blank border so filtering does not
+// bleed between them, and a small block at the far inside value lets strokes
+// be drawn from the same texture as the text. The distance fields take a
+// while to compute, so Build() can keep the atlas in a cache file, checked
+// against the font's checksum, and load it from there next time.
+class GlyphAtlas {
+public:
+    static constexpr uint32_t kFirstCodepoint = 32;
+    static constexpr uint32_t kLastCodepoint = 126;
+    static constexpr int kSpread = 8;
+
+    // Distance fields of the font at pixelHeight, from cachePath when that
+    // holds them for this font and size, otherwise computed and written
+    // there. No cache with an empty path. Returns false if the font cannot
+    // be read.
+    bool Build(const std::string& fontPath, int pixelHeight, const std::string& cachePath = std::string());
+    void Clear();
+    bool IsValid() const { return !m_Pixels.empty(); }
+
+    // nullptr for codepoints the atlas does not have
+    const GlyphMetrics* GetGlyph(uint32_t codepoint) const;
+    // Texel at the middle of the block that is inside everywhere
+    const glm::vec2& GetSolidUv() const { return m_SolidUv; }
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    // GetWidth() * GetHeight() bytes, top row first
+    const uint8_t* GetPixels() const { return m_Pixels.data(); }
+
+private:
+    bool Generate(const std::vector<unsigned char>& font, int pixelHeight);
+    bool LoadCache(const std::string& path, uint64_t fontChecksum, int pixelHeight);
+    void WriteCache(const std::string& path, uint64_t fontChecksum, int pixelHeight) const;
+
+    std::vector<GlyphMetrics> m_Glyphs;
+    std::vector<uint8_t> m_Pixels;
+    int m_Width = 0, m_Height = 0;
+    glm::vec2 m_SolidUv = { 0.0f, 0.0f };
+};
+
+} // namespace EasyLine
@@ -0,0 +1,225 @@
+#include "JobSystem.h"
+#include "Log.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace EasyLine {
+
+namespace {
+
+struct Job {
+    void (*Function)(const void* data, size_t begin, size_t end) = nullptr;
+    const void* Data = nullptr;
+    size_t Begin = 0, End = 0;
+    JobCounter* Counter = nullptr;
+};
+
+// Owner works at the back, thieves take from the front. Jobs here are coarse
+// (a chunk of lines, a file slice), so a plain lock per deque is cheap enough.
+class WorkQueue {
+public:
+    void Push(const Job& job) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Jobs.push_back(job);
+    }
+
+    bool Pop(Job& job) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Jobs.empty()) return false;
+        job = m_Jobs.back();
+        m_Jobs.pop_back();
+        return true;
+    }
+
+    bool Steal(Job& job) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Jobs.empty()) return false;
+        job = m_Jobs.front();
+        m_Jobs.pop_front();
+        return true;
+    }
+
+    // Take the oldest job that belongs to counter
+    bool StealFor(const JobCounter* counter, Job& job) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (auto it = m_Jobs.begin(); it != m_Jobs.end(); ++it) {
+            if (it->Counter != counter) continue;
+            job = *it;
+            m_Jobs.erase(it);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    std::mutex m_Mutex;
+    std::deque<Job> m_Jobs;
+};
+
+} // namespace
+
+static std::vector<std::thread> g_workers;
+static std::vector<std::unique_ptr<WorkQueue>> g_queues;   // one per worker
+static WorkQueue g_injectQueue;                            // jobs from non-worker threads
+static std::atomic<size_t> g_queuedJobs{0};
+static std::atomic<bool> g_running{false};
+static std::mutex g_sleepMutex;
+static std::condition_variable g_wake;
+static thread_local int t_workerIndex = -1;
+
+static void Execute(const Job& job) {
+    job.Function(job.Data, job.Begin, job.End);
+    if (job.Counter) job.Counter->Pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+static void Push(const Job& job) {
+    g_queuedJobs.fetch_add(1, std::memory_order_acq_rel);
+    if (t_workerIndex >= 0) g_queues[t_workerIndex]->Push(job);
+    else g_injectQueue.Push(job);
+}
+
+static void WakeWorkers(bool all) {
+    // take the lock so a worker between its predicate check and wait() cannot miss this
+    { std::lock_guard<std::mutex> lock(g_sleepMutex); }
+    if (all) g_wake.notify_all();
+    else g_wake.notify_one();
+}
+
+static bool TryGetJob(Job& job) {
+    const int self = t_workerIndex;
+    bool found = (self >= 0 && g_queues[self]->Pop(job)) || g_injectQueue.Steal(job);
+
+    if (!found) {
+        const size_t n = g_queues.size();
+        const size_t start = self >= 0 ? (size_t)self + 1 : 0;
+        for (size_t i = 0; i < n && !found; i++) {
+            size_t victim = (start + i) % n;
+            if ((int)victim != self) found = g_queues[victim]->Steal(job);
+        }
+    }
+
+    if (found) g_queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+    return found;
+}
+
+static void WorkerMain(int index) {
+    t_workerIndex = index;
+    for (;;) {
+        Job job;
+        if (TryGetJob(job)) {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(g_sleepMutex);
+        g_wake.wait(lock, [] { return g_queuedJobs.load(std::memory_order_acquire) > 0 || !g_running.load(); });
+        if (!g_running.load() && g_queuedJobs.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
+
+void JobSystem::Init(uint32_t workerCount) {
+    if (g_running.load()) return;
+
+    if (workerCount == 0) {
+        uint32_t hw = std::thread::hardware_concurrency();
+        workerCount = hw > 1 ? hw - 1 : 1;
+    }
+
+    g_running = true;
+    g_queues.clear();
+    for (uint32_t i = 0; i < workerCount; i++)
+        g_queues.push_back(std::make_unique<WorkQueue>());
+    for (uint32_t i = 0; i < workerCount; i++)
+        g_workers.emplace_back(WorkerMain, (int)i);
+
+    EL_CORE_INFO("Job system started with {} workers", workerCount);
+}
+
+void JobSystem::Shutdown() {
+    if (!g_running.load()) return;
+
+    g_running = false;
+    WakeWorkers(true);
+    for (std::thread& worker : g_workers)
+        worker.join();
+    g_workers.clear();
+    g_queues.clear();
+}
+
+uint32_t JobSystem::GetWorkerCount() {
+    return (uint32_t)g_workers.size();
+}
+
+void JobSystem::Run(std::function<void()> job, JobCounter* counter) {
+    if (!g_running.load()) {
+        job();
+        return;
+    }
+
+    if (counter) counter->Pending.fetch_add(1, std::memory_order_acq_rel);
+
+    Job j;
+    j.Function = [](const void* data, size_t, size_t) {
+        auto* fn = (std::function<void()>*)data;
+        (*fn)();
+        delete fn;
+    };
+    j.Data = new std::function<void()>(std::move(job));
+    j.Counter = counter;
+    Push(j);
+    WakeWorkers(false);
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    while (!counter.IsDone()) {
+        Job job;
+        bool found = false;
+        if (t_workerIndex >= 0) {
+            found = TryGetJob(job);
+        } else if (g_injectQueue.StealFor(&counter, job)) {
+            g_queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+            found = true;
+        }
+
+        if (found) Execute(job);
+        else std::this_thread::yield();
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    const size_t ranges = (count + grain - 1) / grain;
+    if (!g_running.load() || ranges == 1) {
+        body(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    counter.Pending.store((uint32_t)(ranges - 1), std::memory_order_release);
+
+    Job job;
+    job.Function = [](const void* data, size_t begin, size_t end) {
+        (*(const std::function<void(size_t, size_t)>*)data)(begin, end);
+    };
+    job.Data = &body;
+    job.Counter = &counter;
+    for (size_t r = 1; r < ranges; r++) {
+        job.Begin = r * grain;
+        job.End = std::min(count, job.Begin + grain);
+        Push(job);
+    }
+    WakeWorkers(true);
+
+    // the caller takes the first range itself, then helps with the rest
+    body(0, std::min(count, grain));
+    Wait(counter);
+}
+
+} // namespace EasyLine
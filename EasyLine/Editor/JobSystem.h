@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace EasyLine {
+
+// Tracks a group of jobs; JobSystem::Wait() returns once all of them finished.
+struct JobCounter {
+    std::atomic<uint32_t> Pending{0};
+
+    bool IsDone() const { return Pending.load(std::memory_order_acquire) == 0; }
+};
+
+// Fixed pool of worker threads with one work-stealing deque per worker.
+//
+// A worker pushes and pops jobs at the back of its own deque (LIFO, cache
+// friendly) and, when that runs dry, steals from the front of the others.
+// Jobs submitted from non-worker threads (the GL/main thread) go to a shared
+// injection queue. Threads that Wait() on a counter run jobs instead of
+// blocking, so nested ParallelFor calls cannot deadlock the pool. Workers help
+// with anything; non-worker threads only run jobs of the counter they wait
+// on, so a frame never picks up a long background job such as file loading.
+class JobSystem {
+public:
+    // workerCount == 0 uses hardware_concurrency() - 1 (the main thread helps while waiting)
+    static void Init(uint32_t workerCount = 0);
+    static void Shutdown();
+
+    static uint32_t GetWorkerCount();
+
+    // Queue a job. If counter is given it is incremented now and decremented when the job finished.
+    static void Run(std::function<void()> job, JobCounter* counter = nullptr);
+    // Block until counter reaches zero, executing queued jobs in the meantime.
+    static void Wait(JobCounter& counter);
+
+    // Run body(begin, end) over [0, count) split into ranges of at most `grain`
+    // items, and return once every range is done. Runs inline when the pool is
+    // not initialized or there is only one range.
+    static void ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body);
+};
+
+} // namespace EasyLine
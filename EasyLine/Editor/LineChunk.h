@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include "AABB.h"
+
+namespace EasyLine {
+
+// Identifies a line by its chunk and slot: (chunk << LineChunk::kShift) | slot.
+using LineHandle = uint32_t;
+
+// Fixed-capacity block of lines stored as structure-of-arrays, so culling,
+// tessellation and SIMD kernels stream only the fields they need.
+// Chunks are the unit of parallel work and of per-chunk caching.
+struct LineChunk {
+    static constexpr uint32_t kShift = 12;
+    static constexpr uint32_t kCapacity = 1u << kShift;
+
+    uint32_t Count = 0;         // slots in use, including deleted ones
+    uint32_t DeletedCount = 0;
+    uint32_t Version = 0;   // bumped on every change, lets caches (spatial index, GPU) spot stale chunks
+    AABB Bounds;            // of the lines' endpoints, not inflated by thickness
+    float MaxThickness = 0.0f;
+
+    float X0[kCapacity];
+    float Y0[kCapacity];
+    float X1[kCapacity];
+    float Y1[kCapacity];
+    float Thickness[kCapacity];
+    uint32_t Color[kCapacity];  // PackColor()
+    // Deleted lines keep their slot (so handles stay stable) and are skipped
+    // by drawing, queries and export. One bit per slot.
+    uint32_t Deleted[kCapacity / 32] = {};
+
+    bool IsFull() const { return Count == kCapacity; }
+    bool IsDeleted(uint32_t slot) const { return (Deleted[slot >> 5] >> (slot & 31)) & 1u; }
+};
+
+inline LineHandle MakeLineHandle(uint32_t chunk, uint32_t slot) { return (chunk << LineChunk::kShift) | slot; }
+inline uint32_t GetHandleChunk(LineHandle handle) { return handle >> LineChunk::kShift; }
+inline uint32_t GetHandleSlot(LineHandle handle) { return handle & (LineChunk::kCapacity - 1); }
+
+} // namespace EasyLine
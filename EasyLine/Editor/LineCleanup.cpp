@@ -0,0 +1,296 @@
+#include "LineCleanup.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "Log.h"
+#include "UndoHistory.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace EasyLine {
+
+namespace {
+
+// Grid steps across the drawing; keeps the line keys' products within 64 bits
+constexpr double kMaxSteps = (double)(1 << 30);
+// Lines per job when gathering and hashing
+constexpr size_t kBlockSize = 1 << 16;
+// Line keys are hashed into this many buckets, sorted independently
+constexpr size_t kBucketCount = 1024;
+constexpr uint32_t kEmptySlot = UINT32_MAX;
+
+// A line with its ends on the grid, the lower end (by x, then y) first
+struct Entry {
+    int32_t X0, Y0, X1, Y1;
+    uint32_t Color;
+    uint32_t Thickness;     // bits of the float, so only equal thicknesses match
+    LineHandle Handle;
+    bool Flipped;           // the line's P0 is the upper end
+    uint64_t Hash;
+};
+
+// A line on its grid line: the key, then the span along it
+struct Span {
+    int64_t Dx, Dy, Offset;
+    uint32_t Color, Thickness;
+    int64_t T0, T1;
+    uint32_t Entry;
+};
+
+bool IsSameLine(const Span& a, const Span& b) {
+    return a.Dx == b.Dx && a.Dy == b.Dy && a.Offset == b.Offset && a.Color == b.Color && a.Thickness == b.Thickness;
+}
+
+bool IsSameEntry(const Entry& a, const Entry& b) {
+    return a.X0 == b.X0 && a.Y0 == b.Y0 && a.X1 == b.X1 && a.Y1 == b.Y1 && a.Color == b.Color && a.Thickness == b.Thickness;
+}
+
+uint64_t Mix(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    return key ^ (key >> 33);
+}
+
+uint64_t Combine(uint64_t hash, uint64_t value) {
+    return Mix(hash ^ (value + 0x9e3779b97f4a7c15ull + (hash << 6)));
+}
+
+template<typename Fn>
+void ForEachBlock(size_t count, Fn&& body) {
+    JobSystem::ParallelFor((count + kBlockSize - 1) / kBlockSize, 1, [&](size_t first, size_t last) {
+        for (size_t block = first; block < last; block++)
+            body(block * kBlockSize, std::min(count, (block + 1) * kBlockSize));
+    });
+}
+
+// Open-addressing set of entries, filled by all threads at once. Each slot
+// ends up holding the smallest index of the entries equal to it.
+class DuplicateTable {
+public:
+    DuplicateTable(const std::vector<Entry>& entries)
+        : m_Entries(entries), m_Mask(std::bit_ceil(std::max<size_t>(entries.size() * 2, 16)) - 1), m_Slots(new std::atomic<uint32_t>[m_Mask + 1]) {
+        ForEachBlock(m_Mask + 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) m_Slots[i].store(kEmptySlot, std::memory_order_relaxed);
+        });
+    }
+
+    void Insert(uint32_t index) {
+        const Entry& entry = m_Entries[index];
+        for (size_t slot = entry.Hash & m_Mask;; slot = (slot + 1) & m_Mask) {
+            uint32_t current = m_Slots[slot].load(std::memory_order_relaxed);
+            if (current == kEmptySlot && m_Slots[slot].compare_exchange_strong(current, index, std::memory_order_relaxed)) return;
+            // the slot is taken, by now if not before: keep the smaller of equal entries
+            if (!IsSameEntry(m_Entries[current], entry)) continue;
+            while (index < current && !m_Slots[slot].compare_exchange_weak(current, index, std::memory_order_relaxed)) {}
+            return;
+        }
+    }
+
+    // The first entry equal to index. Only once all inserts are done.
+    uint32_t Find(uint32_t index) const {
+        const Entry& entry = m_Entries[index];
+        for (size_t slot = entry.Hash & m_Mask;; slot = (slot + 1) & m_Mask) {
+            const uint32_t current = m_Slots[slot].load(std::memory_order_relaxed);
+            if (IsSameEntry(m_Entries[current], entry)) return current;
+        }
+    }
+
+private:
+    const std::vector<Entry>& m_Entries;
+    size_t m_Mask;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_Slots;
+};
+
+} // namespace
+
+CleanupResult RemoveOverkill(LineDocument& document, float tolerance) {
+    CleanupResult result;
+    const AABB& bounds = document.GetBounds();
+    if (bounds.IsEmpty()) return result;
+
+    // the grid, coarsened if the drawing is too wide for it
+    const glm::dvec2 origin = glm::dvec2(bounds.Min);
+    const double span = std::max(bounds.GetSize().x, bounds.GetSize().y);
+    double step = std::max((double)tolerance, span / kMaxSteps);
+    if (!(step > 0.0)) step = std::max(span, 1.0) / kMaxSteps;
+    if (step > tolerance && tolerance > 0.0f) EL_CORE_WARN("Overkill: the drawing is too large for a tolerance of {}, using {}", tolerance, step);
+
+    // entries in handle order, lines with an end that is not finite left out
+    const size_t chunkCount = document.GetChunkCount();
+    std::vector<size_t> chunkFirst(chunkCount + 1, 0);
+    for (size_t c = 0; c < chunkCount; c++) {
+        const LineChunk& chunk = document.GetChunk(c);
+        chunkFirst[c + 1] = chunkFirst[c] + chunk.Count - chunk.DeletedCount;
+    }
+    std::vector<Entry> entries(chunkFirst.back());
+    std::vector<uint8_t> valid(entries.size(), 0);
+    JobSystem::ParallelFor(chunkCount, 8, [&](size_t begin, size_t end) {
+        auto quantize = [&](float value, double low) {
+            return (int32_t)std::clamp(std::round((value - low) / step), 0.0, kMaxSteps);
+        };
+        for (size_t c = begin; c < end; c++) {
+            const LineChunk& chunk = document.GetChunk(c);
+            size_t index = chunkFirst[c];
+            for (uint32_t slot = 0; slot < chunk.Count; slot++) {
+                if (chunk.DeletedCount > 0 && chunk.IsDeleted(slot)) continue;
+                Entry& entry = entries[index];
+                const bool finite = std::isfinite(chunk.X0[slot]) && std::isfinite(chunk.Y0[slot]) && std::isfinite(chunk.X1[slot]) && std::isfinite(chunk.Y1[slot]);
+                valid[index++] = finite;
+                if (!finite) continue;
+                int32_t x0 = quantize(chunk.X0[slot], origin.x), y0 = quantize(chunk.Y0[slot], origin.y);
+                int32_t x1 = quantize(chunk.X1[slot], origin.x), y1 = quantize(chunk.Y1[slot], origin.y);
+                entry.Flipped = x1 < x0 || (x1 == x0 && y1 < y0);
+                if (entry.Flipped) {
+                    std::swap(x0, x1);
+                    std::swap(y0, y1);
+                }
+                entry.X0 = x0;
+                entry.Y0 = y0;
+                entry.X1 = x1;
+                entry.Y1 = y1;
+                entry.Color = chunk.Color[slot];
+                std::memcpy(&entry.Thickness, &chunk.Thickness[slot], sizeof(entry.Thickness));
+                entry.Handle = MakeLineHandle((uint32_t)c, slot);
+                uint64_t hash = Mix(((uint64_t)(uint32_t)x0 << 32) | (uint32_t)y0);
+                hash = Combine(hash, ((uint64_t)(uint32_t)x1 << 32) | (uint32_t)y1);
+                entry.Hash = Combine(hash, ((uint64_t)entry.Color << 32) | entry.Thickness);
+            }
+        }
+    });
+
+    // exact duplicates: everything after the first of its kind goes
+    std::vector<uint8_t> removed(entries.size(), 0);
+    {
+        DuplicateTable table(entries);
+        ForEachBlock(entries.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                if (valid[i]) table.Insert((uint32_t)i);
+        });
+        ForEachBlock(entries.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                if (valid[i]) removed[i] = table.Find((uint32_t)i) != i;
+        });
+    }
+    result.Duplicates = (size_t)std::count(removed.begin(), removed.end(), (uint8_t)1);
+
+    // the others on their grid lines, bucketed by key
+    std::vector<Span> spans(entries.size());
+    std::vector<uint32_t> bucketOf(entries.size(), UINT32_MAX);
+    ForEachBlock(entries.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Entry& entry = entries[i];
+            if (!valid[i] || removed[i] || (entry.X0 == entry.X1 && entry.Y0 == entry.Y1)) continue;
+            int64_t dx = (int64_t)entry.X1 - entry.X0, dy = (int64_t)entry.Y1 - entry.Y0;
+            const int64_t divisor = std::gcd(dx, dy);
+            dx /= divisor;
+            dy /= divisor;
+            Span& s = spans[i];
+            s.Dx = dx;
+            s.Dy = dy;
+            s.Offset = dx * entry.Y0 - dy * entry.X0;
+            s.Color = entry.Color;
+            s.Thickness = entry.Thickness;
+            // along the axis the line runs more along, increasing from end 0 to end 1
+            if (dx >= std::abs(dy)) {
+                s.T0 = entry.X0;
+                s.T1 = entry.X1;
+            } else {
+                s.T0 = dy > 0 ? entry.Y0 : -(int64_t)entry.Y0;
+                s.T1 = dy > 0 ? entry.Y1 : -(int64_t)entry.Y1;
+            }
+            s.Entry = (uint32_t)i;
+            uint64_t hash = Combine(Mix((uint64_t)dx), (uint64_t)dy);
+            hash = Combine(hash, (uint64_t)s.Offset);
+            bucketOf[i] = (uint32_t)(Combine(hash, ((uint64_t)s.Color << 32) | s.Thickness) % kBucketCount);
+        }
+    });
+    std::vector<size_t> bucketFirst(kBucketCount + 1, 0);
+    for (uint32_t bucket : bucketOf)
+        if (bucket != UINT32_MAX) bucketFirst[bucket + 1]++;
+    std::partial_sum(bucketFirst.begin(), bucketFirst.end(), bucketFirst.begin());
+    std::vector<Span> sorted(bucketFirst.back());
+    {
+        std::vector<size_t> cursor(bucketFirst.begin(), bucketFirst.end() - 1);
+        for (size_t i = 0; i < entries.size(); i++)
+            if (bucketOf[i] != UINT32_MAX) sorted[cursor[bucketOf[i]]++] = spans[i];
+    }
+    spans = {};
+    bucketOf = {};
+
+    // Sort each bucket along its lines and merge the overlapping runs. The
+    // first line of a run keeps its start; if another reaches further, the
+    // first is stretched to that one's far end.
+    struct Stretch {
+        uint32_t Entry, Far;
+    };
+    std::vector<std::vector<Stretch>> stretches(kBucketCount);
+    JobSystem::ParallelFor(kBucketCount, 16, [&](size_t begin, size_t end) {
+        for (size_t bucket = begin; bucket < end; bucket++) {
+            Span* first = sorted.data() + bucketFirst[bucket];
+            Span* last = sorted.data() + bucketFirst[bucket + 1];
+            std::sort(first, last, [](const Span& a, const Span& b) {
+                if (a.Dx != b.Dx) return a.Dx < b.Dx;
+                if (a.Dy != b.Dy) return a.Dy < b.Dy;
+                if (a.Offset != b.Offset) return a.Offset < b.Offset;
+                if (a.Color != b.Color) return a.Color < b.Color;
+                if (a.Thickness != b.Thickness) return a.Thickness < b.Thickness;
+                if (a.T0 != b.T0) return a.T0 < b.T0;
+                if (a.T1 != b.T1) return a.T1 > b.T1;
+                return a.Entry < b.Entry;
+            });
+            for (Span* run = first; run != last;) {
+                int64_t reach = run->T1;
+                uint32_t far = run->Entry;
+                Span* next = run + 1;
+                for (; next != last && IsSameLine(*next, *run) && next->T0 < reach; ++next) {
+                    removed[next->Entry] = 1;
+                    if (next->T1 > reach) {
+                        reach = next->T1;
+                        far = next->Entry;
+                    }
+                }
+                if (far != run->Entry) stretches[bucket].push_back({ run->Entry, far });
+                run = next;
+            }
+        }
+    });
+    sorted = {};
+    result.Overlaps = (size_t)std::count(removed.begin(), removed.end(), (uint8_t)1) - result.Duplicates;
+    if (result.GetRemovedCount() == 0) return result;
+
+    std::vector<Stretch> moves;
+    for (const std::vector<Stretch>& bucket : stretches) moves.insert(moves.end(), bucket.begin(), bucket.end());
+    std::sort(moves.begin(), moves.end(), [](const Stretch& a, const Stretch& b) { return a.Entry < b.Entry; });
+    result.Extended = moves.size();
+
+    // the line's own end at grid end 0 or 1
+    auto endOf = [&](const Entry& entry, int end) {
+        const LineChunk& chunk = document.GetChunk(GetHandleChunk(entry.Handle));
+        const uint32_t slot = GetHandleSlot(entry.Handle);
+        return (end == 0) != entry.Flipped ? glm::vec2(chunk.X0[slot], chunk.Y0[slot]) : glm::vec2(chunk.X1[slot], chunk.Y1[slot]);
+    };
+    UndoHistory* history = document.GetHistory();
+    if (history) history->BeginCommand("Overkill");
+    for (const Stretch& move : moves) {
+        const Entry& entry = entries[move.Entry];
+        const glm::vec2 start = endOf(entry, 0), reach = endOf(entries[move.Far], 1);
+        if (entry.Flipped) document.MoveLine(entry.Handle, reach, start);
+        else document.MoveLine(entry.Handle, start, reach);
+    }
+    for (size_t i = 0; i < entries.size(); i++)
+        if (removed[i]) document.RemoveLine(entries[i].Handle);
+    if (history) history->EndCommand();
+
+    EL_CORE_INFO("Overkill removed {} of {} lines ({} duplicates, {} overlapping)", result.GetRemovedCount(), entries.size(),
+        result.Duplicates, result.Overlaps);
+    return result;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+namespace EasyLine {
+
+class LineDocument;
+
+struct CleanupResult {
+    size_t Duplicates = 0;  // lines removed as copies of another, in either direction
+    size_t Overlaps = 0;    // lines removed because a collinear one they overlapped took them in
+    size_t Extended = 0;    // lines lengthened to cover what they took in
+
+    size_t GetRemovedCount() const { return Duplicates + Overlaps; }
+};
+
+// Overkill: remove duplicate lines and merge collinear overlapping ones, as
+// imported CAD drawings are full of both.
+//
+// Endpoints are quantized to a grid of tolerance, so lines count as the same
+// when their ends round to the same grid points. Exact duplicates are found
+// with a hash filled by all threads at once and the first of each group in
+// handle order is kept. The remaining lines are keyed by the grid line they
+// lie on (reduced direction and offset, both exact integers) and sorted
+// along it, in buckets of keys on the job system; each run of lines that
+// overlap by more than a point becomes its first line, stretched over the
+// whole run. Lines only merge with lines of the same thickness and color,
+// so the drawing looks the same afterwards. Lines that merely touch end to
+// end are left alone.
+//
+// The edits are one undo step. Coordinates more than 2^30 tolerances across
+// the drawing coarsen the grid to fit.
+CleanupResult RemoveOverkill(LineDocument& document, float tolerance);
+
+} // namespace EasyLine
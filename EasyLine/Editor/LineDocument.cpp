@@ -0,0 +1,124 @@
+#include "LineDocument.h"
+#include "DocumentJournal.h"
+#include "MappedFile.h"
+#include "UndoHistory.h"
+
+namespace EasyLine {
+
+LineHandle LineDocument::AddLine(const glm::vec2& p0, const glm::vec2& p1, float thickness, const Color& color) {
+    if (m_Chunks.IsEmpty() || m_Chunks[m_Chunks.GetSize() - 1]->IsFull())
+        m_Chunks.GetMutable().push_back(std::make_shared<LineChunk>());
+
+    const uint32_t chunkIndex = (uint32_t)m_Chunks.GetSize() - 1;
+    LineChunk& chunk = GetMutableChunk(chunkIndex);
+    const uint32_t slot = chunk.Count++;
+
+    chunk.X0[slot] = p0.x;
+    chunk.Y0[slot] = p0.y;
+    chunk.X1[slot] = p1.x;
+    chunk.Y1[slot] = p1.y;
+    chunk.Thickness[slot] = thickness;
+    chunk.Color[slot] = PackColor(color);
+
+    chunk.Bounds.Expand(p0);
+    chunk.Bounds.Expand(p1);
+    chunk.MaxThickness = std::max(chunk.MaxThickness, thickness);
+    chunk.Version++;
+    m_Bounds.Expand(chunk.Bounds);
+    m_LineCount++;
+    m_Revision++;
+
+    const LineHandle handle = MakeLineHandle(chunkIndex, slot);
+    if (m_Journal) m_Journal->RecordAdd(handle, chunk, slot);
+    if (m_History) m_History->RecordAdd(handle);
+    return handle;
+}
+
+void LineDocument::MoveLine(LineHandle handle, const glm::vec2& p0, const glm::vec2& p1) {
+    if (!IsLineValid(handle)) return;
+    LineChunk& chunk = GetMutableChunk(GetHandleChunk(handle));
+    const uint32_t slot = GetHandleSlot(handle);
+    if (m_History) m_History->RecordMove(handle, { chunk.X0[slot], chunk.Y0[slot] }, { chunk.X1[slot], chunk.Y1[slot] }, p0, p1);
+
+    chunk.X0[slot] = p0.x;
+    chunk.Y0[slot] = p0.y;
+    chunk.X1[slot] = p1.x;
+    chunk.Y1[slot] = p1.y;
+    // bounds only grow; they stay conservative when a line moves inwards
+    chunk.Bounds.Expand(p0);
+    chunk.Bounds.Expand(p1);
+    chunk.Version++;
+    m_Bounds.Expand(chunk.Bounds);
+    m_Revision++;
+
+    if (m_Journal) m_Journal->RecordMove(handle, p0, p1);
+}
+
+void LineDocument::RemoveLine(LineHandle handle) {
+    if (!IsLineValid(handle)) return;
+    LineChunk& chunk = GetMutableChunk(GetHandleChunk(handle));
+    const uint32_t slot = GetHandleSlot(handle);
+
+    chunk.Deleted[slot >> 5] |= 1u << (slot & 31);
+    chunk.DeletedCount++;
+    chunk.Version++;
+    m_LineCount--;
+    m_Revision++;
+
+    if (m_Journal) m_Journal->RecordRemove(handle);
+    if (m_History) m_History->RecordRemove(handle);
+}
+
+void LineDocument::RestoreLine(LineHandle handle) {
+    const uint32_t c = GetHandleChunk(handle);
+    const uint32_t slot = GetHandleSlot(handle);
+    if (c >= m_Chunks.GetSize() || slot >= m_Chunks[c]->Count || !m_Chunks[c]->IsDeleted(slot)) return;
+    LineChunk& chunk = GetMutableChunk(c);
+
+    chunk.Deleted[slot >> 5] &= ~(1u << (slot & 31));
+    chunk.DeletedCount--;
+    chunk.Version++;
+    m_LineCount++;
+    m_Revision++;
+
+    if (m_Journal) m_Journal->RecordRestore(handle);
+    if (m_History) m_History->RecordRestore(handle);
+}
+
+bool LineDocument::IsLineValid(LineHandle handle) const {
+    const uint32_t c = GetHandleChunk(handle);
+    if (c >= m_Chunks.GetSize()) return false;
+    const uint32_t slot = GetHandleSlot(handle);
+    return slot < m_Chunks[c]->Count && !m_Chunks[c]->IsDeleted(slot);
+}
+
+LineChunk& LineDocument::GetMutableChunk(uint32_t index) {
+    std::shared_ptr<LineChunk>& chunk = m_Chunks.GetMutable()[index];
+    if (chunk.use_count() > 1 || IsMapped(chunk)) chunk = std::make_shared<LineChunk>(*chunk);
+    return *chunk;
+}
+
+std::shared_ptr<const LineDocument> LineDocument::CreateSnapshot() const {
+    auto snapshot = std::make_shared<LineDocument>(*this);
+    snapshot->m_Journal = nullptr;
+    snapshot->m_History = nullptr;
+    return snapshot;
+}
+
+void LineDocument::AppendChunk(std::shared_ptr<LineChunk> chunk, std::shared_ptr<ChunkTree> tree) {
+    m_LineCount += chunk->Count - chunk->DeletedCount;
+    if (chunk->Count > 0) m_Bounds.Expand(chunk->Bounds);
+    m_Revision++;
+    m_Chunks.GetMutable().push_back(std::move(chunk));
+    if (tree) m_Index.SetTree(m_Chunks.GetSize() - 1, std::move(tree));
+}
+
+void LineDocument::Clear() {
+    m_Chunks.Clear();
+    m_Index.Clear();
+    m_LineCount = 0;
+    m_Bounds = AABB();
+    m_Revision++;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "AABB.h"
+#include "Color.h"
+#include "LineChunk.h"
+#include "SharedList.h"
+#include "SpatialIndex.h"
+
+namespace EasyLine {
+
+class DocumentJournal;
+class UndoHistory;
+
+// The editable drawing: an append-only list of line chunks in world
+// coordinates, plus the spatial index over them.
+//
+// Chunks are shared: a chunk may live in a memory-mapped file or be
+// referenced from elsewhere, so one is only modified in place while the
+// document is its sole owner and is copied first otherwise. The chunk list
+// is shared the same way, which is what makes snapshots O(1).
+class LineDocument {
+public:
+    LineHandle AddLine(const glm::vec2& p0, const glm::vec2& p1, float thickness, const Color& color);
+    // Move both endpoints of a line; thickness and color stay
+    void MoveLine(LineHandle handle, const glm::vec2& p0, const glm::vec2& p1);
+    // Delete a line. Its slot is kept as a tombstone, so other handles stay valid.
+    void RemoveLine(LineHandle handle);
+    // Bring a deleted line back under its old handle (undo of a delete, redo of an add)
+    void RestoreLine(LineHandle handle);
+    // True if handle names a line that exists and is not deleted
+    bool IsLineValid(LineHandle handle) const;
+    // Adopt a chunk filled elsewhere (e.g. by a loader thread), with its tree if one was built
+    void AppendChunk(std::shared_ptr<LineChunk> chunk, std::shared_ptr<ChunkTree> tree = nullptr);
+    void Clear();
+
+    size_t GetLineCount() const { return m_LineCount; }
+    size_t GetChunkCount() const { return m_Chunks.GetSize(); }
+    const LineChunk& GetChunk(size_t index) const { return *m_Chunks[index]; }
+    const AABB& GetBounds() const { return m_Bounds; }
+    // Increases with every change, so callers can tell whether anything changed since they last looked
+    uint64_t GetRevision() const { return m_Revision; }
+
+    // Rebuild index trees for chunks changed since the last call. Call once per frame.
+    void UpdateSpatialIndex() { m_Index.Update(*this); }
+    const SpatialIndex& GetSpatialIndex() const { return m_Index; }
+
+    // Edits are recorded into journal (nullptr to stop). Not owned.
+    void SetJournal(DocumentJournal* journal) { m_Journal = journal; }
+    DocumentJournal* GetJournal() const { return m_Journal; }
+    // Edits are also reported to history (nullptr to stop), which keeps what is needed to undo them. Not owned.
+    void SetHistory(UndoHistory* history) { m_History = history; }
+    UndoHistory* GetHistory() const { return m_History; }
+
+    // Read-only copy sharing all chunks and trees with this document, for
+    // saving on a worker thread while editing goes on. O(1): the first edit
+    // afterwards copies the chunk list (one pointer per chunk) and each edited
+    // chunk is copied once. Release it on the editing thread.
+    std::shared_ptr<const LineDocument> CreateSnapshot() const;
+
+    // Calls fn(handle) for every line whose endpoint box intersects rect. Chunks
+    // without an up-to-date tree are scanned linearly, so results are always exact.
+    template<typename Fn>
+    void QueryLines(const AABB& rect, Fn&& fn) const
+    {
+        for (uint32_t c = 0; c < (uint32_t)m_Chunks.GetSize(); c++) {
+            const LineChunk& chunk = *m_Chunks[c];
+            if (chunk.Count == 0 || !chunk.Bounds.Intersects(rect)) continue;
+
+            const ChunkTree* tree = m_Index.GetTree(c);
+            if (tree && tree->ChunkVersion == chunk.Version) {
+                tree->Query(chunk, rect, [&](uint32_t slot) { fn(MakeLineHandle(c, slot)); });
+                continue;
+            }
+            for (uint32_t slot = 0; slot < chunk.Count; slot++) {
+                if (chunk.DeletedCount > 0 && chunk.IsDeleted(slot)) continue;
+                if (std::max(chunk.X0[slot], chunk.X1[slot]) < rect.Min.x || std::min(chunk.X0[slot], chunk.X1[slot]) > rect.Max.x ||
+                    std::max(chunk.Y0[slot], chunk.Y1[slot]) < rect.Min.y || std::min(chunk.Y0[slot], chunk.Y1[slot]) > rect.Max.y)
+                    continue;
+                fn(MakeLineHandle(c, slot));
+            }
+        }
+    }
+
+    // Calls fn(handle) for every line whose endpoint box segment ab passes
+    // through, the candidates for intersecting it. A ray is queried as the
+    // segment up to where it leaves GetBounds().
+    template<typename Fn>
+    void QuerySegment(const glm::vec2& a, const glm::vec2& b, Fn&& fn) const
+    {
+        for (uint32_t c = 0; c < (uint32_t)m_Chunks.GetSize(); c++) {
+            const LineChunk& chunk = *m_Chunks[c];
+            if (chunk.Count == 0 || !chunk.Bounds.IntersectsSegment(a, b)) continue;
+
+            const ChunkTree* tree = m_Index.GetTree(c);
+            if (tree && tree->ChunkVersion == chunk.Version) {
+                tree->QuerySegment(chunk, a, b, [&](uint32_t slot) { fn(MakeLineHandle(c, slot)); });
+                continue;
+            }
+            for (uint32_t slot = 0; slot < chunk.Count; slot++) {
+                if (chunk.DeletedCount > 0 && chunk.IsDeleted(slot)) continue;
+                const AABB box = { { std::min(chunk.X0[slot], chunk.X1[slot]), std::min(chunk.Y0[slot], chunk.Y1[slot]) },
+                    { std::max(chunk.X0[slot], chunk.X1[slot]), std::max(chunk.Y0[slot], chunk.Y1[slot]) } };
+                if (box.IntersectsSegment(a, b)) fn(MakeLineHandle(c, slot));
+            }
+        }
+    }
+
+private:
+    // The chunk, copied first if it is mapped from a file or anyone else holds a reference to it
+    LineChunk& GetMutableChunk(uint32_t index);
+
+    SharedList<LineChunk> m_Chunks;
+    size_t m_LineCount = 0;
+    uint64_t m_Revision = 0;
+    AABB m_Bounds;
+    SpatialIndex m_Index;
+    DocumentJournal* m_Journal = nullptr;
+    UndoHistory* m_History = nullptr;
+};
+
+} // namespace EasyLine
@@ -0,0 +1,223 @@
+#include "LineEditing.h"
+#include "LineDocument.h"
+#include "Predicates.h"
+#include "SelectionSet.h"
+#include "UndoHistory.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <glm/gtc/constants.hpp>
+
+namespace EasyLine {
+
+namespace {
+
+// Crossings this close to a line's own ends (as a fraction of its length) do not cut it
+constexpr double kEndParameter = 1e-6;
+// Fillet arcs are split into lines that stray at most this fraction of the radius from the arc
+constexpr double kArcTolerance = 1e-3;
+
+struct Line {
+    glm::dvec2 P0, P1;
+    float Thickness;
+    Color LineColor;
+};
+
+Line GetLine(const LineDocument& document, LineHandle handle) {
+    const LineChunk& chunk = document.GetChunk(GetHandleChunk(handle));
+    const uint32_t slot = GetHandleSlot(handle);
+    return { { chunk.X0[slot], chunk.Y0[slot] }, { chunk.X1[slot], chunk.Y1[slot] }, chunk.Thickness[slot], UnpackColor(chunk.Color[slot]) };
+}
+
+bool IsBoundary(LineHandle handle, LineHandle line, const SelectionSet* boundaries) {
+    return handle != line && (!boundaries || boundaries->Contains(handle));
+}
+
+// Where segment cd crosses or touches segment ab, as a parameter along ab.
+// Collinear segments have no single point and do not count.
+bool CrossingParameter(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c, const glm::dvec2& d, double& t) {
+    const double oa = Orient2D(c, d, a), ob = Orient2D(c, d, b);
+    if ((oa > 0.0 && ob > 0.0) || (oa < 0.0 && ob < 0.0) || (oa == 0.0 && ob == 0.0)) return false;
+    const double oc = Orient2D(a, b, c), od = Orient2D(a, b, d);
+    if ((oc > 0.0 && od > 0.0) || (oc < 0.0 && od < 0.0)) return false;
+    // the orientation of a point to cd is linear along ab
+    t = oa / (oa - ob);
+    return true;
+}
+
+glm::vec2 PointAt(const Line& line, double t) {
+    return glm::vec2(line.P0 + (line.P1 - line.P0) * t);
+}
+
+double ParameterOf(const Line& line, const glm::dvec2& point) {
+    const glm::dvec2 d = line.P1 - line.P0;
+    const double lengthSquared = glm::dot(d, d);
+    return lengthSquared > 0.0 ? glm::dot(point - line.P0, d) / lengthSquared : 0.0;
+}
+
+// TrimLine without the undo step, so a fence can group several
+void Trim(LineDocument& document, LineHandle handle, double pickParameter, const SelectionSet* boundaries) {
+    const Line line = GetLine(document, handle);
+    double lower = -1.0, upper = 2.0;
+    document.QuerySegment(glm::vec2(line.P0), glm::vec2(line.P1), [&](LineHandle other) {
+        if (!IsBoundary(other, handle, boundaries)) return;
+        const Line boundary = GetLine(document, other);
+        double t;
+        if (!CrossingParameter(line.P0, line.P1, boundary.P0, boundary.P1, t) || t <= kEndParameter || t >= 1.0 - kEndParameter) return;
+        if (t < pickParameter) lower = std::max(lower, t);
+        else upper = std::min(upper, t);
+    });
+
+    const bool cutBefore = lower >= 0.0, cutAfter = upper <= 1.0;
+    if (!cutBefore && !cutAfter) {
+        document.RemoveLine(handle);
+    } else if (!cutAfter) {
+        document.MoveLine(handle, glm::vec2(line.P0), PointAt(line, lower));
+    } else if (!cutBefore) {
+        document.MoveLine(handle, PointAt(line, upper), glm::vec2(line.P1));
+    } else {
+        document.MoveLine(handle, glm::vec2(line.P0), PointAt(line, lower));
+        document.AddLine(PointAt(line, upper), glm::vec2(line.P1), line.Thickness, line.LineColor);
+    }
+}
+
+} // namespace
+
+bool TrimLine(LineDocument& document, LineHandle line, const glm::vec2& pick, const SelectionSet* boundaries) {
+    if (!document.IsLineValid(line)) return false;
+    UndoHistory* history = document.GetHistory();
+    if (history) history->BeginCommand("Trim");
+    Trim(document, line, std::clamp(ParameterOf(GetLine(document, line), pick), 0.0, 1.0), boundaries);
+    if (history) history->EndCommand();
+    return true;
+}
+
+size_t TrimFence(LineDocument& document, const glm::vec2& a, const glm::vec2& b, const SelectionSet* boundaries) {
+    // where the fence crosses each line, found before any of them is cut
+    struct Crossing {
+        LineHandle Handle;
+        double Parameter;
+    };
+    std::vector<Crossing> crossings;
+    document.QuerySegment(a, b, [&](LineHandle handle) {
+        const Line line = GetLine(document, handle);
+        double t;
+        if (CrossingParameter(line.P0, line.P1, a, b, t)) crossings.push_back({ handle, t });
+    });
+    if (crossings.empty()) return 0;
+
+    UndoHistory* history = document.GetHistory();
+    if (history) history->BeginCommand("Trim");
+    size_t trimmed = 0;
+    for (const Crossing& crossing : crossings) {
+        // an earlier cut may have removed or shortened the line
+        if (!document.IsLineValid(crossing.Handle)) continue;
+        const Line line = GetLine(document, crossing.Handle);
+        double t;
+        if (!CrossingParameter(line.P0, line.P1, a, b, t)) continue;
+        Trim(document, crossing.Handle, t, boundaries);
+        trimmed++;
+    }
+    if (history) history->EndCommand();
+    return trimmed;
+}
+
+bool ExtendLine(LineDocument& document, LineHandle handle, const glm::vec2& pick, const SelectionSet* boundaries) {
+    if (!document.IsLineValid(handle)) return false;
+    const Line line = GetLine(document, handle);
+    const bool extendEnd = ParameterOf(line, pick) >= 0.5;
+    const glm::dvec2 from = extendEnd ? line.P1 : line.P0;
+    const glm::dvec2 direction = extendEnd ? line.P1 - line.P0 : line.P0 - line.P1;
+    const double length = glm::length(direction);
+    if (!(length > 0.0)) return false;
+
+    // The ray is queried in steps that double in length, up to where it is
+    // sure to have left the drawing, so a boundary close ahead is found
+    // without visiting everything further along
+    const AABB& bounds = document.GetBounds();
+    const double reach = glm::length(glm::dvec2(bounds.GetSize())) + glm::length(from - glm::dvec2(bounds.GetCenter())) + 1.0;
+    const glm::dvec2 unit = direction / length;
+    double nearest = -1.0;
+    for (double begin = 0.0, end = std::min(length, reach); begin < reach && nearest < 0.0; begin = end, end = std::min(end * 2.0, reach)) {
+        const glm::dvec2 stepFrom = from + unit * begin, stepTo = from + unit * end;
+        document.QuerySegment(glm::vec2(stepFrom), glm::vec2(stepTo), [&](LineHandle other) {
+            if (!IsBoundary(other, handle, boundaries)) return;
+            const Line boundary = GetLine(document, other);
+            double t;
+            // a boundary the end already lies on is not ahead of it
+            if (!CrossingParameter(from, stepTo, boundary.P0, boundary.P1, t) || !(t > 0.0)) return;
+            const double distance = t * end;
+            if (nearest < 0.0 || distance < nearest) nearest = distance;
+        });
+    }
+    if (nearest < 0.0) return false;
+
+    const glm::vec2 reached = glm::vec2(from + unit * nearest);
+    UndoHistory* history = document.GetHistory();
+    if (history) history->BeginCommand("Extend");
+    if (extendEnd) document.MoveLine(handle, glm::vec2(line.P0), reached);
+    else document.MoveLine(handle, reached, glm::vec2(line.P1));
+    if (history) history->EndCommand();
+    return true;
+}
+
+bool FilletLines(LineDocument& document, LineHandle a, const glm::vec2& pickA, LineHandle b, const glm::vec2& pickB, float radius) {
+    if (a == b || !document.IsLineValid(a) || !document.IsLineValid(b) || !(radius >= 0.0f) || !std::isfinite(radius)) return false;
+    const Line lineA = GetLine(document, a), lineB = GetLine(document, b);
+
+    // corner where the lines, extended, meet
+    const glm::dvec2 da = lineA.P1 - lineA.P0, db = lineB.P1 - lineB.P0;
+    const double denominator = da.x * db.y - da.y * db.x;
+    if (Orient2D({ 0.0, 0.0 }, da, db) == 0.0 || !std::isfinite(denominator)) return false;
+    const glm::dvec2 offset = lineB.P0 - lineA.P0;
+    const glm::dvec2 corner = lineA.P0 + da * ((offset.x * db.y - offset.y * db.x) / denominator);
+
+    // each line keeps its end on the picked side of the corner
+    auto keptSide = [&](const Line& line, const glm::vec2& pick, glm::dvec2& direction, glm::dvec2& end) {
+        const glm::dvec2 d = glm::normalize(line.P1 - line.P0);
+        direction = glm::dot(glm::dvec2(pick) - corner, d) >= 0.0 ? d : -d;
+        end = glm::dot(line.P1 - corner, direction) >= glm::dot(line.P0 - corner, direction) ? line.P1 : line.P0;
+        return glm::dot(end - corner, direction);
+    };
+    glm::dvec2 ua, ub, endA, endB;
+    const double reachA = keptSide(lineA, pickA, ua, endA), reachB = keptSide(lineB, pickB, ub, endB);
+
+    UndoHistory* history = document.GetHistory();
+    if (radius == 0.0f) {
+        if (history) history->BeginCommand("Fillet");
+        document.MoveLine(a, glm::vec2(endA), glm::vec2(corner));
+        document.MoveLine(b, glm::vec2(endB), glm::vec2(corner));
+        if (history) history->EndCommand();
+        return true;
+    }
+
+    // the arc touches each line at the tangent distance from the corner
+    const double angle = std::acos(std::clamp(glm::dot(ua, ub), -1.0, 1.0));
+    const double tangent = radius / std::tan(angle * 0.5);
+    if (!(tangent <= reachA && tangent <= reachB)) return false;
+    const glm::dvec2 tangentA = corner + ua * tangent, tangentB = corner + ub * tangent;
+    const glm::dvec2 center = corner + glm::normalize(ua + ub) * (radius / std::sin(angle * 0.5));
+
+    const double sweep = glm::pi<double>() - angle;
+    const double step = 2.0 * std::acos(1.0 - kArcTolerance);
+    const int segments = std::max(1, (int)std::ceil(sweep / step));
+    const glm::dvec2 startRadius = tangentA - center;
+    const double turn = (startRadius.x * (tangentB - center).y - startRadius.y * (tangentB - center).x) >= 0.0 ? sweep : -sweep;
+
+    if (history) history->BeginCommand("Fillet");
+    document.MoveLine(a, glm::vec2(endA), glm::vec2(tangentA));
+    document.MoveLine(b, glm::vec2(endB), glm::vec2(tangentB));
+    glm::vec2 previous = glm::vec2(tangentA);
+    for (int i = 1; i <= segments; i++) {
+        const double theta = turn * i / segments;
+        const double c = std::cos(theta), s = std::sin(theta);
+        const glm::vec2 point = i == segments ? glm::vec2(tangentB)
+                                              : glm::vec2(center + glm::dvec2(startRadius.x * c - startRadius.y * s, startRadius.x * s + startRadius.y * c));
+        document.AddLine(previous, point, lineA.Thickness, lineA.LineColor);
+        previous = point;
+    }
+    if (history) history->EndCommand();
+    return true;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "LineChunk.h"
+
+namespace EasyLine {
+
+class LineDocument;
+class SelectionSet;
+
+// Trim, extend and fillet, the CAD edits that cut lines at or stretch them
+// to the lines they meet.
+//
+// The boundary lines are found through the spatial index: a trim queries the
+// segment of the line being cut, an extend the ray beyond the picked end up
+// to the edge of the drawing, so only the few lines near the edit are looked
+// at, however large the drawing. Those are then tested exactly (Orient2D), so
+// lines ending on a boundary and nearly parallel ones are cut consistently.
+//
+// Each call is one undo step on the document's history and changes only the
+// lines it edits plus any pieces it adds, so only their chunks are marked
+// changed and only their index trees are rebuilt.
+//
+// boundaries restricts the cutting and extension edges to the lines in the
+// set; nullptr makes every other line one.
+
+// Cut out the part of line between the boundaries on either side of pick,
+// keeping what lies beyond them. A line no boundary crosses is deleted.
+// False if line is not valid.
+bool TrimLine(LineDocument& document, LineHandle line, const glm::vec2& pick, const SelectionSet* boundaries = nullptr);
+// Trim every line the fence ab crosses at the point it crosses it, as one
+// undo step; returns the number of lines trimmed
+size_t TrimFence(LineDocument& document, const glm::vec2& a, const glm::vec2& b, const SelectionSet* boundaries = nullptr);
+// Lengthen line at the end nearer to pick up to the first boundary ahead of
+// that end. False if none lies ahead.
+bool ExtendLine(LineDocument& document, LineHandle line, const glm::vec2& pick, const SelectionSet* boundaries = nullptr);
+// Join lines a and b by an arc of radius tangent to both, made of short lines
+// in a's thickness and color. Both lines are trimmed or extended to the arc,
+// keeping the side of their intersection the pick points are on; radius 0
+// gives a sharp corner. False if the lines are parallel or the radius is too
+// large for them.
+bool FilletLines(LineDocument& document, LineHandle a, const glm::vec2& pickA, LineHandle b, const glm::vec2& pickB, float radius);
+
+} // namespace EasyLine
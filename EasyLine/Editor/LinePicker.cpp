@@ -0,0 +1,227 @@
+#include "LinePicker.h"
+#include "Camera.h"
+#include "LineDocument.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+#ifdef EL_PICK_X86
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace EasyLine {
+
+static constexpr uint32_t kNone = UINT32_MAX;
+
+// Distance from point to the stroke of one segment, NaN if the segment is not
+// finite. Same operations in the same order as the SIMD kernels, so all agree.
+static float StrokeDistance(const SegmentBatch& batch, uint32_t i, const glm::vec2& point) {
+    const float dx = batch.X1[i] - batch.X0[i], dy = batch.Y1[i] - batch.Y0[i];
+    const float ax = point.x - batch.X0[i], ay = point.y - batch.Y0[i];
+    const float length2 = dx * dx + dy * dy;
+    // written so that NaN passes through every min/max
+    float t = (ax * dx + ay * dy) / (length2 < FLT_MIN ? FLT_MIN : length2);
+    t = t < 0.0f ? 0.0f : t;
+    t = t > 1.0f ? 1.0f : t;
+    const float ex = ax - t * dx, ey = ay - t * dy;
+    const float d = std::sqrt(ex * ex + ey * ey) - 0.5f * batch.Thickness[i];
+    return d < 0.0f ? 0.0f : d;
+}
+
+uint32_t FindNearestSegmentScalar(const SegmentBatch& batch, const glm::vec2& point, float& distance) {
+    uint32_t best = kNone;
+    float bestDistance = INFINITY;
+    for (uint32_t i = 0; i < batch.Count; i++) {
+        const float d = StrokeDistance(batch, i, point);
+        if (d <= bestDistance) {
+            bestDistance = d;
+            best = i;
+        }
+    }
+    distance = bestDistance;
+    return best;
+}
+
+#ifdef EL_PICK_X86
+
+uint32_t FindNearestSegmentSSE2(const SegmentBatch& batch, const glm::vec2& point, float& distance) {
+    const __m128 px = _mm_set1_ps(point.x), py = _mm_set1_ps(point.y);
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f), tiny = _mm_set1_ps(FLT_MIN);
+    __m128 bestDistance = _mm_set1_ps(INFINITY);
+    __m128i bestIndex = _mm_set1_epi32(-1);
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i step = _mm_set1_epi32(4);
+
+    uint32_t i = 0;
+    for (; i + 4 <= batch.Count; i += 4) {
+        const __m128 x0 = _mm_loadu_ps(batch.X0 + i), y0 = _mm_loadu_ps(batch.Y0 + i);
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(batch.X1 + i), x0), dy = _mm_sub_ps(_mm_loadu_ps(batch.Y1 + i), y0);
+        const __m128 ax = _mm_sub_ps(px, x0), ay = _mm_sub_ps(py, y0);
+        const __m128 length2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        // max/min return their second operand when either is NaN: keep the value there
+        __m128 t = _mm_div_ps(_mm_add_ps(_mm_mul_ps(ax, dx), _mm_mul_ps(ay, dy)), _mm_max_ps(tiny, length2));
+        t = _mm_min_ps(one, _mm_max_ps(zero, t));
+        const __m128 ex = _mm_sub_ps(ax, _mm_mul_ps(t, dx)), ey = _mm_sub_ps(ay, _mm_mul_ps(t, dy));
+        __m128 d = _mm_sub_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey))), _mm_mul_ps(half, _mm_loadu_ps(batch.Thickness + i)));
+        d = _mm_max_ps(zero, d);
+
+        const __m128 closer = _mm_cmple_ps(d, bestDistance);
+        bestDistance = _mm_or_ps(_mm_and_ps(closer, d), _mm_andnot_ps(closer, bestDistance));
+        const __m128i mask = _mm_castps_si128(closer);
+        bestIndex = _mm_or_si128(_mm_and_si128(mask, index), _mm_andnot_si128(mask, bestIndex));
+        index = _mm_add_epi32(index, step);
+    }
+
+    alignas(16) float distances[4];
+    alignas(16) int32_t indices[4];
+    _mm_store_ps(distances, bestDistance);
+    _mm_store_si128((__m128i*)indices, bestIndex);
+    uint32_t best = kNone;
+    distance = INFINITY;
+    for (int lane = 0; lane < 4; lane++) {
+        if (indices[lane] < 0) continue;
+        if (best == kNone || distances[lane] < distance || (distances[lane] == distance && (uint32_t)indices[lane] > best)) {
+            distance = distances[lane];
+            best = (uint32_t)indices[lane];
+        }
+    }
+
+    // the rest are later than any lane, so they win ties
+    if (i < batch.Count) {
+        const SegmentBatch rest = { batch.X0 + i, batch.Y0 + i, batch.X1 + i, batch.Y1 + i, batch.Thickness + i, batch.Count - i };
+        float restDistance;
+        const uint32_t restBest = FindNearestSegmentScalar(rest, point, restDistance);
+        if (restBest != kNone && (best == kNone || restDistance <= distance)) {
+            distance = restDistance;
+            best = i + restBest;
+        }
+    }
+    return best;
+}
+
+bool IsAVX2Supported() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] >> 27) & 1, avx = (info[2] >> 28) & 1;
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] >> 5) & 1;
+    // the OS must save the YMM registers
+    return osxsave && avx && avx2 && (_xgetbv(0) & 6) == 6;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+using NearestSegmentFn = uint32_t (*)(const SegmentBatch&, const glm::vec2&, float&);
+
+static NearestSegmentFn GetKernel() {
+    static const NearestSegmentFn kernel = [] {
+#ifdef EL_PICK_X86
+        return IsAVX2Supported() ? &FindNearestSegmentAVX2 : &FindNearestSegmentSSE2;
+#else
+        return &FindNearestSegmentScalar;
+#endif
+    }();
+    return kernel;
+}
+
+namespace {
+
+// Candidates of one chunk, gathered in slot order
+struct Candidates {
+    uint32_t Count = 0;
+    uint16_t Slots[LineChunk::kCapacity];
+    float X0[LineChunk::kCapacity];
+    float Y0[LineChunk::kCapacity];
+    float X1[LineChunk::kCapacity];
+    float Y1[LineChunk::kCapacity];
+    float Thickness[LineChunk::kCapacity];
+
+    void Gather(const LineChunk& chunk) {
+        std::sort(Slots, Slots + Count);
+        for (uint32_t i = 0; i < Count; i++) {
+            const uint32_t slot = Slots[i];
+            X0[i] = chunk.X0[slot];
+            Y0[i] = chunk.Y0[slot];
+            X1[i] = chunk.X1[slot];
+            Y1[i] = chunk.Y1[slot];
+            Thickness[i] = chunk.Thickness[slot];
+        }
+    }
+};
+
+} // namespace
+
+bool PickLine(const LineDocument& document, const glm::vec2& point, float tolerance, PickResult& result) {
+    if (!std::isfinite(point.x) || !std::isfinite(point.y) || !(tolerance >= 0.0f)) return false;
+    const NearestSegmentFn kernel = GetKernel();
+    std::unique_ptr<Candidates> candidates;
+    float best = tolerance;
+    bool found = false;
+
+    for (size_t c = 0; c < document.GetChunkCount(); c++) {
+        const LineChunk& chunk = document.GetChunk(c);
+        if (chunk.Count == chunk.DeletedCount) continue;
+        // the search shrinks to the best distance so far; equal ones are still found
+        const float reach = best + chunk.MaxThickness * 0.5f;
+        const AABB rect = { point - reach, point + reach };
+        if (!chunk.Bounds.Intersects(rect)) continue;
+
+        SegmentBatch batch = { chunk.X0, chunk.Y0, chunk.X1, chunk.Y1, chunk.Thickness, chunk.Count };
+        const ChunkTree* tree = document.GetSpatialIndex().GetTree(c);
+        const bool useTree = tree && tree->ChunkVersion == chunk.Version;
+        if (useTree || chunk.DeletedCount > 0) {
+            if (!candidates) candidates = std::make_unique<Candidates>();
+            Candidates& gathered = *candidates;
+            gathered.Count = 0;
+            if (useTree) {
+                tree->Query(chunk, rect, [&](uint32_t slot) { gathered.Slots[gathered.Count++] = (uint16_t)slot; });
+            } else {
+                for (uint32_t slot = 0; slot < chunk.Count; slot++)
+                    if (!chunk.IsDeleted(slot)) gathered.Slots[gathered.Count++] = (uint16_t)slot;
+            }
+            if (gathered.Count == 0) continue;
+            gathered.Gather(chunk);
+            batch = { gathered.X0, gathered.Y0, gathered.X1, gathered.Y1, gathered.Thickness, gathered.Count };
+        }
+
+        float distance;
+        const uint32_t index = kernel(batch, point, distance);
+        if (index == kNone || !(distance <= best)) continue;
+        best = distance;
+        found = true;
+        result.Handle = MakeLineHandle((uint32_t)c, batch.X0 == chunk.X0 ? index : candidates->Slots[index]);
+        result.Distance = distance;
+    }
+    return found;
+}
+
+bool PickLine(const LineDocument& document, const Camera& camera, const glm::vec2& pixel, float pixelTolerance, PickResult& result) {
+    return PickLine(document, camera.ScreenToWorld(pixel), pixelTolerance * camera.GetPixelSize(), result);
+}
+
+bool PickIdRegion(const uint32_t* ids, uint32_t width, uint32_t height, const glm::ivec2& center, LineHandle& handle) {
+    int64_t bestDistance = INT64_MAX;
+    for (uint32_t y = 0; y < height; y++) {
+        const int64_t dy = (int64_t)y - center.y;
+        for (uint32_t x = 0; x < width; x++) {
+            const uint32_t id = ids[y * width + x];
+            const int64_t dx = (int64_t)x - center.x;
+            if (id != 0 && dx * dx + dy * dy < bestDistance) {
+                bestDistance = dx * dx + dy * dy;
+                handle = id - 1;
+            }
+        }
+    }
+    return bestDistance != INT64_MAX;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "LineChunk.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define EL_PICK_X86 1
+#endif
+
+namespace EasyLine {
+
+class Camera;
+class LineDocument;
+
+struct PickResult {
+    LineHandle Handle = 0;
+    float Distance = 0.0f;  // from the point to the line's stroke (0 when on it), world units
+};
+
+// Nearest line to point whose stroke is within tolerance (world units).
+// Chunks are narrowed down by their bounds and index trees; the candidates
+// are then measured in batches by a SIMD point-to-segment kernel. Lines
+// under the point are at distance 0, and of equal distances the one drawn
+// last (on top) wins. Returns false if nothing is close enough.
+bool PickLine(const LineDocument& document, const glm::vec2& point, float tolerance, PickResult& result);
+// Same for a point in framebuffer pixels (origin top left) and a tolerance in pixels
+bool PickLine(const LineDocument& document, const Camera& camera, const glm::vec2& pixel, float pixelTolerance, PickResult& result);
+
+// ID-buffer picking (Renderer::SetIdPicking) reads back the pixels around the
+// cursor: width x height ids, row by row, each the handle + 1 of the line
+// drawn there or 0. Picks the covered pixel nearest to center (in region
+// pixels), so it costs the same however large the document is.
+bool PickIdRegion(const uint32_t* ids, uint32_t width, uint32_t height, const glm::ivec2& center, LineHandle& handle);
+
+// Structure-of-arrays view of Count segments
+struct SegmentBatch {
+    const float* X0;
+    const float* Y0;
+    const float* X1;
+    const float* Y1;
+    const float* Thickness;
+    uint32_t Count;
+};
+
+// The distance kernel per instruction set: index of the segment whose stroke
+// is nearest to point (the last of equals), its distance in distance.
+// Non-finite segments never win. Returns UINT32_MAX if there is none.
+// PickLine uses the best kernel the CPU supports; these are for benchmarks.
+uint32_t FindNearestSegmentScalar(const SegmentBatch& batch, const glm::vec2& point, float& distance);
+#ifdef EL_PICK_X86
+uint32_t FindNearestSegmentSSE2(const SegmentBatch& batch, const glm::vec2& point, float& distance);
+uint32_t FindNearestSegmentAVX2(const SegmentBatch& batch, const glm::vec2& point, float& distance);
+bool IsAVX2Supported();
+#endif
+
+} // namespace EasyLine
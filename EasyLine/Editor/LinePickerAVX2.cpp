@@ -0,0 +1,68 @@
+// Built with AVX2 enabled (see CMakeLists.txt); only called after IsAVX2Supported()
+#include "LinePicker.h"
+
+#ifdef EL_PICK_X86
+#include <immintrin.h>
+#include <cfloat>
+#include <cmath>
+
+namespace EasyLine {
+
+uint32_t FindNearestSegmentAVX2(const SegmentBatch& batch, const glm::vec2& point, float& distance) {
+    const __m256 px = _mm256_set1_ps(point.x), py = _mm256_set1_ps(point.y);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), half = _mm256_set1_ps(0.5f), tiny = _mm256_set1_ps(FLT_MIN);
+    __m256 bestDistance = _mm256_set1_ps(INFINITY);
+    __m256i bestIndex = _mm256_set1_epi32(-1);
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi32(8);
+
+    uint32_t i = 0;
+    for (; i + 8 <= batch.Count; i += 8) {
+        const __m256 x0 = _mm256_loadu_ps(batch.X0 + i), y0 = _mm256_loadu_ps(batch.Y0 + i);
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(batch.X1 + i), x0), dy = _mm256_sub_ps(_mm256_loadu_ps(batch.Y1 + i), y0);
+        const __m256 ax = _mm256_sub_ps(px, x0), ay = _mm256_sub_ps(py, y0);
+        const __m256 length2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        // max/min return their second operand when either is NaN: keep the value there
+        __m256 t = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(ax, dx), _mm256_mul_ps(ay, dy)), _mm256_max_ps(tiny, length2));
+        t = _mm256_min_ps(one, _mm256_max_ps(zero, t));
+        const __m256 ex = _mm256_sub_ps(ax, _mm256_mul_ps(t, dx)), ey = _mm256_sub_ps(ay, _mm256_mul_ps(t, dy));
+        __m256 d = _mm256_sub_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey))),
+            _mm256_mul_ps(half, _mm256_loadu_ps(batch.Thickness + i)));
+        d = _mm256_max_ps(zero, d);
+
+        const __m256 closer = _mm256_cmp_ps(d, bestDistance, _CMP_LE_OQ);
+        bestDistance = _mm256_blendv_ps(bestDistance, d, closer);
+        bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIndex), _mm256_castsi256_ps(index), closer));
+        index = _mm256_add_epi32(index, step);
+    }
+
+    alignas(32) float distances[8];
+    alignas(32) int32_t indices[8];
+    _mm256_store_ps(distances, bestDistance);
+    _mm256_store_si256((__m256i*)indices, bestIndex);
+    uint32_t best = UINT32_MAX;
+    distance = INFINITY;
+    for (int lane = 0; lane < 8; lane++) {
+        if (indices[lane] < 0) continue;
+        if (best == UINT32_MAX || distances[lane] < distance || (distances[lane] == distance && (uint32_t)indices[lane] > best)) {
+            distance = distances[lane];
+            best = (uint32_t)indices[lane];
+        }
+    }
+
+    // the rest are later than any lane, so they win ties
+    if (i < batch.Count) {
+        const SegmentBatch rest = { batch.X0 + i, batch.Y0 + i, batch.X1 + i, batch.Y1 + i, batch.Thickness + i, batch.Count - i };
+        float restDistance;
+        const uint32_t restBest = FindNearestSegmentSSE2(rest, point, restDistance);
+        if (restBest != UINT32_MAX && (best == UINT32_MAX || restDistance <= distance)) {
+            distance = restDistance;
+            best = i + restBest;
+        }
+    }
+    return best;
+}
+
+} // namespace EasyLine
+
+#endif
@@ -0,0 +1,373 @@
+#include "LineSelection.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "SelectionSet.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#if defined(__x86_64__) || defined(_M_X64)
+#define EL_SELECT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace EasyLine {
+
+namespace {
+
+constexpr uint32_t kWords = SelectionSet::kWordsPerChunk;
+// Chunks per job: enough to amortize scheduling when most chunks are skipped or taken whole
+constexpr size_t kChunksPerJob = 8;
+
+enum class Coverage { None, Partial, All };
+
+// True if segment ab has a point in rect (closed)
+bool SegmentTouchesRect(const glm::vec2& a, const glm::vec2& b, const AABB& rect) {
+    if (std::max(a.x, b.x) < rect.Min.x || std::min(a.x, b.x) > rect.Max.x ||
+        std::max(a.y, b.y) < rect.Min.y || std::min(a.y, b.y) > rect.Max.y)
+        return false;
+    // within the box of the segment, it misses rect only if all corners are strictly on one side of it
+    const glm::vec2 d = b - a;
+    const glm::vec2 corners[4] = { rect.Min, { rect.Max.x, rect.Min.y }, { rect.Min.x, rect.Max.y }, rect.Max };
+    int positive = 0, negative = 0;
+    for (const glm::vec2& corner : corners) {
+        const float side = d.x * (corner.y - a.y) - d.y * (corner.x - a.x);
+        positive += side > 0.0f;
+        negative += side < 0.0f;
+    }
+    return positive < 4 && negative < 4;
+}
+
+// Lasso outline as edges a -> b in SoA, with what the tests need per edge
+struct Polygon {
+    std::vector<float> AX, AY, BX, BY;
+    std::vector<float> EX, EY;      // b - a
+    std::vector<float> Slope;       // dx / dy, for where a horizontal ray crosses the edge
+    AABB Bounds;                    // of the whole outline
+
+    Polygon() = default;
+    explicit Polygon(const std::vector<glm::vec2>& points) {
+        for (size_t i = 0; i < points.size(); i++) {
+            const glm::vec2 a = points[i], b = points[(i + 1) % points.size()];
+            AddEdge(a.x, a.y, b.x, b.y);
+            Bounds.Expand(a);
+        }
+    }
+
+    // Keep the edges of whole that span part of the height of bounds. The
+    // others can neither cross a segment in bounds nor a horizontal ray from
+    // a point in it, so the tests below give the same answers there.
+    void Localize(const Polygon& whole, const AABB& bounds) {
+        for (std::vector<float>* v : { &AX, &AY, &BX, &BY, &EX, &EY, &Slope }) v->clear();
+        Bounds = whole.Bounds;
+        for (size_t e = 0; e < whole.GetEdgeCount(); e++)
+            if (std::max(whole.AY[e], whole.BY[e]) >= bounds.Min.y && std::min(whole.AY[e], whole.BY[e]) <= bounds.Max.y)
+                AddEdge(whole.AX[e], whole.AY[e], whole.BX[e], whole.BY[e]);
+    }
+
+    void AddEdge(float ax, float ay, float bx, float by) {
+        AX.push_back(ax);
+        AY.push_back(ay);
+        BX.push_back(bx);
+        BY.push_back(by);
+        EX.push_back(bx - ax);
+        EY.push_back(by - ay);
+        Slope.push_back(ay != by ? (bx - ax) / (by - ay) : 0.0f);
+    }
+
+    size_t GetEdgeCount() const { return AX.size(); }
+
+    // Even-odd rule: count the edges a ray towards +x crosses
+    bool Contains(const glm::vec2& p) const {
+        bool inside = false;
+        for (size_t e = 0; e < AX.size(); e++)
+            if ((AY[e] > p.y) != (BY[e] > p.y) && p.x < AX[e] + (p.y - AY[e]) * Slope[e]) inside = !inside;
+        return inside;
+    }
+
+    // Proper crossing of segment pq with any edge
+    bool Crosses(const glm::vec2& p, const glm::vec2& q) const {
+        const glm::vec2 d = q - p;
+        for (size_t e = 0; e < AX.size(); e++) {
+            const float o1 = d.x * (AY[e] - p.y) - d.y * (AX[e] - p.x);
+            const float o2 = d.x * (BY[e] - p.y) - d.y * (BX[e] - p.x);
+            const float o3 = EX[e] * (p.y - AY[e]) - EY[e] * (p.x - AX[e]);
+            const float o4 = EX[e] * (q.y - AY[e]) - EY[e] * (q.x - AX[e]);
+            if (o1 * o2 < 0.0f && o3 * o4 < 0.0f) return true;
+        }
+        return false;
+    }
+
+    // Where box lies relative to the outline. A localized polygon only
+    // answers for boxes within what it was localized to.
+    Coverage Classify(const AABB& box) const {
+        if (!box.Intersects(Bounds)) return Coverage::None;
+        for (size_t e = 0; e < AX.size(); e++)
+            if (SegmentTouchesRect({ AX[e], AY[e] }, { BX[e], BY[e] }, box)) return Coverage::Partial;
+        // the outline stays clear of the box: it is all inside or all outside
+        return Contains(box.Min) ? Coverage::All : Coverage::None;
+    }
+};
+
+// Segment endpoints in SoA: a chunk's arrays, or lines gathered from them
+struct Segments {
+    const float* X0;
+    const float* Y0;
+    const float* X1;
+    const float* Y1;
+};
+
+Segments GetSegments(const LineChunk& chunk) {
+    return { chunk.X0, chunk.Y0, chunk.X1, chunk.Y1 };
+}
+
+// Tested slots of a chunk: Count rounded up to the kernels' step of 4
+uint32_t GetTestCount(const LineChunk& chunk) {
+    return std::min((chunk.Count + 3) & ~3u, LineChunk::kCapacity);
+}
+
+// Kernels: set bit i of hits for each segment i in [0, count) that is hit.
+// count is a multiple of 4; callers mask off what lies past their lines.
+
+#ifdef EL_SELECT_SSE2
+
+// All four coordinates finite: v - v is 0 for finite v and NaN otherwise
+inline __m128 AllFinite(__m128 x0, __m128 y0, __m128 x1, __m128 y1) {
+    const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_sub_ps(x0, x0), _mm_sub_ps(y0, y0)), _mm_add_ps(_mm_sub_ps(x1, x1), _mm_sub_ps(y1, y1)));
+    return _mm_cmpeq_ps(sum, _mm_setzero_ps());
+}
+
+inline __m128 BothInside(__m128 x0, __m128 y0, __m128 x1, __m128 y1, __m128 minX, __m128 minY, __m128 maxX, __m128 maxY) {
+    const __m128 inX = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(x0, minX), _mm_cmpge_ps(x1, minX)), _mm_and_ps(_mm_cmple_ps(x0, maxX), _mm_cmple_ps(x1, maxX)));
+    const __m128 inY = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(y0, minY), _mm_cmpge_ps(y1, minY)), _mm_and_ps(_mm_cmple_ps(y0, maxY), _mm_cmple_ps(y1, maxY)));
+    return _mm_and_ps(inX, inY);
+}
+
+// The segments' boxes overlap the box
+inline __m128 BoxesOverlap(__m128 x0, __m128 y0, __m128 x1, __m128 y1, __m128 minX, __m128 minY, __m128 maxX, __m128 maxY) {
+    const __m128 overlapX = _mm_and_ps(_mm_or_ps(_mm_cmpge_ps(x0, minX), _mm_cmpge_ps(x1, minX)), _mm_or_ps(_mm_cmple_ps(x0, maxX), _mm_cmple_ps(x1, maxX)));
+    const __m128 overlapY = _mm_and_ps(_mm_or_ps(_mm_cmpge_ps(y0, minY), _mm_cmpge_ps(y1, minY)), _mm_or_ps(_mm_cmple_ps(y0, maxY), _mm_cmple_ps(y1, maxY)));
+    return _mm_and_ps(overlapX, overlapY);
+}
+
+void TestRect(const Segments& lines, uint32_t count, const AABB& rect, SelectionMode mode, uint64_t* hits) {
+    const __m128 minX = _mm_set1_ps(rect.Min.x), minY = _mm_set1_ps(rect.Min.y), maxX = _mm_set1_ps(rect.Max.x), maxY = _mm_set1_ps(rect.Max.y);
+    const __m128 zero = _mm_setzero_ps();
+    for (uint32_t i = 0; i < count; i += 4) {
+        const __m128 x0 = _mm_loadu_ps(lines.X0 + i), y0 = _mm_loadu_ps(lines.Y0 + i);
+        const __m128 x1 = _mm_loadu_ps(lines.X1 + i), y1 = _mm_loadu_ps(lines.Y1 + i);
+        __m128 hit;
+        if (mode == SelectionMode::Window) {
+            hit = BothInside(x0, y0, x1, y1, minX, minY, maxX, maxY);
+        } else {
+            // box overlap, and not all corners strictly on one side of the line
+            const __m128 dx = _mm_sub_ps(x1, x0), dy = _mm_sub_ps(y1, y0);
+            const __m128 toMinX = _mm_mul_ps(dy, _mm_sub_ps(minX, x0)), toMaxX = _mm_mul_ps(dy, _mm_sub_ps(maxX, x0));
+            const __m128 toMinY = _mm_mul_ps(dx, _mm_sub_ps(minY, y0)), toMaxY = _mm_mul_ps(dx, _mm_sub_ps(maxY, y0));
+            const __m128 c0 = _mm_sub_ps(toMinY, toMinX), c1 = _mm_sub_ps(toMinY, toMaxX);
+            const __m128 c2 = _mm_sub_ps(toMaxY, toMinX), c3 = _mm_sub_ps(toMaxY, toMaxX);
+            const __m128 positive = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(c0, zero), _mm_cmpgt_ps(c1, zero)), _mm_and_ps(_mm_cmpgt_ps(c2, zero), _mm_cmpgt_ps(c3, zero)));
+            const __m128 negative = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(c0, zero), _mm_cmplt_ps(c1, zero)), _mm_and_ps(_mm_cmplt_ps(c2, zero), _mm_cmplt_ps(c3, zero)));
+            const __m128 touches = _mm_and_ps(BoxesOverlap(x0, y0, x1, y1, minX, minY, maxX, maxY), AllFinite(x0, y0, x1, y1));
+            hit = _mm_andnot_ps(_mm_or_ps(positive, negative), touches);
+        }
+        hits[i >> 6] |= (uint64_t)_mm_movemask_ps(hit) << (i & 63);
+    }
+}
+
+void TestPolygon(const Segments& lines, uint32_t count, const Polygon& polygon, SelectionMode mode, uint64_t* hits) {
+    const __m128 minX = _mm_set1_ps(polygon.Bounds.Min.x), minY = _mm_set1_ps(polygon.Bounds.Min.y);
+    const __m128 maxX = _mm_set1_ps(polygon.Bounds.Max.x), maxY = _mm_set1_ps(polygon.Bounds.Max.y);
+    const __m128 zero = _mm_setzero_ps();
+    const size_t edges = polygon.GetEdgeCount();
+    for (uint32_t i = 0; i < count; i += 4) {
+        const __m128 x0 = _mm_loadu_ps(lines.X0 + i), y0 = _mm_loadu_ps(lines.Y0 + i);
+        const __m128 x1 = _mm_loadu_ps(lines.X1 + i), y1 = _mm_loadu_ps(lines.Y1 + i);
+        // lines that cannot be hit skip the walk over the outline
+        __m128 candidate = mode == SelectionMode::Window ? BothInside(x0, y0, x1, y1, minX, minY, maxX, maxY)
+            : BoxesOverlap(x0, y0, x1, y1, minX, minY, maxX, maxY);
+        candidate = _mm_and_ps(candidate, AllFinite(x0, y0, x1, y1));
+        if (_mm_movemask_ps(candidate) == 0) continue;
+
+        const __m128 dx = _mm_sub_ps(x1, x0), dy = _mm_sub_ps(y1, y0);
+        __m128 inside0 = zero, inside1 = zero, crosses = zero;
+        for (size_t e = 0; e < edges; e++) {
+            const __m128 ax = _mm_set1_ps(polygon.AX[e]), ay = _mm_set1_ps(polygon.AY[e]);
+            const __m128 bx = _mm_set1_ps(polygon.BX[e]), by = _mm_set1_ps(polygon.BY[e]);
+            const __m128 ex = _mm_set1_ps(polygon.EX[e]), ey = _mm_set1_ps(polygon.EY[e]);
+            const __m128 slope = _mm_set1_ps(polygon.Slope[e]);
+
+            // even-odd ray test of both endpoints
+            const __m128 spans0 = _mm_xor_ps(_mm_cmpgt_ps(ay, y0), _mm_cmpgt_ps(by, y0));
+            const __m128 spans1 = _mm_xor_ps(_mm_cmpgt_ps(ay, y1), _mm_cmpgt_ps(by, y1));
+            inside0 = _mm_xor_ps(inside0, _mm_and_ps(spans0, _mm_cmplt_ps(x0, _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(y0, ay), slope)))));
+            inside1 = _mm_xor_ps(inside1, _mm_and_ps(spans1, _mm_cmplt_ps(x1, _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(y1, ay), slope)))));
+
+            // proper crossing: each segment's ends on opposite sides of the other
+            const __m128 o1 = _mm_sub_ps(_mm_mul_ps(dx, _mm_sub_ps(ay, y0)), _mm_mul_ps(dy, _mm_sub_ps(ax, x0)));
+            const __m128 o2 = _mm_sub_ps(_mm_mul_ps(dx, _mm_sub_ps(by, y0)), _mm_mul_ps(dy, _mm_sub_ps(bx, x0)));
+            const __m128 o3 = _mm_sub_ps(_mm_mul_ps(ex, _mm_sub_ps(y0, ay)), _mm_mul_ps(ey, _mm_sub_ps(x0, ax)));
+            const __m128 o4 = _mm_sub_ps(_mm_mul_ps(ex, _mm_sub_ps(y1, ay)), _mm_mul_ps(ey, _mm_sub_ps(x1, ax)));
+            crosses = _mm_or_ps(crosses, _mm_and_ps(_mm_cmplt_ps(_mm_mul_ps(o1, o2), zero), _mm_cmplt_ps(_mm_mul_ps(o3, o4), zero)));
+        }
+        const __m128 hit = mode == SelectionMode::Window ? _mm_andnot_ps(crosses, _mm_and_ps(inside0, inside1))
+            : _mm_or_ps(_mm_or_ps(inside0, inside1), crosses);
+        hits[i >> 6] |= (uint64_t)_mm_movemask_ps(_mm_and_ps(hit, candidate)) << (i & 63);
+    }
+}
+
+#else
+
+bool IsFinite(const glm::vec2& a, const glm::vec2& b) {
+    return std::isfinite(a.x) && std::isfinite(a.y) && std::isfinite(b.x) && std::isfinite(b.y);
+}
+
+void TestRect(const Segments& lines, uint32_t count, const AABB& rect, SelectionMode mode, uint64_t* hits) {
+    for (uint32_t i = 0; i < count; i++) {
+        const glm::vec2 a = { lines.X0[i], lines.Y0[i] }, b = { lines.X1[i], lines.Y1[i] };
+        const bool hit = mode == SelectionMode::Window ? rect.Contains(a) && rect.Contains(b) : IsFinite(a, b) && SegmentTouchesRect(a, b, rect);
+        hits[i >> 6] |= (uint64_t)hit << (i & 63);
+    }
+}
+
+void TestPolygon(const Segments& lines, uint32_t count, const Polygon& polygon, SelectionMode mode, uint64_t* hits) {
+    for (uint32_t i = 0; i < count; i++) {
+        const glm::vec2 a = { lines.X0[i], lines.Y0[i] }, b = { lines.X1[i], lines.Y1[i] };
+        if (!IsFinite(a, b)) continue;
+        bool hit;
+        if (mode == SelectionMode::Window)
+            hit = polygon.Bounds.Contains(a) && polygon.Bounds.Contains(b) && polygon.Contains(a) && polygon.Contains(b) && !polygon.Crosses(a, b);
+        else
+            hit = SegmentTouchesRect(a, b, polygon.Bounds) && (polygon.Contains(a) || polygon.Contains(b) || polygon.Crosses(a, b));
+        hits[i >> 6] |= (uint64_t)hit << (i & 63);
+    }
+}
+
+#endif
+
+// Lasso test of a chunk the outline passes through, against only the edges
+// near it. With a current index tree, subtrees clear of the outline are
+// taken or skipped whole and the lines of the leaves it passes through are
+// gathered and tested a leaf at a time.
+void TestChunkPolygon(const LineChunk& chunk, const ChunkTree* tree, const Polygon& polygon, SelectionMode mode, uint64_t* hits) {
+    Polygon local;
+    local.Localize(polygon, chunk.Bounds);
+    if (!tree || tree->ChunkVersion != chunk.Version || tree->NodeCount == 0) {
+        TestPolygon(GetSegments(chunk), GetTestCount(chunk), local, mode, hits);
+        return;
+    }
+
+    constexpr uint32_t kLeafSize = ChunkTree::kFanout;
+    float x0[kLeafSize], y0[kLeafSize], x1[kLeafSize], y1[kLeafSize];
+    struct Entry {
+        uint16_t Node;
+        bool All;   // an ancestor is inside the outline
+    };
+    Entry stack[64];
+    int top = 0;
+    stack[top++] = { (uint16_t)(tree->NodeCount - 1), false };
+    while (top > 0) {
+        const Entry entry = stack[--top];
+        const ChunkTree::Node& node = tree->Nodes[entry.Node];
+        const Coverage coverage = entry.All ? Coverage::All : local.Classify(node.Bounds);
+        if (coverage == Coverage::None) continue;
+        if (!tree->IsLeaf(entry.Node)) {
+            for (uint32_t c = node.First; c < (uint32_t)node.First + node.Count; c++) stack[top++] = { (uint16_t)c, coverage == Coverage::All };
+            continue;
+        }
+
+        uint64_t leafHits = 0;
+        if (coverage == Coverage::All) {
+            leafHits = (1ull << node.Count) - 1;
+        } else {
+            for (uint32_t k = 0; k < kLeafSize; k++) {
+                // pad with NaN, which never hits
+                const uint32_t slot = tree->Order[node.First + std::min(k, node.Count - 1u)];
+                const float pad = k < node.Count ? 0.0f : NAN;
+                x0[k] = chunk.X0[slot] + pad;
+                y0[k] = chunk.Y0[slot];
+                x1[k] = chunk.X1[slot];
+                y1[k] = chunk.Y1[slot];
+            }
+            TestPolygon({ x0, y0, x1, y1 }, (node.Count + 3) & ~3u, local, mode, &leafHits);
+        }
+        for (; leafHits != 0; leafHits &= leafHits - 1) {
+            const uint32_t slot = tree->Order[node.First + std::countr_zero(leafHits)];
+            hits[slot >> 6] |= 1ull << (slot & 63);
+        }
+    }
+}
+
+// Keep only slots in use and not deleted
+void MaskLive(const LineChunk& chunk, uint64_t* hits) {
+    for (uint32_t w = 0; w < kWords; w++) {
+        const uint32_t first = w * 64;
+        uint64_t live = first >= chunk.Count ? 0 : chunk.Count - first >= 64 ? ~0ull : (1ull << (chunk.Count - first)) - 1;
+        if (chunk.DeletedCount > 0) live &= ~((uint64_t)chunk.Deleted[2 * w] | (uint64_t)chunk.Deleted[2 * w + 1] << 32);
+        hits[w] &= live;
+    }
+}
+
+// Sorts chunks out by classify(chunk) and calls test(chunk index, chunk, hits)
+// for those on the outline, over the job system
+template<typename ClassifyFn, typename TestFn>
+void Select(const LineDocument& document, SelectionSet& selection, SelectionOp op, ClassifyFn&& classify, TestFn&& test) {
+    const size_t chunkCount = document.GetChunkCount();
+    if (op == SelectionOp::Replace) {
+        // chunks the document no longer has
+        for (size_t c = chunkCount; c < selection.GetChunkCount(); c++) std::fill_n(selection.GetChunkWords(c), kWords, 0);
+    }
+    selection.Resize(chunkCount);
+
+    JobSystem::ParallelFor(chunkCount, kChunksPerJob, [&](size_t begin, size_t end) {
+        uint64_t hits[kWords];
+        for (size_t c = begin; c < end; c++) {
+            const LineChunk& chunk = document.GetChunk(c);
+            const Coverage coverage = chunk.Count > chunk.DeletedCount ? classify(chunk) : Coverage::None;
+            if (coverage == Coverage::None && op != SelectionOp::Replace) continue;
+
+            std::fill_n(hits, kWords, coverage == Coverage::All ? ~0ull : 0ull);
+            if (coverage == Coverage::Partial) test(c, chunk, hits);
+            MaskLive(chunk, hits);
+
+            uint64_t* words = selection.GetChunkWords(c);
+            for (uint32_t w = 0; w < kWords; w++) {
+                switch (op) {
+                case SelectionOp::Replace: words[w] = hits[w]; break;
+                case SelectionOp::Add: words[w] |= hits[w]; break;
+                case SelectionOp::Remove: words[w] &= ~hits[w]; break;
+                }
+            }
+        }
+    });
+    selection.Recount();
+}
+
+} // namespace
+
+void SelectInRect(const LineDocument& document, const AABB& rect, SelectionMode mode, SelectionSet& selection, SelectionOp op) {
+    // a box edge costs a few instructions per line, so whole chunks are tested without the trees
+    Select(document, selection, op,
+        [&](const LineChunk& chunk) {
+            if (!chunk.Bounds.Intersects(rect)) return Coverage::None;
+            return rect.Contains(chunk.Bounds) ? Coverage::All : Coverage::Partial;
+        },
+        [&](size_t, const LineChunk& chunk, uint64_t* hits) {
+            TestRect(GetSegments(chunk), GetTestCount(chunk), rect, mode, hits);
+        });
+}
+
+void SelectInPolygon(const LineDocument& document, const std::vector<glm::vec2>& points, SelectionMode mode, SelectionSet& selection, SelectionOp op) {
+    if (points.size() < 3) {
+        // nothing is inside a degenerate lasso
+        if (op == SelectionOp::Replace) selection.Clear();
+        return;
+    }
+    const Polygon polygon(points);
+    Select(document, selection, op,
+        [&](const LineChunk& chunk) { return polygon.Classify(chunk.Bounds); },
+        [&](size_t index, const LineChunk& chunk, uint64_t* hits) {
+            TestChunkPolygon(chunk, document.GetSpatialIndex().GetTree(index), polygon, mode, hits);
+        });
+}
+
+} // namespace EasyLine
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "AABB.h"
+
+namespace EasyLine {
+
+class LineDocument;
+class SelectionSet;
+
+enum class SelectionMode {
+    Window,     // lines entirely inside the shape
+    Crossing,   // lines inside the shape or crossing its outline
+};
+
+// How the lines found combine with what is already selected
+enum class SelectionOp {
+    Replace,
+    Add,
+    Remove,
+};
+
+// Box and lasso selection of a document's lines, by their center lines.
+//
+// Chunks are sorted out by their bounds first: chunks the shape misses are
+// skipped and chunks it covers are taken whole, a few words of bits each.
+// Only chunks on the outline are tested line by line, by SSE2 kernels that
+// test four lines per step and produce their selection bits directly. A
+// lasso is tested against the edges near each chunk only, and through the
+// chunk's spatial index tree when it is current, down to leaves of 16 lines.
+// Chunks are spread over the job system and write disjoint parts of the
+// set, so selecting all of a multi-million line drawing takes a few
+// milliseconds and a box dragged over it can be re-evaluated every frame.
+void SelectInRect(const LineDocument& document, const AABB& rect, SelectionMode mode, SelectionSet& selection,
+    SelectionOp op = SelectionOp::Replace);
+// Lasso: polygon is closed (the last point connects to the first), may be
+// concave or cross itself (even-odd rule) and needs at least three points
+void SelectInPolygon(const LineDocument& document, const std::vector<glm::vec2>& polygon, SelectionMode mode, SelectionSet& selection,
+    SelectionOp op = SelectionOp::Replace);
+
+} // namespace EasyLine
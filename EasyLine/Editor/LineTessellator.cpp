@@ -0,0 +1,50 @@
+#include "LineTessellator.h"
+#include <cmath>
+
+namespace EasyLine {
+
+void TessellateLine(const glm::vec2& p0, const glm::vec2& p1, float thickness, const Color& color, LineVertex* out) {
+    glm::vec2 d = p1 - p0;
+    float length = std::sqrt(d.x * d.x + d.y * d.y);
+    glm::vec2 dir = length > 0.0f ? d / length : glm::vec2(1.0f, 0.0f);
+    glm::vec2 offset = glm::vec2(-dir.y, dir.x) * (thickness * 0.5f);
+
+    LineVertex v0 = { p0.x + offset.x, p0.y + offset.y, color.r, color.g, color.b, color.a };
+    LineVertex v1 = { p1.x + offset.x, p1.y + offset.y, color.r, color.g, color.b, color.a };
+    LineVertex v2 = { p0.x - offset.x, p0.y - offset.y, color.r, color.g, color.b, color.a };
+    LineVertex v3 = { p1.x - offset.x, p1.y - offset.y, color.r, color.g, color.b, color.a };
+
+    out[0] = v0; out[1] = v1; out[2] = v2;
+    out[3] = v1; out[4] = v3; out[5] = v2;
+}
+
+size_t CullAndTessellateChunk(const LineChunk& chunk, const AABB& view, std::vector<LineVertex>& out, std::vector<uint32_t>* slots) {
+    // lines are tested against the view grown by the thickest line in the chunk
+    const AABB bounds = view.Inflated(chunk.MaxThickness * 0.5f);
+    if (!bounds.Intersects(chunk.Bounds)) return 0;
+    const bool allVisible = bounds.Contains(chunk.Bounds);
+
+    size_t first = out.size();
+    out.resize(first + chunk.Count * kVerticesPerLine);
+    LineVertex* dst = out.data() + first;
+
+    const bool anyDeleted = chunk.DeletedCount > 0;
+    size_t emitted = 0;
+    for (uint32_t i = 0; i < chunk.Count; i++) {
+        if (anyDeleted && chunk.IsDeleted(i)) continue;
+        const float x0 = chunk.X0[i], y0 = chunk.Y0[i], x1 = chunk.X1[i], y1 = chunk.Y1[i];
+        if (!allVisible) {
+            if (std::max(x0, x1) < bounds.Min.x || std::min(x0, x1) > bounds.Max.x ||
+                std::max(y0, y1) < bounds.Min.y || std::min(y0, y1) > bounds.Max.y)
+                continue;
+        }
+        TessellateLine({ x0, y0 }, { x1, y1 }, chunk.Thickness[i], UnpackColor(chunk.Color[i]), dst + emitted * kVerticesPerLine);
+        if (slots) slots->push_back(i);
+        emitted++;
+    }
+
+    out.resize(first + emitted * kVerticesPerLine);
+    return emitted;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "AABB.h"
+#include "Color.h"
+#include "LineDocument.h"
+
+namespace EasyLine {
+
+struct LineVertex {
+    float x, y;       // position (world)
+    float r, g, b, a; // color
+};
+
+static constexpr size_t kVerticesPerLine = 6;
+
+// Expand a line into a quad (two triangles) of the given world-space thickness.
+// Writes kVerticesPerLine vertices to out.
+void TessellateLine(const glm::vec2& p0, const glm::vec2& p1, float thickness, const Color& color, LineVertex* out);
+
+// Cull the lines of a chunk against view and append the visible ones to out,
+// and their slots to slots when given. Returns the number of lines emitted.
+// Safe to call for different chunks from several threads at once.
+size_t CullAndTessellateChunk(const LineChunk& chunk, const AABB& view, std::vector<LineVertex>& out,
+    std::vector<uint32_t>* slots = nullptr);
+
+} // namespace EasyLine
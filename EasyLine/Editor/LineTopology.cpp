@@ -0,0 +1,425 @@
+#include "LineTopology.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "SelectionSet.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+namespace EasyLine {
+
+namespace {
+
+// Items per job in the parallel passes
+constexpr size_t kBlockSize = 1 << 16;
+// Cell keys are never this, so it marks a free slot of the hash table
+constexpr uint64_t kEmptyCell = 0;
+
+size_t GetBlockCount(size_t count) {
+    return (count + kBlockSize - 1) / kBlockSize;
+}
+
+// Runs body(begin, end) over [0, count) in blocks of kBlockSize, with the block index
+template<typename Fn>
+void ForEachBlock(size_t count, Fn&& body) {
+    JobSystem::ParallelFor(GetBlockCount(count), 1, [&](size_t first, size_t last) {
+        for (size_t block = first; block < last; block++)
+            body(block, block * kBlockSize, std::min(count, (block + 1) * kBlockSize));
+    });
+}
+
+// Union-find that any number of threads may update at once. A root is only
+// ever linked under a smaller root, so every set ends up rooted at its
+// smallest element whatever order the unions ran in.
+class ConcurrentUnionFind {
+public:
+    explicit ConcurrentUnionFind(size_t count) : m_Parent(new std::atomic<uint32_t>[count]) {
+        ForEachBlock(count, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) m_Parent[i].store((uint32_t)i, std::memory_order_relaxed);
+        });
+    }
+
+    uint32_t Find(uint32_t x) {
+        for (;;) {
+            const uint32_t parent = m_Parent[x].load(std::memory_order_relaxed);
+            if (parent == x) return x;
+            // path halving; losing the race only means a shorter path was written first
+            const uint32_t grandparent = m_Parent[parent].load(std::memory_order_relaxed);
+            if (grandparent != parent) {
+                uint32_t expected = parent;
+                m_Parent[x].compare_exchange_weak(expected, grandparent, std::memory_order_relaxed);
+            }
+            x = grandparent;
+        }
+    }
+
+    void Union(uint32_t a, uint32_t b) {
+        for (;;) {
+            a = Find(a);
+            b = Find(b);
+            if (a == b) return;
+            if (a < b) std::swap(a, b);
+            // link the larger root a under b, unless a stopped being a root meanwhile
+            uint32_t expected = a;
+            if (m_Parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) return;
+        }
+    }
+
+private:
+    std::unique_ptr<std::atomic<uint32_t>[]> m_Parent;
+};
+
+// Number the sets of uf: ids[i] becomes the set index of element i, sets
+// numbered in the order of their smallest element. Returns the number of sets.
+size_t NumberSets(ConcurrentUnionFind& uf, size_t count, std::vector<uint32_t>& ids, std::vector<uint32_t>* roots = nullptr) {
+    std::vector<uint32_t> root(count);
+    std::vector<uint32_t> blockFirst(GetBlockCount(count) + 1, 0);
+    ForEachBlock(count, [&](size_t block, size_t begin, size_t end) {
+        uint32_t sets = 0;
+        for (size_t i = begin; i < end; i++) {
+            root[i] = uf.Find((uint32_t)i);
+            sets += root[i] == i;
+        }
+        blockFirst[block + 1] = sets;
+    });
+    for (size_t block = 0; block + 1 < blockFirst.size(); block++) blockFirst[block + 1] += blockFirst[block];
+    const size_t setCount = blockFirst.back();
+
+    ids.resize(count);
+    if (roots) roots->resize(setCount);
+    ForEachBlock(count, [&](size_t block, size_t begin, size_t end) {
+        uint32_t next = blockFirst[block];
+        for (size_t i = begin; i < end; i++) {
+            if (root[i] != i) continue;
+            if (roots) (*roots)[next] = (uint32_t)i;
+            ids[i] = next++;
+        }
+    });
+    // roots come first in their set, so their ids are all known by now
+    ForEachBlock(count, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            if (root[i] != i) ids[i] = ids[root[i]];
+    });
+    return setCount;
+}
+
+uint64_t Mix(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    return key ^ (key >> 33);
+}
+
+// Open-addressing hash from cell key to the endpoints in that cell, filled
+// by all threads at once: a slot is claimed by swapping the key in, and an
+// endpoint is pushed onto the slot's list by swapping in the list head.
+class CellHash {
+public:
+    explicit CellHash(size_t pointCount)
+        : m_Mask(std::bit_ceil(std::max<size_t>(pointCount + pointCount / 4, 16)) - 1),
+          m_Keys(new std::atomic<uint64_t>[m_Mask + 1]), m_Heads(new std::atomic<uint32_t>[m_Mask + 1]), m_Next(pointCount) {
+        ForEachBlock(m_Mask + 1, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                m_Keys[i].store(kEmptyCell, std::memory_order_relaxed);
+                m_Heads[i].store(LineTopology::kNone, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    void Insert(uint64_t key, uint32_t point) {
+        for (size_t slot = Mix(key) & m_Mask;; slot = (slot + 1) & m_Mask) {
+            uint64_t found = m_Keys[slot].load(std::memory_order_relaxed);
+            if (found == kEmptyCell && m_Keys[slot].compare_exchange_strong(found, key, std::memory_order_relaxed)) found = key;
+            if (found != key) continue;
+            m_Next[point] = m_Heads[slot].exchange(point, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // First endpoint in the cell, kNone if it has none. Only once all inserts are done.
+    uint32_t GetHead(uint64_t key) const {
+        for (size_t slot = Mix(key) & m_Mask;; slot = (slot + 1) & m_Mask) {
+            const uint64_t found = m_Keys[slot].load(std::memory_order_relaxed);
+            if (found == key) return m_Heads[slot].load(std::memory_order_relaxed);
+            if (found == kEmptyCell) return LineTopology::kNone;
+        }
+    }
+
+    uint32_t GetNext(uint32_t point) const { return m_Next[point]; }
+
+    // Slots in table order, for visiting each cell once
+    size_t GetSlotCount() const { return m_Mask + 1; }
+    uint64_t GetSlotKey(size_t slot) const { return m_Keys[slot].load(std::memory_order_relaxed); }
+    uint32_t GetSlotHead(size_t slot) const { return m_Heads[slot].load(std::memory_order_relaxed); }
+
+private:
+    size_t m_Mask;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_Keys;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_Heads;
+    std::vector<uint32_t> m_Next;
+};
+
+// Cells are offset so that no key is kEmptyCell
+uint64_t MakeCellKey(int64_t x, int64_t y) {
+    constexpr int64_t kLimit = (1ll << 31) - 2;
+    const uint64_t kx = (uint64_t)(std::clamp(x, -kLimit, kLimit) + (1ll << 31));
+    const uint64_t ky = (uint64_t)(std::clamp(y, -kLimit, kLimit) + (1ll << 31));
+    return (kx << 32) | ky;
+}
+
+void GetCell(uint64_t key, int64_t& x, int64_t& y) {
+    x = (int64_t)(key >> 32) - (1ll << 31);
+    y = (int64_t)(key & 0xffffffffull) - (1ll << 31);
+}
+
+// With no tolerance the cell is the position itself; -0 and 0 are the same
+uint64_t MakeExactKey(const glm::vec2& p) {
+    uint32_t x, y;
+    const float px = p.x + 0.0f, py = p.y + 0.0f;
+    std::memcpy(&x, &px, sizeof(x));
+    std::memcpy(&y, &py, sizeof(y));
+    // all bits set would be a NaN, which never gets here
+    return (((uint64_t)x << 32) | y) + 1;
+}
+
+} // namespace
+
+void LineTopology::Build(const LineDocument& document, float tolerance) {
+    Clear();
+    m_Revision = document.GetRevision();
+    tolerance = std::max(tolerance, 0.0f);
+
+    // edges in handle order, two endpoints each
+    const size_t chunkCount = document.GetChunkCount();
+    std::vector<size_t> chunkFirst(chunkCount + 1, 0);
+    for (size_t c = 0; c < chunkCount; c++) {
+        const LineChunk& chunk = document.GetChunk(c);
+        chunkFirst[c + 1] = chunkFirst[c] + chunk.Count - chunk.DeletedCount;
+    }
+    const size_t edgeCount = chunkFirst.back();
+    const size_t pointCount = edgeCount * 2;
+    m_EdgeLines.resize(edgeCount);
+    std::vector<glm::vec2> points(pointCount);
+    JobSystem::ParallelFor(chunkCount, 8, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            const LineChunk& chunk = document.GetChunk(c);
+            size_t edge = chunkFirst[c];
+            for (uint32_t slot = 0; slot < chunk.Count; slot++) {
+                if (chunk.DeletedCount > 0 && chunk.IsDeleted(slot)) continue;
+                m_EdgeLines[edge] = MakeLineHandle((uint32_t)c, slot);
+                points[edge * 2] = { chunk.X0[slot], chunk.Y0[slot] };
+                points[edge * 2 + 1] = { chunk.X1[slot], chunk.Y1[slot] };
+                edge++;
+            }
+        }
+    });
+
+    // hash the endpoints by cell; endpoints that are not finite stay vertices of their own
+    const float cellScale = tolerance > 0.0f ? 1.0f / tolerance : 0.0f;
+    auto cellOf = [&](const glm::vec2& p, int64_t& x, int64_t& y) {
+        x = (int64_t)std::floor((double)p.x * cellScale);
+        y = (int64_t)std::floor((double)p.y * cellScale);
+    };
+    auto isFinite = [](const glm::vec2& p) { return std::isfinite(p.x) && std::isfinite(p.y); };
+    CellHash hash(pointCount);
+    ForEachBlock(pointCount, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (!isFinite(points[i])) continue;
+            if (tolerance == 0.0f) {
+                hash.Insert(MakeExactKey(points[i]), (uint32_t)i);
+            } else {
+                int64_t x, y;
+                cellOf(points[i], x, y);
+                hash.Insert(MakeCellKey(x, y), (uint32_t)i);
+            }
+        }
+    });
+
+    // Weld cell by cell: each endpoint against those after it in its own
+    // cell and all of those in half of the neighbouring cells, so every pair
+    // is seen once and each neighbour is looked up once per cell
+    ConcurrentUnionFind welds(pointCount);
+    const float toleranceSquared = tolerance * tolerance;
+    ForEachBlock(hash.GetSlotCount(), [&](size_t, size_t begin, size_t end) {
+        for (size_t slot = begin; slot < end; slot++) {
+            const uint64_t key = hash.GetSlotKey(slot);
+            const uint32_t head = hash.GetSlotHead(slot);
+            if (key == kEmptyCell) continue;
+            if (tolerance == 0.0f) {
+                // everything in the cell is at the same position
+                for (uint32_t i = hash.GetNext(head); i != kNone; i = hash.GetNext(i)) welds.Union(head, i);
+                continue;
+            }
+            int64_t x, y;
+            GetCell(key, x, y);
+            static constexpr int kNeighbours[4][2] = { { 1, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+            uint32_t neighbours[4];
+            for (int n = 0; n < 4; n++) neighbours[n] = hash.GetHead(MakeCellKey(x + kNeighbours[n][0], y + kNeighbours[n][1]));
+            for (uint32_t i = head; i != kNone; i = hash.GetNext(i)) {
+                const glm::vec2 p = points[i];
+                auto weldList = [&](uint32_t j) {
+                    for (; j != kNone; j = hash.GetNext(j)) {
+                        const glm::vec2 d = points[j] - p;
+                        if (glm::dot(d, d) <= toleranceSquared) welds.Union(i, j);
+                    }
+                };
+                weldList(hash.GetNext(i));
+                for (uint32_t neighbour : neighbours) weldList(neighbour);
+            }
+        }
+    });
+
+    std::vector<uint32_t> roots;
+    const size_t vertexCount = NumberSets(welds, pointCount, m_EdgeVertices, &roots);
+    m_Positions.resize(vertexCount);
+    ForEachBlock(vertexCount, [&](size_t, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) m_Positions[v] = points[roots[v]];
+    });
+    points = {};
+    roots = {};
+
+    // CSR adjacency: count, offset, fill, then sort each vertex's edges so
+    // the order does not depend on which thread got there first
+    std::unique_ptr<std::atomic<uint32_t>[]> cursor(new std::atomic<uint32_t>[vertexCount + 1]);
+    ForEachBlock(vertexCount + 1, [&](size_t, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) cursor[v].store(0, std::memory_order_relaxed);
+    });
+    ForEachBlock(edgeCount, [&](size_t, size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++) {
+            const uint32_t v0 = m_EdgeVertices[e * 2], v1 = m_EdgeVertices[e * 2 + 1];
+            if (v0 == v1) continue;
+            cursor[v0].fetch_add(1, std::memory_order_relaxed);
+            cursor[v1].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    m_Offsets.resize(vertexCount + 1);
+    uint32_t offset = 0;
+    for (size_t v = 0; v <= vertexCount; v++) {
+        const uint32_t degree = cursor[v].load(std::memory_order_relaxed);
+        m_Offsets[v] = offset;
+        cursor[v].store(offset, std::memory_order_relaxed);
+        offset += degree;
+    }
+    m_Incident.resize(offset);
+    ForEachBlock(edgeCount, [&](size_t, size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++) {
+            const uint32_t v0 = m_EdgeVertices[e * 2], v1 = m_EdgeVertices[e * 2 + 1];
+            if (v0 == v1) continue;
+            m_Incident[cursor[v0].fetch_add(1, std::memory_order_relaxed)] = (uint32_t)e;
+            m_Incident[cursor[v1].fetch_add(1, std::memory_order_relaxed)] = (uint32_t)e;
+        }
+    });
+    cursor.reset();
+    ForEachBlock(vertexCount, [&](size_t, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) std::sort(m_Incident.begin() + m_Offsets[v], m_Incident.begin() + m_Offsets[v + 1]);
+    });
+
+    // connected components over the vertices
+    ConcurrentUnionFind components(vertexCount);
+    ForEachBlock(edgeCount, [&](size_t, size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++) components.Union(m_EdgeVertices[e * 2], m_EdgeVertices[e * 2 + 1]);
+    });
+    m_ComponentCount = NumberSets(components, vertexCount, m_Components);
+}
+
+void LineTopology::Clear() {
+    m_Revision = 0;
+    m_Positions.clear();
+    m_Offsets.clear();
+    m_Incident.clear();
+    m_Components.clear();
+    m_ComponentCount = 0;
+    m_EdgeLines.clear();
+    m_EdgeVertices.clear();
+}
+
+uint32_t LineTopology::FindEdge(LineHandle line) const {
+    const auto it = std::lower_bound(m_EdgeLines.begin(), m_EdgeLines.end(), line);
+    return it != m_EdgeLines.end() && *it == line ? (uint32_t)(it - m_EdgeLines.begin()) : kNone;
+}
+
+uint32_t LineTopology::Walk(uint32_t edge, int end, std::vector<uint32_t>* vertices, std::vector<LineHandle>* lines) const {
+    uint32_t current = edge;
+    uint32_t vertex = GetEdgeVertex(edge, end);
+    for (;;) {
+        if (GetDegree(vertex) != 2) return vertex;
+        const uint32_t next = GetIncidentEdge(vertex, 0) == current ? GetIncidentEdge(vertex, 1) : GetIncidentEdge(vertex, 0);
+        if (next == edge) return kNone;
+        if (vertices) vertices->push_back(vertex);
+        if (lines) lines->push_back(m_EdgeLines[next]);
+        current = next;
+        vertex = GetEdgeVertex(next, 0) == vertex ? GetEdgeVertex(next, 1) : GetEdgeVertex(next, 0);
+    }
+}
+
+void LineTopology::TracePolyline(uint32_t edge, Polyline& polyline) const {
+    polyline.Vertices.clear();
+    polyline.Lines.clear();
+    polyline.Closed = false;
+    // a line with both ends welded together joins nothing
+    if (GetEdgeVertex(edge, 0) == GetEdgeVertex(edge, 1)) {
+        polyline.Vertices = { GetEdgeVertex(edge, 0), GetEdgeVertex(edge, 1) };
+        polyline.Lines = { m_EdgeLines[edge] };
+        return;
+    }
+
+    // backwards from end 0 first
+    std::vector<uint32_t> backVertices;
+    std::vector<LineHandle> backLines;
+    const uint32_t start = Walk(edge, 0, &backVertices, &backLines);
+    if (start == kNone) {
+        // came around: end 1, then everything the walk passed, back to end 1
+        polyline.Closed = true;
+        polyline.Vertices.push_back(GetEdgeVertex(edge, 1));
+        polyline.Vertices.insert(polyline.Vertices.end(), backVertices.begin(), backVertices.end());
+        polyline.Lines.push_back(m_EdgeLines[edge]);
+        polyline.Lines.insert(polyline.Lines.end(), backLines.begin(), backLines.end());
+        return;
+    }
+
+    // then lay the run out forwards from where the backward walk stopped
+    polyline.Vertices.push_back(start);
+    polyline.Vertices.insert(polyline.Vertices.end(), backVertices.rbegin(), backVertices.rend());
+    polyline.Lines.insert(polyline.Lines.end(), backLines.rbegin(), backLines.rend());
+    polyline.Lines.push_back(m_EdgeLines[edge]);
+    const uint32_t last = Walk(edge, 1, &polyline.Vertices, &polyline.Lines);
+    polyline.Vertices.push_back(last);
+}
+
+void LineTopology::SelectChain(LineHandle line, SelectionSet& selection) const {
+    const uint32_t edge = FindEdge(line);
+    if (edge == kNone) return;
+    Polyline polyline;
+    TracePolyline(edge, polyline);
+    for (LineHandle handle : polyline.Lines) selection.Add(handle);
+}
+
+void LineTopology::SelectConnected(LineHandle line, SelectionSet& selection) const {
+    const uint32_t edge = FindEdge(line);
+    if (edge == kNone) return;
+    const uint32_t component = m_Components[GetEdgeVertex(edge, 0)];
+    for (size_t e = 0; e < m_EdgeLines.size(); e++)
+        if (m_Components[m_EdgeVertices[e * 2]] == component) selection.Add(m_EdgeLines[e]);
+}
+
+void LineTopology::GetPolylines(std::vector<Polyline>& polylines) const {
+    polylines.clear();
+    std::vector<uint8_t> visited(m_EdgeLines.size(), 0);
+    for (uint32_t e = 0; e < (uint32_t)m_EdgeLines.size(); e++) {
+        if (visited[e]) continue;
+        Polyline& polyline = polylines.emplace_back();
+        TracePolyline(e, polyline);
+        for (LineHandle handle : polyline.Lines) visited[FindEdge(handle)] = 1;
+    }
+}
+
+void LineTopology::GetClosedLoops(std::vector<Polyline>& loops) const {
+    GetPolylines(loops);
+    loops.erase(std::remove_if(loops.begin(), loops.end(), [](const Polyline& polyline) { return !polyline.Closed; }), loops.end());
+}
+
+} // namespace EasyLine
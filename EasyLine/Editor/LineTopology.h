@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "LineChunk.h"
+
+namespace EasyLine {
+
+class LineDocument;
+class SelectionSet;
+
+// Planar-graph view of a document's lines: lines are the edges, their
+// welded endpoints the vertices.
+//
+// Build() welds endpoints closer than a tolerance through a spatial hash of
+// cells the size of the tolerance, so each endpoint is compared with the few
+// in its own and the neighbouring cells. Welding chains: endpoints within
+// tolerance of one another through intermediate ones become one vertex.
+// Vertices and connected components come out of lock-free union-find, and
+// the edges at each vertex are kept in CSR arrays (an offset per vertex into
+// one array of edge indices). Every pass runs on the job system, and the
+// result is the same whatever the thread timing.
+//
+// The graph is a snapshot: rebuild it when GetRevision() no longer matches
+// the document's.
+class LineTopology {
+public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    // A maximal run of edges joined at vertices of degree two. Vertices has
+    // one more entry than Lines, or the same number when the run is closed.
+    struct Polyline {
+        std::vector<uint32_t> Vertices;
+        std::vector<LineHandle> Lines;
+        bool Closed = false;
+    };
+
+    // tolerance 0 welds only endpoints at exactly the same position
+    void Build(const LineDocument& document, float tolerance);
+    void Clear();
+
+    uint64_t GetRevision() const { return m_Revision; }
+    size_t GetVertexCount() const { return m_Positions.size(); }
+    size_t GetEdgeCount() const { return m_EdgeLines.size(); }
+    size_t GetComponentCount() const { return m_ComponentCount; }
+
+    // Position of one of the endpoints welded into vertex
+    const glm::vec2& GetVertexPosition(uint32_t vertex) const { return m_Positions[vertex]; }
+    // Edges at vertex, each once; lines whose ends were welded together are not counted
+    uint32_t GetDegree(uint32_t vertex) const { return m_Offsets[vertex + 1] - m_Offsets[vertex]; }
+    uint32_t GetIncidentEdge(uint32_t vertex, uint32_t index) const { return m_Incident[m_Offsets[vertex] + index]; }
+    uint32_t GetComponent(uint32_t vertex) const { return m_Components[vertex]; }
+
+    LineHandle GetEdgeLine(uint32_t edge) const { return m_EdgeLines[edge]; }
+    // Vertex at the P0 (end 0) or P1 (end 1) end of the edge's line
+    uint32_t GetEdgeVertex(uint32_t edge, int end) const { return m_EdgeVertices[edge * 2 + end]; }
+    // Edge of line, or kNone if the line was not live when the graph was built
+    uint32_t FindEdge(LineHandle line) const;
+
+    // Add to selection the lines chained to line through vertices of degree
+    // two, as a CAD chain select does: it stops at branches and free ends
+    void SelectChain(LineHandle line, SelectionSet& selection) const;
+    // Add to selection every line connected to line
+    void SelectConnected(LineHandle line, SelectionSet& selection) const;
+
+    // Merge the lines into polylines: every edge ends up in exactly one,
+    // broken at vertices that are ends or branches
+    void GetPolylines(std::vector<Polyline>& polylines) const;
+    // The closed polylines only: loops that touch nothing else
+    void GetClosedLoops(std::vector<Polyline>& loops) const;
+
+private:
+    // Walk from edge through its end 'end' along degree-two vertices; appends
+    // the vertices and lines passed and returns the last vertex, or kNone if
+    // the walk came back around to edge
+    uint32_t Walk(uint32_t edge, int end, std::vector<uint32_t>* vertices, std::vector<LineHandle>* lines) const;
+    void TracePolyline(uint32_t edge, Polyline& polyline) const;
+
+    uint64_t m_Revision = 0;
+    std::vector<glm::vec2> m_Positions;     // per vertex
+    std::vector<uint32_t> m_Offsets;        // per vertex + 1, into m_Incident
+    std::vector<uint32_t> m_Incident;       // edge indices, grouped by vertex
+    std::vector<uint32_t> m_Components;     // per vertex
+    size_t m_ComponentCount = 0;
+    std::vector<LineHandle> m_EdgeLines;    // per edge, ascending
+    std::vector<uint32_t> m_EdgeVertices;   // two per edge
+};
+
+} // namespace EasyLine
@@ -0,0 +1,506 @@
+#include "LoopOperations.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "Predicates.h"
+#include "SegmentIntersection.h"
+#include "UndoHistory.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace EasyLine {
+
+namespace {
+
+// Offset arcs are split into lines that stray at most this fraction of the distance from the arc
+constexpr double kArcTolerance = 1e-3;
+// Loops offset in parallel before their results are added to the document
+constexpr size_t kOffsetBatch = 256;
+// Edges per horizontal strip of the winding index, on average
+constexpr size_t kEdgesPerStrip = 4;
+constexpr size_t kMaxStrips = 1 << 16;
+
+// The input rings' edges split where they cross or touch, with coincident
+// pieces merged. Each edge runs from its lower end (by y, then x) up, and
+// counts how many times each operand's rings run along it that way, minus
+// the other way.
+class Arrangement {
+public:
+    void AddRing(const Ring& ring, int operand) {
+        for (size_t i = 0; i < ring.size(); i++) {
+            const glm::vec2 from = glm::vec2(ring[i]), to = glm::vec2(ring[(i + 1) % ring.size()]);
+            if (from == to || !std::isfinite(from.x) || !std::isfinite(from.y) || !std::isfinite(to.x) || !std::isfinite(to.y)) continue;
+            m_Segments.push_back({ from, to });
+            m_Operands.push_back(operand);
+        }
+    }
+
+    void Build(bool parallel);
+
+    // Rings around where inside(windings) holds, windings being the two
+    // operands' winding numbers
+    template<typename Inside>
+    void Extract(Inside&& inside, bool parallel, std::vector<Ring>& rings) const;
+
+private:
+    struct Edge {
+        uint32_t From, To;
+        int Winding[2];
+    };
+
+    uint32_t GetVertex(const glm::vec2& p);
+    void BuildStrips();
+    // Winding numbers just above and to the right of p, a point on edge
+    // (up to rounding) and on no other
+    void GetWinding(const glm::dvec2& p, uint32_t edge, int winding[2]) const;
+    size_t GetStrip(double y) const {
+        const double strip = (y - m_StripBottom) * m_StripScale;
+        return strip <= 0.0 ? 0 : std::min(m_StripFirst.size() - 2, (size_t)strip);
+    }
+
+    std::vector<LineSegment> m_Segments;
+    std::vector<int> m_Operands;
+    std::vector<glm::dvec2> m_Vertices;
+    std::unordered_map<uint64_t, uint32_t> m_VertexOf;
+    std::vector<Edge> m_Edges;
+    // edges crossing each horizontal strip, by y
+    double m_StripBottom = 0.0, m_StripScale = 0.0;
+    std::vector<uint32_t> m_StripFirst;
+    std::vector<uint32_t> m_StripEdges;
+};
+
+bool IsBelow(const glm::dvec2& a, const glm::dvec2& b) {
+    return a.y < b.y || (a.y == b.y && a.x < b.x);
+}
+
+uint32_t Arrangement::GetVertex(const glm::vec2& p) {
+    uint32_t x, y;
+    const float px = p.x + 0.0f, py = p.y + 0.0f;
+    std::memcpy(&x, &px, sizeof(x));
+    std::memcpy(&y, &py, sizeof(y));
+    const auto [it, added] = m_VertexOf.try_emplace(((uint64_t)x << 32) | y, (uint32_t)m_Vertices.size());
+    if (added) m_Vertices.push_back(glm::dvec2(p));
+    return it->second;
+}
+
+void Arrangement::Build(bool parallel) {
+    std::vector<SegmentIntersection> hits;
+    if (parallel) FindIntersectionsParallel(m_Segments, hits);
+    else FindIntersections(m_Segments, hits);
+
+    // Where each segment is cut. An end of one segment on the other is used
+    // as is, so T-junctions and overlaps cut at existing points; only
+    // proper crossings get a new, rounded one.
+    struct Cut {
+        uint32_t Segment;
+        glm::vec2 Point;
+    };
+    std::vector<Cut> cuts;
+    auto isInside = [](const LineSegment& s, const glm::vec2& p) {
+        return p != s.P0 && p != s.P1 && Orient2D(s.P0, s.P1, p) == 0.0 && p.x >= std::min(s.P0.x, s.P1.x) && p.x <= std::max(s.P0.x, s.P1.x) &&
+               p.y >= std::min(s.P0.y, s.P1.y) && p.y <= std::max(s.P0.y, s.P1.y);
+    };
+    for (const SegmentIntersection& hit : hits) {
+        const LineSegment& a = m_Segments[hit.A];
+        const LineSegment& b = m_Segments[hit.B];
+        bool touching = false;
+        for (const glm::vec2& p : { b.P0, b.P1 })
+            if (isInside(a, p)) cuts.push_back({ hit.A, p }), touching = true;
+        for (const glm::vec2& p : { a.P0, a.P1 })
+            if (isInside(b, p)) cuts.push_back({ hit.B, p }), touching = true;
+        if (touching || hit.Overlap) continue;
+        if (hit.Point != a.P0 && hit.Point != a.P1) cuts.push_back({ hit.A, hit.Point });
+        if (hit.Point != b.P0 && hit.Point != b.P1) cuts.push_back({ hit.B, hit.Point });
+    }
+    std::sort(cuts.begin(), cuts.end(), [&](const Cut& a, const Cut& b) {
+        if (a.Segment != b.Segment) return a.Segment < b.Segment;
+        const LineSegment& s = m_Segments[a.Segment];
+        const glm::dvec2 d = glm::dvec2(s.P1) - glm::dvec2(s.P0);
+        return glm::dot(glm::dvec2(a.Point) - glm::dvec2(s.P0), d) < glm::dot(glm::dvec2(b.Point) - glm::dvec2(s.P0), d);
+    });
+
+    // the pieces between the cuts, merged where they coincide
+    std::unordered_map<uint64_t, uint32_t> edgeOf;
+    auto addPiece = [&](uint32_t from, uint32_t to, int operand) {
+        if (from == to) return;
+        const bool upwards = IsBelow(m_Vertices[from], m_Vertices[to]);
+        const uint32_t lower = upwards ? from : to, upper = upwards ? to : from;
+        const auto [it, added] = edgeOf.try_emplace(((uint64_t)lower << 32) | upper, (uint32_t)m_Edges.size());
+        if (added) m_Edges.push_back({ lower, upper, { 0, 0 } });
+        m_Edges[it->second].Winding[operand] += upwards ? 1 : -1;
+    };
+    size_t next = 0;
+    for (uint32_t s = 0; s < (uint32_t)m_Segments.size(); s++) {
+        uint32_t previous = GetVertex(m_Segments[s].P0);
+        for (; next < cuts.size() && cuts[next].Segment == s; next++) {
+            const uint32_t vertex = GetVertex(cuts[next].Point);
+            addPiece(previous, vertex, m_Operands[s]);
+            previous = vertex;
+        }
+        addPiece(previous, GetVertex(m_Segments[s].P1), m_Operands[s]);
+    }
+    BuildStrips();
+}
+
+void Arrangement::BuildStrips() {
+    double bottom = std::numeric_limits<double>::infinity(), top = -bottom;
+    for (const glm::dvec2& v : m_Vertices) {
+        bottom = std::min(bottom, v.y);
+        top = std::max(top, v.y);
+    }
+    const size_t strips = std::clamp<size_t>(m_Edges.size() / kEdgesPerStrip, 1, kMaxStrips);
+    m_StripBottom = bottom;
+    m_StripScale = top > bottom ? strips / (top - bottom) : 0.0;
+    m_StripFirst.assign(strips + 1, 0);
+    // horizontal edges are never crossed by a horizontal ray
+    for (const Edge& edge : m_Edges) {
+        if (m_Vertices[edge.From].y == m_Vertices[edge.To].y) continue;
+        for (size_t strip = GetStrip(m_Vertices[edge.From].y), last = GetStrip(m_Vertices[edge.To].y); strip <= last; strip++)
+            m_StripFirst[strip + 1]++;
+    }
+    for (size_t strip = 0; strip < strips; strip++) m_StripFirst[strip + 1] += m_StripFirst[strip];
+    m_StripEdges.resize(m_StripFirst.back());
+    std::vector<uint32_t> cursor(m_StripFirst.begin(), m_StripFirst.end() - 1);
+    for (uint32_t e = 0; e < (uint32_t)m_Edges.size(); e++) {
+        const Edge& edge = m_Edges[e];
+        if (m_Vertices[edge.From].y == m_Vertices[edge.To].y) continue;
+        for (size_t strip = GetStrip(m_Vertices[edge.From].y), last = GetStrip(m_Vertices[edge.To].y); strip <= last; strip++)
+            m_StripEdges[cursor[strip]++] = e;
+    }
+}
+
+void Arrangement::GetWinding(const glm::dvec2& p, uint32_t edge, int winding[2]) const {
+    // A ray to the right, counting the edges that cross it from below with
+    // p on their left. Ends at p.y count as below, which puts the ray just
+    // above p. The edge p is on is left out: the ray starts past it.
+    winding[0] = winding[1] = 0;
+    const size_t strip = GetStrip(p.y);
+    for (uint32_t i = m_StripFirst[strip]; i < m_StripFirst[strip + 1]; i++) {
+        if (m_StripEdges[i] == edge) continue;
+        const Edge& other = m_Edges[m_StripEdges[i]];
+        const glm::dvec2& from = m_Vertices[other.From];
+        const glm::dvec2& to = m_Vertices[other.To];
+        if (from.y <= p.y && p.y < to.y && Orient2D(from, to, p) > 0.0) {
+            winding[0] += other.Winding[0];
+            winding[1] += other.Winding[1];
+        }
+    }
+}
+
+template<typename Inside>
+void Arrangement::Extract(Inside&& inside, bool parallel, std::vector<Ring>& rings) const {
+    // which edges bound the result, and which way: 1 along, -1 against, 0 neither
+    std::vector<int8_t> kept(m_Edges.size(), 0);
+    auto classify = [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++) {
+            const Edge& edge = m_Edges[e];
+            const glm::dvec2& from = m_Vertices[edge.From];
+            const glm::dvec2& to = m_Vertices[edge.To];
+            // The ray starts on the right of an edge that rises and above, so
+            // on the left of, one that is level. Crossing an edge from its
+            // right to its left adds its winding.
+            int beside[2], left[2], right[2];
+            GetWinding((from + to) * 0.5, (uint32_t)e, beside);
+            const bool level = from.y == to.y;
+            for (int o = 0; o < 2; o++) {
+                left[o] = level ? beside[o] : beside[o] + edge.Winding[o];
+                right[o] = level ? beside[o] - edge.Winding[o] : beside[o];
+            }
+            const bool inLeft = inside(left), inRight = inside(right);
+            kept[e] = inLeft == inRight ? 0 : inLeft ? 1 : -1;
+        }
+    };
+    if (parallel) JobSystem::ParallelFor(m_Edges.size(), 4096, classify);
+    else classify(0, m_Edges.size());
+
+    // outgoing kept edges by vertex
+    std::vector<uint32_t> first(m_Vertices.size() + 1, 0);
+    for (size_t e = 0; e < m_Edges.size(); e++)
+        if (kept[e]) first[(kept[e] > 0 ? m_Edges[e].From : m_Edges[e].To) + 1]++;
+    for (size_t v = 0; v < m_Vertices.size(); v++) first[v + 1] += first[v];
+    std::vector<uint32_t> outgoing(first.back());
+    std::vector<uint32_t> cursor(first.begin(), first.end() - 1);
+    for (uint32_t e = 0; e < (uint32_t)m_Edges.size(); e++)
+        if (kept[e]) outgoing[cursor[kept[e] > 0 ? m_Edges[e].From : m_Edges[e].To]++] = e;
+    auto head = [&](uint32_t e) { return kept[e] > 0 ? m_Edges[e].To : m_Edges[e].From; };
+    auto tail = [&](uint32_t e) { return kept[e] > 0 ? m_Edges[e].From : m_Edges[e].To; };
+
+    // Walk the rings. Where several leave a vertex, as where two areas
+    // touch at a corner, take the sharpest left turn so the walk stays
+    // around one area.
+    std::vector<uint8_t> used(m_Edges.size(), 0);
+    for (uint32_t start = 0; start < (uint32_t)m_Edges.size(); start++) {
+        if (!kept[start] || used[start]) continue;
+        Ring ring;
+        const uint32_t origin = tail(start);
+        uint32_t edge = start;
+        bool closed = false;
+        for (;;) {
+            used[edge] = 1;
+            ring.push_back(m_Vertices[tail(edge)]);
+            const uint32_t vertex = head(edge);
+            if (vertex == origin) {
+                closed = true;
+                break;
+            }
+            const glm::dvec2 in = m_Vertices[vertex] - m_Vertices[tail(edge)];
+            uint32_t best = UINT32_MAX;
+            double bestTurn = -std::numeric_limits<double>::infinity();
+            for (uint32_t i = first[vertex]; i < first[vertex + 1]; i++) {
+                const uint32_t candidate = outgoing[i];
+                if (used[candidate]) continue;
+                const glm::dvec2 out = m_Vertices[head(candidate)] - m_Vertices[vertex];
+                const double turn = std::atan2(in.x * out.y - in.y * out.x, glm::dot(in, out));
+                if (turn > bestTurn) {
+                    bestTurn = turn;
+                    best = candidate;
+                }
+            }
+            if (best == UINT32_MAX) break;
+            edge = best;
+        }
+        if (!closed) continue;
+
+        // drop the vertices the cuts left along straight runs
+        Ring simplified;
+        for (size_t i = 0; i < ring.size(); i++) {
+            const glm::dvec2& previous = simplified.empty() ? ring[(i + ring.size() - 1) % ring.size()] : simplified.back();
+            if (Orient2D(previous, ring[i], ring[(i + 1) % ring.size()]) != 0.0) simplified.push_back(ring[i]);
+        }
+        if (simplified.size() >= 3) rings.push_back(std::move(simplified));
+    }
+}
+
+double GetArea(const Ring& ring) {
+    double area = 0.0;
+    for (size_t i = 0; i < ring.size(); i++) {
+        const glm::dvec2& a = ring[i];
+        const glm::dvec2& b = ring[(i + 1) % ring.size()];
+        area += a.x * b.y - a.y * b.x;
+    }
+    return area * 0.5;
+}
+
+// Number the groups of rings whose bounding boxes overlap, directly or
+// through others, in the order of their first ring. Rings in different
+// groups cannot change each other's result, so the groups can be combined
+// apart. A sweep along x keeps the boxes that are still open.
+size_t GroupOverlapping(const std::vector<const Ring*>& rings, std::vector<uint32_t>& groupOf) {
+    const size_t count = rings.size();
+    std::vector<glm::dvec2> min(count, glm::dvec2(std::numeric_limits<double>::infinity())), max(count, -min[0]);
+    for (size_t i = 0; i < count; i++) {
+        for (const glm::dvec2& p : *rings[i]) {
+            min[i] = glm::min(min[i], p);
+            max[i] = glm::max(max[i], p);
+        }
+    }
+    std::vector<uint32_t> parent(count);
+    std::iota(parent.begin(), parent.end(), 0u);
+    auto find = [&](uint32_t x) {
+        while (parent[x] != x) x = parent[x] = parent[parent[x]];
+        return x;
+    };
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return min[a].x < min[b].x; });
+    std::vector<uint32_t> open;
+    for (uint32_t i : order) {
+        open.erase(std::remove_if(open.begin(), open.end(), [&](uint32_t j) { return max[j].x < min[i].x; }), open.end());
+        for (uint32_t j : open) {
+            if (max[j].y < min[i].y || min[j].y > max[i].y) continue;
+            const uint32_t a = find(i), b = find(j);
+            if (a != b) parent[std::max(a, b)] = std::min(a, b);
+        }
+        open.push_back(i);
+    }
+    groupOf.resize(count);
+    size_t groups = 0;
+    for (uint32_t i = 0; i < (uint32_t)count; i++) {
+        const uint32_t root = find(i);
+        groupOf[i] = root == i ? (uint32_t)groups++ : groupOf[root];
+    }
+    return groups;
+}
+
+bool IsOdd(int winding) {
+    return (winding & 1) != 0;
+}
+
+void AddRing(LineDocument& document, const Ring& ring, float thickness, const Color& color) {
+    for (size_t i = 0; i < ring.size(); i++) document.AddLine(glm::vec2(ring[i]), glm::vec2(ring[(i + 1) % ring.size()]), thickness, color);
+}
+
+void GetLineStyle(const LineDocument& document, LineHandle line, float& thickness, Color& color) {
+    const LineChunk& chunk = document.GetChunk(GetHandleChunk(line));
+    thickness = chunk.Thickness[GetHandleSlot(line)];
+    color = UnpackColor(chunk.Color[GetHandleSlot(line)]);
+}
+
+} // namespace
+
+void OffsetRing(const Ring& ring, double distance, std::vector<Ring>& result) {
+    result.clear();
+    Ring points;
+    for (const glm::dvec2& p : ring)
+        if (points.empty() || p != points.back()) points.push_back(p);
+    while (points.size() > 1 && points.back() == points.front()) points.pop_back();
+    if (points.size() < 3 || !std::isfinite(distance)) return;
+    const double area = GetArea(points);
+    if (area == 0.0 || !std::isfinite(area)) return;
+    if (area < 0.0) std::reverse(points.begin(), points.end());
+    if (distance == 0.0) {
+        result.push_back(std::move(points));
+        return;
+    }
+
+    // Each edge moved along its right-hand normal, which points out of a
+    // counterclockwise ring. Corners that open get an arc; at the others the
+    // moved edges overlap, and going through the corner point closes that
+    // overlap into loops the nonzero rule drops.
+    const double step = 2.0 * std::acos(1.0 - kArcTolerance);
+    Ring raw;
+    raw.reserve(points.size() * 3);
+    const size_t n = points.size();
+    for (size_t i = 0; i < n; i++) {
+        const glm::dvec2& previous = points[(i + n - 1) % n];
+        const glm::dvec2& p = points[i];
+        const glm::dvec2& next = points[(i + 1) % n];
+        const glm::dvec2 in = glm::normalize(p - previous), out = glm::normalize(next - p);
+        const glm::dvec2 normalIn = { in.y, -in.x }, normalOut = { out.y, -out.x };
+        const double turn = Orient2D(previous, p, next);
+        if (turn * distance > 0.0) {
+            const double angle = std::atan2(normalIn.x * normalOut.y - normalIn.y * normalOut.x, glm::dot(normalIn, normalOut));
+            const int segments = std::max(1, (int)std::ceil(std::abs(angle) / step));
+            for (int k = 0; k <= segments; k++) {
+                const double theta = angle * k / segments;
+                const double c = std::cos(theta), s = std::sin(theta);
+                raw.push_back(p + glm::dvec2(normalIn.x * c - normalIn.y * s, normalIn.x * s + normalIn.y * c) * distance);
+            }
+        } else if (turn == 0.0 && glm::dot(in, out) > 0.0) {
+            raw.push_back(p + normalIn * distance);
+        } else {
+            raw.push_back(p + normalIn * distance);
+            raw.push_back(p);
+            raw.push_back(p + normalOut * distance);
+        }
+    }
+
+    Arrangement arrangement;
+    arrangement.AddRing(raw, 0);
+    arrangement.Build(false);
+    arrangement.Extract([](const int* winding) { return winding[0] > 0; }, false, result);
+}
+
+void CombineRings(const std::vector<Ring>& a, const std::vector<Ring>& b, LoopOperation operation, std::vector<Ring>& result) {
+    result.clear();
+    auto inside = [operation](const int* winding) {
+        const bool inA = IsOdd(winding[0]), inB = IsOdd(winding[1]);
+        switch (operation) {
+        case LoopOperation::Union: return inA || inB;
+        case LoopOperation::Intersection: return inA && inB;
+        case LoopOperation::Difference: return inA && !inB;
+        }
+        return false;
+    };
+    std::vector<const Ring*> rings;
+    std::vector<int> operands;
+    for (const Ring& ring : a) rings.push_back(&ring), operands.push_back(0);
+    for (const Ring& ring : b) rings.push_back(&ring), operands.push_back(1);
+    std::vector<uint32_t> groupOf;
+    const size_t groups = GroupOverlapping(rings, groupOf);
+
+    // one tangle of rings is swept in parallel slabs, separate groups each on one thread
+    if (groups <= 1) {
+        Arrangement arrangement;
+        for (size_t i = 0; i < rings.size(); i++) arrangement.AddRing(*rings[i], operands[i]);
+        arrangement.Build(true);
+        arrangement.Extract(inside, true, result);
+        return;
+    }
+    std::vector<uint32_t> first(groups + 1, 0);
+    for (uint32_t group : groupOf) first[group + 1]++;
+    for (size_t group = 0; group < groups; group++) first[group + 1] += first[group];
+    std::vector<uint32_t> members(rings.size());
+    std::vector<uint32_t> cursor(first.begin(), first.end() - 1);
+    for (uint32_t i = 0; i < (uint32_t)rings.size(); i++) members[cursor[groupOf[i]]++] = i;
+
+    std::vector<std::vector<Ring>> results(groups);
+    JobSystem::ParallelFor(groups, 16, [&](size_t begin, size_t end) {
+        for (size_t group = begin; group < end; group++) {
+            Arrangement arrangement;
+            for (uint32_t i = first[group]; i < first[group + 1]; i++) arrangement.AddRing(*rings[members[i]], operands[members[i]]);
+            arrangement.Build(false);
+            arrangement.Extract(inside, false, results[group]);
+        }
+    });
+    for (std::vector<Ring>& groupResult : results)
+        for (Ring& ring : groupResult) result.push_back(std::move(ring));
+}
+
+void GetLoopRing(const LineTopology& topology, const LineTopology::Polyline& loop, Ring& ring) {
+    ring.clear();
+    ring.reserve(loop.Lines.size());
+    for (size_t i = 0; i < loop.Lines.size(); i++) ring.push_back(glm::dvec2(topology.GetVertexPosition(loop.Vertices[i])));
+}
+
+size_t OffsetLoops(LineDocument& document, const LineTopology& topology, const std::vector<LineTopology::Polyline>& loops, double distance) {
+    if (topology.GetRevision() != document.GetRevision() || loops.empty()) return 0;
+    UndoHistory* history = document.GetHistory();
+    if (history) history->BeginCommand("Offset");
+    size_t added = 0;
+    std::vector<std::vector<Ring>> results;
+    for (size_t batch = 0; batch < loops.size(); batch += kOffsetBatch) {
+        const size_t count = std::min(kOffsetBatch, loops.size() - batch);
+        results.resize(count);
+        JobSystem::ParallelFor(count, 1, [&](size_t begin, size_t end) {
+            Ring ring;
+            for (size_t i = begin; i < end; i++) {
+                GetLoopRing(topology, loops[batch + i], ring);
+                OffsetRing(ring, distance, results[i]);
+            }
+        });
+        for (size_t i = 0; i < count; i++) {
+            float thickness;
+            Color color;
+            GetLineStyle(document, loops[batch + i].Lines.front(), thickness, color);
+            for (const Ring& ring : results[i]) AddRing(document, ring, thickness, color);
+            added += results[i].size();
+        }
+    }
+    if (history) history->EndCommand();
+    return added;
+}
+
+size_t CombineLoops(LineDocument& document, const LineTopology& topology, const std::vector<LineTopology::Polyline>& a,
+    const std::vector<LineTopology::Polyline>& b, LoopOperation operation) {
+    if (topology.GetRevision() != document.GetRevision() || a.empty()) return 0;
+    auto getRings = [&](const std::vector<LineTopology::Polyline>& loops, std::vector<Ring>& rings) {
+        rings.resize(loops.size());
+        JobSystem::ParallelFor(loops.size(), 64, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) GetLoopRing(topology, loops[i], rings[i]);
+        });
+    };
+    std::vector<Ring> ringsA, ringsB, result;
+    getRings(a, ringsA);
+    getRings(b, ringsB);
+    CombineRings(ringsA, ringsB, operation, result);
+
+    float thickness;
+    Color color;
+    GetLineStyle(document, a.front().Lines.front(), thickness, color);
+    static constexpr const char* kNames[] = { "Union", "Intersect", "Subtract" };
+    UndoHistory* history = document.GetHistory();
+    if (history) history->BeginCommand(kNames[(int)operation]);
+    for (const std::vector<LineTopology::Polyline>* loops : { &a, &b })
+        for (const LineTopology::Polyline& loop : *loops)
+            for (LineHandle line : loop.Lines)
+                if (document.IsLineValid(line)) document.RemoveLine(line);
+    for (const Ring& ring : result) AddRing(document, ring, thickness, color);
+    if (history) history->EndCommand();
+    return result.size();
+}
+
+} // namespace EasyLine
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+#include "LineTopology.h"
+
+namespace EasyLine {
+
+class LineDocument;
+
+// A closed ring of points, the last joined back to the first
+using Ring = std::vector<glm::dvec2>;
+
+enum class LoopOperation {
+    Union,
+    Intersection,
+    Difference,     // a minus b
+};
+
+// Offsetting and boolean operations on closed loops.
+//
+// Both work on the arrangement of the input rings: their edges are split
+// wherever they cross, found by the Bentley-Ottmann sweep, and coincident
+// pieces are merged. For every piece the winding numbers on either side
+// come from a ray cast with exact orientation tests, and a piece is kept
+// where the result's inside differs between its sides, turned so that the
+// inside is on its left. Output rings are therefore counterclockwise around
+// areas and clockwise around holes, and touch but never cross.
+//
+// Boolean inputs use the even-odd rule, so loops inside loops are holes
+// whichever way they run. An offset moves every edge of a ring along its
+// normal, joins the corners it opens with round arcs and resolves the
+// overlaps at the others by the nonzero rule, so narrow parts that vanish
+// drop out and an inward offset may split a ring in several.
+
+// Rings of loop, made counterclockwise, offset outwards by distance (inwards
+// if negative)
+void OffsetRing(const Ring& ring, double distance, std::vector<Ring>& result);
+// Rings of the area a op b
+void CombineRings(const std::vector<Ring>& a, const std::vector<Ring>& b, LoopOperation operation, std::vector<Ring>& result);
+
+// The loop's vertex positions in order
+void GetLoopRing(const LineTopology& topology, const LineTopology::Polyline& loop, Ring& ring);
+
+// Offset each loop and add the result as lines in the thickness and color of
+// the loop's first line, as one undo step. Loops are offset in parallel in
+// batches, and each batch is added before the next is started. Returns the
+// number of rings added.
+size_t OffsetLoops(LineDocument& document, const LineTopology& topology, const std::vector<LineTopology::Polyline>& loops, double distance);
+// Replace the lines of loops a and b by those of the area a op b, in the
+// style of a's first line, as one undo step. Returns the number of rings added.
+size_t CombineLoops(LineDocument& document, const LineTopology& topology, const std::vector<LineTopology::Polyline>& a,
+    const std::vector<LineTopology::Polyline>& b, LoopOperation operation);
+
+} // namespace EasyLine
@@ -0,0 +1,128 @@
+#include "LzCodec.h"
+#include <cstring>
+
+namespace EasyLine {
+
+static constexpr size_t kMinMatch = 4;
+static constexpr size_t kMaxOffset = 65535;
+// Like LZ4, the last bytes are always literals and no match starts close to
+// the end, which keeps the match search free of bounds checks
+static constexpr size_t kLastLiterals = 5;
+static constexpr size_t kMatchStartLimit = 12;
+static constexpr uint32_t kHashBits = 14;
+
+static uint32_t Load32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t Hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+static uint8_t* PutLength(uint8_t* op, size_t length) {
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+static uint8_t* PutSequence(uint8_t* op, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+    uint8_t* token = op++;
+    const size_t matchCode = matchLength - kMinMatch;
+    *token = (uint8_t)(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+    if (literalCount >= 15) op = PutLength(op, literalCount - 15);
+    std::memcpy(op, literals, literalCount);
+    op += literalCount;
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+    if (matchCode >= 15) op = PutLength(op, matchCode - 15);
+    return op;
+}
+
+size_t LzCompress(const uint8_t* src, size_t size, uint8_t* dst) {
+    uint8_t* op = dst;
+    size_t anchor = 0;
+
+    if (size > kMatchStartLimit) {
+        uint32_t table[1u << kHashBits] = {};
+        const size_t matchLimit = size - kLastLiterals;
+        size_t ip = 0;
+        while (ip < size - kMatchStartLimit) {
+            const uint32_t sequence = Load32(src + ip);
+            const uint32_t h = Hash(sequence);
+            const size_t ref = table[h];
+            table[h] = (uint32_t)ip;
+            if (ref >= ip || ip - ref > kMaxOffset || Load32(src + ref) != sequence) {
+                // step faster through data that does not compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            size_t length = kMinMatch;
+            while (ip + length < matchLimit && src[ip + length] == src[ref + length]) length++;
+            op = PutSequence(op, src + anchor, ip - anchor, ip - ref, length);
+            ip += length;
+            anchor = ip;
+            if (ip < size - kMatchStartLimit) table[Hash(Load32(src + ip - 2))] = (uint32_t)(ip - 2);
+        }
+    }
+
+    // trailing literals, a sequence without a match
+    const size_t literalCount = size - anchor;
+    uint8_t* token = op++;
+    *token = (uint8_t)((literalCount < 15 ? literalCount : 15) << 4);
+    if (literalCount >= 15) op = PutLength(op, literalCount - 15);
+    std::memcpy(op, src + anchor, literalCount);
+    op += literalCount;
+    return (size_t)(op - dst);
+}
+
+// Adds the extension bytes of a length field; false if the block ends first
+static bool GetLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+    uint8_t b;
+    do {
+        if (ip == end) return false;
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+bool LzDecompress(const uint8_t* src, size_t size, uint8_t* dst, size_t dstSize) {
+    const uint8_t* ip = src;
+    const uint8_t* const end = src + size;
+    size_t op = 0;
+
+    while (ip < end) {
+        const uint8_t token = *ip++;
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !GetLength(ip, end, literalCount)) return false;
+        if (literalCount > (size_t)(end - ip) || literalCount > dstSize - op) return false;
+        std::memcpy(dst + op, ip, literalCount);
+        ip += literalCount;
+        op += literalCount;
+        if (ip == end) break;   // the last sequence has no match
+
+        if (end - ip < 2) return false;
+        const size_t offset = ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t length = token & 15;
+        if (length == 15 && !GetLength(ip, end, length)) return false;
+        length += kMinMatch;
+        if (offset == 0 || offset > op || length > dstSize - op) return false;
+
+        uint8_t* out = dst + op;
+        const uint8_t* match = out - offset;
+        if (offset >= length) {
+            std::memcpy(out, match, length);
+        } else {
+            // overlapping: repeats the last offset bytes
+            for (size_t i = 0; i < length; i++) out[i] = match[i];
+        }
+        op += length;
+    }
+    return op == dstSize;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace EasyLine {
+
+// Small LZ77 block codec in the style of LZ4: greedy matching through a hash
+// table of 4-byte sequences, byte-aligned output (token, literals, 16-bit
+// offset, match length) and no entropy coding, so decoding runs at memory
+// speed. Blocks are independent; each caller compresses one chunk at a time.
+//
+// Decoding checks every length and offset against both buffers, so a
+// corrupt block is reported instead of read or written out of bounds.
+
+// Upper bound of LzCompress output for size input bytes (incompressible data grows slightly)
+constexpr size_t LzCompressBound(size_t size) { return size + size / 255 + 16; }
+
+// Compress size bytes of src into dst, which must hold LzCompressBound(size). Returns the compressed size.
+size_t LzCompress(const uint8_t* src, size_t size, uint8_t* dst);
+
+// Decompress a block that must expand to exactly dstSize bytes. Returns false if it is malformed.
+bool LzDecompress(const uint8_t* src, size_t size, uint8_t* dst, size_t dstSize);
+
+} // namespace EasyLine
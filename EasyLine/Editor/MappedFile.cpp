@@ -0,0 +1,105 @@
+#include "MappedFile.h"
+#include "Log.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace EasyLine {
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    m_Path = path;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        EL_CORE_ERROR("Failed to open file: {}", path);
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        EL_CORE_ERROR("Failed to query file size: {}", path);
+        CloseHandle(file);
+        return false;
+    }
+    m_File = file;
+    m_Size = (size_t)size.QuadPart;
+    m_Open = true;
+    if (m_Size == 0) return true;
+
+    m_Mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_Mapping) {
+        EL_CORE_ERROR("Failed to map file: {}", path);
+        Close();
+        return false;
+    }
+    m_Data = (const uint8_t*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m_Data) {
+        EL_CORE_ERROR("Failed to map view of file: {}", path);
+        Close();
+        return false;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        EL_CORE_ERROR("Failed to open file: {}", path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        EL_CORE_ERROR("Failed to query file size: {}", path);
+        ::close(fd);
+        return false;
+    }
+    m_Size = (size_t)st.st_size;
+    m_Open = true;
+    if (m_Size > 0) {
+        void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            EL_CORE_ERROR("Failed to map file: {}", path);
+            ::close(fd);
+            m_Size = 0;
+            m_Open = false;
+            return false;
+        }
+        m_Data = (const uint8_t*)data;
+    }
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+#endif
+    return true;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+    if (m_Data) UnmapViewOfFile(m_Data);
+    if (m_Mapping) CloseHandle((HANDLE)m_Mapping);
+    if (m_File) CloseHandle((HANDLE)m_File);
+    m_Mapping = nullptr;
+    m_File = nullptr;
+#else
+    if (m_Data) munmap((void*)m_Data, m_Size);
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Open = false;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace EasyLine {
+
+// Read-only memory mapping of a whole file. Pages are brought in by the OS on
+// first touch, so opening is cheap regardless of file size.
+//
+// The loader owns mappings through shared_ptr, so a reader that hands out
+// pointers into the data (.elb chunks) can keep the mapping alive with
+// weak_from_this().
+class MappedFile : public std::enable_shared_from_this<MappedFile> {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false (and logs) if the file cannot be opened or mapped
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return m_Open; }
+    const uint8_t* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+    const std::string& GetPath() const { return m_Path; }
+
+private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+    bool m_Open = false;
+    std::string m_Path;
+#ifdef _WIN32
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+#endif
+};
+
+// Deleter of a shared_ptr into a mapping's data: frees nothing and keeps the
+// mapping alive. The data is read-only whatever the pointer's type says, and
+// use_count() cannot tell whether anyone else holds it, so code that edits
+// shared data in place must check IsMapped() and copy first.
+struct MappedFileRef {
+    std::shared_ptr<const MappedFile> File;
+    void operator()(const void*) const {}
+};
+
+template<typename T>
+std::shared_ptr<T> MakeMappedPtr(std::shared_ptr<const MappedFile> file, const void* data)
+{
+    return std::shared_ptr<T>((T*)data, MappedFileRef{ std::move(file) });
+}
+
+template<typename T>
+bool IsMapped(const std::shared_ptr<T>& ptr) { return std::get_deleter<MappedFileRef>(ptr) != nullptr; }
+
+} // namespace EasyLine
@@ -0,0 +1,224 @@
+#include "PathTracer.h"
+#include "FileWriter.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+namespace EasyLine {
+
+// Chunks traced per batch and worker before the batch is written out in order
+static constexpr size_t kChunksPerWorker = 2;
+static constexpr uint32_t kNone = UINT32_MAX;
+
+static uint32_t FloatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static uint32_t HashPoint(const glm::vec2& p, uint64_t style) {
+    // + 0.0f folds -0 into +0, which compare equal
+    uint64_t h = ((uint64_t)FloatBits(p.x + 0.0f) << 32 | FloatBits(p.y + 0.0f)) ^ (style * 0x9e3779b97f4a7c15ull);
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 32;
+    return (uint32_t)h;
+}
+
+static bool IsFinite(const LineChunk& chunk, uint32_t slot) {
+    return std::isfinite(chunk.X0[slot]) && std::isfinite(chunk.Y0[slot]) && std::isfinite(chunk.X1[slot]) && std::isfinite(chunk.Y1[slot]);
+}
+
+void PathTracer::Trace(const LineChunk& chunk, const ChunkTree* tree, const AABB* region, ChunkPaths& out) {
+    out.Points.clear();
+    out.Paths.clear();
+    m_Chunk = &chunk;
+    m_Count = 0;
+    if (region && !chunk.Bounds.Intersects(*region)) return;
+
+    // gather the lines, in index order when the tree is current
+    auto add = [&](uint32_t slot) {
+        if (IsFinite(chunk, slot)) m_Slots[m_Count++] = (uint16_t)slot;
+    };
+    const bool useTree = tree && tree->ChunkVersion == chunk.Version;
+    const bool anyDeleted = chunk.DeletedCount > 0;
+    if (useTree && region) {
+        tree->Query(chunk, *region, add);
+    } else if (useTree) {
+        for (uint32_t k = 0; k < tree->LineCount; k++)
+            if (!anyDeleted || !chunk.IsDeleted(tree->Order[k])) add(tree->Order[k]);
+    } else {
+        for (uint32_t slot = 0; slot < chunk.Count; slot++) {
+            if (anyDeleted && chunk.IsDeleted(slot)) continue;
+            if (region && (std::max(chunk.X0[slot], chunk.X1[slot]) < region->Min.x || std::min(chunk.X0[slot], chunk.X1[slot]) > region->Max.x ||
+                std::max(chunk.Y0[slot], chunk.Y1[slot]) < region->Min.y || std::min(chunk.Y0[slot], chunk.Y1[slot]) > region->Max.y))
+                continue;
+            add(slot);
+        }
+    }
+    if (m_Count == 0) return;
+
+    // endpoint table: id = line * 2 + end
+    uint32_t tableSize = 16;
+    while (tableSize < m_Count * 4) tableSize <<= 1;
+    m_Table.assign(tableSize, 0);
+    for (uint32_t i = 0; i < m_Count; i++) {
+        const uint32_t slot = m_Slots[i];
+        m_Styles[i] = (uint64_t)FloatBits(chunk.Thickness[slot]) << 32 | chunk.Color[slot];
+        m_Used[i] = false;
+        for (uint32_t end = 0; end < 2; end++) {
+            const glm::vec2 p = end ? glm::vec2(chunk.X1[slot], chunk.Y1[slot]) : glm::vec2(chunk.X0[slot], chunk.Y0[slot]);
+            uint32_t h = HashPoint(p, m_Styles[i]) & (tableSize - 1);
+            while (m_Table[h] != 0) h = (h + 1) & (tableSize - 1);
+            m_Table[h] = i * 2 + end + 1;
+        }
+    }
+
+    for (uint32_t i = 0; i < m_Count; i++) {
+        if (m_Used[i]) continue;
+        m_Used[i] = true;
+        const uint32_t slot = m_Slots[i];
+        const uint64_t style = m_Styles[i];
+        const glm::vec2 start = { chunk.X0[slot], chunk.Y0[slot] };
+        const glm::vec2 end = { chunk.X1[slot], chunk.Y1[slot] };
+
+        // walk backwards from the start, then forwards from the end
+        m_Back.clear();
+        for (glm::vec2 p = start;;) {
+            const uint32_t next = FindNext(p, style);
+            if (next == kNone) break;
+            const uint32_t s = m_Slots[next >> 1];
+            p = (next & 1) ? glm::vec2(chunk.X0[s], chunk.Y0[s]) : glm::vec2(chunk.X1[s], chunk.Y1[s]);
+            m_Back.push_back(p);
+        }
+
+        const uint32_t first = (uint32_t)out.Points.size();
+        for (auto it = m_Back.rbegin(); it != m_Back.rend(); ++it) AppendPoint(out.Points, first, *it);
+        AppendPoint(out.Points, first, start);
+        AppendPoint(out.Points, first, end);
+        for (glm::vec2 p = end;;) {
+            const uint32_t next = FindNext(p, style);
+            if (next == kNone) break;
+            const uint32_t s = m_Slots[next >> 1];
+            p = (next & 1) ? glm::vec2(chunk.X0[s], chunk.Y0[s]) : glm::vec2(chunk.X1[s], chunk.Y1[s]);
+            AppendPoint(out.Points, first, p);
+        }
+        out.Paths.push_back({ chunk.Color[slot], chunk.Thickness[slot], first, (uint32_t)out.Points.size() - first });
+    }
+
+    std::stable_sort(out.Paths.begin(), out.Paths.end(), [](const TracedPath& a, const TracedPath& b) {
+        return a.Color != b.Color ? a.Color < b.Color : FloatBits(a.Thickness) < FloatBits(b.Thickness);
+    });
+}
+
+// Unused line of style with an endpoint at point; marks it used and returns
+// the id of that endpoint, or kNone
+uint32_t PathTracer::FindNext(const glm::vec2& point, uint64_t style) {
+    const uint32_t mask = (uint32_t)m_Table.size() - 1;
+    for (uint32_t h = HashPoint(point, style) & mask; m_Table[h] != 0; h = (h + 1) & mask) {
+        const uint32_t id = m_Table[h] - 1;
+        const uint32_t line = id >> 1;
+        if (m_Used[line] || m_Styles[line] != style) continue;
+        const uint32_t slot = m_Slots[line];
+        const glm::vec2 p = (id & 1) ? glm::vec2(m_Chunk->X1[slot], m_Chunk->Y1[slot]) : glm::vec2(m_Chunk->X0[slot], m_Chunk->Y0[slot]);
+        if (p != point) continue;
+        m_Used[line] = true;
+        return id;
+    }
+    return kNone;
+}
+
+// Append to the path starting at first, replacing the last point when it lies on a straight run
+void PathTracer::AppendPoint(std::vector<glm::vec2>& points, uint32_t first, const glm::vec2& point) {
+    const size_t count = points.size() - first;
+    if (count >= 2) {
+        const glm::vec2 a = points[points.size() - 2];
+        const glm::vec2 b = points.back();
+        const glm::vec2 d0 = b - a, d1 = point - b;
+        const float cross = d0.x * d1.y - d0.y * d1.x;
+        // same direction within about 1e-6 radians
+        if (glm::dot(d0, d1) > 0.0f && cross * cross <= 1e-12f * glm::dot(d0, d0) * glm::dot(d1, d1)) {
+            points.back() = point;
+            return;
+        }
+    }
+    points.push_back(point);
+}
+
+bool WriteTracedPaths(const LineDocument& document, const AABB& region, FileWriter& out, const PathFormatFn& format) {
+    std::vector<uint32_t> chunks;
+    for (size_t c = 0; c < document.GetChunkCount(); c++) {
+        const LineChunk& chunk = document.GetChunk(c);
+        if (chunk.Count > chunk.DeletedCount && chunk.Bounds.Intersects(region)) chunks.push_back((uint32_t)c);
+    }
+
+    const size_t batchSize = (JobSystem::GetWorkerCount() + 1) * kChunksPerWorker;
+    const size_t slotCount = std::min(batchSize, chunks.size());
+    std::vector<std::unique_ptr<char[]>> buffers(slotCount);
+    std::vector<std::unique_ptr<PathTracer>> tracers(slotCount);
+    std::vector<ChunkPaths> paths(slotCount);
+    std::vector<size_t> sizes(slotCount);
+    for (size_t i = 0; i < slotCount; i++) {
+        buffers[i] = std::make_unique<char[]>(kMaxPathTextSize);
+        tracers[i] = std::make_unique<PathTracer>();
+    }
+
+    size_t first = 0;
+    const std::function<void(size_t, size_t)> trace = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const uint32_t c = chunks[first + i];
+            const LineChunk& chunk = document.GetChunk(c);
+            tracers[i]->Trace(chunk, document.GetSpatialIndex().GetTree(c), region.Contains(chunk.Bounds) ? nullptr : &region, paths[i]);
+            sizes[i] = format(paths[i], buffers[i].get());
+        }
+    };
+    for (; first < chunks.size() && !out.HasError(); first += slotCount) {
+        const size_t count = std::min(slotCount, chunks.size() - first);
+        JobSystem::ParallelFor(count, 1, trace);
+        for (size_t i = 0; i < count; i++)
+            out.Write(buffers[i].get(), sizes[i]);
+    }
+    return !out.HasError();
+}
+
+AABB GetExportBounds(const LineDocument& document) {
+    AABB bounds = document.GetBounds();
+    if (bounds.IsEmpty()) return { { 0.0f, 0.0f }, { 1.0f, 1.0f } };
+    float maxThickness = 0.0f;
+    for (size_t c = 0; c < document.GetChunkCount(); c++) maxThickness = std::max(maxThickness, document.GetChunk(c).MaxThickness);
+    bounds = bounds.Inflated(maxThickness * 0.5f);
+    const glm::vec2 size = bounds.GetSize();
+    if (!(size.x > 0.0f) && !(size.y > 0.0f)) bounds = bounds.Inflated(0.5f);
+    return bounds;
+}
+
+int GetExportDecimals(const AABB& region) {
+    const glm::vec2 size = region.GetSize();
+    const float extent = std::max(size.x, size.y);
+    if (!(extent > 0.0f) || !std::isfinite(extent)) return 6;
+    return std::clamp(6 - (int)std::floor(std::log10(extent)), 0, 9);
+}
+
+char* AppendNumber(char* p, float value, int decimals) {
+    auto [end, ec] = std::to_chars(p, p + kMaxNumberSize, value, std::chars_format::fixed, decimals);
+    if (ec != std::errc()) {
+        *p = '0';
+        return p + 1;
+    }
+    if (decimals > 0) {
+        while (end[-1] == '0') end--;
+        if (end[-1] == '.') end--;
+    }
+    // "-0" after rounding
+    if (end - p == 2 && p[0] == '-' && p[1] == '0') {
+        *p = '0';
+        return p + 1;
+    }
+    return end;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <glm/glm.hpp>
+#include "AABB.h"
+#include "LineChunk.h"
+
+namespace EasyLine {
+
+class FileWriter;
+class LineDocument;
+struct ChunkTree;
+
+// Polyline of one style: Count points starting at ChunkPaths::Points[First]
+struct TracedPath {
+    uint32_t Color;     // PackColor()
+    float Thickness;
+    uint32_t First;
+    uint32_t Count;
+};
+
+// The lines of one chunk as polylines, grouped by style (all paths of a
+// style are adjacent) and otherwise in spatial order
+struct ChunkPaths {
+    std::vector<glm::vec2> Points;
+    std::vector<TracedPath> Paths;
+};
+
+// Turns line soup into polylines for the vector exporters (SVG, PDF).
+//
+// Lines are visited in the order of the chunk's index tree, so output
+// streams out region by region. Starting from each unvisited line, the path
+// is extended at both ends through lines of the same color and thickness
+// that share an endpoint exactly, then points in the middle of straight runs
+// are dropped. Only lines of the same chunk are joined, which keeps chunks
+// independent and traceable in parallel; loaders fill chunks in drawing
+// order, so connected geometry mostly shares a chunk anyway.
+class PathTracer {
+public:
+    // Trace the live lines of chunk whose endpoint box intersects region (all of them if region is null).
+    // tree may be null or stale, then slot order is used.
+    void Trace(const LineChunk& chunk, const ChunkTree* tree, const AABB* region, ChunkPaths& out);
+
+private:
+    uint32_t FindNext(const glm::vec2& point, uint64_t style);
+    void AppendPoint(std::vector<glm::vec2>& points, uint32_t first, const glm::vec2& point);
+
+    const LineChunk* m_Chunk = nullptr;
+    uint32_t m_Count = 0;
+    uint16_t m_Slots[LineChunk::kCapacity];
+    uint64_t m_Styles[LineChunk::kCapacity];
+    bool m_Used[LineChunk::kCapacity];
+    std::vector<uint32_t> m_Table;          // open addressing: endpoint id + 1, 0 = empty
+    std::vector<glm::vec2> m_Back;
+};
+
+// Upper bound of the text a format writes for one traced chunk: every point
+// as two numbers of at most kMaxNumberSize characters plus separators, and a
+// style change or path start per line
+constexpr size_t kMaxNumberSize = 64;
+constexpr size_t kMaxPathTextSize = 2 * LineChunk::kCapacity * (2 * kMaxNumberSize + 8) + LineChunk::kCapacity * 192;
+
+// Formats one chunk's paths into buffer (kMaxPathTextSize bytes) and returns the size written
+using PathFormatFn = std::function<size_t(const ChunkPaths& paths, char* buffer)>;
+
+// Trace and format the chunks overlapping region in parallel batches, and
+// write the results in document order, so the output does not depend on the
+// worker count. Returns false if writing failed.
+bool WriteTracedPaths(const LineDocument& document, const AABB& region, FileWriter& out, const PathFormatFn& format);
+
+// Document bounds grown by half the widest stroke, never zero-sized: the
+// page of a whole-document export
+AABB GetExportBounds(const LineDocument& document);
+// Digits after the decimal point that resolve about a millionth of the region
+int GetExportDecimals(const AABB& region);
+// value in fixed notation (no exponent, which PDF does not accept) without trailing zeros
+char* AppendNumber(char* p, float value, int decimals);
+// Color on paper: white lines (the default on the dark canvas) print black, as on a CAD plot
+inline uint32_t GetPaperColor(uint32_t color) { return (color & 0x00ffffffu) == 0x00ffffffu ? color & 0xff000000u : color; }
+
+} // namespace EasyLine
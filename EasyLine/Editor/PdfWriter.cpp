@@ -0,0 +1,113 @@
+#include "PdfWriter.h"
+#include "FileWriter.h"
+#include "LineDocument.h"
+#include "PathTracer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace EasyLine {
+
+namespace {
+
+constexpr float kPageSize = 842.0f;
+
+char* Append(char* p, std::string_view text) {
+    std::memcpy(p, text.data(), text.size());
+    return p + text.size();
+}
+
+// World to page space: coordinates are written in points so that viewers
+// never see huge or tiny numbers, whatever units the drawing uses
+struct PageTransform {
+    glm::vec2 Origin;
+    float Scale;
+    int Decimals;
+};
+
+char* AppendPoint(char* p, const glm::vec2& point, const PageTransform& page) {
+    const glm::vec2 q = (point - page.Origin) * page.Scale;
+    p = AppendNumber(p, q.x, page.Decimals);
+    *p++ = ' ';
+    p = AppendNumber(p, q.y, page.Decimals);
+    return p;
+}
+
+size_t FormatPaths(const ChunkPaths& paths, const PageTransform& page, char* begin) {
+    char* p = begin;
+    const TracedPath* style = nullptr;
+    for (const TracedPath& path : paths.Paths) {
+        if (!style || path.Color != style->Color || path.Thickness != style->Thickness) {
+            if (style) p = Append(p, "S\n");
+            const uint32_t color = GetPaperColor(path.Color);
+            for (int channel = 0; channel < 3; channel++) {
+                p = AppendNumber(p, ((color >> (channel * 8)) & 0xff) / 255.0f, 3);
+                *p++ = ' ';
+            }
+            p = Append(p, "RG ");
+            p = AppendNumber(p, path.Thickness * page.Scale, page.Decimals);
+            p = Append(p, " w\n");
+            style = &path;
+        }
+        for (uint32_t i = 0; i < path.Count; i++) {
+            p = AppendPoint(p, paths.Points[path.First + i], page);
+            p = Append(p, i == 0 ? " m\n" : " l\n");
+        }
+    }
+    if (style) p = Append(p, "S\n");
+    return (size_t)(p - begin);
+}
+
+} // namespace
+
+bool WritePdf(const LineDocument& document, FileWriter& out) {
+    return WritePdf(document, GetExportBounds(document), out);
+}
+
+bool WritePdf(const LineDocument& document, const AABB& region, FileWriter& out) {
+    const glm::vec2 size = region.GetSize();
+    const float extent = std::max(size.x, size.y);
+    PageTransform page;
+    page.Origin = region.Min;
+    page.Scale = extent > 0.0f ? kPageSize / extent : 1.0f;
+    page.Decimals = GetExportDecimals({ { 0.0f, 0.0f }, { kPageSize, kPageSize } });
+
+    uint64_t offsets[6] = {};
+    char text[160];
+    auto writeObject = [&](int id, const char* body) {
+        offsets[id] = out.GetBytesWritten();
+        out.Write(text, (size_t)std::snprintf(text, sizeof(text), "%d 0 obj\n%s\nendobj\n", id, body));
+    };
+
+    // the comment line of high bytes marks the file as binary for transfer tools
+    out.Write("%PDF-1.4\n%\xe2\xe3\xcf\xd3\n");
+    writeObject(1, "<< /Type /Catalog /Pages 2 0 R >>");
+    writeObject(2, "<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+    char pageObject[128];
+    std::snprintf(pageObject, sizeof(pageObject), "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 %.2f %.2f] /Contents 4 0 R >>",
+        std::max(size.x * page.Scale, 1.0f), std::max(size.y * page.Scale, 1.0f));
+    writeObject(3, pageObject);
+
+    // the length is only known afterwards, so it goes into an object of its own
+    offsets[4] = out.GetBytesWritten();
+    out.Write("4 0 obj\n<< /Length 5 0 R >>\nstream\n");
+    const uint64_t streamStart = out.GetBytesWritten();
+    out.Write("1 j\n");
+    const bool written = WriteTracedPaths(document, region, out,
+        [&page](const ChunkPaths& paths, char* buffer) { return FormatPaths(paths, page, buffer); });
+    // every operator line ends in a newline; the last one is the EOL before endstream
+    const uint64_t streamLength = out.GetBytesWritten() - streamStart - 1;
+    out.Write("endstream\nendobj\n");
+    std::snprintf(pageObject, sizeof(pageObject), "%llu", (unsigned long long)streamLength);
+    writeObject(5, pageObject);
+
+    const uint64_t xref = out.GetBytesWritten();
+    out.Write("xref\n0 6\n0000000000 65535 f \n");
+    for (int id = 1; id <= 5; id++)
+        out.Write(text, (size_t)std::snprintf(text, sizeof(text), "%010llu 00000 n \n", (unsigned long long)offsets[id]));
+    out.Write(text, (size_t)std::snprintf(text, sizeof(text), "trailer\n<< /Size 6 /Root 1 0 R >>\nstartxref\n%llu\n%%%%EOF\n",
+        (unsigned long long)xref));
+    return written && !out.HasError();
+}
+
+} // namespace EasyLine
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace EasyLine {
+
+class FileWriter;
+class LineDocument;
+struct AABB;
+
+// Single page PDF export (uncompressed content stream): the region is fitted
+// to a page whose longer side is 842 pt (A4 height) and the lines are stroked
+// as polylines merged by PathTracer. Line width scales with the drawing; alpha
+// is dropped, PDF 1.4 transparency is not worth the size here.
+bool WritePdf(const LineDocument& document, FileWriter& out);
+// Only the lines overlapping region, which becomes the page
+bool WritePdf(const LineDocument& document, const AABB& region, FileWriter& out);
+
+} // namespace EasyLine
@@ -0,0 +1,147 @@
+#include "PngWriter.h"
+#include "Deflate.h"
+#include "FileWriter.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace EasyLine {
+
+static constexpr uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+static void PutBigEndian(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+// Sum of the filtered bytes taken as signed: the usual heuristic for picking a row filter
+static uint32_t GetCost(const uint8_t* row, size_t size) {
+    uint32_t cost = 0;
+    for (size_t i = 0; i < size; i++) cost += (uint32_t)std::abs((int)(int8_t)row[i]);
+    return cost;
+}
+
+PngWriter::~PngWriter() {
+    JobSystem::Wait(m_Counter);
+}
+
+bool PngWriter::Begin(FileWriter& out, uint32_t width, uint32_t height) {
+    JobSystem::Wait(m_Counter);
+    m_Out = &out;
+    m_Width = width;
+    m_Height = height;
+    m_RowsSubmitted = 0;
+    m_Adler = 1;
+    m_BandCount = 0;
+    m_PendingLastRow = nullptr;
+    m_LastRow.assign((size_t)width * 3, 0);
+
+    out.Write(kSignature, sizeof(kSignature));
+    uint8_t header[13];
+    PutBigEndian(header, width);
+    PutBigEndian(header + 4, height);
+    header[8] = 8;      // bits per channel
+    header[9] = 2;      // RGB
+    header[10] = 0;     // deflate
+    header[11] = 0;     // adaptive filtering
+    header[12] = 0;     // not interlaced
+    WriteChunk("IHDR", header, sizeof(header));
+    // zlib header (deflate, 32K window, no dictionary); the bands follow in chunks of their own
+    const uint8_t zlibHeader[2] = { 0x78, 0x01 };
+    WriteChunk("IDAT", zlibHeader, sizeof(zlibHeader));
+    return !out.HasError();
+}
+
+void PngWriter::Submit(const uint8_t* rows, uint32_t rowCount) {
+    WriteBands();
+    if (rowCount == 0) return;
+
+    const size_t stride = (size_t)m_Width * 3;
+    m_BandCount = (rowCount + kBandRows - 1) / kBandRows;
+    if (m_Bands.size() < m_BandCount) m_Bands.resize(m_BandCount);
+    for (size_t i = 0; i < m_BandCount; i++) {
+        Band& band = m_Bands[i];
+        const uint32_t first = (uint32_t)i * kBandRows;
+        band.Rows = rows + first * stride;
+        band.RowCount = std::min(kBandRows, rowCount - first);
+        band.Above = first > 0 ? band.Rows - stride : m_RowsSubmitted > 0 ? m_LastRow.data() : nullptr;
+        JobSystem::Run([this, &band] { EncodeBand(band); }, &m_Counter);
+    }
+    m_RowsSubmitted += rowCount;
+    m_PendingLastRow = rows + (rowCount - 1) * stride;
+}
+
+bool PngWriter::End() {
+    WriteBands();
+    uint8_t trailer[sizeof(kDeflateFinalBlock) + 4];
+    std::memcpy(trailer, kDeflateFinalBlock, sizeof(kDeflateFinalBlock));
+    PutBigEndian(trailer + sizeof(kDeflateFinalBlock), m_Adler);
+    WriteChunk("IDAT", trailer, sizeof(trailer));
+    WriteChunk("IEND", nullptr, 0);
+    return m_RowsSubmitted == m_Height && !m_Out->HasError();
+}
+
+// Filter each row with whichever of Sub and Up comes out smaller, then deflate the band
+void PngWriter::EncodeBand(Band& band) const {
+    const size_t stride = (size_t)m_Width * 3;
+    band.Filtered.resize((stride + 1) * band.RowCount);
+    band.Up.resize(stride);
+    uint8_t* up = band.Up.data();
+    for (uint32_t r = 0; r < band.RowCount; r++) {
+        const uint8_t* row = band.Rows + r * stride;
+        const uint8_t* above = r > 0 ? row - stride : band.Above;
+        uint8_t* out = band.Filtered.data() + r * (stride + 1);
+
+        out[0] = 1;     // Sub
+        for (size_t i = 0; i < std::min<size_t>(3, stride); i++) out[1 + i] = row[i];
+        for (size_t i = 3; i < stride; i++) out[1 + i] = (uint8_t)(row[i] - row[i - 3]);
+        if (above) {
+            for (size_t i = 0; i < stride; i++) up[i] = (uint8_t)(row[i] - above[i]);
+            if (GetCost(up, stride) < GetCost(out + 1, stride)) {
+                out[0] = 2;
+                std::memcpy(out + 1, up, stride);
+            }
+        }
+    }
+
+    const size_t size = band.Filtered.size();
+    band.Adler = Adler32(1, band.Filtered.data(), size);
+    band.Chunk.resize(4 + DeflateBound(size) + 4);
+    std::memcpy(band.Chunk.data(), "IDAT", 4);
+    const size_t packed = DeflateCompress(band.Filtered.data(), size, band.Chunk.data() + 4);
+    PutBigEndian(band.Chunk.data() + 4 + packed, Crc32(0, band.Chunk.data(), 4 + packed));
+    band.ChunkSize = 4 + packed + 4;
+}
+
+// Wait for the strip in flight and write its bands in order
+void PngWriter::WriteBands() {
+    JobSystem::Wait(m_Counter);
+    for (size_t i = 0; i < m_BandCount; i++) {
+        const Band& band = m_Bands[i];
+        uint8_t length[4];
+        PutBigEndian(length, (uint32_t)(band.ChunkSize - 8));
+        m_Out->Write(length, sizeof(length));
+        m_Out->Write(band.Chunk.data(), band.ChunkSize);
+        m_Adler = Adler32Combine(m_Adler, band.Adler, band.Filtered.size());
+    }
+    m_BandCount = 0;
+    // the strip is still intact: keep its last row for the Up filter of the next one
+    if (m_PendingLastRow) std::memcpy(m_LastRow.data(), m_PendingLastRow, m_LastRow.size());
+    m_PendingLastRow = nullptr;
+}
+
+void PngWriter::WriteChunk(const char type[4], const uint8_t* data, uint32_t size) {
+    uint8_t length[4], crc[4];
+    PutBigEndian(length, size);
+    uint32_t sum = Crc32(0, (const uint8_t*)type, 4);
+    if (size > 0) sum = Crc32(sum, data, size);
+    PutBigEndian(crc, sum);
+    m_Out->Write(length, sizeof(length));
+    m_Out->Write(type, 4);
+    if (size > 0) m_Out->Write(data, size);
+    m_Out->Write(crc, sizeof(crc));
+}
+
+} // namespace EasyLine
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "JobSystem.h"
+
+namespace EasyLine {
+
+class FileWriter;
+
+// Streaming PNG encoder (8-bit RGB) for images far larger than memory.
+//
+// Rows arrive in strips, top to bottom. Each strip is cut into bands of
+// kBandRows rows that are filtered and deflated as independent jobs (see
+// DeflateCompress) and written as one IDAT chunk each, in order. Submit()
+// returns as soon as the jobs are queued, so the caller can produce the next
+// strip while this one encodes; only two strips are ever alive.
+class PngWriter {
+public:
+    static constexpr uint32_t kBandRows = 16;
+
+    PngWriter() = default;
+    ~PngWriter();
+
+    PngWriter(const PngWriter&) = delete;
+    PngWriter& operator=(const PngWriter&) = delete;
+
+    // Write the signature and header to out, which must stay open until End()
+    bool Begin(FileWriter& out, uint32_t width, uint32_t height);
+    // Queue rowCount rows of 3 * width bytes each. The memory must stay
+    // untouched until the next Submit() or End() returns.
+    void Submit(const uint8_t* rows, uint32_t rowCount);
+    // Write the rest of the image. False if writing failed or the rows submitted do not add up to the height.
+    bool End();
+
+private:
+    struct Band {
+        const uint8_t* Rows = nullptr;
+        const uint8_t* Above = nullptr;     // row before the band, null at the top of the image
+        uint32_t RowCount = 0;
+        std::vector<uint8_t> Filtered;
+        std::vector<uint8_t> Up;            // scratch row for trying the Up filter
+        std::vector<uint8_t> Chunk;         // "IDAT", deflate data, CRC
+        size_t ChunkSize = 0;
+        uint32_t Adler = 1;
+    };
+
+    void EncodeBand(Band& band) const;
+    void WriteBands();
+    void WriteChunk(const char type[4], const uint8_t* data, uint32_t size);
+
+    FileWriter* m_Out = nullptr;
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    uint32_t m_RowsSubmitted = 0;
+    uint32_t m_Adler = 1;
+    const uint8_t* m_PendingLastRow = nullptr;
+    std::vector<uint8_t> m_LastRow;     // copy of the previous strip's last row, that strip may be reused while the next encodes
+    std::vector<Band> m_Bands;
+    size_t m_BandCount = 0;
+    JobCounter m_Counter;
+};
+
+} // namespace EasyLine
@@ -0,0 +1,290 @@
+#include "Predicates.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace EasyLine {
+
+namespace {
+
+// Expansion arithmetic: a value is held exactly as a sum of doubles of
+// increasing magnitude whose bits do not overlap. The primitives compute a
+// sum or product together with its rounding error, which is exact.
+
+constexpr double kEpsilon = DBL_EPSILON * 0.5;     // 2^-53, half an ulp of 1
+constexpr double kSplitter = 134217729.0;          // 2^27 + 1, splits a double into two 26-bit halves
+constexpr double kResultErrorBound = (3.0 + 8.0 * kEpsilon) * kEpsilon;
+constexpr double kOrientErrorBoundA = (3.0 + 16.0 * kEpsilon) * kEpsilon;
+constexpr double kOrientErrorBoundB = (2.0 + 12.0 * kEpsilon) * kEpsilon;
+constexpr double kOrientErrorBoundC = (9.0 + 64.0 * kEpsilon) * kEpsilon * kEpsilon;
+constexpr double kInCircleErrorBoundA = (10.0 + 96.0 * kEpsilon) * kEpsilon;
+constexpr double kInCircleErrorBoundB = (4.0 + 48.0 * kEpsilon) * kEpsilon;
+
+// x + y == a + b exactly, given |a| >= |b|
+inline void FastTwoSum(double a, double b, double& x, double& y)
+{
+    x = a + b;
+    y = b - (x - a);
+}
+
+inline void TwoSum(double a, double b, double& x, double& y)
+{
+    x = a + b;
+    const double bVirtual = x - a;
+    const double aVirtual = x - bVirtual;
+    y = (a - aVirtual) + (b - bVirtual);
+}
+
+// Rounding error of x = a - b
+inline double TwoDiffTail(double a, double b, double x)
+{
+    const double bVirtual = a - x;
+    const double aVirtual = x + bVirtual;
+    return (a - aVirtual) + (bVirtual - b);
+}
+
+inline void TwoDiff(double a, double b, double& x, double& y)
+{
+    x = a - b;
+    y = TwoDiffTail(a, b, x);
+}
+
+// x + y == a * b exactly. A fused multiply-add gives the error directly;
+// without one, Dekker's splitting does it in plain multiplications.
+inline void TwoProduct(double a, double b, double& x, double& y)
+{
+    x = a * b;
+#ifdef FP_FAST_FMA
+    y = std::fma(a, b, -x);
+#else
+    double c = kSplitter * a;
+    const double aHigh = c - (c - a), aLow = a - aHigh;
+    c = kSplitter * b;
+    const double bHigh = c - (c - b), bLow = b - bHigh;
+    y = aLow * bLow - (((x - aHigh * bHigh) - aLow * bHigh) - aHigh * bLow);
+#endif
+}
+
+// (a1 + a0) - (b1 + b0) as a four-term expansion, least significant first
+inline void TwoTwoDiff(double a1, double a0, double b1, double b0, double* x)
+{
+    double i, j, k;
+    TwoDiff(a0, b0, i, x[0]);
+    TwoSum(a1, i, j, k);
+    double l;
+    TwoDiff(k, b1, l, x[1]);
+    TwoSum(j, l, x[3], x[2]);
+}
+
+// h = e + f, dropping zero terms; returns the length of h
+int ExpansionSum(int eLength, const double* e, int fLength, const double* f, double* h)
+{
+    int ei = 0, fi = 0, hi = 0;
+    double q, qNew, hh;
+    // merge by magnitude, smallest first
+    auto takeE = [&]() { return fi == fLength || (ei < eLength && (f[fi] > e[ei]) == (f[fi] > -e[ei])); };
+    q = takeE() ? e[ei++] : f[fi++];
+    if (ei < eLength && fi < fLength) {
+        if (takeE()) FastTwoSum(e[ei++], q, qNew, hh);
+        else FastTwoSum(f[fi++], q, qNew, hh);
+        q = qNew;
+        if (hh != 0.0) h[hi++] = hh;
+    }
+    while (ei < eLength || fi < fLength) {
+        TwoSum(q, takeE() ? e[ei++] : f[fi++], qNew, hh);
+        q = qNew;
+        if (hh != 0.0) h[hi++] = hh;
+    }
+    if (q != 0.0 || hi == 0) h[hi++] = q;
+    return hi;
+}
+
+// h = e * b, dropping zero terms; h holds up to 2 * eLength terms
+int ScaleExpansion(int eLength, const double* e, double b, double* h)
+{
+    int hi = 0;
+    double q, sum, hh, product1, product0;
+    TwoProduct(e[0], b, q, hh);
+    if (hh != 0.0) h[hi++] = hh;
+    for (int i = 1; i < eLength; i++) {
+        TwoProduct(e[i], b, product1, product0);
+        TwoSum(q, product0, sum, hh);
+        if (hh != 0.0) h[hi++] = hh;
+        FastTwoSum(product1, sum, q, hh);
+        if (hh != 0.0) h[hi++] = hh;
+    }
+    if (q != 0.0 || hi == 0) h[hi++] = q;
+    return hi;
+}
+
+// Longest expansion the in-circle products need: a 16-term lift times a 16-term minor
+constexpr int kMaxProductLength = 512;
+
+// h = e * f as the sum of e scaled by each term of f; h holds up to 2 * eLength * fLength terms
+int MultiplyExpansion(int eLength, const double* e, int fLength, const double* f, double* h)
+{
+    double scaled[32], sum[kMaxProductLength];
+    int hLength = ScaleExpansion(eLength, e, f[0], h);
+    for (int i = 1; i < fLength; i++) {
+        const int scaledLength = ScaleExpansion(eLength, e, f[i], scaled);
+        const int sumLength = ExpansionSum(hLength, h, scaledLength, scaled, sum);
+        std::copy(sum, sum + sumLength, h);
+        hLength = sumLength;
+    }
+    return hLength;
+}
+
+void Negate(int length, double* e)
+{
+    for (int i = 0; i < length; i++) e[i] = -e[i];
+}
+
+double Estimate(int length, const double* e)
+{
+    double sum = e[0];
+    for (int i = 1; i < length; i++) sum += e[i];
+    return sum;
+}
+
+// Orient2D for determinants too close to zero for the plain evaluation
+double Orient2DAdapt(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c, double detSum)
+{
+    const double acx = a.x - c.x, bcx = b.x - c.x;
+    const double acy = a.y - c.y, bcy = b.y - c.y;
+
+    double detLeft, detLeftTail, detRight, detRightTail;
+    TwoProduct(acx, bcy, detLeft, detLeftTail);
+    TwoProduct(acy, bcx, detRight, detRightTail);
+    double B[4];
+    TwoTwoDiff(detLeft, detLeftTail, detRight, detRightTail, B);
+
+    double det = Estimate(4, B);
+    double errorBound = kOrientErrorBoundB * detSum;
+    if (det >= errorBound || -det >= errorBound) return det;
+
+    // the differences themselves may have been rounded
+    const double acxTail = TwoDiffTail(a.x, c.x, acx), bcxTail = TwoDiffTail(b.x, c.x, bcx);
+    const double acyTail = TwoDiffTail(a.y, c.y, acy), bcyTail = TwoDiffTail(b.y, c.y, bcy);
+    if (acxTail == 0.0 && acyTail == 0.0 && bcxTail == 0.0 && bcyTail == 0.0) return det;
+
+    errorBound = kOrientErrorBoundC * detSum + kResultErrorBound * std::abs(det);
+    det += (acx * bcyTail + bcy * acxTail) - (acy * bcxTail + bcx * acyTail);
+    if (det >= errorBound || -det >= errorBound) return det;
+
+    // exact: add the tail products one by one
+    double s1, s0, t1, t0, u[4];
+    double C1[8], C2[12], D[16];
+    TwoProduct(acxTail, bcy, s1, s0);
+    TwoProduct(acyTail, bcx, t1, t0);
+    TwoTwoDiff(s1, s0, t1, t0, u);
+    const int c1Length = ExpansionSum(4, B, 4, u, C1);
+
+    TwoProduct(acx, bcyTail, s1, s0);
+    TwoProduct(acy, bcxTail, t1, t0);
+    TwoTwoDiff(s1, s0, t1, t0, u);
+    const int c2Length = ExpansionSum(c1Length, C1, 4, u, C2);
+
+    TwoProduct(acxTail, bcyTail, s1, s0);
+    TwoProduct(acyTail, bcxTail, t1, t0);
+    TwoTwoDiff(s1, s0, t1, t0, u);
+    const int dLength = ExpansionSum(c2Length, C2, 4, u, D);
+    return D[dLength - 1];
+}
+
+// A coordinate difference as an expansion of one or two terms
+struct Difference {
+    double Terms[2];
+    int Length;
+    const double* Begin() const { return Terms + 2 - Length; }
+};
+
+Difference ExactDifference(double a, double b)
+{
+    Difference difference;
+    TwoDiff(a, b, difference.Terms[1], difference.Terms[0]);
+    difference.Length = difference.Terms[0] != 0.0 ? 2 : 1;
+    return difference;
+}
+
+// The in-circle determinant over the given differences, with no rounding
+// in any step
+double InCircleExpansion(const Difference& adx, const Difference& ady, const Difference& bdx, const Difference& bdy,
+    const Difference& cdx, const Difference& cdy)
+{
+    // lift(p) * (qdx * rdy - rdx * qdy) for each rotation of a, b, c
+    auto term = [](const Difference& pdx, const Difference& pdy, const Difference& qdx, const Difference& qdy,
+                    const Difference& rdx, const Difference& rdy, double* h) {
+        double left[8], right[8], minor[16], xx[8], yy[8], lift[16];
+        const int leftLength = MultiplyExpansion(qdx.Length, qdx.Begin(), rdy.Length, rdy.Begin(), left);
+        const int rightLength = MultiplyExpansion(rdx.Length, rdx.Begin(), qdy.Length, qdy.Begin(), right);
+        Negate(rightLength, right);
+        const int minorLength = ExpansionSum(leftLength, left, rightLength, right, minor);
+        const int xxLength = MultiplyExpansion(pdx.Length, pdx.Begin(), pdx.Length, pdx.Begin(), xx);
+        const int yyLength = MultiplyExpansion(pdy.Length, pdy.Begin(), pdy.Length, pdy.Begin(), yy);
+        const int liftLength = ExpansionSum(xxLength, xx, yyLength, yy, lift);
+        return MultiplyExpansion(liftLength, lift, minorLength, minor, h);
+    };
+    double aTerm[kMaxProductLength], bTerm[kMaxProductLength], cTerm[kMaxProductLength];
+    double ab[2 * kMaxProductLength], det[3 * kMaxProductLength];
+    const int aLength = term(adx, ady, bdx, bdy, cdx, cdy, aTerm);
+    const int bLength = term(bdx, bdy, cdx, cdy, adx, ady, bTerm);
+    const int cLength = term(cdx, cdy, adx, ady, bdx, bdy, cTerm);
+    const int abLength = ExpansionSum(aLength, aTerm, bLength, bTerm, ab);
+    const int detLength = ExpansionSum(abLength, ab, cLength, cTerm, det);
+    return det[detLength - 1];
+}
+
+// InCircle for determinants too close to zero for the plain evaluation
+double InCircleAdapt(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c, const glm::dvec2& d, double permanent)
+{
+    const Difference adx = ExactDifference(a.x, d.x), ady = ExactDifference(a.y, d.y);
+    const Difference bdx = ExactDifference(b.x, d.x), bdy = ExactDifference(b.y, d.y);
+    const Difference cdx = ExactDifference(c.x, d.x), cdy = ExactDifference(c.y, d.y);
+    const bool exactDifferences = adx.Length == 1 && ady.Length == 1 && bdx.Length == 1 && bdy.Length == 1
+        && cdx.Length == 1 && cdy.Length == 1;
+
+    // first the determinant of the rounded differences, which is short
+    auto rounded = [](const Difference& difference) { return Difference{ { 0.0, difference.Terms[1] }, 1 }; };
+    const double det = InCircleExpansion(rounded(adx), rounded(ady), rounded(bdx), rounded(bdy), rounded(cdx), rounded(cdy));
+    if (exactDifferences || std::abs(det) >= kInCircleErrorBoundB * permanent) return det;
+    return InCircleExpansion(adx, ady, bdx, bdy, cdx, cdy);
+}
+
+} // namespace
+
+double Orient2D(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c)
+{
+    const double detLeft = (a.x - c.x) * (b.y - c.y);
+    const double detRight = (a.y - c.y) * (b.x - c.x);
+    const double det = detLeft - detRight;
+
+    // Products of opposite signs cannot cancel and always pass the bound. The
+    // test is left without sign branches, which mispredict on random input.
+    const double detSum = std::abs(detLeft) + std::abs(detRight);
+    const double errorBound = kOrientErrorBoundA * detSum;
+    if (std::abs(det) >= errorBound) return det;
+    return Orient2DAdapt(a, b, c, detSum);
+}
+
+double InCircle(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c, const glm::dvec2& d)
+{
+    const double adx = a.x - d.x, ady = a.y - d.y;
+    const double bdx = b.x - d.x, bdy = b.y - d.y;
+    const double cdx = c.x - d.x, cdy = c.y - d.y;
+
+    const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    const double aLift = adx * adx + ady * ady;
+    const double cdxady = cdx * ady, adxcdy = adx * cdy;
+    const double bLift = bdx * bdx + bdy * bdy;
+    const double adxbdy = adx * bdy, bdxady = bdx * ady;
+    const double cLift = cdx * cdx + cdy * cdy;
+
+    const double det = aLift * (bdxcdy - cdxbdy) + bLift * (cdxady - adxcdy) + cLift * (adxbdy - bdxady);
+    const double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * aLift + (std::abs(cdxady) + std::abs(adxcdy)) * bLift
+        + (std::abs(adxbdy) + std::abs(bdxady)) * cLift;
+    const double errorBound = kInCircleErrorBoundA * permanent;
+    if (std::abs(det) > errorBound) return det;
+    return InCircleAdapt(a, b, c, d, permanent);
+}
+
+} // namespace EasyLine
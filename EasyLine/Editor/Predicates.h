@@ -0,0 +1,24 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace EasyLine {
+
+// Exact geometric predicates, after Shewchuk's "Adaptive Precision
+// Floating-Point Arithmetic and Fast Robust Geometric Predicates".
+//
+// The determinant is first evaluated in plain doubles and returned when it
+// is larger than a bound on its rounding error, which is nearly always the
+// case. Only nearly degenerate inputs fall through to expansion arithmetic,
+// which adds just as many exact terms as the sign needs. The sign of the
+// result is always exact, the magnitude only approximate. Float points
+// convert to double exactly, so document coordinates can be passed as is.
+
+// Positive if a, b, c turn counterclockwise, negative if clockwise, zero if
+// they are collinear; about twice the signed area of the triangle
+double Orient2D(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c);
+// Positive if d lies inside the circle through a, b, c (taken counterclockwise;
+// the sign flips for clockwise), negative outside, zero on it
+double InCircle(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c, const glm::dvec2& d);
+
+} // namespace EasyLine
@@ -0,0 +1,168 @@
+#include "RasterExport.h"
+#include "Camera.h"
+#include "FileWriter.h"
+#include "LineDocument.h"
+#include "Log.h"
+#include "PngWriter.h"
+#include "Renderer.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace EasyLine {
+
+// Tiles are wide and short: a strip spans the image width, so its height
+// decides the memory held (2 strips x width x kTileHeight x 3 bytes)
+static constexpr uint32_t kMaxTileWidth = 4096;
+static constexpr uint32_t kTileHeight = 256;
+
+namespace {
+
+// A tile whose pixels are on their way into a pixel buffer
+struct PendingTile {
+    uint32_t Buffer = 0;
+    uint8_t* Strip = nullptr;
+    uint32_t X = 0;
+    uint32_t Columns = 0;
+    uint32_t Rows = 0;
+    bool LastInStrip = false;
+};
+
+// Offscreen target and readback buffers, released on every exit path
+struct TileTarget {
+    GLuint Framebuffer = 0;
+    GLuint Renderbuffer = 0;
+    GLuint PixelBuffers[2] = {};
+
+    ~TileTarget() {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (PixelBuffers[0]) glDeleteBuffers(2, PixelBuffers);
+        if (Renderbuffer) glDeleteRenderbuffers(1, &Renderbuffer);
+        if (Framebuffer) glDeleteFramebuffers(1, &Framebuffer);
+    }
+
+    bool Create(uint32_t width, uint32_t height) {
+        glGenFramebuffers(1, &Framebuffer);
+        glGenRenderbuffers(1, &Renderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, Renderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, (GLsizei)width, (GLsizei)height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, Framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, Renderbuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) return false;
+
+        glGenBuffers(2, PixelBuffers);
+        for (GLuint buffer : PixelBuffers) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return glGetError() == GL_NO_ERROR;
+    }
+};
+
+} // namespace
+
+bool ExportPng(const LineDocument& document, const std::string& path, const RasterExportSettings& settings) {
+    const uint32_t width = settings.Width, height = settings.Height;
+    const glm::vec2 regionSize = settings.Region.GetSize();
+    if (width == 0 || height == 0 || settings.Region.IsEmpty() || !(regionSize.x > 0.0f || regionSize.y > 0.0f)) {
+        EL_CORE_ERROR("Invalid PNG export of {} x {}", width, height);
+        return false;
+    }
+
+    GLint maxRenderbuffer = 0, maxViewport[2] = {};
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbuffer);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewport);
+    const uint32_t tileWidth = std::min({ kMaxTileWidth, width, (uint32_t)maxRenderbuffer, (uint32_t)maxViewport[0] });
+    const uint32_t tileHeight = std::min({ kTileHeight, height, (uint32_t)maxRenderbuffer, (uint32_t)maxViewport[1] });
+
+    TileTarget target;
+    if (!target.Create(tileWidth, tileHeight)) {
+        EL_CORE_ERROR("Cannot create a {} x {} offscreen target for PNG export", tileWidth, tileHeight);
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    FileWriter out;
+    if (!out.Open(path)) return false;
+    PngWriter png;
+    png.Begin(out, width, height);
+
+    // square pixels: the region is fitted and centered
+    const float pixelSize = std::max(regionSize.x / width, regionSize.y / height);
+    const glm::vec2 topLeft = settings.Region.GetCenter() + glm::vec2(-0.5f * width, 0.5f * height) * pixelSize;
+    Camera camera((float)tileWidth, (float)tileHeight);
+    camera.SetZoom(0.5f * tileHeight * pixelSize);
+
+    std::vector<uint8_t> strips[2];
+    for (auto& strip : strips) strip.resize((size_t)width * tileHeight * 3);
+
+    bool failed = false;
+    // Copy a tile out of its pixel buffer (bottom-up RGBA) into its strip (top-down RGB)
+    auto resolve = [&](const PendingTile& tile) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, target.PixelBuffers[tile.Buffer]);
+        const uint8_t* pixels = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)tile.Columns * tile.Rows * 4, GL_MAP_READ_BIT);
+        if (!pixels) {
+            failed = true;
+            return;
+        }
+        for (uint32_t j = 0; j < tile.Rows; j++) {
+            const uint8_t* src = pixels + (size_t)j * tile.Columns * 4;
+            uint8_t* dst = tile.Strip + ((size_t)(tile.Rows - 1 - j) * width + tile.X) * 3;
+            for (uint32_t i = 0; i < tile.Columns; i++, src += 4, dst += 3) {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        if (tile.LastInStrip) png.Submit(tile.Strip, tile.Rows);
+    };
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer);
+    glViewport(0, 0, (GLsizei)tileWidth, (GLsizei)tileHeight);
+    glClearColor(settings.Background.r, settings.Background.g, settings.Background.b, settings.Background.a);
+
+    PendingTile pending;
+    bool hasPending = false;
+    uint32_t buffer = 0;
+    for (uint32_t y = 0, strip = 0; y < height && !failed; y += tileHeight, strip ^= 1) {
+        const uint32_t rows = std::min(tileHeight, height - y);
+        for (uint32_t x = 0; x < width && !failed; x += tileWidth) {
+            const uint32_t columns = std::min(tileWidth, width - x);
+            camera.SetPosition(topLeft + glm::vec2(x + 0.5f * tileWidth, -(y + 0.5f * tileHeight)) * pixelSize);
+
+            glClear(GL_COLOR_BUFFER_BIT);
+            Renderer::BeginFrame(camera);
+            Renderer::DrawDocument(document);
+            Renderer::EndFrame();
+
+            // the strip's rows are the top of the tile; the read only completes when the buffer is mapped
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, target.PixelBuffers[buffer]);
+            glReadPixels(0, (GLint)(tileHeight - rows), (GLsizei)columns, (GLsizei)rows, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            if (hasPending) resolve(pending);
+            pending = { buffer, strips[strip].data(), x, columns, rows, x + tileWidth >= width };
+            hasPending = true;
+            buffer ^= 1;
+        }
+    }
+    if (hasPending && !failed) resolve(pending);
+
+    const bool written = !failed && png.End();
+    if (!written || glGetError() != GL_NO_ERROR) {
+        out.Discard();
+        EL_CORE_ERROR("PNG export to {} failed", path);
+        return false;
+    }
+    const uint64_t bytes = out.GetBytesWritten();
+    if (!out.Close()) return false;
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EL_CORE_INFO("Saved {} ({} x {}, {:.1f} MB in {:.0f} ms)", path, width, height, bytes / 1e6, ms);
+    return true;
+}
+
+} // namespace EasyLine
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "AABB.h"
+#include "Color.h"
+
+namespace EasyLine {
+
+class LineDocument;
+
+struct RasterExportSettings {
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    // World rectangle to show; it is centered in the image with square pixels
+    AABB Region;
+    Color Background = { 0.45f, 0.55f, 0.60f, 1.0f };   // the canvas color
+};
+
+// PNG export at any resolution (32k x 32k and beyond, for plotting).
+//
+// The image is rendered in tiles through one offscreen framebuffer, a strip
+// of tiles at a time. Tiles are read back through two pixel buffers, so the
+// copy of one overlaps the rendering of the next, and finished strips are
+// encoded on the job system by PngWriter while the following strip renders.
+// Memory use is two strips, never the whole image.
+//
+// Needs a current GL context with the Renderer initialized (a hidden window
+// is enough, see the headless export in main.cpp). Blocks until the file is
+// written; returns false and logs if anything failed.
+bool ExportPng(const LineDocument& document, const std::string& path, const RasterExportSettings& settings);
+
+} // namespace EasyLine
@@ -1,25 +1,77 @@
 #include "Renderer.h"
+#include "Dimension.h"
+#include "GlyphAtlas.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "LinePicker.h"
+#include "LineTessellator.h"
 #include "Log.h"
+#include "SelectionSet.h"
 #include <glad/glad.h>
 #include <vector>
+#include <atomic>
 #include <mutex>
 #include <cmath>
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include "glm/glm.hpp"
 
 namespace EasyLine {
 
-struct Vertex {
-    float x, y;      // position (NDC)
-    float r, g, b, a; // color
-};
+using Vertex = LineVertex;
 
-static std::vector<Vertex> g_vertices;
+static FrameArena g_frameArena(8 << 20);
+static FrameVector<Vertex> g_vertices(&g_frameArena);
+static size_t g_frameVertexPeak = 0;
 static unsigned int g_vao = 0, g_vbo = 0, g_program = 0;
 static int g_fbWidth = 1, g_fbHeight = 1;
 static std::mutex g_mutex;
 static glm::mat4 g_ViewProjectionMatrix;
+static AABB g_viewBounds;
+static std::vector<std::vector<Vertex>> g_chunkStaging;  // per document chunk, reused across frames
+static RendererStats g_stats;
+
+// Selection overlay: the document's vertex buffer drawn again by a program that
+// keeps only the lines whose bit is set. Both buffers are read as texture buffers.
+static const Color kSelectionColor = { 0.25f, 0.6f, 1.0f, 1.0f };
+static unsigned int g_selectionProgram = 0;
+static unsigned int g_selectionBuffer = 0, g_selectionTexture = 0;  // SelectionSet bits, by handle
+static unsigned int g_handleBuffer = 0, g_handleTexture = 0;        // handle of each line in the vertex buffer
+static std::vector<uint8_t> g_chunkSelected;                        // per chunk: any line selected
+static std::vector<std::vector<uint32_t>> g_chunkHandles;           // per tracked chunk: handles of the lines staged
+static std::vector<uint8_t> g_chunkTracked;                         // per chunk: handles staged this frame
+static int g_maxTextureBufferSize = 0;
+
+// ID-buffer picking: the vertex buffer drawn once more with each line's
+// handle + 1 into an integer target, and the pixels around the hover point
+// read back into a pixel buffer that is mapped only once its fence has passed
+struct IdReadback {
+    int Width = 0, Height = 0;
+    glm::ivec2 Center = { 0, 0 };   // hover point within the region
+};
+static unsigned int g_idProgram = 0;
+static unsigned int g_idFramebuffer = 0, g_idRenderbuffer = 0, g_idPixelBuffer = 0;
+static int g_idWidth = 0, g_idHeight = 0;
+static bool g_idPicking = false;
+static GLsync g_idFence = nullptr;
+static IdReadback g_idReadback;
+static bool g_hasHoverPoint = false;
+static glm::ivec2 g_hoverPixel = { 0, 0 };
+static int g_hoverRadius = 0;
+static bool g_hasHoveredLine = false;
+static LineHandle g_hoveredLine = 0;
+static float g_pixelSize = 1.0f;
+
+// Dimensions: the layout's quads as instances of one quad strip, cut out of
+// the glyph atlas's distance fields, uploaded only when the layout changes
+static const Color kDimensionColor = { 0.55f, 0.95f, 0.65f, 1.0f };
+static constexpr int kGlyphPixelHeight = 48;
+static GlyphAtlas g_glyphAtlas;
+static DimensionLayout g_dimensionLayout;
+static unsigned int g_glyphProgram = 0, g_glyphVao = 0, g_glyphBuffer = 0, g_atlasTexture = 0;
+static uint64_t g_glyphBufferVersion = UINT64_MAX;  // layout version in the instance buffer
 
 // Shaders are loaded from Resource/Shader at runtime. See ReadFile() below.
 
@@ -47,52 +99,188 @@ static unsigned int CompileShader(unsigned int type, const char* src) {
     return id;
 }
 
-bool Renderer::Init(int fbWidth, int fbHeight) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    g_fbWidth = fbWidth; g_fbHeight = fbHeight;
-
-    EL_CORE_INFO("Initializing renderer ({} x {})", fbWidth, fbHeight);
-
-    // Load shader files (expected under Resource/Shader next to the exe)
-    const std::string vertPath = "Resource/Shader/line.vert.glsl";
-    const std::string fragPath = "Resource/Shader/line.frag.glsl";
-
+// Load, compile and link a program from shader files (expected under
+// Resource/Shader next to the exe), with a geometry shader if geomPath is
+// given. Returns 0 on failure.
+static unsigned int LoadProgram(const std::string& vertPath, const std::string& fragPath, const std::string& geomPath = std::string()) {
     std::string vsrc = ReadFile(vertPath);
-    if (vsrc.empty()) { EL_CORE_ERROR("Failed to read vertex shader: {}", vertPath); return false; }
+    if (vsrc.empty()) { EL_CORE_ERROR("Failed to read vertex shader: {}", vertPath); return 0; }
     std::string fsrc = ReadFile(fragPath);
-    if (fsrc.empty()) { EL_CORE_ERROR("Failed to read fragment shader: {}", fragPath); return false; }
+    if (fsrc.empty()) { EL_CORE_ERROR("Failed to read fragment shader: {}", fragPath); return 0; }
+    std::string gsrc;
+    if (!geomPath.empty()) {
+        gsrc = ReadFile(geomPath);
+        if (gsrc.empty()) { EL_CORE_ERROR("Failed to read geometry shader: {}", geomPath); return 0; }
+    }
 
     unsigned int vs = CompileShader(GL_VERTEX_SHADER, vsrc.c_str());
-    if (!vs) { EL_CORE_ERROR("Vertex shader compile failed"); return false; }
+    if (!vs) { EL_CORE_ERROR("Vertex shader compile failed: {}", vertPath); return 0; }
 
     unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fsrc.c_str());
-    if (!fs) { EL_CORE_ERROR("Fragment shader compile failed"); glDeleteShader(vs); return false; }
+    if (!fs) { EL_CORE_ERROR("Fragment shader compile failed: {}", fragPath); glDeleteShader(vs); return 0; }
+
+    unsigned int gs = 0;
+    if (!gsrc.empty()) {
+        gs = CompileShader(GL_GEOMETRY_SHADER, gsrc.c_str());
+        if (!gs) { EL_CORE_ERROR("Geometry shader compile failed: {}", geomPath); glDeleteShader(vs); glDeleteShader(fs); return 0; }
+    }
 
-    g_program = glCreateProgram();
-    if (!g_program) { EL_CORE_ERROR("Failed to create shader program"); glDeleteShader(vs); glDeleteShader(fs); return false; }
+    unsigned int program = glCreateProgram();
+    if (!program) { EL_CORE_ERROR("Failed to create shader program"); glDeleteShader(vs); glDeleteShader(fs); if (gs) glDeleteShader(gs); return 0; }
 
-    glAttachShader(g_program, vs);
-    glAttachShader(g_program, fs);
-    glLinkProgram(g_program);
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    if (gs) glAttachShader(program, gs);
+    glLinkProgram(program);
+
+    // shaders are no longer needed once linked
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    if (gs) glDeleteShader(gs);
 
     int linked = 0;
-    glGetProgramiv(g_program, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
     if (!linked) {
         char infoLog[1024];
-        glGetProgramInfoLog(g_program, 1024, NULL, infoLog);
+        glGetProgramInfoLog(program, 1024, NULL, infoLog);
         EL_CORE_ERROR("Shader program linking failed: {}", infoLog);
-        glDeleteProgram(g_program); g_program = 0;
-        glDeleteShader(vs); glDeleteShader(fs);
-        return false;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// Buffer and the texture that reads it as one uint per texel
+static bool CreateTextureBuffer(unsigned int& buffer, unsigned int& texture) {
+    glGenBuffers(1, &buffer);
+    glGenTextures(1, &texture);
+    if (!buffer || !texture) return false;
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    return true;
+}
+
+static void DeleteTextureBuffer(unsigned int& buffer, unsigned int& texture) {
+    if (texture) { glDeleteTextures(1, &texture); texture = 0; }
+    if (buffer) { glDeleteBuffers(1, &buffer); buffer = 0; }
+}
+
+static void ShutdownGlyphs() {
+    if (g_glyphProgram) { glDeleteProgram(g_glyphProgram); g_glyphProgram = 0; }
+    if (g_glyphVao) { glDeleteVertexArrays(1, &g_glyphVao); g_glyphVao = 0; }
+    if (g_glyphBuffer) { glDeleteBuffers(1, &g_glyphBuffer); g_glyphBuffer = 0; }
+    if (g_atlasTexture) { glDeleteTextures(1, &g_atlasTexture); g_atlasTexture = 0; }
+    g_glyphAtlas.Clear();
+    g_dimensionLayout.Clear();
+    g_glyphBufferVersion = UINT64_MAX;
+}
+
+// Glyph atlas texture, program and instanced quad layout for DrawDimensions()
+static bool InitGlyphs() {
+    if (!g_glyphAtlas.Build("Resource/Font/Roboto-Medium.ttf", kGlyphPixelHeight, "Resource/Font/Roboto-Medium.sdf")) return false;
+    g_glyphProgram = LoadProgram("Resource/Shader/glyph.vert.glsl", "Resource/Shader/sdf.frag.glsl");
+    glGenTextures(1, &g_atlasTexture);
+    glGenVertexArrays(1, &g_glyphVao);
+    glGenBuffers(1, &g_glyphBuffer);
+    if (!g_glyphProgram || !g_atlasTexture || !g_glyphVao || !g_glyphBuffer) return false;
+
+    glBindTexture(GL_TEXTURE_2D, g_atlasTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, g_glyphAtlas.GetWidth(), g_glyphAtlas.GetHeight(), 0, GL_RED, GL_UNSIGNED_BYTE, g_glyphAtlas.GetPixels());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // attribute layout, one GlyphQuad per instance: 0: position, 1: right, 2: up, 3: uv min, 4: uv max
+    glBindVertexArray(g_glyphVao);
+    glBindBuffer(GL_ARRAY_BUFFER, g_glyphBuffer);
+    glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+    const size_t offsets[] = { offsetof(GlyphQuad, Position), offsetof(GlyphQuad, Right), offsetof(GlyphQuad, Up), offsetof(GlyphQuad, UvMin),
+        offsetof(GlyphQuad, UvMax) };
+    for (GLuint i = 0; i < 5; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribPointer(i, 2, GL_FLOAT, GL_FALSE, sizeof(GlyphQuad), (void*)offsets[i]);
+        glVertexAttribDivisor(i, 1);
     }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(g_glyphProgram);
+    glUniform1i(glGetUniformLocation(g_glyphProgram, "u_Atlas"), 0);
+    glUniform4f(glGetUniformLocation(g_glyphProgram, "u_Color"), kDimensionColor.r, kDimensionColor.g, kDimensionColor.b, kDimensionColor.a);
+    glUseProgram(0);
+    return true;
+}
+
+bool Renderer::Init(int fbWidth, int fbHeight) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_fbWidth = fbWidth; g_fbHeight = fbHeight;
+
+    EL_CORE_INFO("Initializing renderer ({} x {})", fbWidth, fbHeight);
+
+    g_program = LoadProgram("Resource/Shader/line.vert.glsl", "Resource/Shader/line.frag.glsl");
+    if (!g_program) return false;
 
     glUseProgram(g_program);
     glUniformMatrix4fv(glGetUniformLocation(g_program, "u_ViewProjection"), 1, GL_FALSE, &g_ViewProjectionMatrix[0][0]);
     glUseProgram(0);
 
-    // shaders are no longer needed after a successful link
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    // The selection overlay and the ID buffer find lines in the vertex buffer
+    // by handle. Without them, selections are not shown and hover picking
+    // is left to the CPU picker.
+    if (!CreateTextureBuffer(g_handleBuffer, g_handleTexture)) {
+        EL_CORE_ERROR("Failed to create the line handle buffer");
+        DeleteTextureBuffer(g_handleBuffer, g_handleTexture);
+    }
+    g_selectionProgram = g_handleTexture ? LoadProgram("Resource/Shader/selection.vert.glsl", "Resource/Shader/line.frag.glsl") : 0;
+    if (g_selectionProgram && CreateTextureBuffer(g_selectionBuffer, g_selectionTexture)) {
+        glUseProgram(g_selectionProgram);
+        glUniform1i(glGetUniformLocation(g_selectionProgram, "u_Selection"), 0);
+        glUniform1i(glGetUniformLocation(g_selectionProgram, "u_Handles"), 1);
+        glUniform4f(glGetUniformLocation(g_selectionProgram, "u_Color"), kSelectionColor.r, kSelectionColor.g, kSelectionColor.b, kSelectionColor.a);
+        glUseProgram(0);
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &g_maxTextureBufferSize);
+    } else {
+        EL_CORE_ERROR("Failed to create the selection overlay");
+        if (g_selectionProgram) { glDeleteProgram(g_selectionProgram); g_selectionProgram = 0; }
+        DeleteTextureBuffer(g_selectionBuffer, g_selectionTexture);
+    }
+
+    g_idProgram = g_handleTexture ? LoadProgram("Resource/Shader/id.vert.glsl", "Resource/Shader/id.frag.glsl", "Resource/Shader/id.geom.glsl") : 0;
+    if (g_idProgram) {
+        glGenFramebuffers(1, &g_idFramebuffer);
+        glGenRenderbuffers(1, &g_idRenderbuffer);
+        glGenBuffers(1, &g_idPixelBuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, g_idFramebuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, g_idRenderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, 1, 1);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, g_idRenderbuffer);
+        const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (complete) {
+            glUseProgram(g_idProgram);
+            glUniform1i(glGetUniformLocation(g_idProgram, "u_Handles"), 1);
+            glUseProgram(0);
+        } else {
+            EL_CORE_ERROR("ID buffer framebuffer is incomplete");
+            glDeleteProgram(g_idProgram);
+            g_idProgram = 0;
+        }
+    }
+    if (!g_idProgram) EL_CORE_ERROR("Failed to create the ID buffer; hover picking stays on the CPU");
+
+    if (!InitGlyphs()) {
+        EL_CORE_ERROR("Failed to create the glyph atlas; dimensions are not drawn");
+        ShutdownGlyphs();
+    }
 
     glGenVertexArrays(1, &g_vao);
     glGenBuffers(1, &g_vbo);
@@ -127,7 +315,22 @@ void Renderer::Shutdown() {
     if (g_vbo) { glDeleteBuffers(1, &g_vbo); g_vbo = 0; }
     if (g_vao) { glDeleteVertexArrays(1, &g_vao); g_vao = 0; }
     if (g_program) { glDeleteProgram(g_program); g_program = 0; }
-    g_vertices.clear();
+    if (g_selectionProgram) { glDeleteProgram(g_selectionProgram); g_selectionProgram = 0; }
+    DeleteTextureBuffer(g_selectionBuffer, g_selectionTexture);
+    DeleteTextureBuffer(g_handleBuffer, g_handleTexture);
+    if (g_idFence) { glDeleteSync(g_idFence); g_idFence = nullptr; }
+    if (g_idProgram) { glDeleteProgram(g_idProgram); g_idProgram = 0; }
+    if (g_idPixelBuffer) { glDeleteBuffers(1, &g_idPixelBuffer); g_idPixelBuffer = 0; }
+    if (g_idRenderbuffer) { glDeleteRenderbuffers(1, &g_idRenderbuffer); g_idRenderbuffer = 0; }
+    if (g_idFramebuffer) { glDeleteFramebuffers(1, &g_idFramebuffer); g_idFramebuffer = 0; }
+    g_idWidth = g_idHeight = 0;
+    ShutdownGlyphs();
+    g_vertices = FrameVector<Vertex>(&g_frameArena);
+    g_frameArena.Reset();
+    g_chunkStaging.clear();
+    g_chunkHandles.clear();
+    g_chunkTracked.clear();
+    g_chunkSelected.clear();
 }
 
 void Renderer::OnResize(int fbWidth, int fbHeight) {
@@ -135,33 +338,312 @@ void Renderer::OnResize(int fbWidth, int fbHeight) {
     g_fbWidth = fbWidth; g_fbHeight = fbHeight;
 }
 
+// Picks from the last ID readback once the GPU has written it; never waits
+static void ResolveIdReadback() {
+    if (!g_idFence) return;
+    if (glClientWaitSync(g_idFence, 0, 0) == GL_TIMEOUT_EXPIRED) return;
+    glDeleteSync(g_idFence);
+    g_idFence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, g_idPixelBuffer);
+    const size_t size = (size_t)g_idReadback.Width * g_idReadback.Height * sizeof(uint32_t);
+    const uint32_t* ids = (const uint32_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    g_hasHoveredLine = ids && g_hasHoverPoint && PickIdRegion(ids, g_idReadback.Width, g_idReadback.Height, g_idReadback.Center, g_hoveredLine);
+    if (ids) glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
 void Renderer::BeginFrame(const Camera& camera) {
+    std::lock_guard<std::mutex> lock(g_mutex);
     g_ViewProjectionMatrix = camera.GetViewProjectionMatrix();
+    g_viewBounds = camera.GetViewBounds();
+    g_pixelSize = camera.GetPixelSize();
+    ResolveIdReadback();
+    g_stats = RendererStats();
+    // size the batch from last frame so it does not regrow (and leave dead copies in the arena)
+    g_vertices.reserve(g_frameVertexPeak);
+    g_frameVertexPeak = 0;
 }
 
 void Renderer::DrawLine(float x0, float y0, float x1, float y1, float thickness, Color color) {
     std::lock_guard<std::mutex> lock(g_mutex);
 
-    glm::vec2 p0 = {x0, y0};
-    glm::vec2 p1 = {x1, y1};
+    size_t first = g_vertices.size();
+    g_vertices.resize(first + kVerticesPerLine);
+    TessellateLine({x0, y0}, {x1, y1}, thickness, color, g_vertices.data() + first);
+}
+
+// The handles of the lines of tracked chunks, at their place in the vertex
+// buffer DrawDocument just filled
+static void UploadHandles(size_t chunkCount, size_t totalVertices) {
+    glBindBuffer(GL_TEXTURE_BUFFER, g_handleBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, totalVertices / kVerticesPerLine * sizeof(uint32_t), nullptr, GL_STREAM_DRAW);
+    size_t offset = 0;
+    for (size_t i = 0; i < chunkCount; i++) {
+        const size_t vertices = g_chunkStaging[i].size();
+        if (vertices > 0 && g_chunkTracked[i]) {
+            const std::vector<uint32_t>& handles = g_chunkHandles[i];
+            glBufferSubData(GL_TEXTURE_BUFFER, offset / kVerticesPerLine * sizeof(uint32_t), handles.size() * sizeof(uint32_t), handles.data());
+        }
+        offset += vertices;
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
 
-    glm::vec2 dir = glm::normalize(p1 - p0);
-    glm::vec2 normal = {-dir.y, dir.x};
+// Draws the selected lines over the document from the vertex buffer, only
+// the vertices of chunks with a selection
+static void DrawSelectionOverlay(size_t chunkCount) {
+    FrameVector<GLint> firsts(&g_frameArena);
+    FrameVector<GLsizei> counts(&g_frameArena);
+    size_t offset = 0;
+    for (size_t i = 0; i < chunkCount; i++) {
+        const size_t vertices = g_chunkStaging[i].size();
+        if (vertices > 0 && i < g_chunkSelected.size() && g_chunkSelected[i]) {
+            firsts.push_back((GLint)offset);
+            counts.push_back((GLsizei)vertices);
+        }
+        offset += vertices;
+    }
+    if (firsts.empty()) return;
+
+    glUseProgram(g_selectionProgram);
+    glUniformMatrix4fv(glGetUniformLocation(g_selectionProgram, "u_ViewProjection"), 1, GL_FALSE, &g_ViewProjectionMatrix[0][0]);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, g_selectionTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, g_handleTexture);
+    glMultiDrawArrays(GL_TRIANGLES, firsts.data(), counts.data(), (GLsizei)firsts.size());
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
 
-    float halfThickness = thickness / 2.0f;
+// Draws the vertex buffer's line handles into the ID buffer and, unless one
+// is still in flight, starts reading back the pixels around the hover point
+static void DrawIdBuffer(size_t totalVertices) {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_idFramebuffer);
+    if (g_idWidth != g_fbWidth || g_idHeight != g_fbHeight) {
+        glBindRenderbuffer(GL_RENDERBUFFER, g_idRenderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, g_fbWidth, g_fbHeight);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        g_idWidth = g_fbWidth;
+        g_idHeight = g_fbHeight;
+    }
+    glViewport(0, 0, g_idWidth, g_idHeight);
+    const GLuint nothing[4] = { 0, 0, 0, 0 };
+    glClearBufferuiv(GL_COLOR, 0, nothing);
+
+    if (totalVertices > 0) {
+        glUseProgram(g_idProgram);
+        glUniformMatrix4fv(glGetUniformLocation(g_idProgram, "u_ViewProjection"), 1, GL_FALSE, &g_ViewProjectionMatrix[0][0]);
+        // hairlines are widened to cover the pixels they pass through
+        glUniform1f(glGetUniformLocation(g_idProgram, "u_MinHalfWidth"), 0.75f * g_pixelSize);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_BUFFER, g_handleTexture);
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)totalVertices);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
 
-    Vertex v0 = { p0.x + normal.x * halfThickness, p0.y + normal.y * halfThickness, color.r, color.g, color.b, color.a };
-    Vertex v1 = { p1.x + normal.x * halfThickness, p1.y + normal.y * halfThickness, color.r, color.g, color.b, color.a };
-    Vertex v2 = { p0.x - normal.x * halfThickness, p0.y - normal.y * halfThickness, color.r, color.g, color.b, color.a };
-    Vertex v3 = { p1.x - normal.x * halfThickness, p1.y - normal.y * halfThickness, color.r, color.g, color.b, color.a };
+    if (g_hasHoverPoint && !g_idFence) {
+        // GL rows count up from the bottom
+        const int hoverY = g_idHeight - 1 - g_hoverPixel.y;
+        const int x0 = std::max(g_hoverPixel.x - g_hoverRadius, 0), x1 = std::min(g_hoverPixel.x + g_hoverRadius + 1, g_idWidth);
+        const int y0 = std::max(hoverY - g_hoverRadius, 0), y1 = std::min(hoverY + g_hoverRadius + 1, g_idHeight);
+        if (x0 < x1 && y0 < y1) {
+            g_idReadback.Width = x1 - x0;
+            g_idReadback.Height = y1 - y0;
+            g_idReadback.Center = { g_hoverPixel.x - x0, hoverY - y0 };
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, g_idPixelBuffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)g_idReadback.Width * g_idReadback.Height * sizeof(uint32_t), nullptr, GL_STREAM_READ);
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+            glReadPixels(x0, y0, g_idReadback.Width, g_idReadback.Height, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            g_idFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        } else {
+            g_hasHoveredLine = false;
+        }
+    }
 
-    g_vertices.push_back(v0);
-    g_vertices.push_back(v1);
-    g_vertices.push_back(v2);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
 
-    g_vertices.push_back(v1);
-    g_vertices.push_back(v3);
-    g_vertices.push_back(v2);
+bool Renderer::IsIdPickingSupported() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_idProgram != 0;
+}
+
+void Renderer::SetIdPicking(bool enabled) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_idPicking = enabled && g_idProgram;
+    if (!g_idPicking) g_hasHoveredLine = false;
+}
+
+void Renderer::SetHoverPoint(const glm::vec2& pixel, float radius) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_hasHoverPoint = true;
+    g_hoverPixel = glm::ivec2(glm::floor(pixel));
+    g_hoverRadius = std::max(0, (int)std::ceil(radius));
+}
+
+void Renderer::ClearHoverPoint() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_hasHoverPoint = false;
+    g_hasHoveredLine = false;
+}
+
+bool Renderer::GetHoveredLine(LineHandle& handle) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_idPicking || !g_hasHoveredLine) return false;
+    handle = g_hoveredLine;
+    return true;
+}
+
+void Renderer::SetSelection(const SelectionSet& selection) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_chunkSelected.clear();
+    if (!g_selectionProgram || selection.IsEmpty()) return;
+
+    const size_t chunkCount = selection.GetChunkCount();
+    g_chunkSelected.resize(chunkCount);
+    for (size_t c = 0; c < chunkCount; c++) {
+        const uint64_t* words = selection.GetChunkWords(c);
+        g_chunkSelected[c] = std::any_of(words, words + SelectionSet::kWordsPerChunk, [](uint64_t word) { return word != 0; });
+    }
+
+    // The shader reads the set as 32-bit texels indexed by handle / 32, which is
+    // how the 64-bit words lie in memory on the little-endian targets we build for
+    const size_t texels = chunkCount * SelectionSet::kWordsPerChunk * 2;
+    if (texels > (size_t)g_maxTextureBufferSize)
+        EL_CORE_WARN("Selection of {} chunks exceeds the texture buffer limit; lines past it are not highlighted", chunkCount);
+    glBindBuffer(GL_TEXTURE_BUFFER, g_selectionBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, texels * sizeof(uint32_t), selection.GetChunkWords(0), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void Renderer::DrawDocument(const LineDocument& document) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_vao || !g_vbo || !g_program) {
+        EL_CORE_ERROR("Invalid renderer state (program={}, vao={}, vbo={})", g_program, g_vao, g_vbo);
+        return;
+    }
+
+    const size_t chunkCount = document.GetChunkCount();
+    if (g_chunkStaging.size() < chunkCount)
+        g_chunkStaging.resize(chunkCount);
+    // The overlay needs to know which line went where in chunks with a
+    // selection, the ID buffer in all of them
+    const bool overlay = !g_chunkSelected.empty();
+    const bool idPass = g_idPicking;
+    if (overlay || idPass) {
+        if (g_chunkHandles.size() < chunkCount) g_chunkHandles.resize(chunkCount);
+        g_chunkTracked.assign(chunkCount, 0);
+    }
+
+    // CPU side runs on the workers: every chunk writes only its own staging buffer
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<uint64_t> visibleLines{0};
+    const AABB view = g_viewBounds;
+    JobSystem::ParallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+        uint64_t lines = 0;
+        for (size_t i = begin; i < end; i++) {
+            g_chunkStaging[i].clear();
+            if (!idPass && (!overlay || i >= g_chunkSelected.size() || !g_chunkSelected[i])) {
+                lines += CullAndTessellateChunk(document.GetChunk(i), view, g_chunkStaging[i]);
+                continue;
+            }
+            g_chunkTracked[i] = 1;
+            std::vector<uint32_t>& handles = g_chunkHandles[i];
+            handles.clear();
+            lines += CullAndTessellateChunk(document.GetChunk(i), view, g_chunkStaging[i], &handles);
+            for (uint32_t& handle : handles) handle = MakeLineHandle((uint32_t)i, handle);
+        }
+        visibleLines.fetch_add(lines, std::memory_order_relaxed);
+    });
+    g_stats.CullTessellateMs += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // GL side stays on this thread: orphan the buffer once, then copy each visible chunk in
+    size_t totalVertices = 0;
+    for (size_t i = 0; i < chunkCount; i++) {
+        totalVertices += g_chunkStaging[i].size();
+        if (!g_chunkStaging[i].empty()) g_stats.VisibleChunks++;
+    }
+    g_stats.VisibleLines += visibleLines.load();
+    if (totalVertices == 0) {
+        // nothing under the cursor either
+        if (idPass) DrawIdBuffer(0);
+        return;
+    }
+
+    glUseProgram(g_program);
+    glUniformMatrix4fv(glGetUniformLocation(g_program, "u_ViewProjection"), 1, GL_FALSE, &g_ViewProjectionMatrix[0][0]);
+    glBindVertexArray(g_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, g_vbo);
+    glBufferData(GL_ARRAY_BUFFER, totalVertices * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < chunkCount; i++) {
+        const std::vector<Vertex>& staging = g_chunkStaging[i];
+        if (staging.empty()) continue;
+        glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(Vertex), staging.size() * sizeof(Vertex), staging.data());
+        offset += staging.size();
+    }
+
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)totalVertices);
+    if (overlay || idPass) UploadHandles(chunkCount, totalVertices);
+    if (overlay) DrawSelectionOverlay(chunkCount);
+    if (idPass) DrawIdBuffer(totalVertices);
+
+    GLenum err = glGetError();
+    if (err != GL_NO_ERROR) {
+        EL_CORE_ERROR("GL error during document draw: 0x{:x}", err);
+    }
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
+void Renderer::DrawDimensions(const DimensionSet& dimensions) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_glyphProgram) return;
+
+    g_dimensionLayout.Update(dimensions, g_glyphAtlas, g_pixelSize);
+    g_stats.DimensionsLaidOut += (uint32_t)g_dimensionLayout.GetLaidOutCount();
+    const std::vector<GlyphQuad>& quads = g_dimensionLayout.GetQuads();
+    glBindVertexArray(g_glyphVao);
+    if (g_glyphBufferVersion != g_dimensionLayout.GetVersion()) {
+        glBindBuffer(GL_ARRAY_BUFFER, g_glyphBuffer);
+        glBufferData(GL_ARRAY_BUFFER, quads.size() * sizeof(GlyphQuad), quads.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        g_glyphBufferVersion = g_dimensionLayout.GetVersion();
+    }
+    g_stats.DimensionQuads += (uint32_t)quads.size();
+    if (!quads.empty()) {
+        glUseProgram(g_glyphProgram);
+        glUniformMatrix4fv(glGetUniformLocation(g_glyphProgram, "u_ViewProjection"), 1, GL_FALSE, &g_ViewProjectionMatrix[0][0]);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, g_atlasTexture);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)quads.size());
+        glDisable(GL_BLEND);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glUseProgram(0);
+    }
+
+    GLenum err = glGetError();
+    if (err != GL_NO_ERROR) {
+        EL_CORE_ERROR("GL error during dimension draw: 0x{:x}", err);
+    }
+    glBindVertexArray(0);
+}
+
+void Renderer::SetDimensionTextHeight(float height) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_dimensionLayout.SetTextHeight(height);
 }
 
 void Renderer::Flush() {
@@ -189,11 +671,23 @@ void Renderer::Flush() {
 
     glBindVertexArray(0);
     glUseProgram(0);
+    g_frameVertexPeak = std::max(g_frameVertexPeak, g_vertices.size());
     g_vertices.clear();
 }
 
 void Renderer::EndFrame() {
-    // nothing
+    std::lock_guard<std::mutex> lock(g_mutex);
+    // Drop every container that points into the arena before rewinding it
+    g_vertices = FrameVector<Vertex>(&g_frameArena);
+    g_frameArena.Reset();
+}
+
+FrameArena& Renderer::GetFrameArena() {
+    return g_frameArena;
+}
+
+const RendererStats& Renderer::GetStats() {
+    return g_stats;
 }
 
 } // namespace EasyLine
@@ -2,10 +2,23 @@
 
 #include <vector>
 #include "Camera.h"
+#include "Color.h"
+#include "FrameArena.h"
+#include "LineChunk.h"
 
 namespace EasyLine {
 
-struct Color { float r,g,b,a; };
+class DimensionSet;
+class LineDocument;
+class SelectionSet;
+
+struct RendererStats {
+    uint32_t VisibleChunks = 0;
+    uint64_t VisibleLines = 0;
+    float CullTessellateMs = 0.0f;  // CPU time of the parallel cull + tessellate pass
+    uint32_t DimensionQuads = 0;
+    uint32_t DimensionsLaidOut = 0; // dimension strings formatted this frame
+};
 
 class Renderer {
 public:
@@ -18,9 +31,39 @@ public:
     static void BeginFrame(const Camera& camera);
     // Draw a single line from (x0,y0) to (x1,y1) in pixel coords. Thickness in pixels.
     static void DrawLine(float x0, float y0, float x1, float y1, float thickness, Color color);
+    // Cull and tessellate the document's chunks in parallel on the job system,
+    // then upload the visible ones and draw them in one call.
+    static void DrawDocument(const LineDocument& document);
+    // Lines DrawDocument() highlights over the document. Only this uploads the
+    // set, one bit per line; call it again when the selection changes.
+    static void SetSelection(const SelectionSet& selection);
+    // GPU hover picking. While enabled, DrawDocument() also draws the lines'
+    // handles into an integer ID buffer and reads back the pixels within
+    // radius of the hover point (framebuffer pixels, origin top left) without
+    // waiting for the GPU. GetHoveredLine() gives the line nearest to it from
+    // the latest readback, a frame or two behind, and false if there is none.
+    static bool IsIdPickingSupported();
+    static void SetIdPicking(bool enabled);
+    static void SetHoverPoint(const glm::vec2& pixel, float radius);
+    static void ClearHoverPoint();
+    static bool GetHoveredLine(LineHandle& handle);
+    // Draw the dimensions' lines, arrows and text in one instanced call from
+    // the glyph atlas. The quads are cached and uploaded again only when the
+    // set or the zoom step changes.
+    static void DrawDimensions(const DimensionSet& dimensions);
+    // Dimension text height in drawing units, so it zooms with the drawing,
+    // or 0 (the default) to keep it the same size on screen
+    static void SetDimensionTextHeight(float height);
     // Flush current batched lines to GPU
     static void Flush();
+    // Ends the frame and rewinds the frame arena
     static void EndFrame();
+
+    // Scratch memory that is valid until EndFrame(). Use FrameVector/FrameString
+    // for per-frame containers instead of the general heap.
+    static FrameArena& GetFrameArena();
+
+    static const RendererStats& GetStats();
 };
 
 } // namespace EasyLine
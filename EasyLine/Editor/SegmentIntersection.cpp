@@ -0,0 +1,490 @@
+#include "SegmentIntersection.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "Predicates.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <unordered_set>
+
+namespace EasyLine {
+
+namespace {
+
+// Slabs below this many segments cost more in overhead than they save
+constexpr size_t kMinSlabSegments = 4096;
+// Slab edges are placed by a sorted sample of this many left ends
+constexpr size_t kSlabSampleSize = 65536;
+
+using Point = glm::dvec2;
+
+// Sweep order: by x, then by y
+inline bool Less(const Point& a, const Point& b)
+{
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+// A segment from its first endpoint in sweep order to the other
+struct Oriented {
+    Point L, R;
+    Point Direction;    // R - L
+};
+
+bool Orient(const LineSegment& segment, Oriented& oriented)
+{
+    const Point p0 = segment.P0, p1 = segment.P1;
+    if (!std::isfinite(p0.x) || !std::isfinite(p0.y) || !std::isfinite(p1.x) || !std::isfinite(p1.y) || p0 == p1) return false;
+    oriented.L = Less(p0, p1) ? p0 : p1;
+    oriented.R = Less(p0, p1) ? p1 : p0;
+    oriented.Direction = oriented.R - oriented.L;
+    return true;
+}
+
+// True if b is turned counterclockwise from a, i.e. rises more steeply to the right
+inline bool IsSteeper(const Oriented& b, const Oriented& a)
+{
+    return Orient2D({ 0.0, 0.0 }, a.Direction, b.Direction) > 0.0;
+}
+
+enum class PairKind {
+    None,
+    Point,
+    Overlap,
+};
+
+// How segments a and b (a the lower index) meet, and where. Both the sweep
+// and the naive test go through here, so they report identical points.
+PairKind TestPair(const Oriented& a, const Oriented& b, Point& point)
+{
+    const double bl = Orient2D(a.L, a.R, b.L), br = Orient2D(a.L, a.R, b.R);
+    if ((bl > 0.0 && br > 0.0) || (bl < 0.0 && br < 0.0)) return PairKind::None;
+    if (bl == 0.0 && br == 0.0) {
+        // collinear: an overlap if the spans share more than a point
+        const Point& start = Less(a.L, b.L) ? b.L : a.L;
+        const Point& end = Less(a.R, b.R) ? a.R : b.R;
+        if (!Less(start, end)) return PairKind::None;
+        point = start;
+        return PairKind::Overlap;
+    }
+    const double al = Orient2D(b.L, b.R, a.L), ar = Orient2D(b.L, b.R, a.R);
+    if ((al > 0.0 && ar > 0.0) || (al < 0.0 && ar < 0.0)) return PairKind::None;
+    // the one common point; a shared endpoint is a vertex, not an intersection
+    if (a.L == b.L || a.L == b.R || a.R == b.L || a.R == b.R) return PairKind::None;
+    if (al == 0.0) point = a.L;
+    else if (ar == 0.0) point = a.R;
+    else if (bl == 0.0) point = b.L;
+    else if (br == 0.0) point = b.R;
+    else {
+        const Point ab = b.L - a.L;
+        const double t = (ab.x * b.Direction.y - ab.y * b.Direction.x) / (a.Direction.x * b.Direction.y - a.Direction.y * b.Direction.x);
+        point = a.L + std::clamp(t, 0.0, 1.0) * a.Direction;
+        // keep it within both boxes, so crossings on a vertical line are on
+        // its x exactly and are not swept before its endpoints there
+        point.x = std::clamp(point.x, std::max(a.L.x, b.L.x), std::min(a.R.x, b.R.x));
+        point.y = std::clamp(point.y, std::max(std::min(a.L.y, a.R.y), std::min(b.L.y, b.R.y)),
+            std::min(std::max(a.L.y, a.R.y), std::max(b.L.y, b.R.y)));
+    }
+    return PairKind::Point;
+}
+
+// Bentley-Ottmann over the segments of one slab [x0, x1). Segments that
+// enter it from the left are swept from their start as well, so the order
+// at x0 is the exact one, but only what lies within the slab is reported.
+//
+// The status holds the segments under the sweep line from bottom to top.
+// A new segment is placed by the exact side of its left end against the
+// segments there, so the comparator only ever compares the segment being
+// inserted; everything else moves by iterator. Two neighbours are scheduled
+// to cross when they intersect and the lower one rises more steeply, and
+// the pair is reported then; the event swaps them. Segments meeting at one
+// event point are re-sorted by slope together, which handles any number of
+// concurrent lines. An endpoint on another segment is reported when the
+// segment starts or ends there.
+class Sweep {
+public:
+    Sweep(std::vector<Oriented> segments, std::vector<uint32_t> ids, double x0, double x1, std::vector<SegmentIntersection>& out)
+        : m_Segments(std::move(segments)), m_Ids(std::move(ids)), m_X0(x0), m_X1(x1), m_Out(out),
+          m_Status(StatusLess{ this }), m_Where(m_Segments.size()), m_Active(m_Segments.size(), 0), m_Mark(m_Segments.size(), 0),
+          m_Visit(m_Segments.size(), 0), m_RunOf(m_Segments.size(), 0) {}
+
+    void Run();
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct StatusLess {
+        const Sweep* S;
+        bool operator()(uint32_t a, uint32_t b) const { return S->IsBelow(a, b); }
+    };
+    using Status = std::set<uint32_t, StatusLess>;
+
+    struct Endpoint {
+        Point P;
+        uint32_t Segment;
+        uint8_t Phase;  // 0: the segment ends here, 2: it starts here (crossings at the same point are phase 1)
+    };
+    struct Crossing {
+        Point P;
+        uint32_t A, B;
+        bool operator<(const Crossing& other) const {
+            if (P.x != other.P.x) return P.x < other.P.x;
+            if (P.y != other.P.y) return P.y < other.P.y;
+            return A != other.A ? A < other.A : B < other.B;
+        }
+    };
+
+    bool IsBelow(uint32_t a, uint32_t b) const;
+    bool StartsBelow(uint32_t s, uint32_t t) const;
+    void Insert(uint32_t s);
+    void Remove(uint32_t s);
+    void ReportTouching(uint32_t s, const Point& p, bool start);
+    void ProcessCrossings();
+    void ReportConcurrent(const Point& p, const uint32_t* run, size_t count);
+    void CheckCrossing(uint32_t lower, uint32_t upper);
+    void Report(uint32_t a, uint32_t b, PairKind kind, const Point& point);
+
+    std::vector<Oriented> m_Segments;
+    std::vector<uint32_t> m_Ids;    // index in the caller's list, ascending
+    double m_X0, m_X1;
+    std::vector<SegmentIntersection>& m_Out;
+
+    Status m_Status;
+    std::vector<Status::iterator> m_Where;
+    std::vector<uint8_t> m_Active;
+    std::set<Crossing> m_Queue;
+    uint32_t m_Inserting = kNone;
+
+    // scratch for ProcessCrossings
+    std::vector<uint32_t> m_Mark, m_Visit, m_RunOf;
+    uint32_t m_Group = 0;
+    std::vector<uint32_t> m_Members, m_Run;
+    std::vector<size_t> m_RunStarts;
+    std::vector<std::pair<uint32_t, uint32_t>> m_GroupPairs;
+    std::vector<Status::iterator> m_RunSlots;
+    std::unordered_set<uint64_t> m_Deferred;   // pairs reported but not swapped yet
+};
+
+bool Sweep::IsBelow(uint32_t a, uint32_t b) const
+{
+    return a == m_Inserting ? StartsBelow(a, b) : !StartsBelow(b, a);
+}
+
+// Whether s, starting at its left end, runs below t there
+bool Sweep::StartsBelow(uint32_t s, uint32_t t) const
+{
+    const Oriented& S = m_Segments[s];
+    const Oriented& T = m_Segments[t];
+    const double side = Orient2D(T.L, T.R, S.L);
+    if (side != 0.0) return side < 0.0;
+    // starting on t: the less steep one is below from here on
+    if (IsSteeper(T, S)) return true;
+    if (IsSteeper(S, T)) return false;
+    return s < t;
+}
+
+void Sweep::Report(uint32_t a, uint32_t b, PairKind kind, const Point& point)
+{
+    if (point.x < m_X0 || point.x >= m_X1) return;
+    m_Out.push_back({ glm::vec2(point), m_Ids[std::min(a, b)], m_Ids[std::max(a, b)], kind == PairKind::Overlap });
+}
+
+void Sweep::CheckCrossing(uint32_t lower, uint32_t upper)
+{
+    // a lower segment that is less steep moves away; collinear ones never swap
+    if (!IsSteeper(m_Segments[lower], m_Segments[upper])) return;
+    const uint32_t a = std::min(lower, upper), b = std::max(lower, upper);
+    Point point;
+    if (TestPair(m_Segments[a], m_Segments[b], point) != PairKind::Point) return;
+    if (point.x >= m_X1) return;
+    // still queued if it was found before, and never found again once swapped.
+    // A segment ending on the other is reported when it is removed.
+    if (m_Queue.insert({ point, a, b }).second && point != m_Segments[a].R && point != m_Segments[b].R &&
+        (m_Deferred.empty() || m_Deferred.erase((uint64_t)a << 32 | b) == 0))
+        Report(a, b, PairKind::Point, point);
+}
+
+void Sweep::Insert(uint32_t s)
+{
+    m_Inserting = s;
+    const Status::iterator it = m_Status.insert(s).first;
+    m_Inserting = kNone;
+    m_Where[s] = it;
+    m_Active[s] = 1;
+
+    ReportTouching(s, m_Segments[s].L, true);
+    if (it != m_Status.begin()) CheckCrossing(*std::prev(it), s);
+    if (std::next(it) != m_Status.end()) CheckCrossing(s, *std::next(it));
+}
+
+// The segments through p, an end of s, sit right next to it. Overlaps are
+// reported once, when the later of the two starts.
+void Sweep::ReportTouching(uint32_t s, const Point& p, bool start)
+{
+    const Status::iterator it = m_Where[s];
+    Point point;
+    auto touch = [&](uint32_t t) {
+        if (Orient2D(m_Segments[t].L, m_Segments[t].R, p) != 0.0) return false;
+        const PairKind kind = TestPair(m_Segments[std::min(s, t)], m_Segments[std::max(s, t)], point);
+        if (kind == PairKind::Point || (kind == PairKind::Overlap && start)) Report(s, t, kind, point);
+        return true;
+    };
+    for (Status::iterator down = it; down != m_Status.begin() && touch(*--down);) {}
+    for (Status::iterator up = std::next(it); up != m_Status.end() && touch(*up); ++up) {}
+}
+
+void Sweep::Remove(uint32_t s)
+{
+    ReportTouching(s, m_Segments[s].R, false);
+    const Status::iterator it = m_Where[s];
+    const bool hasBelow = it != m_Status.begin();
+    const Status::iterator above = std::next(it);
+    const uint32_t below = hasBelow ? *std::prev(it) : kNone;
+    m_Status.erase(it);
+    m_Active[s] = 0;
+    if (hasBelow && above != m_Status.end()) CheckCrossing(below, *above);
+}
+
+// Several lines through one event point swap all at once, including pairs
+// whose own crossing was never scheduled because they were not neighbours:
+// those are reported here. run is in order before the swap.
+void Sweep::ReportConcurrent(const Point& p, const uint32_t* run, size_t count)
+{
+    Point point;
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 1; j < count; j++) {
+            const uint32_t lower = run[i], upper = run[j];
+            if (!IsSteeper(m_Segments[lower], m_Segments[upper])) continue;
+            const uint32_t a = std::min(lower, upper), b = std::max(lower, upper);
+            if (TestPair(m_Segments[a], m_Segments[b], point) != PairKind::Point) continue;
+            // scheduled pairs were reported then
+            if (point == p && std::find(m_GroupPairs.begin(), m_GroupPairs.end(), std::make_pair(a, b)) != m_GroupPairs.end()) continue;
+            if (m_Queue.erase({ point, a, b }) > 0) continue;
+            if (!m_Deferred.empty() && m_Deferred.erase((uint64_t)a << 32 | b) > 0) continue;
+            if (point != m_Segments[a].R && point != m_Segments[b].R) Report(a, b, PairKind::Point, point);
+        }
+    }
+}
+
+// All crossings at the next event point: the segments meeting there leave
+// it in order of slope
+void Sweep::ProcessCrossings()
+{
+    const Point p = m_Queue.begin()->P;
+    m_Group++;
+    m_Members.clear();
+    m_GroupPairs.clear();
+    while (!m_Queue.empty() && m_Queue.begin()->P == p) {
+        m_GroupPairs.push_back({ m_Queue.begin()->A, m_Queue.begin()->B });
+        for (uint32_t s : { m_Queue.begin()->A, m_Queue.begin()->B }) {
+            // a segment may have ended on the other one already
+            if (!m_Active[s] || m_Mark[s] == m_Group) continue;
+            m_Mark[s] = m_Group;
+            m_Members.push_back(s);
+        }
+        m_Queue.erase(m_Queue.begin());
+    }
+
+    // The members are next to each other, in one run, unless a segment
+    // that is not part of the event lies between them (rounding, or one
+    // collinear with a member)
+    m_Run.clear();
+    m_RunSlots.clear();
+    m_RunStarts.clear();
+    for (uint32_t member : m_Members) {
+        if (m_Visit[member] == m_Group) continue;
+        Status::iterator first = m_Where[member];
+        while (first != m_Status.begin() && m_Mark[*std::prev(first)] == m_Group) --first;
+        m_RunStarts.push_back(m_Run.size());
+        for (Status::iterator it = first; it != m_Status.end() && m_Mark[*it] == m_Group; ++it) {
+            m_Visit[*it] = m_Group;
+            m_RunOf[*it] = (uint32_t)m_RunStarts.size();
+            m_Run.push_back(*it);
+            m_RunSlots.push_back(it);
+        }
+    }
+    m_RunStarts.push_back(m_Run.size());
+    // A pair split over two runs does not swap now. It is scheduled again
+    // once it can, and must not be reported a second time then.
+    for (const auto& [a, b] : m_GroupPairs) {
+        if (m_Active[a] && m_Active[b] && m_RunOf[a] != m_RunOf[b]) m_Deferred.insert((uint64_t)a << 32 | b);
+    }
+
+    for (size_t r = 0; r + 1 < m_RunStarts.size(); r++) {
+        const size_t begin = m_RunStarts[r], end = m_RunStarts[r + 1];
+        if (end - begin < 2) continue;
+        uint32_t* run = m_Run.data() + begin;
+        if (end - begin > 2) ReportConcurrent(p, run, end - begin);
+
+        std::sort(run, run + (end - begin), [&](uint32_t a, uint32_t b) {
+            if (IsSteeper(m_Segments[b], m_Segments[a])) return true;
+            if (IsSteeper(m_Segments[a], m_Segments[b])) return false;
+            return a < b;
+        });
+        // reorder in place: the tree's shape stays, only the ids move
+        for (size_t i = begin; i < end; i++) {
+            const_cast<uint32_t&>(*m_RunSlots[i]) = m_Run[i];
+            m_Where[m_Run[i]] = m_RunSlots[i];
+        }
+
+        if (m_RunSlots[begin] != m_Status.begin()) CheckCrossing(*std::prev(m_RunSlots[begin]), m_Run[begin]);
+        for (size_t i = begin; i + 1 < end; i++) CheckCrossing(m_Run[i], m_Run[i + 1]);
+        const Status::iterator after = std::next(m_RunSlots[end - 1]);
+        if (after != m_Status.end()) CheckCrossing(m_Run[end - 1], *after);
+    }
+}
+
+void Sweep::Run()
+{
+    const uint32_t count = (uint32_t)m_Segments.size();
+    std::vector<Endpoint> events;
+    events.reserve(count * 2);
+    for (uint32_t s = 0; s < count; s++) {
+        events.push_back({ m_Segments[s].L, s, 2 });
+        if (m_Segments[s].R.x < m_X1) events.push_back({ m_Segments[s].R, s, 0 });
+    }
+    std::sort(events.begin(), events.end(), [](const Endpoint& a, const Endpoint& b) {
+        if (a.P != b.P) return Less(a.P, b.P);
+        return a.Phase != b.Phase ? a.Phase < b.Phase : a.Segment < b.Segment;
+    });
+
+    size_t next = 0;
+    while (next < events.size() || !m_Queue.empty()) {
+        bool crossing = !m_Queue.empty();
+        if (crossing && next < events.size()) {
+            const Point& p = m_Queue.begin()->P;
+            const Endpoint& event = events[next];
+            crossing = Less(p, event.P) || (p == event.P && event.Phase > 1);
+        }
+        if (crossing) {
+            ProcessCrossings();
+            continue;
+        }
+        const Endpoint& event = events[next++];
+        if (event.P.x >= m_X1) break;
+        if (event.Phase == 0) Remove(event.Segment);
+        else Insert(event.Segment);
+    }
+}
+
+// The valid segments, oriented, with their indices
+void Prepare(const std::vector<LineSegment>& segments, std::vector<Oriented>& oriented, std::vector<uint32_t>& ids)
+{
+    oriented.reserve(segments.size());
+    ids.reserve(segments.size());
+    for (uint32_t i = 0; i < (uint32_t)segments.size(); i++) {
+        Oriented segment;
+        if (!Orient(segments[i], segment)) continue;
+        oriented.push_back(segment);
+        ids.push_back(i);
+    }
+}
+
+} // namespace
+
+void FindIntersections(const std::vector<LineSegment>& segments, std::vector<SegmentIntersection>& intersections)
+{
+    intersections.clear();
+    std::vector<Oriented> oriented;
+    std::vector<uint32_t> ids;
+    Prepare(segments, oriented, ids);
+    const double infinity = std::numeric_limits<double>::infinity();
+    Sweep(std::move(oriented), std::move(ids), -infinity, infinity, intersections).Run();
+}
+
+void FindIntersectionsParallel(const std::vector<LineSegment>& segments, std::vector<SegmentIntersection>& intersections,
+    uint32_t slabCount)
+{
+    intersections.clear();
+    std::vector<Oriented> oriented;
+    std::vector<uint32_t> ids;
+    Prepare(segments, oriented, ids);
+    if (oriented.empty()) return;
+
+    // a few slabs per thread evens out uneven ones; the calling thread helps too
+    if (slabCount == 0) slabCount = (JobSystem::GetWorkerCount() + 1) * 4;
+    slabCount = (uint32_t)std::max<size_t>(1, std::min<size_t>(slabCount, oriented.size() / kMinSlabSegments));
+
+    // edges at quantiles of the left ends, so slabs get similar numbers of segments
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> edges = { -infinity };
+    if (slabCount > 1) {
+        std::vector<double> sample;
+        const size_t step = std::max<size_t>(1, oriented.size() / kSlabSampleSize);
+        for (size_t i = 0; i < oriented.size(); i += step) sample.push_back(oriented[i].L.x);
+        std::sort(sample.begin(), sample.end());
+        for (uint32_t i = 1; i < slabCount; i++) {
+            const double edge = sample[sample.size() * i / slabCount];
+            if (edge > edges.back()) edges.push_back(edge);
+        }
+    }
+    edges.push_back(infinity);
+    const size_t slabs = edges.size() - 1;
+
+    // a segment goes to every slab its x-range overlaps
+    auto slabOf = [&](double x) { return (size_t)(std::upper_bound(edges.begin() + 1, edges.end() - 1, x) - (edges.begin() + 1)); };
+    std::vector<std::vector<Oriented>> slabSegments(slabs);
+    std::vector<std::vector<uint32_t>> slabIds(slabs);
+    for (size_t i = 0; i < oriented.size(); i++) {
+        const size_t last = slabOf(oriented[i].R.x);
+        for (size_t slab = slabOf(oriented[i].L.x); slab <= last; slab++) {
+            slabSegments[slab].push_back(oriented[i]);
+            slabIds[slab].push_back(ids[i]);
+        }
+    }
+
+    std::vector<std::vector<SegmentIntersection>> results(slabs);
+    JobSystem::ParallelFor(slabs, 1, [&](size_t begin, size_t end) {
+        for (size_t slab = begin; slab < end; slab++)
+            Sweep(std::move(slabSegments[slab]), std::move(slabIds[slab]), edges[slab], edges[slab + 1], results[slab]).Run();
+    });
+
+    size_t total = 0;
+    for (const auto& result : results) total += result.size();
+    intersections.reserve(total);
+    for (const auto& result : results) intersections.insert(intersections.end(), result.begin(), result.end());
+}
+
+void FindIntersectionsNaive(const std::vector<LineSegment>& segments, std::vector<SegmentIntersection>& intersections)
+{
+    intersections.clear();
+    std::vector<Oriented> oriented;
+    std::vector<uint32_t> ids;
+    Prepare(segments, oriented, ids);
+    for (size_t i = 0; i < oriented.size(); i++) {
+        const Oriented& a = oriented[i];
+        const double aMinY = std::min(a.L.y, a.R.y), aMaxY = std::max(a.L.y, a.R.y);
+        for (size_t j = i + 1; j < oriented.size(); j++) {
+            const Oriented& b = oriented[j];
+            if (b.L.x > a.R.x || b.R.x < a.L.x || std::max(b.L.y, b.R.y) < aMinY || std::min(b.L.y, b.R.y) > aMaxY) continue;
+            Point point;
+            const PairKind kind = TestPair(a, b, point);
+            if (kind != PairKind::None) intersections.push_back({ glm::vec2(point), ids[i], ids[j], kind == PairKind::Overlap });
+        }
+    }
+}
+
+void FindLineIntersections(const LineDocument& document, std::vector<LineIntersection>& intersections)
+{
+    std::vector<LineSegment> segments;
+    std::vector<LineHandle> handles;
+    segments.reserve(document.GetLineCount());
+    handles.reserve(document.GetLineCount());
+    for (uint32_t c = 0; c < (uint32_t)document.GetChunkCount(); c++) {
+        const LineChunk& chunk = document.GetChunk(c);
+        for (uint32_t slot = 0; slot < chunk.Count; slot++) {
+            if (chunk.DeletedCount > 0 && chunk.IsDeleted(slot)) continue;
+            segments.push_back({ { chunk.X0[slot], chunk.Y0[slot] }, { chunk.X1[slot], chunk.Y1[slot] } });
+            handles.push_back(MakeLineHandle(c, slot));
+        }
+    }
+
+    std::vector<SegmentIntersection> found;
+    FindIntersectionsParallel(segments, found);
+    intersections.clear();
+    intersections.reserve(found.size());
+    for (const SegmentIntersection& intersection : found)
+        intersections.push_back({ intersection.Point, handles[intersection.A], handles[intersection.B], intersection.Overlap });
+}
+
+} // namespace EasyLine
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "LineChunk.h"
+
+namespace EasyLine {
+
+class LineDocument;
+
+struct LineSegment {
+    glm::vec2 P0, P1;
+};
+
+struct SegmentIntersection {
+    glm::vec2 Point;    // where the segments cross or touch, or where their overlap starts
+    uint32_t A, B;      // indices of the two segments, A < B
+    bool Overlap;       // collinear and sharing more than a point
+};
+
+// Every pair of intersecting segments, found by a Bentley-Ottmann sweep in
+// O((n + k) log n) for k intersections.
+//
+// Segments are closed: crossings, an endpoint on another segment and
+// collinear overlaps are reported, once per pair. Two segments that only
+// share an endpoint are not, so polylines do not report their own vertices.
+// The sweep order is decided by exact orientation predicates, which keeps
+// the status consistent on near-collinear and concurrent lines; only the
+// reported crossing points are rounded. Zero-length and non-finite segments
+// are skipped. Results come in the order the sweep finds them, roughly by x.
+void FindIntersections(const std::vector<LineSegment>& segments, std::vector<SegmentIntersection>& intersections);
+// Same results, with the plane cut into vertical slabs of about equal
+// segment counts swept on the job system. Each slab sweeps the segments
+// overlapping it and reports the intersections that fall within it.
+// slabCount == 0 picks one from the worker count.
+void FindIntersectionsParallel(const std::vector<LineSegment>& segments, std::vector<SegmentIntersection>& intersections,
+    uint32_t slabCount = 0);
+// Same results by testing all pairs, O(n^2); the reference for the above
+void FindIntersectionsNaive(const std::vector<LineSegment>& segments, std::vector<SegmentIntersection>& intersections);
+
+struct LineIntersection {
+    glm::vec2 Point;
+    LineHandle A, B;
+    bool Overlap;
+};
+
+// All intersections between the document's lines, by the parallel sweep
+void FindLineIntersections(const LineDocument& document, std::vector<LineIntersection>& intersections);
+
+} // namespace EasyLine
@@ -0,0 +1,38 @@
+#include "SelectionSet.h"
+#include <algorithm>
+
+namespace EasyLine {
+
+void SelectionSet::Add(LineHandle handle) {
+    Resize(GetHandleChunk(handle) + 1);
+    uint64_t& word = m_Words[GetHandleChunk(handle) * (size_t)kWordsPerChunk + GetHandleSlot(handle) / 64];
+    const uint64_t bit = 1ull << (handle & 63);
+    if (!(word & bit)) m_Count++;
+    word |= bit;
+}
+
+void SelectionSet::Remove(LineHandle handle) {
+    if (!Contains(handle)) return;
+    m_Words[GetHandleChunk(handle) * (size_t)kWordsPerChunk + GetHandleSlot(handle) / 64] &= ~(1ull << (handle & 63));
+    m_Count--;
+}
+
+void SelectionSet::UnionWith(const SelectionSet& other) {
+    Resize(other.GetChunkCount());
+    for (size_t w = 0; w < other.m_Words.size(); w++) m_Words[w] |= other.m_Words[w];
+    Recount();
+}
+
+void SelectionSet::Subtract(const SelectionSet& other) {
+    const size_t count = std::min(m_Words.size(), other.m_Words.size());
+    for (size_t w = 0; w < count; w++) m_Words[w] &= ~other.m_Words[w];
+    Recount();
+}
+
+void SelectionSet::Recount() {
+    size_t count = 0;
+    for (uint64_t word : m_Words) count += std::popcount(word);
+    m_Count = count;
+}
+
+} // namespace EasyLine
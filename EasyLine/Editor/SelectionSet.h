@@ -0,0 +1,58 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "LineChunk.h"
+
+namespace EasyLine {
+
+// Set of selected lines as one bit per chunk slot: 512 bytes per chunk,
+// about 1.2 MB for a 10M-line document however many lines are selected.
+// Chunks own disjoint word ranges, so they can be filled in parallel.
+// Lines deleted after they were selected stay in the set until it is rebuilt;
+// check LineDocument::IsLineValid() when that matters.
+class SelectionSet {
+public:
+    static constexpr uint32_t kWordsPerChunk = LineChunk::kCapacity / 64;
+
+    void Clear() { m_Words.clear(); m_Count = 0; }
+    // Make room for chunkCount chunks, keeping what is selected
+    void Resize(size_t chunkCount) { if (chunkCount > GetChunkCount()) m_Words.resize(chunkCount * kWordsPerChunk, 0); }
+
+    bool IsEmpty() const { return m_Count == 0; }
+    size_t GetCount() const { return m_Count; }
+    size_t GetChunkCount() const { return m_Words.size() / kWordsPerChunk; }
+
+    bool Contains(LineHandle handle) const {
+        const size_t word = GetHandleChunk(handle) * (size_t)kWordsPerChunk + GetHandleSlot(handle) / 64;
+        return word < m_Words.size() && (m_Words[word] >> (handle & 63)) & 1;
+    }
+    void Add(LineHandle handle);
+    void Remove(LineHandle handle);
+    void UnionWith(const SelectionSet& other);
+    void Subtract(const SelectionSet& other);
+
+    // Bits of one chunk, slot s at word s / 64, bit s % 64. Call Recount() after writing.
+    uint64_t* GetChunkWords(size_t chunk) { return m_Words.data() + chunk * kWordsPerChunk; }
+    const uint64_t* GetChunkWords(size_t chunk) const { return m_Words.data() + chunk * kWordsPerChunk; }
+    void Recount();
+
+    // Calls fn(handle) for every selected line, in handle order
+    template<typename Fn>
+    void ForEach(Fn&& fn) const {
+        for (size_t w = 0; w < m_Words.size(); w++) {
+            for (uint64_t bits = m_Words[w]; bits != 0; bits &= bits - 1) {
+                const uint32_t chunk = (uint32_t)(w / kWordsPerChunk);
+                fn(MakeLineHandle(chunk, (uint32_t)(w % kWordsPerChunk) * 64 + std::countr_zero(bits)));
+            }
+        }
+    }
+
+private:
+    std::vector<uint64_t> m_Words;
+    size_t m_Count = 0;
+};
+
+} // namespace EasyLine
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace EasyLine {
+
+// List of shared_ptr<T> whose storage is itself shared between copies.
+// Copying the list is O(1); the first change made through a copy whose
+// storage is still shared duplicates the pointers (the elements stay shared).
+// Combined with copying an element before changing it, this makes snapshots
+// of the document free to take.
+//
+// Copies must be dropped on the thread that modifies the list: GetMutable()
+// trusts use_count() to tell whether anyone else still reads the storage.
+template<typename T>
+class SharedList {
+public:
+    size_t GetSize() const { return m_Items ? m_Items->size() : 0; }
+    bool IsEmpty() const { return GetSize() == 0; }
+    const std::shared_ptr<T>& operator[](size_t index) const { return (*m_Items)[index]; }
+
+    // The storage for modification, duplicated first if another copy refers to it
+    std::vector<std::shared_ptr<T>>& GetMutable()
+    {
+        if (!m_Items)
+            m_Items = std::make_shared<std::vector<std::shared_ptr<T>>>();
+        else if (m_Items.use_count() > 1)
+            m_Items = std::make_shared<std::vector<std::shared_ptr<T>>>(*m_Items);
+        return *m_Items;
+    }
+    bool IsShared() const { return m_Items && m_Items.use_count() > 1; }
+    void Clear() { m_Items.reset(); }
+
+private:
+    std::shared_ptr<std::vector<std::shared_ptr<T>>> m_Items;
+};
+
+} // namespace EasyLine
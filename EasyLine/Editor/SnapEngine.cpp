@@ -0,0 +1,142 @@
+#include "SnapEngine.h"
+#include "Camera.h"
+#include "LineDocument.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace EasyLine {
+
+namespace {
+
+// Intersections are looked for among this many of the lines nearest to the
+// cursor, which keeps the pairwise test cheap where hundreds of lines pass by
+constexpr size_t kMaxIntersectionLines = 64;
+// Slack for intersections at a segment's very end, which rounding can put just outside it
+constexpr float kEndSlack = 1e-6f;
+
+// Closest point to p on segment ab
+glm::vec2 ClosestPointOnSegment(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b) {
+    const glm::vec2 d = b - a;
+    const float lengthSquared = glm::dot(d, d);
+    const float t = lengthSquared > 0.0f ? std::clamp(glm::dot(p - a, d) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+    return a + t * d;
+}
+
+// Point where segments ab and cd meet, if they meet in exactly one
+bool IntersectSegments(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c, const glm::vec2& d, glm::vec2& point) {
+    const glm::vec2 r = b - a, s = d - c, ac = c - a;
+    const float denominator = r.x * s.y - r.y * s.x;
+    // parallel or degenerate: no single point
+    if (denominator == 0.0f) return false;
+    const float t = (ac.x * s.y - ac.y * s.x) / denominator;
+    const float u = (ac.x * r.y - ac.y * r.x) / denominator;
+    if (!(t >= -kEndSlack && t <= 1.0f + kEndSlack && u >= -kEndSlack && u <= 1.0f + kEndSlack)) return false;
+    point = a + std::clamp(t, 0.0f, 1.0f) * r;
+    return true;
+}
+
+} // namespace
+
+bool SnapEngine::Snap(const LineDocument& document, const glm::vec2& cursor, float radius, SnapResult& result, const glm::vec2* base) {
+    if (!std::isfinite(cursor.x) || !std::isfinite(cursor.y) || !(radius > 0.0f) || !std::isfinite(radius)) return false;
+
+    // Cells are at least twice the radius across, in powers of two so that
+    // zooming does not refill the cache on every step
+    const float cellSize = std::exp2(std::ceil(std::log2(radius * 2.0f)));
+    const glm::dvec2 cell = glm::floor(glm::dvec2(cursor) / (double)cellSize);
+    if (m_Document != &document || m_Revision != document.GetRevision() || m_CellSize != cellSize || m_Cell != cell)
+        Gather(document, cell, cellSize);
+
+    constexpr uint32_t kKinds = (uint32_t)SnapKind::Nearest + 1;
+    float best[kKinds];
+    SnapResult found[kKinds];
+    std::fill_n(best, kKinds, std::numeric_limits<float>::infinity());
+    auto offer = [&](SnapKind kind, const glm::vec2& point, LineHandle line, LineHandle other) {
+        const uint32_t k = (uint32_t)kind;
+        const float distance = glm::length(point - cursor);
+        if ((m_Modes & GetSnapBit(kind)) && distance <= radius && distance < best[k]) {
+            best[k] = distance;
+            found[k] = { kind, point, line, other };
+        }
+    };
+
+    // every snap on a line is on it, so lines farther than the radius have
+    // none; most of the cell's lines are rejected by their bounds alone
+    m_Near.clear();
+    const glm::vec2 reachMin = cursor - radius, reachMax = cursor + radius;
+    for (uint32_t i = 0; i < (uint32_t)m_Candidates.size(); i++) {
+        const Segment& segment = m_Candidates[i];
+        if (std::max(segment.P0.x, segment.P1.x) < reachMin.x || std::min(segment.P0.x, segment.P1.x) > reachMax.x ||
+            std::max(segment.P0.y, segment.P1.y) < reachMin.y || std::min(segment.P0.y, segment.P1.y) > reachMax.y)
+            continue;
+        const glm::vec2 closest = ClosestPointOnSegment(cursor, segment.P0, segment.P1);
+        const float distance = glm::length(closest - cursor);
+        if (!(distance <= radius)) continue;
+        m_Near.push_back({ distance, i });
+
+        offer(SnapKind::Endpoint, segment.P0, segment.Handle, segment.Handle);
+        offer(SnapKind::Endpoint, segment.P1, segment.Handle, segment.Handle);
+        offer(SnapKind::Midpoint, (segment.P0 + segment.P1) * 0.5f, segment.Handle, segment.Handle);
+        offer(SnapKind::Nearest, closest, segment.Handle, segment.Handle);
+        if (base) {
+            // only a foot within the segment is perpendicular to it
+            const glm::vec2 d = segment.P1 - segment.P0;
+            const float lengthSquared = glm::dot(d, d);
+            const float t = lengthSquared > 0.0f ? glm::dot(*base - segment.P0, d) / lengthSquared : -1.0f;
+            if (t >= 0.0f && t <= 1.0f) offer(SnapKind::Perpendicular, segment.P0 + t * d, segment.Handle, segment.Handle);
+        }
+    }
+
+    if ((m_Modes & GetSnapBit(SnapKind::Intersection)) && m_Near.size() >= 2) {
+        const size_t count = std::min(m_Near.size(), kMaxIntersectionLines);
+        std::partial_sort(m_Near.begin(), m_Near.begin() + count, m_Near.end(), [](const NearLine& a, const NearLine& b) {
+            return a.Distance != b.Distance ? a.Distance < b.Distance : a.Index < b.Index;
+        });
+        for (size_t i = 0; i < count; i++) {
+            const Segment& a = m_Candidates[m_Near[i].Index];
+            for (size_t j = i + 1; j < count; j++) {
+                const Segment& b = m_Candidates[m_Near[j].Index];
+                glm::vec2 point;
+                if (IntersectSegments(a.P0, a.P1, b.P0, b.P1, point)) offer(SnapKind::Intersection, point, a.Handle, b.Handle);
+            }
+        }
+    }
+
+    // The closest of the point snaps, the earlier kind at equal distance;
+    // the nearest point on a line only when there is none
+    SnapKind chosen = SnapKind::None;
+    for (uint32_t k = (uint32_t)SnapKind::Endpoint; k < (uint32_t)SnapKind::Nearest; k++)
+        if (best[k] < (chosen == SnapKind::None ? std::numeric_limits<float>::infinity() : best[(uint32_t)chosen])) chosen = (SnapKind)k;
+    if (chosen == SnapKind::None && best[(uint32_t)SnapKind::Nearest] <= radius) chosen = SnapKind::Nearest;
+    if (chosen == SnapKind::None) return false;
+    result = found[(uint32_t)chosen];
+    return true;
+}
+
+bool SnapEngine::Snap(const LineDocument& document, const Camera& camera, const glm::vec2& pixel, float pixelRadius, SnapResult& result,
+    const glm::vec2* base) {
+    return Snap(document, camera.ScreenToWorld(pixel), pixelRadius * camera.GetPixelSize(), result, base);
+}
+
+void SnapEngine::Gather(const LineDocument& document, const glm::dvec2& cell, float cellSize) {
+    m_Document = &document;
+    m_Revision = document.GetRevision();
+    m_Cell = cell;
+    m_CellSize = cellSize;
+    m_RefillCount++;
+    m_Candidates.clear();
+
+    // lines within reach of any cursor in the cell, for any radius up to half the cell
+    const glm::vec2 min = glm::vec2(cell * (double)cellSize);
+    const AABB box = { min - cellSize * 0.5f, min + cellSize * 1.5f };
+    document.QueryLines(box, [&](LineHandle handle) {
+        const LineChunk& chunk = document.GetChunk(GetHandleChunk(handle));
+        const uint32_t slot = GetHandleSlot(handle);
+        const glm::vec2 p0 = { chunk.X0[slot], chunk.Y0[slot] }, p1 = { chunk.X1[slot], chunk.Y1[slot] };
+        if (std::isfinite(p0.x) && std::isfinite(p0.y) && std::isfinite(p1.x) && std::isfinite(p1.y))
+            m_Candidates.push_back({ p0, p1, handle });
+    });
+}
+
+} // namespace EasyLine
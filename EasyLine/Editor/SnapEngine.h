@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "LineChunk.h"
+
+namespace EasyLine {
+
+class Camera;
+class LineDocument;
+
+// In order of precedence between snaps at the same distance
+enum class SnapKind : uint8_t {
+    None,
+    Endpoint,
+    Intersection,
+    Midpoint,
+    Perpendicular,  // foot of the perpendicular from the base point onto a line
+    Nearest,        // closest point on a line; only when there is nothing else
+};
+
+// Which kinds Snap() looks for: a bit per SnapKind
+using SnapModes = uint32_t;
+constexpr SnapModes GetSnapBit(SnapKind kind) { return 1u << (uint32_t)kind; }
+constexpr SnapModes kAllSnapModes = GetSnapBit(SnapKind::Endpoint) | GetSnapBit(SnapKind::Intersection) |
+    GetSnapBit(SnapKind::Midpoint) | GetSnapBit(SnapKind::Perpendicular) | GetSnapBit(SnapKind::Nearest);
+
+struct SnapResult {
+    SnapKind Kind = SnapKind::None;
+    glm::vec2 Point = { 0.0f, 0.0f };
+    LineHandle Line = 0;    // the line snapped to
+    LineHandle Other = 0;   // the second line of an intersection
+};
+
+// Object snapping for drawing tools, run on every mouse move.
+//
+// The lines around the cursor come from the spatial index and are cached for
+// a grid cell about twice the snap radius across, so while the cursor stays
+// in the cell a snap only measures the cached lines. The cache is refreshed
+// when the cursor leaves the cell, the radius changes scale or the document
+// changes (by its revision). The closest endpoint, intersection, midpoint or
+// perpendicular foot within the radius wins; the nearest point on a line is
+// the fallback.
+class SnapEngine {
+public:
+    void SetModes(SnapModes modes) { m_Modes = modes; }
+    SnapModes GetModes() const { return m_Modes; }
+
+    // Snap point within radius of cursor (world units). Perpendicular snaps
+    // need base, the point the line being drawn starts from. Returns false
+    // if there is nothing to snap to.
+    bool Snap(const LineDocument& document, const glm::vec2& cursor, float radius, SnapResult& result, const glm::vec2* base = nullptr);
+    // Same for a framebuffer pixel (origin top left) and a radius in pixels
+    bool Snap(const LineDocument& document, const Camera& camera, const glm::vec2& pixel, float pixelRadius, SnapResult& result,
+        const glm::vec2* base = nullptr);
+
+    // Drop the cached lines
+    void Invalidate() { m_Document = nullptr; }
+    size_t GetCandidateCount() const { return m_Candidates.size(); }
+    // How many times the cache was filled from the index
+    uint64_t GetRefillCount() const { return m_RefillCount; }
+
+private:
+    struct Segment {
+        glm::vec2 P0, P1;
+        LineHandle Handle;
+    };
+    struct NearLine {
+        float Distance;
+        uint32_t Index;
+    };
+
+    void Gather(const LineDocument& document, const glm::dvec2& cell, float cellSize);
+
+    SnapModes m_Modes = kAllSnapModes;
+    std::vector<Segment> m_Candidates;
+    std::vector<NearLine> m_Near;   // scratch: candidates within the radius
+    const LineDocument* m_Document = nullptr;
+    uint64_t m_Revision = 0;
+    glm::dvec2 m_Cell = { 0.0, 0.0 };   // in units of the cell size
+    float m_CellSize = 0.0f;
+    uint64_t m_RefillCount = 0;
+};
+
+} // namespace EasyLine
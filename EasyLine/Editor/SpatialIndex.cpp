@@ -0,0 +1,154 @@
+#include "SpatialIndex.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "MappedFile.h"
+#include <algorithm>
+
+namespace EasyLine {
+
+// Interleave the low 16 bits of v with zeros
+static uint32_t SpreadBits(uint32_t v) {
+    v &= 0xffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+// LSD radix sort of slots 0..count-1 by code, 11 bits per pass. Stable, so
+// equal codes keep slot order. Several times faster than a comparison sort
+// at chunk size, which matters when every chunk of a file is indexed on load.
+static void SortByCode(const uint32_t* codes, uint32_t count, uint16_t* order) {
+    constexpr uint32_t kBits = 11, kBuckets = 1u << kBits, kPasses = 3;
+    uint16_t scratch[LineChunk::kCapacity];
+    uint32_t histogram[kPasses][kBuckets] = {};
+    for (uint32_t i = 0; i < count; i++)
+        for (uint32_t pass = 0; pass < kPasses; pass++)
+            histogram[pass][(codes[i] >> (pass * kBits)) & (kBuckets - 1)]++;
+
+    for (uint32_t i = 0; i < count; i++) order[i] = (uint16_t)i;
+    uint16_t* from = order;
+    uint16_t* to = scratch;
+    for (uint32_t pass = 0; pass < kPasses; pass++) {
+        uint32_t sum = 0;
+        for (uint32_t b = 0; b < kBuckets; b++) {
+            const uint32_t n = histogram[pass][b];
+            histogram[pass][b] = sum;
+            sum += n;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            const uint16_t slot = from[i];
+            to[histogram[pass][(codes[slot] >> (pass * kBits)) & (kBuckets - 1)]++] = slot;
+        }
+        std::swap(from, to);
+    }
+    if (from != order) std::copy(from, from + count, order);
+}
+
+void SpatialIndex::BuildTree(const LineChunk& chunk, ChunkTree& tree) {
+    const uint32_t count = chunk.Count;
+    tree.ChunkVersion = chunk.Version;
+    tree.LineCount = (uint16_t)count;
+    tree.LeafCount = 0;
+    tree.NodeCount = 0;
+    if (count == 0) return;
+
+    // sort slots by the Morton code of their center, quantized to the chunk bounds
+    const glm::vec2 origin = chunk.Bounds.Min;
+    const glm::vec2 size = glm::max(chunk.Bounds.GetSize(), glm::vec2(1e-20f));
+    const glm::vec2 scale = 65535.0f / size;
+    uint32_t codes[LineChunk::kCapacity];
+    for (uint32_t i = 0; i < count; i++) {
+        glm::vec2 center = { (chunk.X0[i] + chunk.X1[i]) * 0.5f, (chunk.Y0[i] + chunk.Y1[i]) * 0.5f };
+        glm::vec2 q = glm::clamp((center - origin) * scale, glm::vec2(0.0f), glm::vec2(65535.0f));
+        codes[i] = SpreadBits((uint32_t)q.x) | (SpreadBits((uint32_t)q.y) << 1);
+    }
+    SortByCode(codes, count, tree.Order);
+
+    // leaves
+    uint32_t nodeCount = 0;
+    for (uint32_t first = 0; first < count; first += ChunkTree::kFanout) {
+        ChunkTree::Node& node = tree.Nodes[nodeCount++];
+        node.First = (uint16_t)first;
+        node.Count = (uint16_t)std::min(ChunkTree::kFanout, count - first);
+        node.Bounds = AABB();
+        for (uint32_t k = first; k < first + node.Count; k++) {
+            const uint32_t slot = tree.Order[k];
+            node.Bounds.Expand(glm::vec2(chunk.X0[slot], chunk.Y0[slot]));
+            node.Bounds.Expand(glm::vec2(chunk.X1[slot], chunk.Y1[slot]));
+        }
+    }
+    tree.LeafCount = (uint16_t)nodeCount;
+
+    // inner levels until a single root remains
+    uint32_t levelBegin = 0, levelEnd = nodeCount;
+    while (levelEnd - levelBegin > 1) {
+        for (uint32_t first = levelBegin; first < levelEnd; first += ChunkTree::kFanout) {
+            ChunkTree::Node& node = tree.Nodes[nodeCount++];
+            node.First = (uint16_t)first;
+            node.Count = (uint16_t)std::min(ChunkTree::kFanout, levelEnd - first);
+            node.Bounds = AABB();
+            for (uint32_t c = first; c < first + node.Count; c++)
+                node.Bounds.Expand(tree.Nodes[c].Bounds);
+        }
+        levelBegin = levelEnd;
+        levelEnd = nodeCount;
+    }
+    tree.NodeCount = (uint16_t)nodeCount;
+}
+
+bool SpatialIndex::IsTreeValid(const LineChunk& chunk, const ChunkTree& tree) {
+    // levels, leaves included, that fit the 64 entry stack of Query() at
+    // kFanout children per node; a built tree has 3
+    constexpr uint32_t kMaxDepth = 4;
+    if (tree.LineCount > chunk.Count || tree.NodeCount > ChunkTree::kMaxNodes || tree.LeafCount > tree.NodeCount) return false;
+    for (uint32_t k = 0; k < tree.LineCount; k++)
+        if (tree.Order[k] >= chunk.Count) return false;
+
+    uint8_t depth[ChunkTree::kMaxNodes];
+    for (uint32_t i = 0; i < tree.NodeCount; i++) {
+        const ChunkTree::Node& node = tree.Nodes[i];
+        const uint32_t end = (uint32_t)node.First + node.Count;
+        if (tree.IsLeaf(i)) {
+            if (end > tree.LineCount) return false;
+            depth[i] = 1;
+            continue;
+        }
+        if (node.Count > ChunkTree::kFanout || end > i) return false;
+        depth[i] = 0;
+        for (uint32_t c = node.First; c < end; c++) depth[i] = std::max(depth[i], depth[c]);
+        if (++depth[i] > kMaxDepth) return false;
+    }
+    return true;
+}
+
+void SpatialIndex::Update(const LineDocument& document) {
+    const size_t chunkCount = document.GetChunkCount();
+
+    std::vector<uint32_t> stale;
+    for (size_t i = 0; i < chunkCount; i++) {
+        const ChunkTree* tree = GetTree(i);
+        if (!tree || tree->ChunkVersion != document.GetChunk(i).Version)
+            stale.push_back((uint32_t)i);
+    }
+    if (stale.empty()) return;
+
+    std::vector<std::shared_ptr<ChunkTree>>& trees = m_Trees.GetMutable();
+    trees.resize(chunkCount);
+    JobSystem::ParallelFor(stale.size(), 4, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            const uint32_t i = stale[k];
+            if (!trees[i] || trees[i].use_count() > 1 || IsMapped(trees[i])) trees[i] = std::make_shared<ChunkTree>();
+            BuildTree(document.GetChunk(i), *trees[i]);
+        }
+    });
+}
+
+void SpatialIndex::SetTree(size_t chunk, std::shared_ptr<ChunkTree> tree) {
+    std::vector<std::shared_ptr<ChunkTree>>& trees = m_Trees.GetMutable();
+    if (trees.size() <= chunk) trees.resize(chunk + 1);
+    trees[chunk] = std::move(tree);
+}
+
+} // namespace EasyLine
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "AABB.h"
+#include "LineChunk.h"
+#include "SharedList.h"
+
+namespace EasyLine {
+
+class LineDocument;
+
+// Packed bounding-volume tree over the lines of one chunk. Lines are sorted
+// along a Morton curve of their centers and grouped kFanout per leaf; upper
+// levels group kFanout nodes the same way. Leaves come first in Nodes, the
+// root is last. Plain data with no pointers, so it can be written to and
+// mapped from disk as is.
+struct ChunkTree {
+    static constexpr uint32_t kFanout = 16;
+    static constexpr uint32_t kMaxNodes = 256 + 16 + 1;   // enough for LineChunk::kCapacity lines
+
+    struct Node {
+        AABB Bounds;
+        uint16_t First;     // leaf: index into Order, inner node: index into Nodes
+        uint16_t Count;
+    };
+
+    uint32_t ChunkVersion = 0;  // LineChunk::Version this tree was built from
+    uint16_t LineCount = 0;
+    uint16_t LeafCount = 0;
+    uint16_t NodeCount = 0;
+    uint16_t Order[LineChunk::kCapacity];   // chunk slots in curve order
+    Node Nodes[kMaxNodes];
+
+    bool IsLeaf(uint32_t node) const { return node < LeafCount; }
+
+    // Calls fn(slot) for every line whose endpoint box intersects rect
+    template<typename Fn>
+    void Query(const LineChunk& chunk, const AABB& rect, Fn&& fn) const
+    {
+        if (NodeCount == 0) return;
+        uint16_t stack[64];
+        int top = 0;
+        stack[top++] = (uint16_t)(NodeCount - 1);
+        while (top > 0) {
+            const uint16_t index = stack[--top];
+            const Node& node = Nodes[index];
+            if (!node.Bounds.Intersects(rect)) continue;
+            if (IsLeaf(index)) {
+                for (uint32_t k = node.First; k < (uint32_t)node.First + node.Count; k++) {
+                    const uint32_t slot = Order[k];
+                    if (chunk.DeletedCount > 0 && chunk.IsDeleted(slot)) continue;
+                    if (std::max(chunk.X0[slot], chunk.X1[slot]) < rect.Min.x || std::min(chunk.X0[slot], chunk.X1[slot]) > rect.Max.x ||
+                        std::max(chunk.Y0[slot], chunk.Y1[slot]) < rect.Min.y || std::min(chunk.Y0[slot], chunk.Y1[slot]) > rect.Max.y)
+                        continue;
+                    fn(slot);
+                }
+            } else {
+                for (uint32_t c = node.First; c < (uint32_t)node.First + node.Count; c++)
+                    stack[top++] = (uint16_t)c;
+            }
+        }
+    }
+
+    // Calls fn(slot) for every line whose endpoint box segment ab passes
+    // through. Boxes are tested against the segment itself, not its bounds,
+    // so a long diagonal query visits few leaves.
+    template<typename Fn>
+    void QuerySegment(const LineChunk& chunk, const glm::vec2& a, const glm::vec2& b, Fn&& fn) const
+    {
+        if (NodeCount == 0) return;
+        uint16_t stack[64];
+        int top = 0;
+        stack[top++] = (uint16_t)(NodeCount - 1);
+        while (top > 0) {
+            const uint16_t index = stack[--top];
+            const Node& node = Nodes[index];
+            if (!node.Bounds.IntersectsSegment(a, b)) continue;
+            if (IsLeaf(index)) {
+                for (uint32_t k = node.First; k < (uint32_t)node.First + node.Count; k++) {
+                    const uint32_t slot = Order[k];
+                    if (chunk.DeletedCount > 0 && chunk.IsDeleted(slot)) continue;
+                    const AABB box = { { std::min(chunk.X0[slot], chunk.X1[slot]), std::min(chunk.Y0[slot], chunk.Y1[slot]) },
+                        { std::max(chunk.X0[slot], chunk.X1[slot]), std::max(chunk.Y0[slot], chunk.Y1[slot]) } };
+                    if (box.IntersectsSegment(a, b)) fn(slot);
+                }
+            } else {
+                for (uint32_t c = node.First; c < (uint32_t)node.First + node.Count; c++)
+                    stack[top++] = (uint16_t)c;
+            }
+        }
+    }
+};
+
+// Two-level spatial index of a LineDocument: the chunks' own bounds at the top
+// (a few thousand boxes even for 10M lines, scanned linearly) and one
+// ChunkTree per chunk below. Trees are built per chunk, so they can be built
+// incrementally (e.g. on loader threads as chunks arrive) and rebuilt only for
+// chunks that changed.
+class SpatialIndex {
+public:
+    static void BuildTree(const LineChunk& chunk, ChunkTree& tree);
+    // Whether Query() can walk a tree that did not come from BuildTree() (read
+    // from a file) without leaving it or chunk: every index in range,
+    // children stored before their parent and the tree shallow enough
+    static bool IsTreeValid(const LineChunk& chunk, const ChunkTree& tree);
+
+    // Rebuild the trees of chunks whose Version changed, in parallel on the job system
+    void Update(const LineDocument& document);
+    void SetTree(size_t chunk, std::shared_ptr<ChunkTree> tree);
+    void Clear() { m_Trees.Clear(); }
+
+    // nullptr if the chunk has no tree yet
+    const ChunkTree* GetTree(size_t chunk) const { return chunk < m_Trees.GetSize() ? m_Trees[chunk].get() : nullptr; }
+
+private:
+    SharedList<ChunkTree> m_Trees;  // shared trees (e.g. mapped from a file or held by a snapshot) are replaced, not rebuilt in place
+};
+
+} // namespace EasyLine
@@ -0,0 +1,83 @@
+#include "SvgWriter.h"
+#include "FileWriter.h"
+#include "LineDocument.h"
+#include "PathTracer.h"
+#include <cstring>
+
+namespace EasyLine {
+
+namespace {
+
+char* Append(char* p, std::string_view text) {
+    std::memcpy(p, text.data(), text.size());
+    return p + text.size();
+}
+
+char* AppendHex(char* p, uint32_t value) {
+    static const char kDigits[] = "0123456789abcdef";
+    *p++ = kDigits[(value >> 4) & 15];
+    *p++ = kDigits[value & 15];
+    return p;
+}
+
+size_t FormatPaths(const ChunkPaths& paths, int decimals, char* begin) {
+    char* p = begin;
+    const TracedPath* style = nullptr;
+    for (const TracedPath& path : paths.Paths) {
+        if (!style || path.Color != style->Color || path.Thickness != style->Thickness) {
+            if (style) p = Append(p, "\"/>\n");
+            const uint32_t color = GetPaperColor(path.Color);
+            p = Append(p, "<path stroke=\"#");
+            p = AppendHex(AppendHex(AppendHex(p, color), color >> 8), color >> 16);
+            if ((color >> 24) != 255) {
+                p = Append(p, "\" stroke-opacity=\"");
+                p = AppendNumber(p, (color >> 24) / 255.0f, 3);
+            }
+            p = Append(p, "\" stroke-width=\"");
+            p = AppendNumber(p, path.Thickness, decimals);
+            p = Append(p, "\" d=\"M");
+            style = &path;
+        } else {
+            p = Append(p, " M");
+        }
+        for (uint32_t i = 0; i < path.Count; i++) {
+            const glm::vec2& point = paths.Points[path.First + i];
+            if (i > 0) *p++ = ' ';
+            p = AppendNumber(p, point.x, decimals);
+            *p++ = ' ';
+            p = AppendNumber(p, point.y, decimals);
+        }
+    }
+    if (style) p = Append(p, "\"/>\n");
+    return (size_t)(p - begin);
+}
+
+} // namespace
+
+bool WriteSvg(const LineDocument& document, FileWriter& out) {
+    return WriteSvg(document, GetExportBounds(document), out);
+}
+
+bool WriteSvg(const LineDocument& document, const AABB& region, FileWriter& out) {
+    const int decimals = GetExportDecimals(region);
+    char number[kMaxNumberSize];
+    auto writeNumber = [&](float value) { out.Write(number, (size_t)(AppendNumber(number, value, decimals) - number)); };
+
+    out.Write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"");
+    writeNumber(region.Min.x);
+    out.Put(' ');
+    writeNumber(-region.Max.y);
+    out.Put(' ');
+    writeNumber(region.Max.x - region.Min.x);
+    out.Put(' ');
+    writeNumber(region.Max.y - region.Min.y);
+    out.Write("\">\n<g transform=\"scale(1 -1)\" fill=\"none\" stroke-linejoin=\"round\">\n");
+
+    const bool written = WriteTracedPaths(document, region, out,
+        [decimals](const ChunkPaths& paths, char* buffer) { return FormatPaths(paths, decimals, buffer); });
+
+    out.Write("</g>\n</svg>\n");
+    return written && !out.HasError();
+}
+
+} // namespace EasyLine
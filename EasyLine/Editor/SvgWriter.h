@@ -0,0 +1,17 @@
+#pragma once
+
+namespace EasyLine {
+
+class FileWriter;
+class LineDocument;
+struct AABB;
+
+// SVG export: the lines become one <path> per style and chunk, with
+// connected segments merged into polylines (see PathTracer). Coordinates and
+// stroke widths stay in world units; the y axis is flipped by a group
+// transform so the file opens the way the canvas shows it.
+bool WriteSvg(const LineDocument& document, FileWriter& out);
+// Only the lines overlapping region, which becomes the view box
+bool WriteSvg(const LineDocument& document, const AABB& region, FileWriter& out);
+
+} // namespace EasyLine
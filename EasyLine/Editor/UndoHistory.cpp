@@ -0,0 +1,254 @@
+#include "UndoHistory.h"
+#include "LineDocument.h"
+#include <algorithm>
+#include <numeric>
+
+namespace EasyLine {
+
+static void PutVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+static uint32_t GetVarint(const uint8_t*& p) {
+    uint32_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        const uint8_t b = *p++;
+        value |= (uint32_t)(b & 0x7f) << shift;
+        if (b < 0x80) return value;
+    }
+}
+
+// Calls fn(handle, index) for the handles of a block, in ascending order
+template<typename Fn>
+static void ForEachHandle(const std::vector<uint8_t>& handles, Fn&& fn) {
+    const uint8_t* p = handles.data();
+    const uint8_t* end = p + handles.size();
+    uint32_t next = 0, index = 0;
+    while (p < end) {
+        const uint32_t first = next + GetVarint(p);
+        const uint32_t count = GetVarint(p);
+        for (uint32_t i = 0; i < count; i++) fn(first + i, index++);
+        next = first + count;
+    }
+}
+
+static const std::string s_NoName;
+
+void UndoHistory::BeginCommand(const std::string& name, uint64_t mergeId) {
+    if (m_Open) EndCommand();
+
+    if (mergeId != 0 && m_Applied == m_Commands.size() && !m_Commands.empty() && m_Commands.back().MergeId == mergeId) {
+        // continue the last step: unpack its last block so further edits of the same kind merge into it
+        Command& command = m_Commands.back();
+        m_Memory -= command.Memory;
+        if (!command.Blocks.empty()) {
+            Block& block = command.Blocks.back();
+            m_PendingType = block.Type;
+            ForEachHandle(block.Handles, [&](LineHandle handle, uint32_t) { m_PendingHandles.push_back(handle); });
+            m_PendingOld = std::move(block.Old);
+            m_PendingNew = std::move(block.New);
+            command.Blocks.pop_back();
+        }
+        command.Memory = GetMemory(command);
+        m_Memory += command.Memory;
+        m_Open = true;
+        return;
+    }
+
+    // a new step replaces whatever could have been redone
+    while (m_Commands.size() > m_Applied) {
+        m_Memory -= m_Commands.back().Memory;
+        m_Commands.pop_back();
+    }
+    Command& command = m_Commands.emplace_back();
+    command.Name = name;
+    command.MergeId = mergeId;
+    command.Memory = GetMemory(command);
+    m_Memory += command.Memory;
+    m_Applied = m_Commands.size();
+    m_Open = true;
+}
+
+void UndoHistory::EndCommand() {
+    if (!m_Open) return;
+    FlushBlock();
+    m_Open = false;
+    if (m_Commands.back().Blocks.empty()) {
+        m_Memory -= m_Commands.back().Memory;
+        m_Commands.pop_back();
+        m_Applied = m_Commands.size();
+        return;
+    }
+    EnforceBudget();
+}
+
+const std::string& UndoHistory::GetUndoName() const {
+    return CanUndo() ? m_Commands[m_Applied - 1].Name : s_NoName;
+}
+
+const std::string& UndoHistory::GetRedoName() const {
+    return CanRedo() ? m_Commands[m_Applied].Name : s_NoName;
+}
+
+void UndoHistory::Undo(LineDocument& document) {
+    EndCommand();
+    if (!CanUndo()) return;
+    Apply(document, m_Commands[m_Applied - 1], true);
+    m_Applied--;
+}
+
+void UndoHistory::Redo(LineDocument& document) {
+    EndCommand();
+    if (!CanRedo()) return;
+    Apply(document, m_Commands[m_Applied], false);
+    m_Applied++;
+}
+
+void UndoHistory::Clear() {
+    m_Commands.clear();
+    m_Applied = 0;
+    m_Memory = 0;
+    m_Open = false;
+    m_PendingHandles.clear();
+    m_PendingOld.clear();
+    m_PendingNew.clear();
+}
+
+void UndoHistory::SetMemoryBudget(size_t bytes) {
+    m_Budget = bytes;
+    EnforceBudget();
+}
+
+void UndoHistory::RecordAdd(LineHandle handle) {
+    Record(EditType::Add, handle);
+}
+
+void UndoHistory::RecordMove(LineHandle handle, const glm::vec2& oldP0, const glm::vec2& oldP1, const glm::vec2& p0, const glm::vec2& p1) {
+    const glm::vec4 oldValue = { oldP0, oldP1 }, newValue = { p0, p1 };
+    Record(EditType::Move, handle, &oldValue, &newValue);
+}
+
+void UndoHistory::RecordRemove(LineHandle handle) {
+    Record(EditType::Remove, handle);
+}
+
+void UndoHistory::RecordRestore(LineHandle handle) {
+    Record(EditType::Restore, handle);
+}
+
+void UndoHistory::Record(EditType type, LineHandle handle, const glm::vec4* oldValue, const glm::vec4* newValue) {
+    if (m_Replaying) return;
+    const bool single = !m_Open;
+    if (single) BeginCommand("Edit");
+
+    if (!m_PendingHandles.empty() && type != m_PendingType) FlushBlock();
+    m_PendingType = type;
+    m_PendingHandles.push_back(handle);
+    if (type == EditType::Move) {
+        m_PendingOld.push_back(*oldValue);
+        m_PendingNew.push_back(*newValue);
+    }
+
+    if (single) EndCommand();
+}
+
+void UndoHistory::FlushBlock() {
+    if (m_PendingHandles.empty()) return;
+    const size_t count = m_PendingHandles.size();
+
+    // ascending handles; a line moved several times keeps its first old and last new position
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    if (!std::is_sorted(m_PendingHandles.begin(), m_PendingHandles.end()))
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return m_PendingHandles[a] < m_PendingHandles[b]; });
+
+    Block block;
+    block.Type = m_PendingType;
+    const bool move = m_PendingType == EditType::Move;
+    uint32_t next = 0, runFirst = 0, runLast = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t index = order[i];
+        const LineHandle handle = m_PendingHandles[index];
+        if (block.Count > 0 && handle == runLast) {
+            if (move) block.New.back() = m_PendingNew[index];
+            continue;
+        }
+        if (move) {
+            block.Old.push_back(m_PendingOld[index]);
+            block.New.push_back(m_PendingNew[index]);
+        }
+        if (block.Count > 0 && handle == runLast + 1) {
+            runLast = handle;
+        } else {
+            if (block.Count > 0) {
+                PutVarint(block.Handles, runFirst - next);
+                PutVarint(block.Handles, runLast - runFirst + 1);
+                next = runLast + 1;
+            }
+            runFirst = runLast = handle;
+        }
+        block.Count++;
+    }
+    PutVarint(block.Handles, runFirst - next);
+    PutVarint(block.Handles, runLast - runFirst + 1);
+    block.Handles.shrink_to_fit();
+    block.Old.shrink_to_fit();
+    block.New.shrink_to_fit();
+
+    m_PendingHandles.clear();
+    m_PendingOld.clear();
+    m_PendingNew.clear();
+
+    Command& command = m_Commands.back();
+    m_Memory -= command.Memory;
+    command.Blocks.push_back(std::move(block));
+    command.Memory = GetMemory(command);
+    m_Memory += command.Memory;
+}
+
+void UndoHistory::Apply(LineDocument& document, const Command& command, bool undo) {
+    m_Replaying = true;
+    for (size_t b = 0; b < command.Blocks.size(); b++) {
+        const Block& block = command.Blocks[undo ? command.Blocks.size() - 1 - b : b];
+        switch (block.Type) {
+        case EditType::Add:
+            ForEachHandle(block.Handles, [&](LineHandle handle, uint32_t) { undo ? document.RemoveLine(handle) : document.RestoreLine(handle); });
+            break;
+        case EditType::Remove:
+            ForEachHandle(block.Handles, [&](LineHandle handle, uint32_t) { undo ? document.RestoreLine(handle) : document.RemoveLine(handle); });
+            break;
+        case EditType::Restore:
+            ForEachHandle(block.Handles, [&](LineHandle handle, uint32_t) { undo ? document.RemoveLine(handle) : document.RestoreLine(handle); });
+            break;
+        case EditType::Move:
+            ForEachHandle(block.Handles, [&](LineHandle handle, uint32_t index) {
+                const glm::vec4& p = undo ? block.Old[index] : block.New[index];
+                document.MoveLine(handle, { p.x, p.y }, { p.z, p.w });
+            });
+            break;
+        }
+    }
+    m_Replaying = false;
+}
+
+// Drop the oldest steps until the history fits; the newest one always stays
+void UndoHistory::EnforceBudget() {
+    while (m_Memory > m_Budget && m_Commands.size() > 1 && m_Applied > 1) {
+        m_Memory -= m_Commands.front().Memory;
+        m_Commands.pop_front();
+        m_Applied--;
+    }
+}
+
+size_t UndoHistory::GetMemory(const Command& command) {
+    size_t bytes = sizeof(Command) + command.Name.capacity() + command.Blocks.capacity() * sizeof(Block);
+    for (const Block& block : command.Blocks)
+        bytes += block.Handles.capacity() + (block.Old.capacity() + block.New.capacity()) * sizeof(glm::vec4);
+    return bytes;
+}
+
+} // namespace EasyLine
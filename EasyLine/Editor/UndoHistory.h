@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "LineChunk.h"
+
+namespace EasyLine {
+
+class LineDocument;
+
+// Undo/redo as a log of compact deltas rather than document copies.
+//
+// The document reports every edit here (LineDocument::SetHistory). Edits
+// between BeginCommand() and EndCommand() form one undo step; an edit made
+// outside a command is a step of its own. A step stores only what changed:
+// the handles of added, removed and restored lines (sorted and run-length
+// coded, so deleting a whole drawing costs a few bytes per chunk) and the old
+// and new endpoints of moved lines. Deleted lines keep their slot, so undoing
+// a delete just clears tombstones and handles stay valid across undo/redo.
+//
+// Steps beyond the memory budget are dropped, oldest first.
+class UndoHistory {
+public:
+    static constexpr size_t kDefaultBudget = 64 << 20;
+
+    explicit UndoHistory(size_t memoryBudget = kDefaultBudget) : m_Budget(memoryBudget) {}
+
+    // Group the following edits into one step named name (for the UI).
+    // A step begun with the same non-zero mergeId as the last one continues it
+    // instead, e.g. every frame of a drag; moves of the same line then keep the
+    // first old and the last new position, so a long drag costs one entry per line.
+    void BeginCommand(const std::string& name, uint64_t mergeId = 0);
+    void EndCommand();
+
+    bool CanUndo() const { return !m_Commands.empty() && m_Applied > 0; }
+    bool CanRedo() const { return m_Applied < m_Commands.size(); }
+    // Name of the step Undo()/Redo() would apply
+    const std::string& GetUndoName() const;
+    const std::string& GetRedoName() const;
+
+    // Revert or reapply one step on document, which must be the one the edits came from
+    void Undo(LineDocument& document);
+    void Redo(LineDocument& document);
+    // Forget everything, e.g. when another document is opened
+    void Clear();
+
+    void SetMemoryBudget(size_t bytes);
+    size_t GetMemoryUsage() const { return m_Memory; }
+    size_t GetCommandCount() const { return m_Commands.size(); }
+
+    // Called by LineDocument; ignored while a step is being undone or redone
+    void RecordAdd(LineHandle handle);
+    void RecordMove(LineHandle handle, const glm::vec2& oldP0, const glm::vec2& oldP1, const glm::vec2& p0, const glm::vec2& p1);
+    void RecordRemove(LineHandle handle);
+    void RecordRestore(LineHandle handle);
+
+private:
+    enum class EditType : uint8_t { Add, Move, Remove, Restore };
+
+    // A run of edits of one type. Handles are coded as (gap, run length)
+    // varint pairs in ascending order; moves keep their endpoints in the same order.
+    struct Block {
+        EditType Type;
+        uint32_t Count = 0;
+        std::vector<uint8_t> Handles;
+        std::vector<glm::vec4> Old, New;    // moves only: (x0, y0, x1, y1)
+    };
+
+    struct Command {
+        std::string Name;
+        uint64_t MergeId = 0;
+        std::vector<Block> Blocks;
+        size_t Memory = 0;
+    };
+
+    void Record(EditType type, LineHandle handle, const glm::vec4* oldValue = nullptr, const glm::vec4* newValue = nullptr);
+    // Pack the edits collected for the current block into m_Commands.back()
+    void FlushBlock();
+    void Apply(LineDocument& document, const Command& command, bool undo);
+    void EnforceBudget();
+    static size_t GetMemory(const Command& command);
+
+    std::deque<Command> m_Commands;
+    size_t m_Applied = 0;       // commands [0, m_Applied) are done, the rest can be redone
+    size_t m_Memory = 0;
+    size_t m_Budget;
+    bool m_Open = false;        // inside BeginCommand/EndCommand
+    bool m_Replaying = false;
+
+    // Edits of the current block as recorded, packed by FlushBlock()
+    EditType m_PendingType = EditType::Add;
+    std::vector<LineHandle> m_PendingHandles;
+    std::vector<glm::vec4> m_PendingOld, m_PendingNew;
+};
+
+} // namespace EasyLine
@@ -10,12 +10,70 @@
 #include "Log.h"
 #include "Renderer.h"
 #include "Camera.h"
+#include "JobSystem.h"
+#include "LineDocument.h"
+#include "DocumentLoader.h"
+#include "DocumentWriter.h"
+#include "DocumentJournal.h"
+#include "DocumentAutosave.h"
+#include "UndoHistory.h"
+#include "LinePicker.h"
+#include "Dimension.h"
+#include "LineSelection.h"
+#include "SelectionSet.h"
+#include "SnapEngine.h"
+#include "SegmentIntersection.h"
+#include "LineEditing.h"
+#include "LineTopology.h"
+#include "LineCleanup.h"
+#include "LoopOperations.h"
+#include "PathTracer.h"
+#include "RasterExport.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
 #include <string>
+#include <thread>
 #include <iostream>
 
 static bool s_bDrag = false;
+
+// Native documents are saved incrementally through their journal
+static bool IsNativeDocument(const std::string& path)
+{
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".elb") == 0;
+}
+
+static bool IsRasterImage(const std::string& path)
+{
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0;
+}
+
+// Recovery file for documents that have no journal
+static std::string GetAutosavePath(const std::string& path)
+{
+    return (path.empty() ? std::string("untitled") : path) + ".autosave.elb";
+}
 static double s_lastMouseX = 0.0, s_lastMouseY = 0.0;
+// Where the current press started; a release close to it is a click, not a drag
+static double s_pressMouseX = 0.0, s_pressMouseY = 0.0;
+// Right-button selection drag: the box corners or lasso outline so far, in window pixels
+static bool s_bSelectDrag = false;
+static bool s_bLasso = false;
+static std::vector<glm::vec2> s_selectPoints;
+
+// Framebuffer pixels per window unit (cursor positions are in window units)
+static float GetFramebufferScale(GLFWwindow* window)
+{
+    int windowW, windowH, framebufferW, framebufferH;
+    glfwGetWindowSize(window, &windowW, &windowH);
+    glfwGetFramebufferSize(window, &framebufferW, &framebufferH);
+    return windowW > 0 ? (float)framebufferW / windowW : 1.0f;
+}
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
@@ -26,14 +84,104 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
     camera->SetZoom(zoom);
 }
 
-int main(int, char**)
+// Fill the document with random short segments, one square tile per chunk so
+// chunks stay spatially compact and view culling has something to reject.
+static void BuildDemoDocument(EasyLine::LineDocument& document, int lineCount)
 {
+    document.Clear();
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    const float tileSize = 0.5f;
+    const int perTile = (int)EasyLine::LineChunk::kCapacity;
+    const int tiles = (lineCount + perTile - 1) / perTile;
+    const int tilesPerRow = std::max(1, (int)std::ceil(std::sqrt((float)tiles)));
+    const float origin = -0.5f * tilesPerRow * tileSize;
+
+    for (int i = 0; i < lineCount; i++) {
+        int tile = i / perTile;
+        glm::vec2 base = { origin + (tile % tilesPerRow) * tileSize, origin + (tile / tilesPerRow) * tileSize };
+        glm::vec2 p0 = base + glm::vec2(unit(rng), unit(rng)) * tileSize;
+        glm::vec2 p1 = p0 + (glm::vec2(unit(rng), unit(rng)) - 0.5f) * (tileSize * 0.2f);
+        document.AddLine(p0, p1, 0.002f, { unit(rng), unit(rng), unit(rng), 1.0f });
+    }
+}
+
+// A dimension of the line from p0 to p1, drawn offset world units to its
+// left; linear ones measure along the line's main axis, radial ones take the
+// line as a radius from p0
+static EasyLine::Dimension MakeLineDimension(EasyLine::DimensionKind kind, const glm::vec2& p0, const glm::vec2& p1, float offset)
+{
+    EasyLine::Dimension dimension;
+    dimension.Kind = kind;
+    dimension.P0 = p0;
+    dimension.P1 = p1;
+    const glm::vec2 delta = p1 - p0;
+    const float length = glm::length(delta);
+    const glm::vec2 along = length > 0.0f ? delta / length : glm::vec2(1.0f, 0.0f);
+    if (kind == EasyLine::DimensionKind::Radial) {
+        dimension.Location = p1 + along * offset;
+    } else if (kind == EasyLine::DimensionKind::Linear) {
+        const bool vertical = std::abs(delta.y) > std::abs(delta.x);
+        dimension.Angle = vertical ? 1.5707963f : 0.0f;
+        dimension.Location = (p0 + p1) * 0.5f + (vertical ? glm::vec2(-offset, 0.0f) : glm::vec2(0.0f, offset));
+    } else {
+        dimension.Location = (p0 + p1) * 0.5f + glm::vec2(-along.y, along.x) * offset;
+    }
+    return dimension;
+}
+
+// PNG of region at the given width; the height follows from the region's aspect
+static bool ExportImage(const EasyLine::LineDocument& document, const std::string& path, const EasyLine::AABB& region, int width)
+{
+    EasyLine::RasterExportSettings settings;
+    settings.Region = region;
+    settings.Width = (uint32_t)std::max(width, 1);
+    const glm::vec2 size = region.GetSize();
+    settings.Height = (uint32_t)std::max(1.0f, std::round(settings.Width * size.y / std::max(size.x, 1e-30f)));
+    return EasyLine::ExportPng(document, path, settings);
+}
+
+// Load path, render the whole drawing into a PNG and quit, without showing
+// the window: EasyLineEditor <document> --png <image.png> <width>
+static int RunHeadlessExport(const char* documentPath, const char* imagePath, int width)
+{
+    EasyLine::LineDocument document;
+    if (documentPath) {
+        auto task = EasyLine::DocumentLoader::LoadAsync(documentPath);
+        while (!task->IsFinished()) {
+            task->Poll(document);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        task->Poll(document);
+        if (task->GetState() != EasyLine::LoadState::Completed) return 1;
+    } else {
+        BuildDemoDocument(document, 100000);
+    }
+    return ExportImage(document, imagePath, EasyLine::GetExportBounds(document), width) ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    const char* documentPath = nullptr;
+    const char* imagePath = nullptr;
+    int imageWidth = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--png") == 0 && i + 2 < argc) {
+            imagePath = argv[++i];
+            imageWidth = std::atoi(argv[++i]);
+        } else {
+            documentPath = argv[i];
+        }
+    }
+
     if (!glfwInit())
         return 1;
 
-    // Create window with OpenGL context
+    // Create window with OpenGL context; a headless export only needs the context
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_VISIBLE, imagePath ? GLFW_FALSE : GLFW_TRUE);
     GLFWwindow* window = glfwCreateWindow(1280, 720, "EasyLine - ImGui + GLFW + OpenGL3", NULL, NULL);
     if (window == NULL)
     {
@@ -53,6 +201,7 @@ int main(int, char**)
 
     // Initialize logging
     EasyLine::Log::Init();
+    EasyLine::JobSystem::Init();
 
     // Initialize our simple renderer
     int fb_w = 1280, fb_h = 720;
@@ -60,6 +209,15 @@ int main(int, char**)
     EasyLine::Camera camera((float)fb_w, (float)fb_h);
     glfwSetWindowUserPointer(window, &camera);
 
+    if (imagePath) {
+        int result = RunHeadlessExport(documentPath, imagePath, imageWidth);
+        EasyLine::JobSystem::Shutdown();
+        EasyLine::Renderer::Shutdown();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return result;
+    }
+
     // Resize callback to keep renderer in sync
     glfwSetFramebufferSizeCallback(window, [](GLFWwindow* wnd, int w, int h){
         EasyLine::Renderer::OnResize(w,h);
@@ -80,6 +238,82 @@ int main(int, char**)
     const char* glsl_version = "#version 330";
     ImGui_ImplOpenGL3_Init(glsl_version);
 
+    EasyLine::LineDocument document;
+    int demoLineCount = 100000;
+    std::shared_ptr<EasyLine::LoadTask> loadTask;
+    bool fitPending = false;
+    char openPath[512] = {};
+    char savePath[512] = "drawing.dxf";
+    EasyLine::DocumentJournal journal;
+    EasyLine::DocumentAutosave autosave;
+    // Edits are undoable once a document is ready; loading and journal replay are not
+    EasyLine::UndoHistory history;
+    bool openPending = false;
+    bool saveViewOnly = false;
+    int pngWidth = 8192;
+    bool hasPickedLine = false;
+    EasyLine::LineHandle pickedLine = 0;
+    // What is selected, and what it would be if the drag in progress ended now
+    EasyLine::SelectionSet selection;
+    EasyLine::SelectionSet dragSelection;
+    bool selectionChanged = false;
+    // Hover highlight from the GPU ID buffer, or from the CPU picker to compare
+    bool gpuHoverPicking = EasyLine::Renderer::IsIdPickingSupported();
+    EasyLine::Renderer::SetIdPicking(gpuHoverPicking);
+    bool hasHoveredLine = false;
+    EasyLine::LineHandle hoveredLine = 0;
+    float hoverPickMs = 0.0f;
+    // Object snap under the cursor, marked while hovering
+    EasyLine::SnapEngine snapEngine;
+    bool snapEnabled = true;
+    bool hasSnap = false;
+    EasyLine::SnapResult snap;
+    float snapMs = 0.0f;
+    // Trim, extend or fillet the line clicked instead of just picking it
+    enum class EditTool { Pan, Trim, Extend, Fillet };
+    EditTool editTool = EditTool::Pan;
+    float filletRadius = 0.0f;
+    bool hasFilletFirst = false;
+    EasyLine::LineHandle filletFirst = 0;
+    glm::vec2 filletFirstPick = { 0.0f, 0.0f };
+    bool editApplied = true;
+    float editMs = 0.0f;
+    // Every intersection in the drawing, marked until the document changes
+    std::vector<EasyLine::LineIntersection> intersections;
+    uint64_t intersectionRevision = 0;
+    bool showIntersections = false;
+    float intersectionMs = 0.0f;
+    // Welded line network for chain and connected selection, rebuilt on demand
+    EasyLine::LineTopology topology;
+    float topologyTolerance = 0.001f;
+    float topologyMs = 0.0f;
+    size_t closedLoopCount = 0;
+    // Offset the selected closed loops, or combine the picked one with them
+    float offsetDistance = 1.0f;
+    size_t loopRingsAdded = 0;
+    float loopMs = 0.0f;
+    bool hasLoopResult = false;
+    // Duplicate and overlapping lines removed by the last overkill
+    float overkillTolerance = 0.001f;
+    bool hasOverkill = false;
+    EasyLine::CleanupResult overkill;
+    float overkillMs = 0.0f;
+    // Dimensions annotating the view, made from lines
+    EasyLine::DimensionSet dimensions;
+    int dimensionKind = (int)EasyLine::DimensionKind::Aligned;
+    float dimensionTextHeight = 0.0f;
+
+    if (documentPath) {
+        snprintf(openPath, sizeof(openPath), "%s", documentPath);
+        loadTask = EasyLine::DocumentLoader::LoadAsync(openPath);
+        fitPending = true;
+        openPending = true;
+    } else {
+        BuildDemoDocument(document, demoLineCount);
+        autosave.Start(document, GetAutosavePath(""));
+        document.SetHistory(&history);
+    }
+
     EL_INFO("Starting example loop");
 
     while (!glfwWindowShouldClose(window))
@@ -95,6 +329,8 @@ int main(int, char**)
                 {
                     s_bDrag = true;
                     glfwGetCursorPos(window, &s_lastMouseX, &s_lastMouseY);
+                    s_pressMouseX = s_lastMouseX;
+                    s_pressMouseY = s_lastMouseY;
                 }
 
                 double mouseX, mouseY;
@@ -111,10 +347,142 @@ int main(int, char**)
             }
             else
             {
+                // a click picks the line under the cursor, within a few pixels
+                if (s_bDrag && std::abs(s_lastMouseX - s_pressMouseX) + std::abs(s_lastMouseY - s_pressMouseY) < 3.0)
+                {
+                    const float scale = GetFramebufferScale(window);
+                    EasyLine::PickResult pick;
+                    const glm::vec2 pixel = glm::vec2((float)s_lastMouseX, (float)s_lastMouseY) * scale;
+                    hasPickedLine = EasyLine::PickLine(document, camera, pixel, 5.0f * scale, pick);
+                    pickedLine = pick.Handle;
+                    // with an edit tool chosen the click applies it; a selection gives the boundaries
+                    if (hasPickedLine && editTool != EditTool::Pan && !openPending)
+                    {
+                        const glm::vec2 point = camera.ScreenToWorld(pixel);
+                        const EasyLine::SelectionSet* boundaries = selection.IsEmpty() ? nullptr : &selection;
+                        auto start = std::chrono::steady_clock::now();
+                        if (editTool == EditTool::Trim)
+                            editApplied = EasyLine::TrimLine(document, pickedLine, point, boundaries);
+                        else if (editTool == EditTool::Extend)
+                            editApplied = EasyLine::ExtendLine(document, pickedLine, point, boundaries);
+                        else if (!hasFilletFirst)
+                        {
+                            hasFilletFirst = true;
+                            filletFirst = pickedLine;
+                            filletFirstPick = point;
+                        }
+                        else
+                        {
+                            editApplied = EasyLine::FilletLines(document, filletFirst, filletFirstPick, pickedLine, point, filletRadius);
+                            hasFilletFirst = false;
+                        }
+                        editMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    }
+                }
                 s_bDrag = false;
             }
+
+            // A right drag selects with a box, or a lasso while Alt is held.
+            // Dragging to the right takes the lines entirely inside (window),
+            // to the left also those crossing the outline (crossing).
+            // Shift adds to the selection and Ctrl removes from it.
+            if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS)
+            {
+                double mouseX, mouseY;
+                glfwGetCursorPos(window, &mouseX, &mouseY);
+                const glm::vec2 mouse = { (float)mouseX, (float)mouseY };
+                if (!s_bSelectDrag)
+                {
+                    s_bSelectDrag = true;
+                    s_bLasso = io.KeyAlt;
+                    s_selectPoints.assign(1, mouse);
+                }
+                if (!s_bLasso) s_selectPoints.resize(1);
+                if (!s_bLasso || glm::length(mouse - s_selectPoints.back()) >= 2.0f) s_selectPoints.push_back(mouse);
+                const EasyLine::SelectionOp op = io.KeyCtrl ? EasyLine::SelectionOp::Remove : io.KeyShift ? EasyLine::SelectionOp::Add : EasyLine::SelectionOp::Replace;
+                if (op != EasyLine::SelectionOp::Replace) dragSelection = selection;
+
+                // re-evaluated every frame so the count follows the drag
+                const float scale = GetFramebufferScale(window);
+                const EasyLine::SelectionMode mode = s_selectPoints.back().x >= s_selectPoints.front().x ? EasyLine::SelectionMode::Window : EasyLine::SelectionMode::Crossing;
+                if (s_bLasso) {
+                    std::vector<glm::vec2> polygon;
+                    for (const glm::vec2& point : s_selectPoints) polygon.push_back(camera.ScreenToWorld(point * scale));
+                    EasyLine::SelectInPolygon(document, polygon, mode, dragSelection, op);
+                } else {
+                    const glm::vec2 a = camera.ScreenToWorld(s_selectPoints.front() * scale);
+                    const glm::vec2 b = camera.ScreenToWorld(s_selectPoints.back() * scale);
+                    EasyLine::SelectInRect(document, { glm::min(a, b), glm::max(a, b) }, mode, dragSelection, op);
+                }
+                selectionChanged = true;
+            }
+            else if (s_bSelectDrag)
+            {
+                std::swap(selection, dragSelection);
+                dragSelection.Clear();
+                s_bSelectDrag = false;
+                selectionChanged = true;
+            }
         }
 
+        hasHoveredLine = false;
+        if (!io.WantCaptureMouse && !s_bDrag && !s_bSelectDrag)
+        {
+            double mouseX, mouseY;
+            glfwGetCursorPos(window, &mouseX, &mouseY);
+            const float scale = GetFramebufferScale(window);
+            const glm::vec2 pixel = glm::vec2((float)mouseX, (float)mouseY) * scale;
+            if (gpuHoverPicking) {
+                EasyLine::Renderer::SetHoverPoint(pixel, 5.0f * scale);
+                hasHoveredLine = EasyLine::Renderer::GetHoveredLine(hoveredLine);
+            } else {
+                auto start = std::chrono::steady_clock::now();
+                EasyLine::PickResult pick;
+                hasHoveredLine = EasyLine::PickLine(document, camera, pixel, 5.0f * scale, pick);
+                hoveredLine = pick.Handle;
+                hoverPickMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+        }
+        else
+        {
+            EasyLine::Renderer::ClearHoverPoint();
+        }
+
+        hasSnap = false;
+        if (snapEnabled && !io.WantCaptureMouse && !s_bDrag && !s_bSelectDrag && !openPending)
+        {
+            double mouseX, mouseY;
+            glfwGetCursorPos(window, &mouseX, &mouseY);
+            const float scale = GetFramebufferScale(window);
+            auto start = std::chrono::steady_clock::now();
+            hasSnap = snapEngine.Snap(document, camera, glm::vec2((float)mouseX, (float)mouseY) * scale, 10.0f * scale, snap);
+            snapMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+
+        // Pick up whatever the loader finished since last frame; frame the
+        // drawing once when the first chunks arrive, then leave the camera to the user
+        if (loadTask && loadTask->Poll(document) > 0 && fitPending) {
+            camera.FitBounds(document.GetBounds());
+            fitPending = false;
+        }
+        // Once fully loaded, a native document takes its journal's edits;
+        // anything else is protected by autosave
+        if (openPending && loadTask && loadTask->IsFinished()) {
+            if (loadTask->GetState() == EasyLine::LoadState::Completed) {
+                if (IsNativeDocument(loadTask->GetPath())) journal.Attach(document, loadTask->GetPath());
+                if (!journal.IsAttached()) autosave.Start(document, GetAutosavePath(loadTask->GetPath()));
+            }
+            document.SetHistory(&history);
+            openPending = false;
+        }
+        if (!io.WantTextInput && io.KeyCtrl && document.GetHistory()) {
+            if (ImGui::IsKeyPressed(ImGuiKey_Z) && !io.KeyShift) history.Undo(document);
+            else if (ImGui::IsKeyPressed(ImGuiKey_Y) || (ImGui::IsKeyPressed(ImGuiKey_Z) && io.KeyShift)) history.Redo(document);
+        }
+        journal.Update();
+        autosave.Update();
+        document.UpdateSpatialIndex();
 
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -123,8 +491,333 @@ int main(int, char**)
         ImGui::Begin("Hello from EasyLine");
         ImGui::Text("This is a minimal integration example.");
         ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
+        const EasyLine::RendererStats& stats = EasyLine::Renderer::GetStats();
+        ImGui::Text("Lines: %zu (%llu visible in %u chunks)", document.GetLineCount(),
+            (unsigned long long)stats.VisibleLines, stats.VisibleChunks);
+        ImGui::Text("Cull + tessellate: %.2f ms on %u workers", stats.CullTessellateMs,
+            EasyLine::JobSystem::GetWorkerCount());
+        ImGui::SliderInt("Demo lines", &demoLineCount, 0, 10000000, "%d", ImGuiSliderFlags_Logarithmic);
+        if (ImGui::Button("Regenerate")) {
+            if (loadTask) loadTask->Cancel();
+            journal.Detach();
+            autosave.Stop(true);
+            document.SetHistory(nullptr);
+            history.Clear();
+            selection.Clear();
+            selectionChanged = true;
+            BuildDemoDocument(document, demoLineCount);
+            autosave.Start(document, GetAutosavePath(""));
+            document.SetHistory(&history);
+        }
+
+        ImGui::Separator();
+        ImGui::InputText("File", openPath, sizeof(openPath));
+        ImGui::SameLine();
+        if (ImGui::Button("Open") && openPath[0]) {
+            if (loadTask) loadTask->Cancel();
+            journal.Detach();
+            autosave.Stop(true);
+            document.SetHistory(nullptr);
+            history.Clear();
+            selection.Clear();
+            selectionChanged = true;
+            document.Clear();
+            loadTask = EasyLine::DocumentLoader::LoadAsync(openPath);
+            fitPending = true;
+            openPending = true;
+        }
+        ImGui::InputText("Save as", savePath, sizeof(savePath));
+        ImGui::SameLine();
+        const bool loading = loadTask && !loadTask->IsFinished();
+        const bool raster = IsRasterImage(savePath);
+        const bool viewOnly = saveViewOnly && (raster || EasyLine::DocumentWriter::SupportsRegion(savePath));
+        if (ImGui::Button("Save") && savePath[0] && !loading) {
+            if (raster) {
+                ExportImage(document, savePath, viewOnly ? camera.GetViewBounds() : EasyLine::GetExportBounds(document), pngWidth);
+            } else if (viewOnly) {
+                // a partial export, the document itself is not saved
+                EasyLine::DocumentWriter::Save(document, savePath, camera.GetViewBounds());
+            } else if (journal.IsAttached() && journal.GetBasePath() == savePath) {
+                journal.Commit();
+            } else if (EasyLine::DocumentWriter::Save(document, savePath)) {
+                autosave.MarkSaved();
+                if (IsNativeDocument(savePath) && journal.Attach(document, savePath)) autosave.Stop(true);
+            }
+        }
+        if (raster || EasyLine::DocumentWriter::SupportsRegion(savePath)) {
+            ImGui::SameLine();
+            ImGui::Checkbox("View only", &saveViewOnly);
+        }
+        if (raster) {
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(120.0f);
+            ImGui::InputInt("Width (px)", &pngWidth, 1024, 8192);
+            pngWidth = std::clamp(pngWidth, 16, 262144);
+        }
+        ImGui::BeginDisabled(!document.GetHistory() || !history.CanUndo());
+        if (ImGui::Button("Undo")) history.Undo(document);
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::BeginDisabled(!document.GetHistory() || !history.CanRedo());
+        if (ImGui::Button("Redo")) history.Redo(document);
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::Text("%zu steps, %.1f MB", history.GetCommandCount(), history.GetMemoryUsage() / 1e6);
+        ImGui::BeginDisabled(!EasyLine::Renderer::IsIdPickingSupported());
+        if (ImGui::Checkbox("GPU hover picking", &gpuHoverPicking)) EasyLine::Renderer::SetIdPicking(gpuHoverPicking);
+        ImGui::EndDisabled();
+        if (!gpuHoverPicking) {
+            ImGui::SameLine();
+            ImGui::Text("CPU pick %.3f ms", hoverPickMs);
+        }
+        ImGui::Checkbox("Snap", &snapEnabled);
+        if (snapEnabled) {
+            ImGui::SameLine();
+            ImGui::Text("%.3f ms, %zu lines cached", snapMs, snapEngine.GetCandidateCount());
+        }
+        int tool = (int)editTool;
+        ImGui::SetNextItemWidth(120.0f);
+        if (ImGui::Combo("Click", &tool, "Pan / pick\0Trim\0Extend\0Fillet\0")) {
+            editTool = (EditTool)tool;
+            hasFilletFirst = false;
+        }
+        if (editTool == EditTool::Fillet) {
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(100.0f);
+            ImGui::InputFloat("Radius", &filletRadius);
+            filletRadius = std::max(filletRadius, 0.0f);
+        }
+        if (editTool != EditTool::Pan) {
+            if (editTool == EditTool::Fillet && hasFilletFirst) ImGui::Text("Pick the second line");
+            else if (!editApplied) ImGui::TextUnformatted(editTool == EditTool::Extend ? "No boundary ahead to extend to" : "The lines cannot be filleted");
+            else ImGui::Text("Last edit %.3f ms, boundaries: %s", editMs, selection.IsEmpty() ? "all lines" : "selection");
+        }
+        if (ImGui::Button("Find intersections") && !loading) {
+            auto start = std::chrono::steady_clock::now();
+            EasyLine::FindLineIntersections(document, intersections);
+            intersectionMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            intersectionRevision = document.GetRevision();
+            showIntersections = true;
+        }
+        showIntersections = showIntersections && intersectionRevision == document.GetRevision();
+        if (showIntersections) {
+            ImGui::SameLine();
+            ImGui::Text("%zu intersections in %.0f ms", intersections.size(), intersectionMs);
+        }
+        if (ImGui::Button("Build topology") && !loading) {
+            auto start = std::chrono::steady_clock::now();
+            topology.Build(document, topologyTolerance);
+            std::vector<EasyLine::LineTopology::Polyline> loops;
+            topology.GetClosedLoops(loops);
+            closedLoopCount = loops.size();
+            topologyMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100.0f);
+        ImGui::InputFloat("Weld", &topologyTolerance, 0.0f, 0.0f, "%g");
+        topologyTolerance = std::max(topologyTolerance, 0.0f);
+        const bool topologyCurrent = topology.GetRevision() == document.GetRevision() && topology.GetEdgeCount() > 0;
+        if (topologyCurrent) {
+            ImGui::Text("%zu vertices, %zu components, %zu closed loops in %.0f ms", topology.GetVertexCount(), topology.GetComponentCount(),
+                closedLoopCount, topologyMs);
+            if (hasPickedLine && document.IsLineValid(pickedLine)) {
+                if (ImGui::Button("Select chain")) {
+                    topology.SelectChain(pickedLine, selection);
+                    selectionChanged = true;
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Select connected")) {
+                    topology.SelectConnected(pickedLine, selection);
+                    selectionChanged = true;
+                }
+            }
+
+            // The closed loops wholly selected (all of them with no selection),
+            // and the picked line's: booleans combine the picked loop with the others
+            std::vector<EasyLine::LineTopology::Polyline> selectedLoops, pickedLoop;
+            auto gatherLoops = [&]() {
+                std::vector<EasyLine::LineTopology::Polyline> loops;
+                topology.GetClosedLoops(loops);
+                for (EasyLine::LineTopology::Polyline& loop : loops) {
+                    const bool picked = hasPickedLine && std::find(loop.Lines.begin(), loop.Lines.end(), pickedLine) != loop.Lines.end();
+                    const bool selected = selection.IsEmpty() ||
+                        std::all_of(loop.Lines.begin(), loop.Lines.end(), [&](EasyLine::LineHandle line) { return selection.Contains(line); });
+                    if (picked) pickedLoop.push_back(std::move(loop));
+                    else if (selected) selectedLoops.push_back(std::move(loop));
+                }
+            };
+            ImGui::SetNextItemWidth(100.0f);
+            ImGui::InputFloat("##Distance", &offsetDistance, 0.0f, 0.0f, "%g");
+            ImGui::SameLine();
+            if (ImGui::Button("Offset loops")) {
+                auto start = std::chrono::steady_clock::now();
+                gatherLoops();
+                selectedLoops.insert(selectedLoops.end(), pickedLoop.begin(), pickedLoop.end());
+                loopRingsAdded = EasyLine::OffsetLoops(document, topology, selectedLoops, offsetDistance);
+                loopMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+                hasLoopResult = true;
+            }
+            static constexpr const char* kLoopOperations[] = { "Union", "Intersect", "Subtract" };
+            for (int operation = 0; operation < 3; operation++) {
+                ImGui::SameLine();
+                if (ImGui::Button(kLoopOperations[operation])) {
+                    auto start = std::chrono::steady_clock::now();
+                    gatherLoops();
+                    loopRingsAdded = pickedLoop.empty() ? 0 : EasyLine::CombineLoops(document, topology, pickedLoop, selectedLoops, (EasyLine::LoopOperation)operation);
+                    loopMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    hasLoopResult = true;
+                }
+            }
+        }
+        if (hasLoopResult) ImGui::Text("Added %zu loops in %.0f ms", loopRingsAdded, loopMs);
+        if (ImGui::Button("Overkill") && !loading) {
+            auto start = std::chrono::steady_clock::now();
+            overkill = EasyLine::RemoveOverkill(document, overkillTolerance);
+            overkillMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            hasOverkill = true;
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100.0f);
+        ImGui::InputFloat("Quantize", &overkillTolerance, 0.0f, 0.0f, "%g");
+        overkillTolerance = std::max(overkillTolerance, 0.0f);
+        if (hasOverkill) {
+            ImGui::Text("Removed %zu lines (%zu duplicates, %zu overlapping) in %.0f ms", overkill.GetRemovedCount(), overkill.Duplicates,
+                overkill.Overlaps, overkillMs);
+        }
+        ImGui::SetNextItemWidth(100.0f);
+        ImGui::Combo("##DimensionKind", &dimensionKind, "Linear\0Aligned\0Radial\0");
+        ImGui::SameLine();
+        if (ImGui::Button("Dimension lines")) {
+            // every selected line, or the picked one
+            const float offset = 24.0f * camera.GetPixelSize();
+            auto addDimension = [&](EasyLine::LineHandle line) {
+                if (!document.IsLineValid(line)) return;
+                const EasyLine::LineChunk& chunk = document.GetChunk(EasyLine::GetHandleChunk(line));
+                const uint32_t slot = EasyLine::GetHandleSlot(line);
+                dimensions.Add(MakeLineDimension((EasyLine::DimensionKind)dimensionKind, { chunk.X0[slot], chunk.Y0[slot] },
+                    { chunk.X1[slot], chunk.Y1[slot] }, offset));
+            };
+            if (!selection.IsEmpty()) selection.ForEach(addDimension);
+            else if (hasPickedLine) addDimension(pickedLine);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear dimensions")) dimensions.Clear();
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(80.0f);
+        // 0 keeps the text the same size on screen
+        if (ImGui::InputFloat("Text height", &dimensionTextHeight, 0.0f, 0.0f, "%g")) {
+            dimensionTextHeight = std::max(dimensionTextHeight, 0.0f);
+            EasyLine::Renderer::SetDimensionTextHeight(dimensionTextHeight);
+        }
+        if (dimensions.GetCount() > 0) {
+            ImGui::Text("%zu dimensions, %u quads, %u strings laid out", dimensions.GetCount(), stats.DimensionQuads,
+                stats.DimensionsLaidOut);
+        }
+        if (s_bSelectDrag)
+            ImGui::Text("Selecting %zu lines", dragSelection.GetCount());
+        else if (!selection.IsEmpty())
+            ImGui::Text("Selected %zu lines", selection.GetCount());
+        if (hasPickedLine && document.IsLineValid(pickedLine)) {
+            ImGui::Text("Picked line %u in chunk %u", EasyLine::GetHandleSlot(pickedLine), EasyLine::GetHandleChunk(pickedLine));
+        }
+        if (journal.IsAttached()) {
+            ImGui::Text("Journal: %zu unsaved edits, %.1f MB%s", journal.GetPendingCount(), journal.GetSize() / 1e6,
+                journal.IsCompacting() ? ", compacting" : "");
+        }
+        if (autosave.IsActive()) {
+            ImGui::Text("Autosave: %s%s", autosave.GetPath().c_str(), autosave.IsSaving() ? " (saving)" : "");
+            if (autosave.GetLastSaveMs() > 0.0) {
+                ImGui::SameLine();
+                ImGui::Text("last took %.0f ms", autosave.GetLastSaveMs());
+            }
+        }
+        if (loadTask) {
+            switch (loadTask->GetState()) {
+            case EasyLine::LoadState::Loading:
+                ImGui::ProgressBar(loadTask->GetProgress(), ImVec2(-80.0f, 0.0f));
+                ImGui::SameLine();
+                if (ImGui::Button("Cancel")) loadTask->Cancel();
+                ImGui::Text("%llu lines parsed", (unsigned long long)loadTask->GetLineCount());
+                break;
+            case EasyLine::LoadState::Completed:
+                ImGui::Text("Loaded %llu lines", (unsigned long long)loadTask->GetLineCount());
+                break;
+            case EasyLine::LoadState::Cancelled:
+                ImGui::Text("Loading cancelled");
+                break;
+            case EasyLine::LoadState::Failed:
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Load failed: %s", loadTask->GetError().c_str());
+                break;
+            }
+        }
         ImGui::End();
 
+        // selection outline: blue for window, green for crossing
+        if (s_bSelectDrag && s_selectPoints.size() >= 2) {
+            ImDrawList* drawList = ImGui::GetForegroundDrawList();
+            const bool window = s_selectPoints.back().x >= s_selectPoints.front().x;
+            const ImU32 color = window ? IM_COL32(80, 140, 255, 255) : IM_COL32(80, 220, 120, 255);
+            if (s_bLasso) {
+                std::vector<ImVec2> outline;
+                for (const glm::vec2& point : s_selectPoints) outline.push_back({ point.x, point.y });
+                drawList->AddPolyline(outline.data(), (int)outline.size(), color, ImDrawFlags_Closed, 1.5f);
+            } else {
+                const glm::vec2 min = glm::min(s_selectPoints.front(), s_selectPoints.back());
+                const glm::vec2 max = glm::max(s_selectPoints.front(), s_selectPoints.back());
+                drawList->AddRectFilled({ min.x, min.y }, { max.x, max.y }, (color & ~IM_COL32_A_MASK) | IM_COL32(0, 0, 0, 40));
+                drawList->AddRect({ min.x, min.y }, { max.x, max.y }, color, 0.0f, 0, 1.5f);
+            }
+        }
+
+        // intersections in view, as small crosses
+        if (showIntersections) {
+            ImDrawList* drawList = ImGui::GetForegroundDrawList();
+            const EasyLine::AABB view = camera.GetViewBounds();
+            const float scale = GetFramebufferScale(window);
+            int drawn = 0;
+            for (const EasyLine::LineIntersection& intersection : intersections) {
+                if (!view.Contains(intersection.Point)) continue;
+                if (++drawn > 20000) break;
+                const glm::vec2 p = camera.WorldToScreen(intersection.Point) / scale;
+                const ImU32 color = intersection.Overlap ? IM_COL32(255, 120, 60, 255) : IM_COL32(255, 80, 200, 255);
+                drawList->AddLine({ p.x - 3.0f, p.y - 3.0f }, { p.x + 3.0f, p.y + 3.0f }, color);
+                drawList->AddLine({ p.x - 3.0f, p.y + 3.0f }, { p.x + 3.0f, p.y - 3.0f }, color);
+            }
+        }
+
+        // snap marker in the usual drafting shapes, at the snapped point
+        if (hasSnap) {
+            ImDrawList* drawList = ImGui::GetForegroundDrawList();
+            const glm::vec2 p = camera.WorldToScreen(snap.Point) / GetFramebufferScale(window);
+            const ImVec2 c = { p.x, p.y };
+            const float r = 6.0f;
+            const ImU32 color = IM_COL32(255, 220, 60, 255);
+            switch (snap.Kind) {
+            case EasyLine::SnapKind::Endpoint:
+                drawList->AddRect({ c.x - r, c.y - r }, { c.x + r, c.y + r }, color, 0.0f, 0, 2.0f);
+                break;
+            case EasyLine::SnapKind::Intersection:
+                drawList->AddLine({ c.x - r, c.y - r }, { c.x + r, c.y + r }, color, 2.0f);
+                drawList->AddLine({ c.x - r, c.y + r }, { c.x + r, c.y - r }, color, 2.0f);
+                break;
+            case EasyLine::SnapKind::Midpoint:
+                drawList->AddTriangle({ c.x, c.y - r }, { c.x + r, c.y + r }, { c.x - r, c.y + r }, color, 2.0f);
+                break;
+            case EasyLine::SnapKind::Perpendicular:
+                drawList->AddLine({ c.x - r, c.y - r }, { c.x - r, c.y + r }, color, 2.0f);
+                drawList->AddLine({ c.x - r, c.y + r }, { c.x + r, c.y + r }, color, 2.0f);
+                drawList->AddLine({ c.x - r, c.y }, { c.x, c.y }, color, 2.0f);
+                drawList->AddLine({ c.x, c.y }, { c.x, c.y + r }, color, 2.0f);
+                break;
+            default:
+                drawList->AddLine({ c.x - r, c.y - r }, { c.x + r, c.y - r }, color, 2.0f);
+                drawList->AddLine({ c.x + r, c.y - r }, { c.x - r, c.y + r }, color, 2.0f);
+                drawList->AddLine({ c.x - r, c.y + r }, { c.x + r, c.y + r }, color, 2.0f);
+                drawList->AddLine({ c.x + r, c.y + r }, { c.x - r, c.y - r }, color, 2.0f);
+                break;
+            }
+        }
+
     ImGui::Render();
 
     int display_w, display_h;
@@ -135,9 +828,29 @@ int main(int, char**)
 
     // Draw some sample lines via our renderer (world coords)
     EasyLine::Renderer::BeginFrame(camera);
+    // the highlight follows the drag; only the selection bits are uploaded
+    if (selectionChanged) {
+        EasyLine::Renderer::SetSelection(s_bSelectDrag ? dragSelection : selection);
+        selectionChanged = false;
+    }
+    EasyLine::Renderer::DrawDocument(document);
+    if (hasHoveredLine && document.IsLineValid(hoveredLine)) {
+        const EasyLine::LineChunk& chunk = document.GetChunk(EasyLine::GetHandleChunk(hoveredLine));
+        const uint32_t slot = EasyLine::GetHandleSlot(hoveredLine);
+        const float thickness = std::max(chunk.Thickness[slot], 2.0f * camera.GetPixelSize());
+        EasyLine::Renderer::DrawLine(chunk.X0[slot], chunk.Y0[slot], chunk.X1[slot], chunk.Y1[slot], thickness, {1.0f,1.0f,0.6f,1.0f});
+    }
+    if (hasPickedLine && document.IsLineValid(pickedLine)) {
+        const EasyLine::LineChunk& chunk = document.GetChunk(EasyLine::GetHandleChunk(pickedLine));
+        const uint32_t slot = EasyLine::GetHandleSlot(pickedLine);
+        const float thickness = std::max(chunk.Thickness[slot], 3.0f * camera.GetPixelSize());
+        EasyLine::Renderer::DrawLine(chunk.X0[slot], chunk.Y0[slot], chunk.X1[slot], chunk.Y1[slot], thickness, {1.0f,0.6f,0.0f,1.0f});
+    }
     EasyLine::Renderer::DrawLine(-0.5f, -0.5f, 0.5f, 0.5f, 0.05f, {1.0f,0.0f,0.0f,1.0f});
     EasyLine::Renderer::DrawLine(-0.5f, 0.5f, 0.5f, -0.5f, 0.05f, {0.0f,1.0f,0.0f,1.0f});
     EasyLine::Renderer::Flush();
+    EasyLine::Renderer::DrawDimensions(dimensions);
+    EasyLine::Renderer::EndFrame();
 
     // Render ImGui on top
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -145,6 +858,10 @@ int main(int, char**)
     }
 
     // Cleanup
+    if (loadTask) loadTask->Cancel();
+    journal.Detach();
+    autosave.Stop(true);
+    EasyLine::JobSystem::Shutdown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
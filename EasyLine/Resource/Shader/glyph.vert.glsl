@@ -0,0 +1,17 @@
+#version 330 core
+// One quad per instance: a glyph, or a stroke drawn from the atlas's solid texels
+layout(location = 0) in vec2 aPosition;  // corner (0, 0), world
+layout(location = 1) in vec2 aRight;     // from there to corner (1, 0)
+layout(location = 2) in vec2 aUp;        // from there to corner (0, 1)
+layout(location = 3) in vec2 aUvMin;     // atlas at corner (0, 0)
+layout(location = 4) in vec2 aUvMax;     // atlas at corner (1, 1)
+out vec2 vUv;
+
+uniform mat4 u_ViewProjection;
+
+void main() {
+    // a triangle strip over the corners (0, 0) (1, 0) (0, 1) (1, 1)
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vUv = mix(aUvMin, aUvMax, corner);
+    gl_Position = u_ViewProjection * vec4(aPosition + corner.x * aRight + corner.y * aUp, 0.0, 1.0);
+}
@@ -0,0 +1,7 @@
+#version 330 core
+flat in uint gId;
+out uint FragId;
+
+void main() {
+    FragId = gId;
+}
@@ -0,0 +1,33 @@
+#version 330 core
+// A line arrives as two triangles, (p0+o, p1+o, p0-o) and (p1+o, p1-o, p0-o)
+// (see TessellateLine). The first is emitted as the whole quad, at least
+// u_MinHalfWidth wide on each side so hairlines still cover pixels, and the
+// second is dropped.
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 4) out;
+in vec2 vPos[];
+flat out uint gId;
+
+uniform mat4 u_ViewProjection;
+uniform float u_MinHalfWidth;        // world units
+uniform usamplerBuffer u_Handles;    // handle of each line in the vertex buffer
+
+void main() {
+    if ((gl_PrimitiveIDIn & 1) != 0) return;
+
+    vec2 offset = (vPos[0] - vPos[2]) * 0.5;
+    vec2 p0 = vPos[0] - offset;
+    vec2 p1 = vPos[1] - offset;
+    float halfWidth = length(offset);
+    vec2 d = p1 - p0;
+    vec2 normal = halfWidth > 0.0 ? offset / halfWidth : (dot(d, d) > 0.0 ? normalize(vec2(-d.y, d.x)) : vec2(0.0, 1.0));
+    offset = normal * max(halfWidth, u_MinHalfWidth);
+
+    // 0 in the ID buffer is no line
+    uint id = texelFetch(u_Handles, gl_PrimitiveIDIn / 2).r + 1u;
+    gId = id; gl_Position = u_ViewProjection * vec4(p0 + offset, 0.0, 1.0); EmitVertex();
+    gId = id; gl_Position = u_ViewProjection * vec4(p1 + offset, 0.0, 1.0); EmitVertex();
+    gId = id; gl_Position = u_ViewProjection * vec4(p0 - offset, 0.0, 1.0); EmitVertex();
+    gId = id; gl_Position = u_ViewProjection * vec4(p1 - offset, 0.0, 1.0); EmitVertex();
+    EndPrimitive();
+}
@@ -0,0 +1,8 @@
+#version 330 core
+layout(location = 0) in vec2 aPos;   // the document's vertex buffer, six vertices per line
+out vec2 vPos;
+
+void main() {
+    vPos = aPos;
+    gl_Position = vec4(aPos, 0.0, 1.0);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+in vec2 vUv;
+out vec4 FragColor;
+
+uniform sampler2D u_Atlas;  // distance to the glyph outlines, 0.5 on them and more inside
+uniform vec4 u_Color;
+
+void main() {
+    // the edge is where the distance crosses 0.5, smoothed over the one
+    // pixel it takes to change by fwidth, whatever the magnification
+    float distance = texture(u_Atlas, vUv).r;
+    float alpha = clamp((distance - 0.5) / max(fwidth(distance), 1e-5) + 0.5, 0.0, 1.0);
+    FragColor = vec4(u_Color.rgb, u_Color.a * alpha);
+}
@@ -0,0 +1,16 @@
+#version 330 core
+layout(location = 0) in vec2 aPos;   // the document's vertex buffer, six vertices per line
+out vec4 vColor;
+
+uniform mat4 u_ViewProjection;
+uniform vec4 u_Color;
+uniform usamplerBuffer u_Selection;  // one bit per line handle
+uniform usamplerBuffer u_Handles;    // handle of each line in the vertex buffer
+
+void main() {
+    uint handle = texelFetch(u_Handles, gl_VertexID / 6).r;
+    uint bits = texelFetch(u_Selection, int(handle >> 5u)).r;
+    vColor = u_Color;
+    // lines not selected collapse outside the clip volume and draw nothing
+    gl_Position = ((bits >> (handle & 31u)) & 1u) != 0u ? u_ViewProjection * vec4(aPos, 0.0, 1.0) : vec4(2.0, 2.0, 2.0, 1.0);
+}